@@ -50,12 +50,14 @@ extern "C" {
  *  \verbatim
     ++-----------------------sample is signed if set
     ||
-    ||       ++-----------sample is bigendian if set
-    ||       ||
-    ||       ||          ++---sample is float if set
-    ||       ||          ||
-    ||       ||          || +---sample bit size---+
-    ||       ||          || |                     |
+    ||    ++-----------------channels are planar if set
+    ||    ||
+    ||    || ++-----------sample is bigendian if set
+    ||    || ||
+    ||    || ||          ++---sample is float if set
+    ||    || ||          ||
+    ||    || ||          || +---sample bit size---+
+    ||    || ||          || |                     |
     15 14 13 12 11 10 09 08 07 06 05 04 03 02 01 00
     \endverbatim
  *
@@ -71,6 +73,7 @@ typedef Uint16 SDL_AudioFormat;
 #define SDL_AUDIO_MASK_BITSIZE       (0xFF)
 #define SDL_AUDIO_MASK_DATATYPE      (1<<8)
 #define SDL_AUDIO_MASK_ENDIAN        (1<<12)
+#define SDL_AUDIO_MASK_PLANAR        (1<<13)
 #define SDL_AUDIO_MASK_SIGNED        (1<<15)
 #define SDL_AUDIO_BITSIZE(x)         (x & SDL_AUDIO_MASK_BITSIZE)
 #define SDL_AUDIO_ISFLOAT(x)         (x & SDL_AUDIO_MASK_DATATYPE)
@@ -79,6 +82,8 @@ typedef Uint16 SDL_AudioFormat;
 #define SDL_AUDIO_ISINT(x)           (!SDL_AUDIO_ISFLOAT(x))
 #define SDL_AUDIO_ISLITTLEENDIAN(x)  (!SDL_AUDIO_ISBIGENDIAN(x))
 #define SDL_AUDIO_ISUNSIGNED(x)      (!SDL_AUDIO_ISSIGNED(x))
+#define SDL_AUDIO_ISPLANAR(x)        (x & SDL_AUDIO_MASK_PLANAR)
+#define SDL_AUDIO_ISINTERLEAVED(x)   (!SDL_AUDIO_ISPLANAR(x))
 
 /**
  *  \name Audio format flags
@@ -131,6 +136,24 @@ typedef Uint16 SDL_AudioFormat;
 #endif
 /* @} */
 
+/**
+ *  \name Planar audio
+ *
+ *  Any format can have SDL_AUDIO_MASK_PLANAR set, meaning a buffer holds
+ *  each channel's samples one after another ("LLLLRRRR") instead of
+ *  interleaved ("LRLRLRLR"). A buffer of (len) bytes holds (channels)
+ *  planes of (len / channels) bytes each, so len must be a whole number of
+ *  sample frames; mono planar data is the same as interleaved.
+ *  SDL_ConvertAudio() and SDL_QueueAudio() (and
+ *  SDL_DequeueAudio()) take planar data directly, and audio callbacks get
+ *  planar buffers if the device was opened with a planar format. Audio
+ *  hardware never sees planar data; SDL converts it on the way.
+ */
+/* @{ */
+#define AUDIO_S16P      (AUDIO_S16SYS | SDL_AUDIO_MASK_PLANAR)  /**< Native-endian signed 16-bit samples, planar */
+#define AUDIO_F32P      (AUDIO_F32SYS | SDL_AUDIO_MASK_PLANAR)  /**< Native-endian float samples, planar */
+/* @} */
+
 /**
  *  \name Allow change flags
  *
@@ -384,6 +407,102 @@ extern DECLSPEC SDL_AudioStatus SDLCALL
 SDL_GetAudioDeviceStatus(SDL_AudioDeviceID dev);
 /* @} *//* Audio State */
 
+/**
+ *  Get the buffer sizes an opened audio device is really running with,
+ *  in sample frames of the device's format (which may differ from the
+ *  format the callback sees, if SDL is converting).
+ *
+ *  \param dev The device to query.
+ *  \param period_frames Receives how many frames the device consumes
+ *                       between wakeups of the audio thread. May be NULL.
+ *  \param buffer_frames Receives the total number of frames the device
+ *                       buffers ahead of playback. May be NULL.
+ *
+ *  Drivers that can't tell report a single period of spec.samples frames.
+ *
+ *  \return 0 on success, or -1 on error (invalid device ID).
+ */
+extern DECLSPEC int SDLCALL SDL_GetAudioDeviceBufferSize(SDL_AudioDeviceID dev,
+                                                         int *period_frames,
+                                                         int *buffer_frames);
+
+/**
+ *  Get how long it will be until audio the callback produces now is
+ *  heard (or, for capture devices, how old captured audio is by the time
+ *  the callback sees it), in microseconds. Apps can use this to keep
+ *  audio in sync with video.
+ *
+ *  This includes the device's own buffering and any data SDL is holding
+ *  for conversion, but not audio queued with SDL_QueueAudio() (use
+ *  SDL_GetQueuedAudioSize() for that). Drivers that can't ask the system
+ *  report the size of the device buffer.
+ *
+ *  \param dev The device to query.
+ *
+ *  \return The latency in microseconds, or -1 on error (invalid device ID).
+ */
+extern DECLSPEC int SDLCALL SDL_GetAudioDeviceLatency(SDL_AudioDeviceID dev);
+
+/**
+ *  Timing statistics SDL keeps for each opened audio device, to help pick
+ *  a buffer size that doesn't glitch. Times are in microseconds.
+ *
+ *  \sa SDL_GetAudioDeviceStats
+ */
+typedef struct SDL_AudioDeviceStats
+{
+    Uint32 callbacks;           /**< Number of times the callback has run */
+    Uint32 period_usec;         /**< How often the callback should run, on average */
+    Uint32 callback_usec_avg;   /**< Average time spent in the callback */
+    Uint32 callback_usec_max;   /**< Longest time spent in the callback */
+    Uint32 late_callbacks;      /**< Callbacks that took longer than period_usec */
+    Uint32 jitter_usec_avg;     /**< Average difference between period_usec and the real time between callbacks */
+    Uint32 jitter_usec_max;     /**< Largest difference between period_usec and the real time between callbacks */
+    Uint32 underruns;           /**< Times the device ran out of data (or, for capture, lost data) */
+    Uint32 device_samples;      /**< Current size of the device buffer, in sample frames */
+    Uint32 resizes;             /**< Times SDL resized the device buffer, see SDL_HINT_AUDIO_ADAPTIVE_LATENCY_USEC */
+    Uint32 capture_overruns;    /**< Capture blocks dropped because the ring was full, see SDL_HINT_AUDIO_CAPTURE_RING_MS */
+} SDL_AudioDeviceStats;
+
+/**
+ *  Get timing statistics for an opened audio device, collected since it
+ *  was opened.
+ *
+ *  Callback timings are measured by SDL's audio thread, so they are zero
+ *  for targets that drive the callback from their own thread. Underruns
+ *  are counted by the audio driver, where it can tell. When SDL converts
+ *  between differently sized callback and device buffers, callbacks run
+ *  in bursts and the jitter values grow accordingly.
+ *
+ *  \param dev The device to query.
+ *  \param stats Receives the statistics.
+ *
+ *  \return 0 on success, or -1 on error (invalid device ID).
+ */
+extern DECLSPEC int SDLCALL SDL_GetAudioDeviceStats(SDL_AudioDeviceID dev,
+                                                    SDL_AudioDeviceStats *stats);
+
+/**
+ *  Get the sample frame an opened audio device is playing right now (or,
+ *  for capture devices, recording), counting frames in the callback's
+ *  format since the device was opened.
+ *
+ *  This combines what SDL has handed to the device with the delay the
+ *  driver reports, so it is as precise as the driver allows. The clock
+ *  keeps running while the device is paused, as it plays silence then.
+ *
+ *  \param dev The device to query.
+ *  \param timestamp If not NULL, receives the SDL_GetPerformanceCounter()
+ *                   value at which the position was measured.
+ *
+ *  \return The frame, or -1 on error (invalid device ID, or a target that
+ *          runs the callback from its own thread and can't tell).
+ *
+ *  \sa SDL_QueueAudioAt
+ */
+extern DECLSPEC Sint64 SDLCALL SDL_GetAudioDevicePosition(SDL_AudioDeviceID dev,
+                                                          Uint64 *timestamp);
+
 /**
  *  \name Pause audio functions
  *
@@ -436,6 +555,95 @@ extern DECLSPEC SDL_AudioSpec *SDLCALL SDL_LoadWAV_RW(SDL_RWops * src,
  */
 extern DECLSPEC void SDLCALL SDL_FreeWAV(Uint8 * audio_buf);
 
+/**
+ *  \brief A WAVE file that is read and decoded a piece at a time.
+ *
+ *  Unlike SDL_LoadWAV_RW(), this never holds more than a small, fixed
+ *  amount of the file in memory, so it's suitable for long soundtracks.
+ *
+ *  \sa SDL_OpenWAVStream_RW
+ */
+struct SDL_WAVStream;
+typedef struct SDL_WAVStream SDL_WAVStream;
+
+/**
+ *  This function opens a WAVE from the data source for incremental
+ *  decoding, automatically freeing that source when the stream is closed
+ *  if \c freesrc is non-zero. Only the headers are read here.
+ *
+ *  If \c spec is not NULL, it is filled with the audio data format of the
+ *  wave data, as SDL_LoadWAV_RW() would report it.
+ *
+ *  The data source must stay valid while the stream is open, and must be
+ *  seekable if you want to use SDL_WAVStreamSeek().
+ *
+ *  \return the new stream, or NULL on error (call SDL_GetError() for
+ *          more information).
+ *
+ *  \sa SDL_WAVStreamRead
+ *  \sa SDL_CloseWAVStream
+ */
+extern DECLSPEC SDL_WAVStream *SDLCALL SDL_OpenWAVStream_RW(SDL_RWops * src,
+                                                            int freesrc,
+                                                            SDL_AudioSpec * spec);
+
+/**
+ *  Opens a WAV file for incremental decoding.
+ *  Convenience function.
+ */
+#define SDL_OpenWAVStream(file, spec) \
+    SDL_OpenWAVStream_RW(SDL_RWFromFile(file, "rb"),1, spec)
+
+/**
+ *  Make SDL_WAVStreamRead() convert the audio to the format, channels and
+ *  frequency in \c spec as it decodes it. Passing the file's own format
+ *  turns conversion off again.
+ *
+ *  \return 0 on success, or -1 on error.
+ */
+extern DECLSPEC int SDLCALL SDL_SetWAVStreamFormat(SDL_WAVStream * wav,
+                                                   const SDL_AudioSpec * spec);
+
+/**
+ *  Decode up to \c len bytes of audio into \c buf. Only whole sample
+ *  frames are returned.
+ *
+ *  \return the number of bytes decoded, 0 at the end of the data, or -1
+ *          on error.
+ */
+extern DECLSPEC int SDLCALL SDL_WAVStreamRead(SDL_WAVStream * wav,
+                                              void *buf, int len);
+
+/**
+ *  Move the stream to sample frame \c frame, counting from the start of
+ *  the data. Any audio waiting to be converted is discarded.
+ *
+ *  \return 0 on success, or -1 on error.
+ */
+extern DECLSPEC int SDLCALL SDL_WAVStreamSeek(SDL_WAVStream * wav,
+                                              Sint64 frame);
+
+/**
+ *  Get the sample frame the stream will decode next. When the stream is
+ *  converting, audio that is still waiting in the converter counts as
+ *  already read.
+ *
+ *  \return the frame, or -1 on error.
+ */
+extern DECLSPEC Sint64 SDLCALL SDL_WAVStreamTell(SDL_WAVStream * wav);
+
+/**
+ *  Get the length of the wave data, in sample frames.
+ *
+ *  \return the number of frames, or -1 on error.
+ */
+extern DECLSPEC Sint64 SDLCALL SDL_WAVStreamLength(SDL_WAVStream * wav);
+
+/**
+ *  Close a stream opened with SDL_OpenWAVStream_RW().
+ */
+extern DECLSPEC void SDLCALL SDL_CloseWAVStream(SDL_WAVStream * wav);
+
 /**
  *  This function takes a source format and rate and a destination format
  *  and rate, and initializes the \c cvt structure with information needed
@@ -486,6 +694,113 @@ extern DECLSPEC void SDLCALL SDL_MixAudioFormat(Uint8 * dst,
                                                 SDL_AudioFormat format,
                                                 Uint32 len, int volume);
 
+/**
+ *  \name Audio mixer
+ *
+ *  An SDL_AudioMixer mixes any number of voices into one output format. Each
+ *  voice has its own format, channel count and sample rate, plus a gain and
+ *  pan, and is fed by pushing data to it with SDL_AudioVoicePut(). A typical
+ *  use is to call SDL_AudioMixerMix() from the audio callback of a device
+ *  opened with the mixer's output format.
+ *
+ *  Voices are converted, resampled and mixed in a single pass over the
+ *  output, so adding voices doesn't add intermediate buffers. Mono and
+ *  stereo voices are supported; they're mixed to the first two channels of
+ *  the output. Resampling adds two frames of latency to each voice.
+ *
+ *  A mixer and its voices are safe to use from different threads.
+ */
+/* @{ */
+
+struct SDL_AudioMixer;
+typedef struct SDL_AudioMixer SDL_AudioMixer;
+
+struct SDL_AudioVoice;
+typedef struct SDL_AudioVoice SDL_AudioVoice;
+
+/**
+ *  Create a mixer that produces audio in the given format.
+ *
+ *  \param format The output data format.
+ *  \param channels The number of output channels.
+ *  \param freq The output sample rate.
+ *  \return The new mixer, or NULL on error.
+ */
+extern DECLSPEC SDL_AudioMixer * SDLCALL SDL_NewAudioMixer(SDL_AudioFormat format,
+                                                           Uint8 channels,
+                                                           int freq);
+
+/**
+ *  Add a voice to a mixer. It starts out silent, at full gain and centered.
+ *
+ *  \param mixer The mixer to add the voice to.
+ *  \param format The format of the data that will be put to the voice.
+ *  \param channels The number of channels of that data (1 or 2).
+ *  \param freq The sample rate of that data.
+ *  \return The new voice, or NULL on error.
+ */
+extern DECLSPEC SDL_AudioVoice * SDLCALL SDL_AudioMixerAddVoice(SDL_AudioMixer * mixer,
+                                                                SDL_AudioFormat format,
+                                                                Uint8 channels,
+                                                                int freq);
+
+/**
+ *  Remove a voice from its mixer and free it. Any data still queued for it
+ *  is dropped.
+ */
+extern DECLSPEC void SDLCALL SDL_AudioMixerRemoveVoice(SDL_AudioVoice * voice);
+
+/**
+ *  Queue more data for a voice to play, in the format the voice was created
+ *  with. \c len must be a whole number of sample frames.
+ *
+ *  \return 0 on success, -1 on error.
+ */
+extern DECLSPEC int SDLCALL SDL_AudioVoicePut(SDL_AudioVoice * voice,
+                                              const void *buf, Uint32 len);
+
+/**
+ *  Get the number of bytes still queued for a voice.
+ *
+ *  This is measured after any format conversion, so it's only useful to
+ *  compare against zero or to an earlier result.
+ */
+extern DECLSPEC int SDLCALL SDL_AudioVoiceQueued(SDL_AudioVoice * voice);
+
+/**
+ *  Drop any data still queued for a voice.
+ */
+extern DECLSPEC void SDLCALL SDL_AudioVoiceClear(SDL_AudioVoice * voice);
+
+/**
+ *  Set a voice's gain and pan.
+ *
+ *  \param voice The voice to change.
+ *  \param gain Linear gain, 1.0f plays the voice unchanged.
+ *  \param pan -1.0f is full left, 0.0f is centered and 1.0f is full right.
+ *             Panning a stereo voice attenuates the opposite channel.
+ *  \return 0 on success, -1 on error.
+ */
+extern DECLSPEC int SDLCALL SDL_SetAudioVoiceGain(SDL_AudioVoice * voice,
+                                                  float gain, float pan);
+
+/**
+ *  Mix all of a mixer's voices into \c buf, overwriting it. \c len must be a
+ *  whole number of sample frames in the mixer's output format. Voices that
+ *  run out of data are mixed as silence for the rest of the buffer.
+ *
+ *  \return 0 on success, -1 on error.
+ */
+extern DECLSPEC int SDLCALL SDL_AudioMixerMix(SDL_AudioMixer * mixer,
+                                              void *buf, Uint32 len);
+
+/**
+ *  Free a mixer and all of its voices.
+ */
+extern DECLSPEC void SDLCALL SDL_FreeAudioMixer(SDL_AudioMixer * mixer);
+
+/* @} *//* Audio mixer */
+
 /**
  *  Queue more audio on non-callback devices.
  *
@@ -527,6 +842,31 @@ extern DECLSPEC void SDLCALL SDL_MixAudioFormat(Uint8 * dst,
  */
 extern DECLSPEC int SDLCALL SDL_QueueAudio(SDL_AudioDeviceID dev, const void *data, Uint32 len);
 
+/**
+ *  Queue audio on a non-callback device to start playing at a given frame
+ *  of the device's clock, as reported by SDL_GetAudioDevicePosition().
+ *
+ *  If the audio queued so far runs out before (frame), SDL plays silence
+ *  until then. If the device is paused when (frame) comes around, the
+ *  audio that should have played meanwhile is skipped, so the rest still
+ *  plays on schedule. Data queued with SDL_QueueAudio() afterwards plays
+ *  right after this.
+ *
+ *  This fails if (frame) is earlier than the end of the audio already
+ *  queued, or earlier than the next frame the device will ask for, which
+ *  is about SDL_GetAudioDeviceLatency() after the current position.
+ *
+ *  \param dev The device ID to which we will queue audio.
+ *  \param frame The frame at which (data) should start playing.
+ *  \param data The data to queue to the device for later playback.
+ *  \param len The number of bytes (not samples!) to which (data) points.
+ *  \return zero on success, -1 on error (including if (frame) is too early).
+ *
+ *  \sa SDL_QueueAudio
+ *  \sa SDL_GetAudioDevicePosition
+ */
+extern DECLSPEC int SDLCALL SDL_QueueAudioAt(SDL_AudioDeviceID dev, Sint64 frame, const void *data, Uint32 len);
+
 /**
  *  Dequeue more audio on non-callback devices.
  *
@@ -544,6 +884,8 @@ extern DECLSPEC int SDLCALL SDL_QueueAudio(SDL_AudioDeviceID dev, const void *da
  *  exhaustion of address space. Data from the device will keep queuing as
  *  necessary without further intervention from you. This means you will
  *  eventually run out of memory if you aren't routinely dequeueing data.
+ *  To bound that, set SDL_HINT_AUDIO_CAPTURE_RING_MS before opening the
+ *  device; SDL then keeps a fixed amount and drops new data when it's full.
  *
  *  Capture devices will not queue data when paused; if you are expecting
  *  to not need captured audio for some length of time, use
@@ -573,6 +915,26 @@ extern DECLSPEC int SDLCALL SDL_QueueAudio(SDL_AudioDeviceID dev, const void *da
  */
 extern DECLSPEC Uint32 SDLCALL SDL_DequeueAudio(SDL_AudioDeviceID dev, void *data, Uint32 len);
 
+/**
+ *  Dequeue captured audio, like SDL_DequeueAudio(), and report when it was
+ *  recorded.
+ *
+ *  (timestamp) receives the SDL_GetPerformanceCounter() time at which the
+ *  first returned sample frame was captured by the device, on the same
+ *  clock as SDL_GetAudioDevicePosition(). Timestamps are only kept when
+ *  the device uses a capture ring (see SDL_HINT_AUDIO_CAPTURE_RING_MS);
+ *  otherwise, or when nothing is dequeued, (timestamp) is set to zero.
+ *
+ *  \param dev The device ID from which we will dequeue audio.
+ *  \param data A pointer into where audio data should be copied.
+ *  \param len The number of bytes (not samples!) to which (data) points.
+ *  \param timestamp Receives the capture time of the first frame. May be NULL.
+ *  \return number of bytes dequeued, which could be less than requested.
+ *
+ *  \sa SDL_DequeueAudio
+ */
+extern DECLSPEC Uint32 SDLCALL SDL_DequeueAudioWithTimestamp(SDL_AudioDeviceID dev, void *data, Uint32 len, Uint64 *timestamp);
+
 /**
  *  Get the number of bytes of still-queued audio.
  *
@@ -801,6 +801,154 @@ extern "C" {
  */
 #define SDL_HINT_AUDIO_RESAMPLING_MODE   "SDL_AUDIO_RESAMPLING_MODE"
 
+/**
+ *  \brief  A variable controlling whether the ALSA audio driver runs in low-latency mode.
+ *
+ *  In low-latency mode, SDL maps the device's ring buffer into memory and
+ *  sleeps on the device's poll descriptors, so the audio callback renders
+ *  straight into the hardware buffer and the audio thread wakes up exactly
+ *  when a period has been consumed. Devices that don't support mmap access
+ *  fall back to the normal mode.
+ *
+ *  This hint is checked when an audio device is opened.
+ *
+ *  This variable can be set to the following values:
+ *    "0"       - Use read/write access and blocking calls (default)
+ *    "1"       - Use mmap access and poll(), if the device supports it
+ */
+#define SDL_HINT_AUDIO_ALSA_LOW_LATENCY   "SDL_AUDIO_ALSA_LOW_LATENCY"
+
+/**
+ *  \brief  A variable setting the latency the PulseAudio driver should aim for, in microseconds.
+ *
+ *  When this is set, SDL drives the PulseAudio stream from a threaded main
+ *  loop, waking the audio thread on the server's write requests, and asks
+ *  the server to adjust its buffering so that the total latency matches
+ *  this value. The device's sample count is shrunk to fit, if needed.
+ *  SDL_GetAudioDeviceLatency() reports what the server actually achieved.
+ *
+ *  This hint is checked when an audio device is opened.
+ *
+ *  This variable can be set to the following values:
+ *    "0"       - Use the default, fixed buffering (default)
+ *    "N"       - Aim for a latency of N microseconds (for example, "20000" for 20ms)
+ */
+#define SDL_HINT_AUDIO_PULSEAUDIO_LATENCY_USEC   "SDL_AUDIO_PULSEAUDIO_LATENCY_USEC"
+
+/**
+ *  \brief  A variable enabling adaptive buffer sizing for audio playback, and setting its latency target in microseconds.
+ *
+ *  When this is set, the device buffer starts out holding about this much
+ *  audio, whatever the app asked for in SDL_AudioSpec.samples (the callback
+ *  still gets the size it asked for). Whenever the driver reports underruns,
+ *  SDL doubles the device buffer; once playback has been clean for a while,
+ *  it halves it again, never going below the target. Each time the buffer
+ *  has to grow, SDL waits longer before trying to shrink it.
+ *
+ *  Only drivers that can resize an open device support this; others keep
+ *  the fixed size. SDL_GetAudioDeviceStats() reports the current size.
+ *
+ *  This hint is checked when an audio device is opened.
+ *
+ *  This variable can be set to the following values:
+ *    "0"       - Use a fixed device buffer (default)
+ *    "N"       - Adapt the device buffer, aiming for N microseconds (for example, "10000" for 10ms)
+ */
+#define SDL_HINT_AUDIO_ADAPTIVE_LATENCY_USEC   "SDL_AUDIO_ADAPTIVE_LATENCY_USEC"
+
+/**
+ *  \brief  A variable making the dummy and disk audio drivers simulate a heavily loaded system.
+ *
+ *  These drivers normally consume (or produce) audio at exactly the rate a
+ *  real device would. With this set, after each buffer the device thread
+ *  stalls for a random time of up to this many milliseconds, and the driver
+ *  counts an underrun whenever its simulated device runs out of data as a
+ *  result. This is useful to test SDL_GetAudioDeviceStats() and
+ *  SDL_HINT_AUDIO_ADAPTIVE_LATENCY_USEC without real hardware.
+ *
+ *  This hint is checked when an audio device is opened.
+ *
+ *  This variable can be set to the following values:
+ *    "0"       - Don't stall (default)
+ *    "N"       - Stall for up to N milliseconds after each buffer
+ */
+#define SDL_HINT_AUDIO_SIMULATED_LOAD   "SDL_AUDIO_SIMULATED_LOAD"
+
+/**
+ *  \brief  A variable making queued audio capture use a fixed-size ring buffer.
+ *
+ *  By default, a capture device opened without a callback keeps queueing
+ *  data until SDL_DequeueAudio() takes it, growing without limit. With this
+ *  set, SDL instead keeps about this many milliseconds of audio in a ring
+ *  buffer. The capture thread never waits for readers: when the ring is
+ *  full, new data is dropped and counted in SDL_AudioDeviceStats, and
+ *  SDL_DequeueAudio() never blocks the capture thread. Each block also
+ *  records when it was captured, see SDL_DequeueAudioWithTimestamp().
+ *
+ *  This hint is checked when an audio device is opened.
+ *
+ *  This variable can be set to the following values:
+ *    "0"       - Use an unbounded queue (default)
+ *    "N"       - Keep up to N milliseconds of audio in a ring buffer
+ */
+#define SDL_HINT_AUDIO_CAPTURE_RING_MS   "SDL_AUDIO_CAPTURE_RING_MS"
+
+/**
+ *  \brief  A variable controlling how many threads decode ADPCM WAVE data.
+ *
+ *  ADPCM blocks decode independently of each other, so when SDL_LoadWAV_RW()
+ *  or a big SDL_WAVStreamRead() has many of them to do, SDL splits them over
+ *  several threads. Small reads are always decoded on the calling thread.
+ *
+ *  This hint is checked when the WAVE data is opened.
+ *
+ *  This variable can be set to the following values:
+ *    "1"       - Decode on the calling thread only
+ *    "N"       - Use up to N threads (at most 8)
+ *
+ *  By default SDL uses one thread per CPU core.
+ */
+#define SDL_HINT_WAVE_DECODE_THREADS   "SDL_WAVE_DECODE_THREADS"
+
+/**
+ *  \brief  A variable controlling how many threads do big software blits.
+ *
+ *  Rows of a blit don't depend on each other, so when SDL_BlitSurface() or
+ *  SDL_BlitScaled() has a lot of pixels to do, SDL splits the destination
+ *  rows into bands and blits them on several threads. The result is the
+ *  same as blitting on one thread. Blits of less than 64K pixels per thread
+ *  always run on the calling thread, as do blits of a surface onto itself.
+ *
+ *  This hint is checked on every blit that is big enough to split.
+ *
+ *  This variable can be set to the following values:
+ *    "1"       - Blit on the calling thread only
+ *    "N"       - Use up to N threads (at most 8)
+ *
+ *  By default SDL uses one thread per CPU core.
+ */
+#define SDL_HINT_BLIT_THREADS   "SDL_BLIT_THREADS"
+
+/**
+ *  \brief  A variable that hides CPU features from SDL and the app.
+ *
+ *  SDL_HasSSE2() and friends report the listed features as missing, so SDL
+ *  picks the code paths it would use on a CPU without them. This is meant
+ *  for testing and benchmarking the fallbacks; it can't enable a feature
+ *  the CPU lacks. Hiding a feature also hides the ones that build on it,
+ *  so "sse2" hides SSE2 through AVX2.
+ *
+ *  Code that the compiler was told may assume a feature (for example, SSE2
+ *  on x86_64) still uses it wherever SDL doesn't check at runtime.
+ *
+ *  This hint is checked the first time SDL looks up CPU features.
+ *
+ *  This variable is a comma or space separated list of: "mmx", "3dnow",
+ *  "sse", "sse2", "sse3", "sse41", "sse42", "avx", "avx2", "altivec",
+ *  "neon", or "all" to hide every SIMD feature.
+ */
+#define SDL_HINT_CPU_DISABLE_FEATURES   "SDL_CPU_DISABLE_FEATURES"
+
 /**
  *  \brief  An enumeration of hint priorities
  */
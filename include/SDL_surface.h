@@ -483,6 +483,24 @@ extern DECLSPEC int SDLCALL SDL_SoftStretch(SDL_Surface * src,
                                             SDL_Surface * dst,
                                             const SDL_Rect * dstrect);
 
+/**
+ *  \brief Perform a filtered stretch blit between two surfaces.
+ *
+ *  Each direction that gets bigger is interpolated linearly between the
+ *  nearest source pixels, and each direction that gets smaller averages
+ *  all the source pixels under a destination pixel. The surfaces can have
+ *  different pixel formats, as long as neither is indexed or FOURCC.
+ *
+ *  Like SDL_SoftStretch(), this copies the pixels and ignores the source
+ *  surface's blend mode, color key and color and alpha modulation.
+ *
+ *  \return 0 on success, or -1 on error.
+ */
+extern DECLSPEC int SDLCALL SDL_SoftStretchLinear(SDL_Surface * src,
+                                                  const SDL_Rect * srcrect,
+                                                  SDL_Surface * dst,
+                                                  const SDL_Rect * dstrect);
+
 #define SDL_BlitScaled SDL_UpperBlitScaled
 
 /**
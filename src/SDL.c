@@ -42,6 +42,8 @@
 extern int SDL_HelperWindowCreate(void);
 extern int SDL_HelperWindowDestroy(void);
 #endif
+extern void SDL_QuitBlitThreads(void);
+extern void SDL_QuitBlitCache(void);
 
 
 /* The initialized subsystems */
@@ -357,6 +359,8 @@ SDL_Quit(void)
     SDL_TicksQuit();
 #endif
 
+    SDL_QuitBlitThreads();
+    SDL_QuitBlitCache();
     SDL_ClearHints();
     SDL_AssertionsQuit();
     SDL_LogResetPriorities();
@@ -245,6 +245,29 @@ SDL_AudioGetPendingBytes_Default(_THIS)
     return 0;
 }
 
+static void
+SDL_AudioGetDeviceBufferSize_Default(_THIS, int *period_frames, int *buffer_frames)
+{
+    /* assume the device plays one callback's worth of data at a time. */
+    *period_frames = *buffer_frames = (int) _this->spec.samples;
+}
+
+static int
+SDL_AudioGetDeviceLatency_Default(_THIS)
+{
+    /* assume the device's whole buffer is between us and the speakers. */
+    int period_frames = 0;
+    int buffer_frames = 0;
+    current_audio.impl.GetDeviceBufferSize(_this, &period_frames, &buffer_frames);
+    return (int) ((((Sint64) buffer_frames) * 1000000) / _this->spec.freq);
+}
+
+static int
+SDL_AudioResizeDevice_Default(_THIS, int samples)
+{
+    return SDL_Unsupported();  /* adaptive buffer sizing stays off. */
+}
+
 static Uint8 *
 SDL_AudioGetDeviceBuf_Default(_THIS)
 {
@@ -352,6 +375,9 @@ finish_audio_entry_points_init(void)
     FILL_STUB(WaitDevice);
     FILL_STUB(PlayDevice);
     FILL_STUB(GetPendingBytes);
+    FILL_STUB(GetDeviceBufferSize);
+    FILL_STUB(GetDeviceLatency);
+    FILL_STUB(ResizeDevice);
     FILL_STUB(GetDeviceBuf);
     FILL_STUB(CaptureFromDevice);
     FILL_STUB(FlushCapture);
@@ -464,6 +490,75 @@ void SDL_OpenedAudioDeviceDisconnected(SDL_AudioDevice *device)
     }
 }
 
+/* The audio backends call this when an opened device runs dry (or drops captured data). */
+void
+SDL_AudioDeviceUnderrun(SDL_AudioDevice *device)
+{
+    SDL_AtomicIncRef(&device->underruns);
+}
+
+void
+SDL_InitAudioClock(SDL_AudioClock *clock)
+{
+    const char *hint = SDL_GetHint(SDL_HINT_AUDIO_SIMULATED_LOAD);
+
+    SDL_zerop(clock);
+    clock->stall_ms = hint ? (Uint32) SDL_strtoul(hint, NULL, 10) : 0;
+    clock->seed = (Uint32) SDL_GetPerformanceCounter();
+}
+
+void
+SDL_WaitAudioClock(SDL_AudioDevice *device, SDL_AudioClock *clock)
+{
+    const Uint64 freq = SDL_GetPerformanceFrequency();
+    const Uint64 buffer_ticks = (((Uint64) device->spec.samples) * freq) / device->spec.freq;
+    Uint64 now = SDL_GetPerformanceCounter();
+    Uint64 target;
+
+    /* The simulated device holds two buffers: for playback, the one it's
+       playing and the one we just gave it; for capture, the one we're about
+       to take and the one it's recording into. Being later than that means
+       it ran dry (or overwrote data). */
+    if (clock->deadline == 0) {
+        clock->deadline = now;  /* just started. */
+    } else if (now > (device->iscapture ? clock->deadline + buffer_ticks : clock->deadline)) {
+        SDL_AudioDeviceUnderrun(device);
+        clock->deadline = now;
+    }
+    clock->deadline += buffer_ticks;
+
+    /* playback waits until there's room for another buffer, capture until
+       the next one has been recorded. */
+    target = device->iscapture ? clock->deadline : clock->deadline - buffer_ticks;
+    if (target > now) {
+        SDL_Delay((Uint32) (((target - now) * 1000) / freq));
+    }
+
+    if (clock->stall_ms > 0) {
+        clock->seed = (clock->seed * 1103515245) + 12345;
+        SDL_Delay((clock->seed >> 16) % (clock->stall_ms + 1));
+    }
+}
+
+int
+SDL_GetAudioClockLatency(SDL_AudioDevice *device, SDL_AudioClock *clock)
+{
+    const Uint64 deadline = clock->deadline;
+    const Uint64 now = SDL_GetPerformanceCounter();
+    Uint64 ticks;
+
+    /* playback: what's queued plays until the deadline. Capture: the
+       device has been recording since the last buffer we took ended. */
+    if (deadline == 0) {
+        ticks = 0;
+    } else if (device->iscapture) {
+        ticks = (now > deadline) ? (now - deadline) : 0;
+    } else {
+        ticks = (deadline > now) ? (deadline - now) : 0;
+    }
+    return (int) ((ticks * 1000000) / SDL_GetPerformanceFrequency());
+}
+
 static void
 mark_device_removed(void *handle, SDL_AudioDeviceItem *devices, SDL_bool *removedFlag)
 {
@@ -520,6 +615,35 @@ SDL_BufferQueueDrainCallback(void *userdata, Uint8 *stream, int len)
     SDL_assert(!device->iscapture);  /* this shouldn't ever happen, right?! */
     SDL_assert(len >= 0);  /* this shouldn't ever happen, right?! */
 
+    /* Audio queued with SDL_QueueAudioAt() waits for its frame. */
+    if (device->queue_start >= 0) {
+        const Sint64 framelen = (SDL_AUDIO_BITSIZE(device->callbackspec.format) / 8) * device->callbackspec.channels;
+        const Sint64 now = device->callback_frames;  /* this buffer starts here. */
+
+        if (device->queue_start > now) {
+            /* not there yet; play silence until then. */
+            const int silent = (int) SDL_min((device->queue_start - now) * framelen, (Sint64) len);
+            SDL_memset(stream, device->callbackspec.silence, silent);
+            stream += silent;
+            len -= silent;
+        } else {
+            /* we were paused past the start; skip what should have played. */
+            Sint64 skip = (now - device->queue_start) * framelen;
+            while ((skip > 0) && (len > 0)) {
+                const size_t skipped = SDL_ReadFromDataQueue(device->buffer_queue, stream, (size_t) SDL_min(skip, (Sint64) len));
+                if (skipped == 0) {
+                    break;
+                }
+                skip -= (Sint64) skipped;
+            }
+        }
+
+        if (len == 0) {
+            return;  /* the whole buffer was before the start. */
+        }
+        device->queue_start = -1;
+    }
+
     dequeued = SDL_ReadFromDataQueue(device->buffer_queue, stream, len);
     stream += dequeued;
     len -= (int) dequeued;
@@ -546,6 +670,52 @@ SDL_BufferQueueFillCallback(void *userdata, Uint8 *stream, int len)
     SDL_WriteToDataQueue(device->buffer_queue, stream, len);
 }
 
+/* Queue planar data a packet's worth of frames at a time, interleaving it
+   straight into the queue. Caller holds the device lock. */
+static int
+queue_planar_audio(SDL_AudioDevice *device, const Uint8 *data, Uint32 len)
+{
+    const int samplesize = SDL_AUDIO_BITSIZE(device->callbackspec.format) / 8;
+    const int channels = device->callbackspec.channels;
+    const int framelen = samplesize * channels;
+    const int frames = (int) (len / framelen);
+    const int pitch = frames * samplesize;  /* bytes per plane. */
+    const int maxframes = SDL_AUDIOBUFFERQUEUE_PACKETLEN / framelen;
+    int i;
+
+    for (i = 0; i < frames; i += maxframes) {
+        const int chunk = SDL_min(maxframes, frames - i);
+        void *dst = SDL_ReserveSpaceInDataQueue(device->buffer_queue, chunk * framelen);
+        if (!dst) {
+            return -1;  /* SDL_ReserveSpaceInDataQueue() set the error. */
+        }
+        SDL_InterleaveAudio(dst, data + (i * samplesize), pitch, samplesize, channels, chunk);
+    }
+    return 0;
+}
+
+static int
+queue_audio_data(SDL_AudioDevice *device, const void *data, Uint32 len)
+{
+    if (device->queue_planar) {
+        return queue_planar_audio(device, (const Uint8 *) data, len);
+    }
+    return SDL_WriteToDataQueue(device->buffer_queue, data, len);
+}
+
+/* Planar data has to come in whole frames, or the planes don't line up. */
+static int
+check_planar_len(SDL_AudioDevice *device, Uint32 len)
+{
+    if (device->queue_planar) {
+        const Uint32 framelen = (SDL_AUDIO_BITSIZE(device->callbackspec.format) / 8) * device->callbackspec.channels;
+        if ((len % framelen) != 0) {
+            return SDL_SetError("Planar audio must be queued in whole sample frames");
+        }
+    }
+    return 0;
+}
+
 int
 SDL_QueueAudio(SDL_AudioDeviceID devid, const void *data, Uint32 len)
 {
@@ -558,23 +728,135 @@ SDL_QueueAudio(SDL_AudioDeviceID devid, const void *data, Uint32 len)
         return SDL_SetError("This is a capture device, queueing not allowed");
     } else if (device->spec.callback != SDL_BufferQueueDrainCallback) {
         return SDL_SetError("Audio device has a callback, queueing not allowed");
+    } else if (check_planar_len(device, len) < 0) {
+        return -1;
     }
 
     if (len > 0) {
         current_audio.impl.LockDevice(device);
-        rc = SDL_WriteToDataQueue(device->buffer_queue, data, len);
+        rc = queue_audio_data(device, data, len);
         current_audio.impl.UnlockDevice(device);
     }
 
     return rc;
 }
 
+int
+SDL_QueueAudioAt(SDL_AudioDeviceID devid, Sint64 frame, const void *data, Uint32 len)
+{
+    SDL_AudioDevice *device = get_audio_device(devid);
+    Sint64 framelen, next, start, end;
+    int rc = 0;
+
+    if (!device) {
+        return -1;  /* get_audio_device() will have set the error state */
+    } else if (device->iscapture) {
+        return SDL_SetError("This is a capture device, queueing not allowed");
+    } else if (device->spec.callback != SDL_BufferQueueDrainCallback) {
+        return SDL_SetError("Audio device has a callback, queueing not allowed");
+    } else if (current_audio.impl.ProvidesOwnCallbackThread) {
+        return SDL_Unsupported();  /* no device clock to schedule against. */
+    } else if (check_planar_len(device, len) < 0) {
+        return -1;
+    }
+
+    framelen = (SDL_AUDIO_BITSIZE(device->callbackspec.format) / 8) * device->callbackspec.channels;
+
+    current_audio.impl.LockDevice(device);
+
+    /* Figure out where what's queued so far ends. */
+    next = device->callback_frames;  /* the next callback starts here. */
+    start = (device->queue_start >= 0) ? device->queue_start : next;
+    end = SDL_max(start + (Sint64) (SDL_CountDataQueue(device->buffer_queue) / framelen), next);
+
+    if (frame < end) {
+        rc = SDL_SetError("Audio is already queued (or playing) at that frame");
+    } else if (SDL_CountDataQueue(device->buffer_queue) == 0) {
+        device->queue_start = frame;
+    } else {
+        /* fill the gap after what's queued with silence. */
+        Uint8 silence[1024];
+        Sint64 gap = (frame - end) * framelen;
+        SDL_memset(silence, device->callbackspec.silence, sizeof (silence));
+        while ((gap > 0) && (rc == 0)) {
+            const size_t chunk = (size_t) SDL_min(gap, (Sint64) (sizeof (silence) - (sizeof (silence) % framelen)));
+            rc = SDL_WriteToDataQueue(device->buffer_queue, silence, chunk);
+            gap -= (Sint64) chunk;
+        }
+    }
+
+    if ((rc == 0) && (len > 0)) {
+        rc = queue_audio_data(device, data, len);
+    }
+
+    current_audio.impl.UnlockDevice(device);
+
+    return rc;
+}
+
+/* Bytes waiting in the capture ring. Caller holds ring_lock. */
+static Uint32
+ring_available(SDL_AudioDevice *device)
+{
+    const Uint32 blocks = (Uint32) SDL_AtomicGet(&device->ring_write) - (Uint32) SDL_AtomicGet(&device->ring_read);
+    return (blocks * device->callbackspec.size) - device->ring_offset;
+}
+
+/* Copy blocks out of the capture ring. Caller holds ring_lock, so only the
+   capture thread can touch the ring meanwhile, and it only ever adds. */
+static Uint32
+ring_dequeue(SDL_AudioDevice *device, Uint8 *data, Uint32 len, Uint64 *timestamp)
+{
+    const Uint32 blocksize = device->callbackspec.size;
+    const Uint32 written = (Uint32) SDL_AtomicGet(&device->ring_write);
+    Uint32 consumed = (Uint32) SDL_AtomicGet(&device->ring_read);
+    Uint32 total = 0;
+
+    /* see the capture thread's writes to the blocks it published. */
+    SDL_MemoryBarrierAcquire();
+
+    if ((consumed != written) && timestamp) {
+        const Uint32 framelen = (SDL_AUDIO_BITSIZE(device->callbackspec.format) / 8) * device->callbackspec.channels;
+        const Uint64 frames = device->ring_offset / framelen;
+        *timestamp = device->ring_stamps[consumed % device->ring_slots] +
+                     ((frames * SDL_GetPerformanceFrequency()) / device->callbackspec.freq);
+    }
+
+    while ((consumed != written) && (total < len)) {
+        const Uint8 *block = device->ring + ((size_t) (consumed % device->ring_slots) * blocksize);
+        const Uint32 cpy = SDL_min(len - total, blocksize - device->ring_offset);
+        SDL_memcpy(data + total, block + device->ring_offset, cpy);
+        total += cpy;
+        device->ring_offset += cpy;
+        if (device->ring_offset == blocksize) {
+            device->ring_offset = 0;
+            consumed++;
+        }
+    }
+
+    /* we're done with those blocks before the capture thread reuses them. */
+    SDL_MemoryBarrierRelease();
+    SDL_AtomicSet(&device->ring_read, (int) consumed);
+    return total;
+}
+
 Uint32
 SDL_DequeueAudio(SDL_AudioDeviceID devid, void *data, Uint32 len)
+{
+    return SDL_DequeueAudioWithTimestamp(devid, data, len, NULL);
+}
+
+Uint32
+SDL_DequeueAudioWithTimestamp(SDL_AudioDeviceID devid, void *data, Uint32 len, Uint64 *timestamp)
 {
     SDL_AudioDevice *device = get_audio_device(devid);
+    Uint8 *buf;
     Uint32 rc;
 
+    if (timestamp) {
+        *timestamp = 0;
+    }
+
     if ( (len == 0) ||  /* nothing to do? */
          (!device) ||  /* called with bogus device id */
          (!device->iscapture) ||  /* playback devices can't dequeue */
@@ -582,9 +864,39 @@ SDL_DequeueAudio(SDL_AudioDeviceID devid, void *data, Uint32 len)
         return 0;  /* just report zero bytes dequeued. */
     }
 
-    current_audio.impl.LockDevice(device);
-    rc = (Uint32) SDL_ReadFromDataQueue(device->buffer_queue, data, len);
-    current_audio.impl.UnlockDevice(device);
+    /* the queue is interleaved; planar data is split up on the way out. */
+    buf = (Uint8 *) data;
+    if (device->queue_planar) {
+        const Uint32 framelen = (SDL_AUDIO_BITSIZE(device->callbackspec.format) / 8) * device->callbackspec.channels;
+        len -= len % framelen;  /* whole frames only. */
+        if (len == 0) {
+            return 0;
+        }
+        buf = (Uint8 *) SDL_malloc(len);
+        if (!buf) {
+            SDL_OutOfMemory();
+            return 0;
+        }
+    }
+
+    if (device->ring) {
+        /* never takes the device lock, so the capture thread doesn't wait. */
+        SDL_AtomicLock(&device->ring_lock);
+        rc = ring_dequeue(device, buf, len, timestamp);
+        SDL_AtomicUnlock(&device->ring_lock);
+    } else {
+        current_audio.impl.LockDevice(device);
+        rc = (Uint32) SDL_ReadFromDataQueue(device->buffer_queue, buf, len);
+        current_audio.impl.UnlockDevice(device);
+    }
+
+    if (buf != data) {
+        const int samplesize = SDL_AUDIO_BITSIZE(device->callbackspec.format) / 8;
+        const int channels = device->callbackspec.channels;
+        const int frames = (int) (rc / (samplesize * channels));
+        SDL_DeinterleaveAudio(data, frames * samplesize, buf, samplesize, channels, frames);
+        SDL_free(buf);
+    }
     return rc;
 }
 
@@ -603,6 +915,10 @@ SDL_GetQueuedAudioSize(SDL_AudioDeviceID devid)
         current_audio.impl.LockDevice(device);
         retval = ((Uint32) SDL_CountDataQueue(device->buffer_queue)) + current_audio.impl.GetPendingBytes(device);
         current_audio.impl.UnlockDevice(device);
+    } else if ((device->spec.callback == SDL_BufferQueueFillCallback) && device->ring) {
+        SDL_AtomicLock(&device->ring_lock);
+        retval = ring_available(device);
+        SDL_AtomicUnlock(&device->ring_lock);
     } else if (device->spec.callback == SDL_BufferQueueFillCallback) {
         current_audio.impl.LockDevice(device);
         retval = (Uint32) SDL_CountDataQueue(device->buffer_queue);
@@ -621,23 +937,152 @@ SDL_ClearQueuedAudio(SDL_AudioDeviceID devid)
         return;  /* nothing to do. */
     }
 
+    if (device->ring) {
+        /* drop whatever the capture thread has published so far. */
+        SDL_AtomicLock(&device->ring_lock);
+        SDL_AtomicSet(&device->ring_read, SDL_AtomicGet(&device->ring_write));
+        device->ring_offset = 0;
+        SDL_AtomicUnlock(&device->ring_lock);
+        return;
+    }
+
     /* Blank out the device and release the mutex. Free it afterwards. */
     current_audio.impl.LockDevice(device);
 
     /* Keep up to two packets in the pool to reduce future malloc pressure. */
     SDL_ClearDataQueue(device->buffer_queue, SDL_AUDIOBUFFERQUEUE_PACKETLEN * 2);
+    device->queue_start = -1;
 
     current_audio.impl.UnlockDevice(device);
 }
 
 
+/* Record how long a callback took and how far its start strayed from the
+   expected period. Called by the audio thread with mixer_lock held. */
+static void
+update_callback_stats(SDL_AudioDevice *device, const Uint64 start, const Uint64 end)
+{
+    SDL_AudioDeviceStats *stats = &device->stats;
+    const Uint64 freq = SDL_GetPerformanceFrequency();
+    const Uint64 period = (((Uint64) device->callbackspec.samples) * freq) / device->callbackspec.freq;
+    const Uint64 ticks = end - start;
+    Uint32 usec;
+
+    stats->callbacks++;
+    device->callback_ticks += ticks;
+    if (ticks > period) {
+        stats->late_callbacks++;
+    }
+    usec = (Uint32) ((ticks * 1000000) / freq);
+    if (usec > stats->callback_usec_max) {
+        stats->callback_usec_max = usec;
+    }
+
+    if (device->last_callback_start != 0) {
+        const Uint64 interval = start - device->last_callback_start;
+        const Uint64 jitter = (interval > period) ? (interval - period) : (period - interval);
+        device->jitter_ticks += jitter;
+        device->jitter_count++;
+        usec = (Uint32) ((jitter * 1000000) / freq);
+        if (usec > stats->jitter_usec_max) {
+            stats->jitter_usec_max = usec;
+        }
+    }
+    device->last_callback_start = start;
+}
+
+/* Advance the device clock after the driver played (or captured) frames. */
+static void
+add_device_frames(SDL_AudioDevice *device, const int frames)
+{
+    SDL_LockMutex(device->mixer_lock);
+    device->device_frames += frames;
+    SDL_UnlockMutex(device->mixer_lock);
+}
+
+/* Change the device buffer size from the audio thread. */
+static void
+resize_audio_device(SDL_AudioDevice *device, const int samples)
+{
+    int rc;
+
+    /* Keep SDL_LockAudioDevice() callers out while the driver works. */
+    SDL_LockMutex(device->mixer_lock);
+    rc = current_audio.impl.ResizeDevice(device, samples);
+    if (rc == 0) {
+        SDL_CalculateAudioSpec(&device->spec);
+        device->stats.resizes++;
+        if (device->spec.size > device->work_buffer_len) {
+            Uint8 *ptr = (Uint8 *) SDL_realloc(device->work_buffer, device->spec.size);
+            if (ptr == NULL) {
+                /* We can't feed the device anymore. Keep the spec within
+                   the work buffer, which still paces the callback. */
+                const Uint32 framelen = (SDL_AUDIO_BITSIZE(device->spec.format) / 8) * device->spec.channels;
+                SDL_OpenedAudioDeviceDisconnected(device);
+                device->spec.samples = (Uint16) (device->work_buffer_len / framelen);
+                SDL_CalculateAudioSpec(&device->spec);
+                rc = -1;
+            } else {
+                device->work_buffer = ptr;
+                device->work_buffer_len = device->spec.size;
+            }
+        }
+    }
+    SDL_UnlockMutex(device->mixer_lock);
+
+    if (rc < 0) {
+        /* Give up on adapting; if the driver couldn't keep the device
+           working, it was disconnected already. */
+        device->adaptive = SDL_FALSE;
+    }
+}
+
+/* Adaptive buffer sizing. Every half second of playback, double the device
+   buffer if the driver reported underruns, or halve it if things have been
+   calm for long enough. Each growth doubles how long "long enough" is, so
+   we settle on a size instead of bouncing between two. */
+static void
+adapt_audio_device(SDL_AudioDevice *device)
+{
+    int samples = (int) device->spec.samples;
+    int underruns;
+
+    device->adaptive_frames += device->spec.samples;
+    if (device->adaptive_frames < (Uint32) (device->spec.freq / 2)) {
+        return;
+    }
+    device->adaptive_frames = 0;
+
+    underruns = SDL_AtomicGet(&device->underruns);
+    if (underruns != device->adaptive_underruns) {
+        device->adaptive_calm_windows = 0;
+        if (samples < device->adaptive_max_samples) {
+            samples = SDL_min(samples * 2, device->adaptive_max_samples);
+            device->adaptive_calm_needed = SDL_min(device->adaptive_calm_needed * 2, 64);
+        }
+    } else if (++device->adaptive_calm_windows >= device->adaptive_calm_needed) {
+        device->adaptive_calm_windows = 0;
+        if (samples > device->adaptive_min_samples) {
+            samples = SDL_max(samples / 2, device->adaptive_min_samples);
+        }
+    }
+
+    if (samples != device->spec.samples) {
+        resize_audio_device(device, samples);
+    }
+
+    /* don't blame the new size for glitches caused by resizing. */
+    device->adaptive_underruns = SDL_AtomicGet(&device->underruns);
+}
+
+
 /* The general mixing thread function */
 static int SDLCALL
 SDL_RunAudio(void *devicep)
 {
     SDL_AudioDevice *device = (SDL_AudioDevice *) devicep;
     const int silence = (int) device->spec.silence;
-    const Uint32 delay = ((device->spec.samples * 1000) / device->spec.freq);
+    Uint32 delay = ((device->spec.samples * 1000) / device->spec.freq);
     const int data_len = device->callbackspec.size;
     Uint8 *data;
     void *udata = device->spec.userdata;
@@ -676,9 +1121,13 @@ SDL_RunAudio(void *devicep)
         SDL_LockMutex(device->mixer_lock);
         if (SDL_AtomicGet(&device->paused)) {
             SDL_memset(data, silence, data_len);
+            device->last_callback_start = 0;
         } else {
+            const Uint64 start = SDL_GetPerformanceCounter();
             callback(udata, data, data_len);
+            update_callback_stats(device, start, SDL_GetPerformanceCounter());
         }
+        device->callback_frames += device->callbackspec.samples;
         SDL_UnlockMutex(device->mixer_lock);
 
         if (device->stream) {
@@ -699,7 +1148,12 @@ SDL_RunAudio(void *devicep)
                         SDL_memset(data, device->spec.silence, device->spec.size);
                     }
                     current_audio.impl.PlayDevice(device);
+                    add_device_frames(device, device->spec.samples);
                     current_audio.impl.WaitDevice(device);
+                    if (device->adaptive) {
+                        adapt_audio_device(device);
+                        delay = ((device->spec.samples * 1000) / device->spec.freq);
+                    }
                 }
             }
         } else if (data == device->work_buffer) {
@@ -708,6 +1162,7 @@ SDL_RunAudio(void *devicep)
         } else {  /* writing directly to the device. */
             /* queue this buffer and wait for it to finish playing. */
             current_audio.impl.PlayDevice(device);
+            add_device_frames(device, device->spec.samples);
             current_audio.impl.WaitDevice(device);
         }
     }
@@ -722,6 +1177,80 @@ SDL_RunAudio(void *devicep)
     return 0;
 }
 
+/* Publish one callback-sized block to the capture ring. Only the capture
+   thread calls this; it never waits for readers, it drops the block if
+   they've fallen too far behind. */
+static void
+ring_enqueue(SDL_AudioDevice *device, const Uint8 *data)
+{
+    const Uint32 written = (Uint32) SDL_AtomicGet(&device->ring_write);
+    const Uint32 consumed = (Uint32) SDL_AtomicGet(&device->ring_read);
+    const Uint64 freq = SDL_GetPerformanceFrequency();
+    const Uint64 now = SDL_GetPerformanceCounter();
+    Sint64 newest;
+    Uint64 behind;
+    Uint64 duration;
+    Uint64 stamp;
+
+    /* The newest frame the device has recorded was captured just now;
+       count back from it to the first frame of this block. */
+    newest = device->device_frames;
+    if (SDL_AtomicGet(&device->enabled)) {
+        newest += (((Sint64) current_audio.impl.GetDeviceLatency(device)) * device->spec.freq) / 1000000;
+    }
+    if (device->callbackspec.freq != device->spec.freq) {
+        newest = (newest * device->callbackspec.freq) / device->spec.freq;
+    }
+    behind = (Uint64) SDL_max(newest - device->callback_frames, 0);
+    behind = (behind * freq) / device->callbackspec.freq;
+    device->callback_frames += device->callbackspec.samples;
+
+    /* That estimate jitters. The whole block was recorded by now, and the
+       blocks are back to back, so never stamp one later than that or before
+       the previous one ended; timestamps only go up. */
+    duration = (((Uint64) device->callbackspec.samples) * freq) / device->callbackspec.freq;
+    stamp = (now > behind) ? (now - behind) : 0;
+    stamp = SDL_min(stamp, (now > duration) ? (now - duration) : 0);
+    stamp = SDL_max(stamp, device->ring_next_stamp);
+    device->ring_next_stamp = stamp + duration;
+
+    if ((written - consumed) >= device->ring_slots) {
+        SDL_AtomicIncRef(&device->capture_overruns);  /* full, lose it. */
+        return;
+    }
+
+    SDL_memcpy(device->ring + ((size_t) (written % device->ring_slots) * device->callbackspec.size), data, device->callbackspec.size);
+    device->ring_stamps[written % device->ring_slots] = stamp;
+
+    /* readers must see the block before they see it counted. */
+    SDL_MemoryBarrierRelease();
+    SDL_AtomicSet(&device->ring_write, (int) (written + 1));
+}
+
+/* Hand one callback-sized block of captured audio to the app. */
+static void
+deliver_captured_block(SDL_AudioDevice *device, Uint8 *data)
+{
+    if (device->ring) {
+        if (!SDL_AtomicGet(&device->paused)) {
+            ring_enqueue(device, data);
+        }
+        return;
+    }
+
+    /* !!! FIXME: this should be LockDevice. */
+    SDL_LockMutex(device->mixer_lock);
+    if (SDL_AtomicGet(&device->paused)) {
+        device->last_callback_start = 0;
+    } else {
+        const Uint64 start = SDL_GetPerformanceCounter();
+        device->spec.callback(device->spec.userdata, data, device->callbackspec.size);
+        update_callback_stats(device, start, SDL_GetPerformanceCounter());
+        device->callback_frames += device->callbackspec.samples;
+    }
+    SDL_UnlockMutex(device->mixer_lock);
+}
+
 /* The general capture thread function */
 static int SDLCALL
 SDL_CaptureAudio(void *devicep)
@@ -731,8 +1260,6 @@ SDL_CaptureAudio(void *devicep)
     const Uint32 delay = ((device->spec.samples * 1000) / device->spec.freq);
     const int data_len = device->spec.size;
     Uint8 *data;
-    void *udata = device->spec.userdata;
-    SDL_AudioCallback callback = device->spec.callback;
 
     SDL_assert(device->iscapture);
 
@@ -791,6 +1318,11 @@ SDL_CaptureAudio(void *devicep)
             SDL_memset(ptr, silence, still_need);
         }
 
+        if (ptr != data) {
+            const int framelen = (SDL_AUDIO_BITSIZE(device->spec.format) / 8) * device->spec.channels;
+            add_device_frames(device, (int) (ptr - data) / framelen);
+        }
+
         if (device->stream) {
             /* if this fails...oh well. */
             SDL_AudioStreamPut(device->stream, data, data_len);
@@ -801,21 +1333,10 @@ SDL_CaptureAudio(void *devicep)
                 if (got != device->callbackspec.size) {
                     SDL_memset(device->work_buffer, device->spec.silence, device->callbackspec.size);
                 }
-
-                /* !!! FIXME: this should be LockDevice. */
-                SDL_LockMutex(device->mixer_lock);
-                if (!SDL_AtomicGet(&device->paused)) {
-                    callback(udata, device->work_buffer, device->callbackspec.size);
-                }
-                SDL_UnlockMutex(device->mixer_lock);
+                deliver_captured_block(device, device->work_buffer);
             }
         } else {  /* feeding user callback directly without streaming. */
-            /* !!! FIXME: this should be LockDevice. */
-            SDL_LockMutex(device->mixer_lock);
-            if (!SDL_AtomicGet(&device->paused)) {
-                callback(udata, data, device->callbackspec.size);
-            }
-            SDL_UnlockMutex(device->mixer_lock);
+            deliver_captured_block(device, data);
         }
     }
 
@@ -868,8 +1389,6 @@ SDL_GetAudioDriver(int index)
     return NULL;
 }
 
-extern void SDL_ChooseAudioConverters(void);
-
 int
 SDL_AudioInit(const char *driver_name)
 {
@@ -1070,6 +1589,8 @@ close_audio_device(SDL_AudioDevice * device)
     }
 
     SDL_FreeDataQueue(device->buffer_queue);
+    SDL_free(device->ring);
+    SDL_free(device->ring_stamps);
 
     SDL_free(device);
 }
@@ -1148,6 +1669,7 @@ open_audio_device(const char *devname, int iscapture,
     SDL_AudioDevice *device;
     SDL_bool build_stream;
     void *handle = NULL;
+    Uint32 ring_ms = 0;
     int i = 0;
 
     if (!SDL_WasInit(SDL_INIT_AUDIO)) {
@@ -1254,12 +1776,14 @@ open_audio_device(const char *devname, int iscapture,
     }
     device->id = id + 1;
     device->spec = *obtained;
+    device->spec.format &= ~SDL_AUDIO_MASK_PLANAR;  /* hardware is interleaved. */
     device->iscapture = iscapture ? SDL_TRUE : SDL_FALSE;
     device->handle = handle;
 
     SDL_AtomicSet(&device->shutdown, 0);  /* just in case. */
     SDL_AtomicSet(&device->paused, 1);
     SDL_AtomicSet(&device->enabled, 1);
+    device->queue_start = -1;
 
     /* Create a mutex for locking the sound buffers */
     if (!current_audio.impl.SkipMixerLock) {
@@ -1271,11 +1795,35 @@ open_audio_device(const char *devname, int iscapture,
         }
     }
 
+    /* Adaptive buffer sizing starts the device at the latency target. */
+    if (!iscapture && !current_audio.impl.ProvidesOwnCallbackThread &&
+        (current_audio.impl.ResizeDevice != SDL_AudioResizeDevice_Default)) {
+        const char *hint = SDL_GetHint(SDL_HINT_AUDIO_ADAPTIVE_LATENCY_USEC);
+        const Uint32 usec = hint ? (Uint32) SDL_strtoul(hint, NULL, 10) : 0;
+        if (usec > 0) {
+            const Uint32 frames = (Uint32) ((((Uint64) usec) * device->spec.freq) / 1000000);
+            Uint32 samples = 64;
+            while ((samples < frames) && (samples < 2048)) {
+                samples *= 2;  /* hardware likes powers of two. */
+            }
+            device->adaptive = SDL_TRUE;
+            device->adaptive_calm_needed = 4;
+            device->spec.samples = (Uint16) samples;
+            SDL_CalculateAudioSpec(&device->spec);
+        }
+    }
+
     if (current_audio.impl.OpenDevice(device, handle, devname, iscapture) < 0) {
         close_audio_device(device);
         return 0;
     }
 
+    if (device->adaptive) {
+        /* never go below what the driver settled on for the target. */
+        device->adaptive_min_samples = device->spec.samples;
+        device->adaptive_max_samples = (Uint16) SDL_min(((Uint32) device->spec.samples) * 16, 32768);
+    }
+
     /* if your target really doesn't need it, set it to 0x1 or something. */
     /* otherwise, close_audio_device() won't call impl.CloseDevice(). */
     SDL_assert(device->hidden != NULL);
@@ -1289,9 +1837,9 @@ open_audio_device(const char *devname, int iscapture,
             build_stream = SDL_TRUE;
         }
     }
-    if (obtained->format != device->spec.format) {
+    if ((obtained->format & ~SDL_AUDIO_MASK_PLANAR) != device->spec.format) {
         if (allowed_changes & SDL_AUDIO_ALLOW_FORMAT_CHANGE) {
-            obtained->format = device->spec.format;
+            obtained->format = device->spec.format | (obtained->format & SDL_AUDIO_MASK_PLANAR);
         } else {
             build_stream = SDL_TRUE;
         }
@@ -1314,17 +1862,36 @@ open_audio_device(const char *devname, int iscapture,
         build_stream = SDL_TRUE;
     }
 
+    /* Adaptive buffer sizing changes the device's sample count on the fly,
+       so the stream keeps the callback's size steady. */
+    if (device->adaptive) {
+        build_stream = SDL_TRUE;
+    }
+
+    /* Planar callbacks go through the stream. Queued audio is shuffled as
+       it's queued (or dequeued) instead, so the queue stays interleaved. */
+    if (SDL_AUDIO_ISPLANAR(obtained->format) && (obtained->channels > 1)) {
+        if (obtained->callback == NULL) {
+            device->queue_planar = SDL_TRUE;
+        } else {
+            build_stream = SDL_TRUE;
+        }
+    }
+
     SDL_CalculateAudioSpec(obtained);  /* recalc after possible changes. */
 
     device->callbackspec = *obtained;
+    if (device->queue_planar) {
+        device->callbackspec.format &= ~SDL_AUDIO_MASK_PLANAR;
+    }
 
     if (build_stream) {
         if (iscapture) {
             device->stream = SDL_NewAudioStream(device->spec.format,
                                   device->spec.channels, device->spec.freq,
-                                  obtained->format, obtained->channels, obtained->freq);
+                                  device->callbackspec.format, obtained->channels, obtained->freq);
         } else {
-            device->stream = SDL_NewAudioStream(obtained->format, obtained->channels,
+            device->stream = SDL_NewAudioStream(device->callbackspec.format, obtained->channels,
                                   obtained->freq, device->spec.format,
                                   device->spec.channels, device->spec.freq);
         }
@@ -1335,7 +1902,26 @@ open_audio_device(const char *devname, int iscapture,
         }
     }
 
-    if (device->spec.callback == NULL) {  /* use buffer queueing? */
+    /* A capture ring only works when our own capture thread feeds it. */
+    if ((device->spec.callback == NULL) && iscapture && !current_audio.impl.ProvidesOwnCallbackThread) {
+        const char *hint = SDL_GetHint(SDL_HINT_AUDIO_CAPTURE_RING_MS);
+        ring_ms = hint ? (Uint32) SDL_strtoul(hint, NULL, 10) : 0;
+    }
+
+    if (ring_ms > 0) {
+        /* fixed ring of whole callback blocks, at least two of them. */
+        const Uint64 frames = (((Uint64) ring_ms) * device->callbackspec.freq) / 1000;
+        device->ring_slots = (Uint32) SDL_max((frames + device->callbackspec.samples - 1) / device->callbackspec.samples, 2);
+        device->ring = (Uint8 *) SDL_malloc((size_t) device->ring_slots * device->callbackspec.size);
+        device->ring_stamps = (Uint64 *) SDL_calloc(device->ring_slots, sizeof (Uint64));
+        if (!device->ring || !device->ring_stamps) {
+            close_audio_device(device);
+            SDL_OutOfMemory();
+            return 0;
+        }
+        device->spec.callback = SDL_BufferQueueFillCallback;
+        device->spec.userdata = device;
+    } else if (device->spec.callback == NULL) {  /* use buffer queueing? */
         /* pool a few packets to start. Enough for two callbacks. */
         device->buffer_queue = SDL_NewDataQueue(SDL_AUDIOBUFFERQUEUE_PACKETLEN, obtained->size * 2);
         if (!device->buffer_queue) {
@@ -1439,6 +2025,133 @@ SDL_GetAudioDeviceStatus(SDL_AudioDeviceID devid)
 }
 
 
+int
+SDL_GetAudioDeviceBufferSize(SDL_AudioDeviceID devid, int *period_frames, int *buffer_frames)
+{
+    SDL_AudioDevice *device = get_audio_device(devid);
+    int period = 0;
+    int buffer = 0;
+
+    if (!device) {
+        return -1;  /* get_audio_device() already set the error. */
+    }
+
+    current_audio.impl.LockDevice(device);
+    if (SDL_AtomicGet(&device->enabled)) {
+        current_audio.impl.GetDeviceBufferSize(device, &period, &buffer);
+    } else {
+        /* a lost device has nothing to tell us. */
+        SDL_AudioGetDeviceBufferSize_Default(device, &period, &buffer);
+    }
+    current_audio.impl.UnlockDevice(device);
+
+    if (period_frames) {
+        *period_frames = period;
+    }
+    if (buffer_frames) {
+        *buffer_frames = buffer;
+    }
+    return 0;
+}
+
+
+int
+SDL_GetAudioDeviceLatency(SDL_AudioDeviceID devid)
+{
+    SDL_AudioDevice *device = get_audio_device(devid);
+    int retval;
+
+    if (!device) {
+        return -1;  /* get_audio_device() already set the error. */
+    }
+
+    current_audio.impl.LockDevice(device);
+    if (SDL_AtomicGet(&device->enabled)) {
+        retval = current_audio.impl.GetDeviceLatency(device);
+    } else {
+        /* a lost device has nothing to tell us. */
+        retval = SDL_AudioGetDeviceLatency_Default(device);
+    }
+    if (device->stream && !device->iscapture) {
+        /* converted data that hasn't been handed to the device yet. */
+        const int framelen = (SDL_AUDIO_BITSIZE(device->spec.format) / 8) * device->spec.channels;
+        const Sint64 frames = SDL_AudioStreamAvailable(device->stream) / framelen;
+        retval += (int) ((frames * 1000000) / device->spec.freq);
+    }
+    current_audio.impl.UnlockDevice(device);
+
+    return retval;
+}
+
+
+int
+SDL_GetAudioDeviceStats(SDL_AudioDeviceID devid, SDL_AudioDeviceStats *stats)
+{
+    SDL_AudioDevice *device = get_audio_device(devid);
+    const Uint64 freq = SDL_GetPerformanceFrequency();
+
+    if (!device) {
+        return -1;  /* get_audio_device() already set the error. */
+    } else if (!stats) {
+        return SDL_InvalidParamError("stats");
+    }
+
+    current_audio.impl.LockDevice(device);
+    *stats = device->stats;
+    stats->period_usec = (Uint32) ((((Uint64) device->callbackspec.samples) * 1000000) / device->callbackspec.freq);
+    if (stats->callbacks > 0) {
+        stats->callback_usec_avg = (Uint32) (((device->callback_ticks / stats->callbacks) * 1000000) / freq);
+    }
+    if (device->jitter_count > 0) {
+        stats->jitter_usec_avg = (Uint32) (((device->jitter_ticks / device->jitter_count) * 1000000) / freq);
+    }
+    stats->underruns = (Uint32) SDL_AtomicGet(&device->underruns);
+    stats->device_samples = device->spec.samples;
+    stats->capture_overruns = (Uint32) SDL_AtomicGet(&device->capture_overruns);
+    current_audio.impl.UnlockDevice(device);
+
+    return 0;
+}
+
+
+Sint64
+SDL_GetAudioDevicePosition(SDL_AudioDeviceID devid, Uint64 *timestamp)
+{
+    SDL_AudioDevice *device = get_audio_device(devid);
+    Uint64 now;
+    Sint64 frames;
+    Sint64 delay;
+
+    if (!device) {
+        return -1;  /* get_audio_device() already set the error. */
+    } else if (current_audio.impl.ProvidesOwnCallbackThread) {
+        SDL_Unsupported();  /* we don't see the data go by. */
+        return -1;
+    }
+
+    current_audio.impl.LockDevice(device);
+    delay = SDL_AtomicGet(&device->enabled) ? current_audio.impl.GetDeviceLatency(device) : 0;
+    now = SDL_GetPerformanceCounter();
+    frames = device->device_frames;
+    current_audio.impl.UnlockDevice(device);
+
+    /* what's been handed to the device, minus what it hasn't played yet
+       (or, capturing, plus what it recorded that we haven't read yet). */
+    delay = (delay * device->spec.freq) / 1000000;
+    frames = device->iscapture ? (frames + delay) : SDL_max(frames - delay, 0);
+
+    /* count in the callback's frames, if we're resampling. */
+    if (device->callbackspec.freq != device->spec.freq) {
+        frames = (frames * device->callbackspec.freq) / device->spec.freq;
+    }
+
+    if (timestamp) {
+        *timestamp = now;
+    }
+    return frames;
+}
+
+
 SDL_AudioStatus
 SDL_GetAudioStatus(void)
 {
@@ -65,6 +65,16 @@ extern SDL_AudioFilter SDL_Convert_F32_to_U8;
 extern SDL_AudioFilter SDL_Convert_F32_to_S16;
 extern SDL_AudioFilter SDL_Convert_F32_to_U16;
 extern SDL_AudioFilter SDL_Convert_F32_to_S32;
+extern SDL_AudioFilter SDL_Convert_Byteswap;
+
+/* Set the pointers above; safe to call more than once, and before init. */
+extern void SDL_ChooseAudioConverters(void);
+
+/* Move between planar and interleaved samples, in one pass. Plane (c) of
+   the planar side starts (pitch) bytes after plane (c - 1). Uses SIMD for
+   stereo 16 and 32-bit samples where it can. */
+extern void SDL_InterleaveAudio(void *dst, const void *src, const int src_pitch, const int samplesize, const int channels, const int frames);
+extern void SDL_DeinterleaveAudio(void *dst, const int dst_pitch, const void *src, const int samplesize, const int channels, const int frames);
 
 
 /* SDL_AudioStream is a new audio conversion interface. It
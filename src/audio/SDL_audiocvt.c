@@ -432,6 +432,185 @@ SDL_ResampleAudioSimple_si16_c2(const double rate_incr,
     return (int) ((dst - outbuf) * ((int) sizeof (Sint16)));
 }
 
+/* The conversion SDL_Convert_S16_to_F32 does; every implementation of it
+   gives exactly this result. */
+#define S16_TO_F32(x) (((float) (x)) * 3.05185094759972e-05f)
+
+/* Source frames converted to float at a time by the resampler below. 512
+   stereo frames is 4 kilobytes, comfortably inside the L1 cache. */
+#define RESAMPLE_BLOCK_FRAMES 512
+
+/* Convert (frames) S16 frames starting at (first) into (block). */
+static void
+ConvertResampleBlock(float *block, const Sint16 *inbuf, const int chans, const int first, const int frames)
+{
+    SDL_AudioCVT cvt;
+    SDL_zero(cvt);
+    SDL_memcpy(block, inbuf + (first * chans), frames * chans * sizeof (Sint16));
+    cvt.buf = (Uint8 *) block;
+    cvt.len = cvt.len_cvt = frames * chans * (int) sizeof (Sint16);
+    cvt.filters[0] = SDL_Convert_S16_to_F32;
+    cvt.filters[0](&cvt, AUDIO_S16SYS);
+}
+
+/* Converting S16 to float and resampling in one pass over the data: this is
+   SDL_ResampleAudioSimple() reading its input through a small block of
+   float data, which gets refilled with SDL_Convert_S16_to_F32 as the
+   resampler moves through the input. It gives exactly the same results as
+   converting the whole buffer and then resampling it, but the float data
+   never leaves the cache, and the input doesn't have to be copied into the
+   stream's work buffer first. (inbuf) and (outbuf) can't overlap. */
+static int
+SDL_ResampleAudioSimple_S16_to_F32(const int chans, const double rate_incr,
+                        float *last_sample, const Sint16 *inbuf,
+                        const int inbuflen, float *outbuf, const int outbuflen)
+{
+    const int framelen = chans * (int)sizeof (Sint16);
+    const int total = (inbuflen / framelen);
+    const int finalpos = (total * chans) - chans;
+    const int dest_samples = (int)(((double)total) * rate_incr);
+    const double src_incr = 1.0 / rate_incr;
+    float blockdata[(RESAMPLE_BLOCK_FRAMES * 2) + 4];
+    float *block = (float *) ((((size_t) blockdata) + 15) & ~((size_t) 15));  /* align for the SIMD converters. */
+    float *dst;
+    double idx;
+
+    SDL_assert((dest_samples * chans * (int)sizeof (float)) <= outbuflen);
+    SDL_assert((inbuflen % framelen) == 0);
+    SDL_assert((chans == 1) || (chans == 2));
+
+    /* The outer loops convert the next block of input; the inner loops are
+       the ones from SDL_ResampleAudioSimple(), and run until they need a
+       frame that isn't in the current block. */
+    if (rate_incr > 1.0) {  /* upsample */
+        float *target = (outbuf + chans);
+        dst = outbuf + (dest_samples * chans);
+        idx = (double) total;
+
+        if (chans == 1) {
+            const float final_sample = S16_TO_F32(inbuf[finalpos]);
+            float earlier_sample = final_sample;
+            while (dst > target) {
+                const int block_end = SDL_max(1, (int) idx);
+                const int block_start = SDL_max(0, block_end - RESAMPLE_BLOCK_FRAMES);
+                ConvertResampleBlock(block, inbuf, chans, block_start, block_end - block_start);
+                while (dst > target) {
+                    int pos = ((int) idx) - block_start;
+                    float val;
+                    if (pos <= 0) {
+                        if (block_start > 0) {
+                            break;  /* need the previous block. */
+                        }
+                        pos = 1;  /* rounding ran idx off the front of the buffer; clamp. */
+                    }
+                    val = block[pos - 1];
+                    *(--dst) = (val + earlier_sample) * 0.5f;
+                    earlier_sample = val;
+                    idx -= src_incr;
+                }
+            }
+            /* do last sample, interpolated against previous run's state. */
+            *(--dst) = (S16_TO_F32(inbuf[0]) + last_sample[0]) * 0.5f;
+            *last_sample = final_sample;
+        } else {
+            const float final_sample2 = S16_TO_F32(inbuf[finalpos+1]);
+            const float final_sample1 = S16_TO_F32(inbuf[finalpos]);
+            /* these match what SDL_ResampleAudioSimple() starts with. */
+            float earlier_sample2 = final_sample1;
+            float earlier_sample1 = (finalpos > 0) ? S16_TO_F32(inbuf[finalpos-1]) : final_sample1;
+            while (dst > target) {
+                const int block_end = SDL_max(1, (int) idx);
+                const int block_start = SDL_max(0, block_end - RESAMPLE_BLOCK_FRAMES);
+                ConvertResampleBlock(block, inbuf, chans, block_start, block_end - block_start);
+                while (dst > target) {
+                    int pos = (((int) idx) - block_start) * 2;
+                    const float *src;
+                    float val1, val2;
+                    if (pos <= 0) {
+                        if (block_start > 0) {
+                            break;  /* need the previous block. */
+                        }
+                        pos = 2;  /* rounding ran idx off the front of the buffer; clamp. */
+                    }
+                    src = &block[pos];
+                    val2 = *(--src);
+                    val1 = *(--src);
+                    *(--dst) = (val2 + earlier_sample2) * 0.5f;
+                    *(--dst) = (val1 + earlier_sample1) * 0.5f;
+                    earlier_sample2 = val2;
+                    earlier_sample1 = val1;
+                    idx -= src_incr;
+                }
+            }
+            /* do last sample, interpolated against previous run's state. */
+            *(--dst) = (S16_TO_F32(inbuf[1]) + last_sample[1]) * 0.5f;
+            *(--dst) = (S16_TO_F32(inbuf[0]) + last_sample[0]) * 0.5f;
+            last_sample[1] = final_sample2;
+            last_sample[0] = final_sample1;
+        }
+
+        dst = (outbuf + (dest_samples * chans));
+    } else {  /* downsample */
+        float *target = (outbuf + (dest_samples * chans));
+        dst = outbuf;
+        idx = 0.0;
+        if (chans == 1) {
+            float last = *last_sample;
+            while (dst < target) {
+                const int block_start = SDL_min((int) idx, total - 1);
+                const int block_end = SDL_min(total, block_start + RESAMPLE_BLOCK_FRAMES);
+                ConvertResampleBlock(block, inbuf, chans, block_start, block_end - block_start);
+                while (dst < target) {
+                    int pos = ((int) idx) - block_start;
+                    float val;
+                    if (pos >= (block_end - block_start)) {
+                        if (block_end < total) {
+                            break;  /* need the next block. */
+                        }
+                        pos = (block_end - block_start) - 1;  /* rounding ran idx off the end of the buffer; clamp. */
+                    }
+                    val = block[pos];
+                    *(dst++) = (val + last) * 0.5f;
+                    last = val;
+                    idx += src_incr;
+                }
+            }
+            *last_sample = last;
+        } else {
+            float last1 = last_sample[0];
+            float last2 = last_sample[1];
+            while (dst < target) {
+                const int block_start = SDL_min((int) idx, total - 1);
+                const int block_end = SDL_min(total, block_start + RESAMPLE_BLOCK_FRAMES);
+                ConvertResampleBlock(block, inbuf, chans, block_start, block_end - block_start);
+                while (dst < target) {
+                    int pos = ((int) idx) - block_start;
+                    const float *src;
+                    float val1, val2;
+                    if (pos >= (block_end - block_start)) {
+                        if (block_end < total) {
+                            break;  /* need the next block. */
+                        }
+                        pos = (block_end - block_start) - 1;  /* rounding ran idx off the end of the buffer; clamp. */
+                    }
+                    src = &block[pos * 2];
+                    val1 = src[0];
+                    val2 = src[1];
+                    *(dst++) = (val1 + last1) * 0.5f;
+                    *(dst++) = (val2 + last2) * 0.5f;
+                    last1 = val1;
+                    last2 = val2;
+                    idx += src_incr;
+                }
+            }
+            last_sample[0] = last1;
+            last_sample[1] = last2;
+        }
+    }
+
+    return (int) ((dst - outbuf) * ((int) sizeof (float)));
+}
+
 static void SDLCALL
 SDL_ResampleCVT_si16_c2(SDL_AudioCVT *cvt, SDL_AudioFormat format)
 {
@@ -476,51 +655,15 @@ SDL_ConvertAudio(SDL_AudioCVT * cvt)
     return 0;
 }
 
-static void SDLCALL
-SDL_Convert_Byteswap(SDL_AudioCVT *cvt, SDL_AudioFormat format)
-{
-#if DEBUG_CONVERT
-    printf("Converting byte order\n");
-#endif
-
-    switch (SDL_AUDIO_BITSIZE(format)) {
-        #define CASESWAP(b) \
-            case b: { \
-                Uint##b *ptr = (Uint##b *) cvt->buf; \
-                int i; \
-                for (i = cvt->len_cvt / sizeof (*ptr); i; --i, ++ptr) { \
-                    *ptr = SDL_Swap##b(*ptr); \
-                } \
-                break; \
-            }
-
-        CASESWAP(16);
-        CASESWAP(32);
-        CASESWAP(64);
-
-        #undef CASESWAP
-
-        default: SDL_assert(!"unhandled byteswap datatype!"); break;
-    }
-
-    if (cvt->filters[++cvt->filter_index]) {
-        /* flip endian flag for data. */
-        if (format & SDL_AUDIO_MASK_ENDIAN) {
-            format &= ~SDL_AUDIO_MASK_ENDIAN;
-        } else {
-            format |= SDL_AUDIO_MASK_ENDIAN;
-        }
-        cvt->filters[cvt->filter_index](cvt, format);
-    }
-}
-
-
 static int
 SDL_BuildAudioTypeCVTToFloat(SDL_AudioCVT *cvt, const SDL_AudioFormat src_fmt)
 {
     int retval = 0;  /* 0 == no conversion necessary. */
 
     if ((SDL_AUDIO_ISBIGENDIAN(src_fmt) != 0) == (SDL_BYTEORDER == SDL_LIL_ENDIAN)) {
+        if (!SDL_Convert_Byteswap) {
+            return SDL_SetError("No conversion available for these formats");
+        }
         cvt->filters[cvt->filter_index++] = SDL_Convert_Byteswap;
         retval = 1;  /* added a converter. */
     }
@@ -592,6 +735,9 @@ SDL_BuildAudioTypeCVTFromFloat(SDL_AudioCVT *cvt, const SDL_AudioFormat dst_fmt)
     }
 
     if ((SDL_AUDIO_ISBIGENDIAN(dst_fmt) != 0) == (SDL_BYTEORDER == SDL_LIL_ENDIAN)) {
+        if (!SDL_Convert_Byteswap) {
+            return SDL_SetError("No conversion available for these formats");
+        }
         cvt->filters[cvt->filter_index++] = SDL_Convert_Byteswap;
         retval = 1;  /* added a converter. */
     }
@@ -677,6 +823,106 @@ SDL_BuildAudioResampleCVT(SDL_AudioCVT * cvt, const int dst_channels,
     return 1;               /* added a converter. */
 }
 
+/* Planar <-> interleaved. Shuffling in place is slow, so copy the data to
+   the spare room SDL_BuildPlanarAudioCVT() asks for, and shuffle it back. */
+static void
+SDL_PlanarCVT(SDL_AudioCVT *cvt, SDL_AudioFormat format, const int chans)
+{
+    const int len = cvt->len_cvt;
+    const int samplesize = SDL_AUDIO_BITSIZE(format) / 8;
+    const int frames = len / (samplesize * chans);
+    Uint8 *copy = cvt->buf + len;
+
+    SDL_memcpy(copy, cvt->buf, len);
+    if (SDL_AUDIO_ISPLANAR(format)) {
+        LOG_DEBUG_CONVERT("planar", "interleaved");
+        SDL_InterleaveAudio(cvt->buf, copy, frames * samplesize, samplesize, chans, frames);
+    } else {
+        LOG_DEBUG_CONVERT("interleaved", "planar");
+        SDL_DeinterleaveAudio(cvt->buf, frames * samplesize, copy, samplesize, chans, frames);
+    }
+    format ^= SDL_AUDIO_MASK_PLANAR;
+
+    if (cvt->filters[++cvt->filter_index]) {
+        cvt->filters[cvt->filter_index](cvt, format);
+    }
+}
+
+#define PLANAR_FUNCS(chans) \
+    static void SDLCALL \
+    SDL_PlanarCVT_c##chans(SDL_AudioCVT *cvt, SDL_AudioFormat format) { \
+        SDL_PlanarCVT(cvt, format, chans); \
+    }
+PLANAR_FUNCS(2)
+PLANAR_FUNCS(4)
+PLANAR_FUNCS(6)
+PLANAR_FUNCS(8)
+#undef PLANAR_FUNCS
+
+static SDL_AudioFilter
+ChooseCVTPlanar(const int channels)
+{
+    switch (channels) {
+        case 2: return SDL_PlanarCVT_c2;
+        case 4: return SDL_PlanarCVT_c4;
+        case 6: return SDL_PlanarCVT_c6;
+        case 8: return SDL_PlanarCVT_c8;
+        default: break;
+    }
+
+    return NULL;
+}
+
+/* Planar formats: build the interleaved conversion, and add a shuffle at
+   either end as needed. Converting samples without changing channels or
+   rate doesn't care about their order, so planar to planar skips both.
+   The filters only see SDL_AUDIO_MASK_PLANAR on a side that is shuffled. */
+static int
+SDL_BuildPlanarAudioCVT(SDL_AudioCVT * cvt,
+                        SDL_AudioFormat src_fmt, Uint8 src_channels, int src_rate,
+                        SDL_AudioFormat dst_fmt, Uint8 dst_channels, int dst_rate)
+{
+    SDL_bool src_planar = SDL_AUDIO_ISPLANAR(src_fmt) ? SDL_TRUE : SDL_FALSE;
+    SDL_bool dst_planar = SDL_AUDIO_ISPLANAR(dst_fmt) ? SDL_TRUE : SDL_FALSE;
+    int retval;
+
+    if (src_planar && dst_planar && (src_channels == dst_channels) && (src_rate == dst_rate)) {
+        src_planar = dst_planar = SDL_FALSE;
+    }
+
+    retval = SDL_BuildAudioCVT(cvt, src_fmt & ~SDL_AUDIO_MASK_PLANAR, src_channels, src_rate,
+                               dst_fmt & ~SDL_AUDIO_MASK_PLANAR, dst_channels, dst_rate);
+    if (retval < 0) {
+        return retval;
+    }
+
+    if (!src_planar && !dst_planar) {
+        return retval;
+    }
+
+    if ((src_planar && !ChooseCVTPlanar(src_channels)) ||
+        (dst_planar && !ChooseCVTPlanar(dst_channels))) {
+        return SDL_SetError("No planar conversion available for these channels");
+    } else if ((cvt->filter_index + src_planar + dst_planar) >= SDL_arraysize(cvt->filters)) {
+        return SDL_SetError("Too many filters needed for this conversion");
+    }
+
+    if (src_planar) {
+        SDL_memmove(&cvt->filters[1], &cvt->filters[0], cvt->filter_index * sizeof (cvt->filters[0]));
+        cvt->filters[0] = ChooseCVTPlanar(src_channels);
+        cvt->filter_index++;
+        cvt->src_format = src_fmt;
+    }
+    if (dst_planar) {
+        cvt->filters[cvt->filter_index++] = ChooseCVTPlanar(dst_channels);
+        cvt->dst_format = dst_fmt;
+    }
+    cvt->filters[cvt->filter_index] = NULL;
+    cvt->len_mult *= 2;  /* room for SDL_PlanarCVT()'s copy. */
+    cvt->needed = 1;
+    return 1;
+}
+
 
 /* Creates a set of audio filters to convert from one format to another.
    Returns -1 if the format conversion is not supported, 0 if there's
@@ -696,6 +942,9 @@ SDL_BuildAudioCVT(SDL_AudioCVT * cvt,
     /* Make sure we zero out the audio conversion before error checking */
     SDL_zerop(cvt);
 
+    /* this may be called without the audio subsystem running. */
+    SDL_ChooseAudioConverters();
+
     /* there are no unsigned types over 16 bits, so catch this up front. */
     if ((SDL_AUDIO_BITSIZE(src_fmt) > 16) && (!SDL_AUDIO_ISSIGNED(src_fmt))) {
         return SDL_SetError("Invalid source format");
@@ -711,6 +960,18 @@ SDL_BuildAudioCVT(SDL_AudioCVT * cvt,
     if ((src_rate == 0) || (dst_rate == 0)) {
         return SDL_SetError("Source or destination rate is zero");
     }
+
+    /* One channel of planar data is the same as interleaved */
+    if (src_channels == 1) {
+        src_fmt &= ~SDL_AUDIO_MASK_PLANAR;
+    }
+    if (dst_channels == 1) {
+        dst_fmt &= ~SDL_AUDIO_MASK_PLANAR;
+    }
+
+    if (SDL_AUDIO_ISPLANAR(src_fmt) || SDL_AUDIO_ISPLANAR(dst_fmt)) {
+        return SDL_BuildPlanarAudioCVT(cvt, src_fmt, src_channels, src_rate, dst_fmt, dst_channels, dst_rate);
+    }
 #if DEBUG_CONVERT
     printf("Build format %04x->%04x, channels %u->%u, rate %d->%d\n",
            src_fmt, dst_fmt, src_channels, dst_channels, src_rate, dst_rate);
@@ -772,6 +1033,9 @@ SDL_BuildAudioCVT(SDL_AudioCVT * cvt,
 
         /* just a byteswap needed? */
         if ((src_fmt & ~SDL_AUDIO_MASK_ENDIAN) == (dst_fmt & ~SDL_AUDIO_MASK_ENDIAN)) {
+            if (!SDL_Convert_Byteswap) {
+                return SDL_SetError("No conversion available for these formats");
+            }
             cvt->filters[cvt->filter_index++] = SDL_Convert_Byteswap;
             cvt->needed = 1;
             return 1;
@@ -876,12 +1140,15 @@ struct SDL_AudioStream
     SDL_AudioFormat src_format;
     Uint8 src_channels;
     int src_rate;
+    SDL_bool src_planar;  /* src_format has SDL_AUDIO_MASK_PLANAR removed. */
     int dst_sample_frame_size;
     SDL_AudioFormat dst_format;
     Uint8 dst_channels;
     int dst_rate;
+    SDL_bool dst_planar;
     double rate_incr;
     Uint8 pre_resample_channels;
+    int resampler_output_mult;  /* output bytes per input byte at the same rate; 2 if it converts S16 to float. */
     int packetlen;
     void *resampler_state;
     SDL_ResampleAudioStreamFunc resampler_func;
@@ -1050,6 +1317,28 @@ SDL_ResampleAudioStream_si16_c2(SDL_AudioStream *stream, const void *_inbuf, con
     return SDL_ResampleAudioSimple_si16_c2(stream->rate_incr, state->resampler_state.si16, inbuf, inbuflen, outbuf, outbuflen);
 }
 
+static int
+SDL_ResampleAudioStream_S16_to_F32(SDL_AudioStream *stream, const void *_inbuf, const int inbuflen, void *_outbuf, const int outbuflen)
+{
+    const Sint16 *inbuf = (const Sint16 *) _inbuf;
+    float *outbuf = (float *) _outbuf;
+    SDL_AudioStreamResamplerState *state = (SDL_AudioStreamResamplerState*)stream->resampler_state;
+    const int chans = (int)stream->pre_resample_channels;
+
+    SDL_assert(chans <= SDL_arraysize(state->resampler_state.f));
+    SDL_assert(((const void *) inbuf) != ((const void *) outbuf));
+
+    if (!state->resampler_seeded) {
+        int i;
+        for (i = 0; i < chans; i++) {
+            state->resampler_state.f[i] = S16_TO_F32(inbuf[i]);
+        }
+        state->resampler_seeded = SDL_TRUE;
+    }
+
+    return SDL_ResampleAudioSimple_S16_to_F32(chans, stream->rate_incr, state->resampler_state.f, inbuf, inbuflen, outbuf, outbuflen);
+}
+
 static void
 SDL_ResetAudioStreamResampler(SDL_AudioStream *stream)
 {
@@ -1064,13 +1353,17 @@ SDL_CleanupAudioStreamResampler(SDL_AudioStream *stream)
 }
 
 SDL_AudioStream *
-SDL_NewAudioStream(const SDL_AudioFormat src_format,
+SDL_NewAudioStream(const SDL_AudioFormat _src_format,
                    const Uint8 src_channels,
                    const int src_rate,
-                   const SDL_AudioFormat dst_format,
+                   const SDL_AudioFormat _dst_format,
                    const Uint8 dst_channels,
                    const int dst_rate)
 {
+    /* Planar data is interleaved on the way in and out; everything in
+       between only sees interleaved data. */
+    const SDL_AudioFormat src_format = _src_format & ~SDL_AUDIO_MASK_PLANAR;
+    const SDL_AudioFormat dst_format = _dst_format & ~SDL_AUDIO_MASK_PLANAR;
     const int packetlen = 4096;  /* !!! FIXME: good enough for now. */
     Uint8 pre_resample_channels;
     SDL_AudioStream *retval;
@@ -1078,6 +1371,9 @@ SDL_NewAudioStream(const SDL_AudioFormat src_format,
     const SDL_bool SRC_available = SDL_FALSE;
 #endif
 
+    /* this may be called without the audio subsystem running. */
+    SDL_ChooseAudioConverters();
+
     retval = (SDL_AudioStream *) SDL_calloc(1, sizeof (SDL_AudioStream));
     if (!retval) {
         return NULL;
@@ -1093,11 +1389,14 @@ SDL_NewAudioStream(const SDL_AudioFormat src_format,
     retval->src_format = src_format;
     retval->src_channels = src_channels;
     retval->src_rate = src_rate;
+    retval->src_planar = (SDL_AUDIO_ISPLANAR(_src_format) && (src_channels > 1)) ? SDL_TRUE : SDL_FALSE;
     retval->dst_sample_frame_size = (SDL_AUDIO_BITSIZE(dst_format) / 8) * dst_channels;
     retval->dst_format = dst_format;
     retval->dst_channels = dst_channels;
     retval->dst_rate = dst_rate;
+    retval->dst_planar = (SDL_AUDIO_ISPLANAR(_dst_format) && (dst_channels > 1)) ? SDL_TRUE : SDL_FALSE;
     retval->pre_resample_channels = pre_resample_channels;
+    retval->resampler_output_mult = 1;
     retval->packetlen = packetlen;
     retval->rate_incr = ((double) dst_rate) / ((double) src_rate);
 
@@ -1120,6 +1419,27 @@ SDL_NewAudioStream(const SDL_AudioFormat src_format,
         retval->resampler_func = SDL_ResampleAudioStream_si16_c2;
         retval->reset_resampler_func = SDL_ResetAudioStreamResampler;
         retval->cleanup_resampler_func = SDL_CleanupAudioStreamResampler;
+    /* fast path for mono or stereo Sint16 data: convert to float while resampling, in one pass.
+       This one can't work in place, so planar input (which we interleave into the work buffer) can't use it. */
+    } else if ((!SRC_available) && (!retval->src_planar) && (src_channels <= 2) && (src_channels == pre_resample_channels) && (src_format == AUDIO_S16SYS)) {
+        SDL_assert(src_rate != dst_rate);
+        retval->cvt_before_resampling.needed = SDL_FALSE;
+        retval->resampler_state = SDL_calloc(1, sizeof(SDL_AudioStreamResamplerState));
+        if (!retval->resampler_state) {
+            SDL_FreeAudioStream(retval);
+            SDL_OutOfMemory();
+            return NULL;
+        }
+        retval->resampler_func = SDL_ResampleAudioStream_S16_to_F32;
+        retval->reset_resampler_func = SDL_ResetAudioStreamResampler;
+        retval->cleanup_resampler_func = SDL_CleanupAudioStreamResampler;
+        retval->resampler_output_mult = 2;
+
+        /* Convert us to the final format after resampling. */
+        if (SDL_BuildAudioCVT(&retval->cvt_after_resampling, AUDIO_F32SYS, pre_resample_channels, dst_rate, dst_format, dst_channels, dst_rate) < 0) {
+            SDL_FreeAudioStream(retval);
+            return NULL;  /* SDL_BuildAudioCVT should have called SDL_SetError. */
+        }
     } else {
         /* Don't resample at first. Just get us to Float32 format. */
         /* !!! FIXME: convert to int32 on devices without hardware float. */
@@ -1184,14 +1504,34 @@ SDL_AudioStreamPut(SDL_AudioStream *stream, const void *buf, const Uint32 _bufle
         return SDL_SetError("Can't add partial sample frames");
     }
 
+    if (stream->src_planar) {
+        /* Interleaving is our copy into the work buffer. Make it big enough
+           for every step below, so it doesn't move out from under us. */
+        const int samplesize = SDL_AUDIO_BITSIZE(stream->src_format) / 8;
+        const int frames = buflen / stream->src_sample_frame_size;
+        int workbuflen = buflen * SDL_max(stream->cvt_before_resampling.len_mult, 1);
+        Uint8 *workbuf;
+        if (stream->dst_rate != stream->src_rate) {
+            workbuflen *= ((int) SDL_ceil(stream->rate_incr)) * stream->resampler_output_mult;
+        }
+        workbuflen *= SDL_max(stream->cvt_after_resampling.len_mult, 1);
+        workbuf = EnsureStreamBufferSize(stream, workbuflen);
+        if (workbuf == NULL) {
+            return -1;  /* probably out of memory. */
+        }
+        SDL_InterleaveAudio(workbuf, buf, frames * samplesize, samplesize, stream->src_channels, frames);
+        buf = workbuf;
+    }
+
     if (stream->cvt_before_resampling.needed) {
         const int workbuflen = buflen * stream->cvt_before_resampling.len_mult;  /* will be "* 1" if not needed */
         Uint8 *workbuf = EnsureStreamBufferSize(stream, workbuflen);
         if (workbuf == NULL) {
             return -1;  /* probably out of memory. */
         }
-        SDL_assert(buf == origbuf);
-        SDL_memcpy(workbuf, buf, buflen);
+        if (buf == origbuf) {  /* copy if we haven't before. */
+            SDL_memcpy(workbuf, buf, buflen);
+        }
         stream->cvt_before_resampling.buf = workbuf;
         stream->cvt_before_resampling.len = buflen;
         if (SDL_ConvertAudio(&stream->cvt_before_resampling) == -1) {
@@ -1202,7 +1542,7 @@ SDL_AudioStreamPut(SDL_AudioStream *stream, const void *buf, const Uint32 _bufle
     }
 
     if (stream->dst_rate != stream->src_rate) {
-        const int workbuflen = buflen * ((int) SDL_ceil(stream->rate_incr));
+        const int workbuflen = buflen * ((int) SDL_ceil(stream->rate_incr)) * stream->resampler_output_mult;
         Uint8 *workbuf = EnsureStreamBufferSize(stream, workbuflen);
         if (workbuf == NULL) {
             return -1;  /* probably out of memory. */
@@ -1266,6 +1606,19 @@ SDL_AudioStreamGet(SDL_AudioStream *stream, void *buf, const Uint32 len)
         return SDL_SetError("Can't request partial sample frames");
     }
 
+    if (stream->dst_planar) {
+        const int samplesize = SDL_AUDIO_BITSIZE(stream->dst_format) / 8;
+        Uint8 *workbuf = EnsureStreamBufferSize(stream, (int) len);
+        int got, frames;
+        if (workbuf == NULL) {
+            return -1;  /* probably out of memory. */
+        }
+        got = (int) SDL_ReadFromDataQueue(stream->queue, workbuf, len);
+        frames = got / stream->dst_sample_frame_size;
+        SDL_DeinterleaveAudio(buf, frames * samplesize, workbuf, samplesize, stream->dst_channels, frames);
+        return got;
+    }
+
     return (int) SDL_ReadFromDataQueue(stream->queue, buf, len);
 }
 
@@ -25,27 +25,24 @@
 #include "SDL_cpuinfo.h"
 #include "SDL_assert.h"
 
-/* !!! FIXME: write NEON code. */
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define HAVE_NEON_INTRINSICS 1
+#include <arm_neon.h>
+#else
 #define HAVE_NEON_INTRINSICS 0
+#endif
 
 #ifdef __SSE2__
 #define HAVE_SSE2_INTRINSICS 1
 #endif
 
-#if defined(__x86_64__) && HAVE_SSE2_INTRINSICS
-#define NEED_SCALAR_CONVERTER_FALLBACKS 0  /* x86_64 guarantees SSE2. */
-#elif __MACOSX__ && HAVE_SSE2_INTRINSICS
-#define NEED_SCALAR_CONVERTER_FALLBACKS 0  /* Mac OS X/Intel guarantees SSE2. */
-#elif defined(__ARM_ARCH) && (__ARM_ARCH >= 8) && HAVE_NEON_INTRINSICS
-#define NEED_SCALAR_CONVERTER_FALLBACKS 0  /* ARMv8+ promise NEON. */
-#elif defined(__APPLE__) && defined(__ARM_ARCH) && (__ARM_ARCH >= 7) && HAVE_NEON_INTRINSICS
-#define NEED_SCALAR_CONVERTER_FALLBACKS 0  /* All Apple ARMv7 chips promise NEON support. */
+/* There's no runtime check for SSSE3, so this is only used when the
+   compiler was already told it can assume the CPU has it. */
+#ifdef __SSSE3__
+#define HAVE_SSSE3_INTRINSICS 1
+#include <tmmintrin.h>
 #endif
 
-/* Set to zero if platform is guaranteed to use a SIMD codepath here. */
-#ifndef NEED_SCALAR_CONVERTER_FALLBACKS
-#define NEED_SCALAR_CONVERTER_FALLBACKS 1
-#endif
 
 /* Function pointers set to a CPU-specific implementation. */
 SDL_AudioFilter SDL_Convert_S8_to_F32 = NULL;
@@ -58,6 +55,7 @@ SDL_AudioFilter SDL_Convert_F32_to_U8 = NULL;
 SDL_AudioFilter SDL_Convert_F32_to_S16 = NULL;
 SDL_AudioFilter SDL_Convert_F32_to_U16 = NULL;
 SDL_AudioFilter SDL_Convert_F32_to_S32 = NULL;
+SDL_AudioFilter SDL_Convert_Byteswap = NULL;
 
 
 #define DIVBY127 0.0078740157480315f
@@ -65,7 +63,50 @@ SDL_AudioFilter SDL_Convert_F32_to_S32 = NULL;
 #define DIVBY2147483647 4.6566128752458e-10f
 
 
-#if NEED_SCALAR_CONVERTER_FALLBACKS
+/* Swap (len) bytes worth of (bitsize)-bit samples in place. Used by the
+   byteswap converters to finish off anything the SIMD code didn't cover. */
+static void
+SDL_SwapSamplesScalar(Uint8 *buf, const int len, const int bitsize)
+{
+    switch (bitsize) {
+        #define CASESWAP(b) \
+            case b: { \
+                Uint##b *ptr = (Uint##b *) buf; \
+                int i; \
+                for (i = len / sizeof (*ptr); i; --i, ++ptr) { \
+                    *ptr = SDL_Swap##b(*ptr); \
+                } \
+                break; \
+            }
+
+        CASESWAP(16);
+        CASESWAP(32);
+        CASESWAP(64);
+
+        #undef CASESWAP
+
+        default: SDL_assert(!"unhandled byteswap datatype!"); break;
+    }
+}
+
+/* Run the next filter, if any, telling it the data's endianness changed. */
+static void
+SDL_RunFilterAfterByteswap(SDL_AudioCVT *cvt, SDL_AudioFormat format)
+{
+    if (cvt->filters[++cvt->filter_index]) {
+        /* flip endian flag for data. */
+        if (format & SDL_AUDIO_MASK_ENDIAN) {
+            format &= ~SDL_AUDIO_MASK_ENDIAN;
+        } else {
+            format |= SDL_AUDIO_MASK_ENDIAN;
+        }
+        cvt->filters[cvt->filter_index](cvt, format);
+    }
+}
+
+
+/* The scalar converters are built even where SIMD is guaranteed, so
+   SDL_HINT_CPU_DISABLE_FEATURES can select them for testing. */
 static void SDLCALL
 SDL_Convert_S8_to_F32_Scalar(SDL_AudioCVT *cvt, SDL_AudioFormat format)
 {
@@ -253,7 +294,14 @@ SDL_Convert_F32_to_S32_Scalar(SDL_AudioCVT *cvt, SDL_AudioFormat format)
         cvt->filters[cvt->filter_index](cvt, AUDIO_S32SYS);
     }
 }
-#endif
+
+static void SDLCALL
+SDL_Convert_Byteswap_Scalar(SDL_AudioCVT *cvt, SDL_AudioFormat format)
+{
+    LOG_DEBUG_CONVERT("byte order", "swapped byte order");
+    SDL_SwapSamplesScalar(cvt->buf, cvt->len_cvt, SDL_AUDIO_BITSIZE(format));
+    SDL_RunFilterAfterByteswap(cvt, format);
+}
 
 
 #if HAVE_SSE2_INTRINSICS
@@ -446,7 +494,7 @@ SDL_Convert_U16_to_F32_SSE2(SDL_AudioCVT *cvt, SDL_AudioFormat format)
     if ((((size_t) src) & 15) == 0) {
         /* Aligned! Do SSE blocks as long as we have 16 bytes available. */
         const __m128 divby32767 = _mm_set1_ps(DIVBY32767);
-        const __m128 minus1 = _mm_set1_ps(1.0f);
+        const __m128 minus1 = _mm_set1_ps(-1.0f);
         while (i >= 8) {   /* 8 * 16-bit */
             const __m128i ints = _mm_load_si128((__m128i const *) src);  /* get 8 sint16 into an XMM register. */
             /* treat as int32, shift left to clear every other sint16, then back right with zero-extend. Now sint32. */
@@ -540,10 +588,10 @@ SDL_Convert_F32_to_S8_SSE2(SDL_AudioCVT *cvt, SDL_AudioFormat format)
         const __m128 mulby127 = _mm_set1_ps(127.0f);
         __m128i *mmdst = (__m128i *) dst;
         while (i >= 16) {   /* 16 * float32 */
-            const __m128i ints1 = _mm_cvtps_epi32(_mm_mul_ps(_mm_load_ps(src), mulby127));  /* load 4 floats, convert to sint32 */
-            const __m128i ints2 = _mm_cvtps_epi32(_mm_mul_ps(_mm_load_ps(src+4), mulby127));  /* load 4 floats, convert to sint32 */
-            const __m128i ints3 = _mm_cvtps_epi32(_mm_mul_ps(_mm_load_ps(src+8), mulby127));  /* load 4 floats, convert to sint32 */
-            const __m128i ints4 = _mm_cvtps_epi32(_mm_mul_ps(_mm_load_ps(src+12), mulby127));  /* load 4 floats, convert to sint32 */
+            const __m128i ints1 = _mm_cvttps_epi32(_mm_mul_ps(_mm_load_ps(src), mulby127));  /* load 4 floats, convert to sint32 */
+            const __m128i ints2 = _mm_cvttps_epi32(_mm_mul_ps(_mm_load_ps(src+4), mulby127));  /* load 4 floats, convert to sint32 */
+            const __m128i ints3 = _mm_cvttps_epi32(_mm_mul_ps(_mm_load_ps(src+8), mulby127));  /* load 4 floats, convert to sint32 */
+            const __m128i ints4 = _mm_cvttps_epi32(_mm_mul_ps(_mm_load_ps(src+12), mulby127));  /* load 4 floats, convert to sint32 */
             _mm_store_si128(mmdst, _mm_packs_epi16(_mm_packs_epi32(ints1, ints2), _mm_packs_epi32(ints3, ints4)));  /* pack down, store out. */
             i -= 16; src += 16; mmdst++;
         }
@@ -585,10 +633,10 @@ SDL_Convert_F32_to_U8_SSE2(SDL_AudioCVT *cvt, SDL_AudioFormat format)
         const __m128 mulby127 = _mm_set1_ps(127.0f);
         __m128i *mmdst = (__m128i *) dst;
         while (i >= 16) {   /* 16 * float32 */
-            const __m128i ints1 = _mm_cvtps_epi32(_mm_mul_ps(_mm_add_ps(_mm_load_ps(src), add1), mulby127));  /* load 4 floats, convert to sint32 */
-            const __m128i ints2 = _mm_cvtps_epi32(_mm_mul_ps(_mm_add_ps(_mm_load_ps(src+4), add1), mulby127));  /* load 4 floats, convert to sint32 */
-            const __m128i ints3 = _mm_cvtps_epi32(_mm_mul_ps(_mm_add_ps(_mm_load_ps(src+8), add1), mulby127));  /* load 4 floats, convert to sint32 */
-            const __m128i ints4 = _mm_cvtps_epi32(_mm_mul_ps(_mm_add_ps(_mm_load_ps(src+12), add1), mulby127));  /* load 4 floats, convert to sint32 */
+            const __m128i ints1 = _mm_cvttps_epi32(_mm_mul_ps(_mm_add_ps(_mm_load_ps(src), add1), mulby127));  /* load 4 floats, convert to sint32 */
+            const __m128i ints2 = _mm_cvttps_epi32(_mm_mul_ps(_mm_add_ps(_mm_load_ps(src+4), add1), mulby127));  /* load 4 floats, convert to sint32 */
+            const __m128i ints3 = _mm_cvttps_epi32(_mm_mul_ps(_mm_add_ps(_mm_load_ps(src+8), add1), mulby127));  /* load 4 floats, convert to sint32 */
+            const __m128i ints4 = _mm_cvttps_epi32(_mm_mul_ps(_mm_add_ps(_mm_load_ps(src+12), add1), mulby127));  /* load 4 floats, convert to sint32 */
             _mm_store_si128(mmdst, _mm_packus_epi16(_mm_packs_epi32(ints1, ints2), _mm_packs_epi32(ints3, ints4)));  /* pack down, store out. */
             i -= 16; src += 16; mmdst++;
         }
@@ -629,8 +677,8 @@ SDL_Convert_F32_to_S16_SSE2(SDL_AudioCVT *cvt, SDL_AudioFormat format)
         const __m128 mulby32767 = _mm_set1_ps(32767.0f);
         __m128i *mmdst = (__m128i *) dst;
         while (i >= 8) {   /* 8 * float32 */
-            const __m128i ints1 = _mm_cvtps_epi32(_mm_mul_ps(_mm_load_ps(src), mulby32767));  /* load 4 floats, convert to sint32 */
-            const __m128i ints2 = _mm_cvtps_epi32(_mm_mul_ps(_mm_load_ps(src+4), mulby32767));  /* load 4 floats, convert to sint32 */
+            const __m128i ints1 = _mm_cvttps_epi32(_mm_mul_ps(_mm_load_ps(src), mulby32767));  /* load 4 floats, convert to sint32 */
+            const __m128i ints2 = _mm_cvttps_epi32(_mm_mul_ps(_mm_load_ps(src+4), mulby32767));  /* load 4 floats, convert to sint32 */
             _mm_store_si128(mmdst, _mm_packs_epi32(ints1, ints2));  /* pack to sint16, store out. */
             i -= 8; src += 8; mmdst++;
         }
@@ -668,19 +716,21 @@ SDL_Convert_F32_to_U16_SSE2(SDL_AudioCVT *cvt, SDL_AudioFormat format)
     /* Make sure src is aligned too. */
     if ((((size_t) src) & 15) == 0) {
         /* Aligned! Do SSE blocks as long as we have 16 bytes available. */
-        /* This calculates differently than the scalar path because SSE2 can't
-           pack int32 data down to unsigned int16. _mm_packs_epi32 does signed
-           saturation, so that would corrupt our data. _mm_packus_epi32 exists,
-           but not before SSE 4.1. So we convert from float to sint16, packing
-           that down with legit signed saturation, and then xor the top bit
-           against 1. This results in the correct unsigned 16-bit value, even
-           though it looks like dark magic. */
+        /* SSE2 can't pack int32 data down to unsigned int16. _mm_packs_epi32
+           does signed saturation, so that would corrupt our data.
+           _mm_packus_epi32 exists, but not before SSE 4.1. So we do the same
+           math as the scalar path, bias the result down into sint16 range,
+           pack that down with legit signed saturation, and then xor the top
+           bit against 1. This results in the correct unsigned 16-bit value,
+           even though it looks like dark magic. */
+        const __m128 add1 = _mm_set1_ps(1.0f);
         const __m128 mulby32767 = _mm_set1_ps(32767.0f);
+        const __m128i bias = _mm_set1_epi32(32768);
         const __m128i topbit = _mm_set1_epi16(-32768);
         __m128i *mmdst = (__m128i *) dst;
         while (i >= 8) {   /* 8 * float32 */
-            const __m128i ints1 = _mm_cvtps_epi32(_mm_mul_ps(_mm_load_ps(src), mulby32767));  /* load 4 floats, convert to sint32 */
-            const __m128i ints2 = _mm_cvtps_epi32(_mm_mul_ps(_mm_load_ps(src+4), mulby32767));  /* load 4 floats, convert to sint32 */
+            const __m128i ints1 = _mm_sub_epi32(_mm_cvttps_epi32(_mm_mul_ps(_mm_add_ps(_mm_load_ps(src), add1), mulby32767)), bias);  /* load 4 floats, convert to sint32 */
+            const __m128i ints2 = _mm_sub_epi32(_mm_cvttps_epi32(_mm_mul_ps(_mm_add_ps(_mm_load_ps(src+4), add1), mulby32767)), bias);  /* load 4 floats, convert to sint32 */
             _mm_store_si128(mmdst, _mm_xor_si128(_mm_packs_epi32(ints1, ints2), topbit));  /* pack to sint16, xor top bit, store out. */
             i -= 8; src += 8; mmdst++;
         }
@@ -725,7 +775,7 @@ SDL_Convert_F32_to_S32_SSE2(SDL_AudioCVT *cvt, SDL_AudioFormat format)
             /* bitshift the whole register over, so _mm_cvtps_pd can read the top floats in the bottom of the vector. */
             const __m128d doubles1 = _mm_mul_pd(_mm_cvtps_pd(_mm_castsi128_ps(_mm_srli_si128(_mm_castps_si128(floats), 8))), mulby2147483647);
             const __m128d doubles2 = _mm_mul_pd(_mm_cvtps_pd(floats), mulby2147483647);
-            _mm_store_si128(mmdst, _mm_or_si128(_mm_slli_si128(_mm_cvtpd_epi32(doubles1), 8), _mm_cvtpd_epi32(doubles2)));
+            _mm_store_si128(mmdst, _mm_or_si128(_mm_slli_si128(_mm_cvttpd_epi32(doubles1), 8), _mm_cvttpd_epi32(doubles2)));
             i -= 4; src += 4; mmdst++;
         }
         dst = (Sint32 *) mmdst;
@@ -741,8 +791,675 @@ SDL_Convert_F32_to_S32_SSE2(SDL_AudioCVT *cvt, SDL_AudioFormat format)
         cvt->filters[cvt->filter_index](cvt, AUDIO_S32SYS);
     }
 }
+
+static void SDLCALL
+SDL_Convert_Byteswap_SSE2(SDL_AudioCVT *cvt, SDL_AudioFormat format)
+{
+    const int bitsize = SDL_AUDIO_BITSIZE(format);
+    __m128i *mmptr = (__m128i *) cvt->buf;
+    int i = cvt->len_cvt;
+
+    LOG_DEBUG_CONVERT("byte order", "swapped byte order (using SSE2)");
+
+    /* SSE2 has no byte shuffle, so swap the bytes in each 16-bit lane with
+       shifts, then reorder the 16-bit lanes for the wider types. */
+    while (i >= 16) {   /* 16 bytes at a time */
+        const __m128i v = _mm_loadu_si128(mmptr);
+        __m128i swapped = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+        if (bitsize == 32) {
+            swapped = _mm_shufflehi_epi16(_mm_shufflelo_epi16(swapped, _MM_SHUFFLE(2, 3, 0, 1)), _MM_SHUFFLE(2, 3, 0, 1));
+        } else if (bitsize == 64) {
+            swapped = _mm_shufflehi_epi16(_mm_shufflelo_epi16(swapped, _MM_SHUFFLE(0, 1, 2, 3)), _MM_SHUFFLE(0, 1, 2, 3));
+        }
+        _mm_storeu_si128(mmptr, swapped);
+        i -= 16; mmptr++;
+    }
+
+    /* Finish off any leftovers with scalar operations. */
+    SDL_SwapSamplesScalar((Uint8 *) mmptr, i, bitsize);
+
+    SDL_RunFilterAfterByteswap(cvt, format);
+}
+#endif
+
+
+#if HAVE_SSSE3_INTRINSICS
+static void SDLCALL
+SDL_Convert_Byteswap_SSSE3(SDL_AudioCVT *cvt, SDL_AudioFormat format)
+{
+    const int bitsize = SDL_AUDIO_BITSIZE(format);
+    __m128i *mmptr = (__m128i *) cvt->buf;
+    int i = cvt->len_cvt;
+    __m128i mask;
+
+    LOG_DEBUG_CONVERT("byte order", "swapped byte order (using SSSE3)");
+
+    switch (bitsize) {
+        case 16: mask = _mm_set_epi8(14, 15, 12, 13, 10, 11, 8, 9, 6, 7, 4, 5, 2, 3, 0, 1); break;
+        case 32: mask = _mm_set_epi8(12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3); break;
+        default: mask = _mm_set_epi8(8, 9, 10, 11, 12, 13, 14, 15, 0, 1, 2, 3, 4, 5, 6, 7); break;
+    }
+
+    while (i >= 16) {   /* 16 bytes at a time */
+        _mm_storeu_si128(mmptr, _mm_shuffle_epi8(_mm_loadu_si128(mmptr), mask));
+        i -= 16; mmptr++;
+    }
+
+    /* Finish off any leftovers with scalar operations. */
+    SDL_SwapSamplesScalar((Uint8 *) mmptr, i, bitsize);
+
+    SDL_RunFilterAfterByteswap(cvt, format);
+}
+#endif
+
+#if HAVE_NEON_INTRINSICS
+/* NEON loads and stores don't need aligned memory, so unlike the SSE2
+   versions, these just run over the whole buffer in blocks and finish up
+   with scalar operations. */
+static void SDLCALL
+SDL_Convert_S8_to_F32_NEON(SDL_AudioCVT *cvt, SDL_AudioFormat format)
+{
+    const Sint8 *src = ((const Sint8 *) (cvt->buf + cvt->len_cvt)) - 16;
+    float *dst = ((float *) (cvt->buf + cvt->len_cvt * 4)) - 16;
+    int i = cvt->len_cvt;
+
+    LOG_DEBUG_CONVERT("AUDIO_S8", "AUDIO_F32 (using NEON)");
+
+    {
+        /* Work backwards in blocks (since buffer is growing, we don't have to worry about overreading from src) */
+        const float32x4_t divby127 = vdupq_n_f32(DIVBY127);
+        while (i >= 16) {   /* 16 * 8-bit */
+            const int8x16_t bytes = vld1q_s8(src);  /* get 16 sint8 into a NEON register. */
+            /* widen to sint16, then to sint32, convert to float, multiply, store. */
+            const int16x8_t shorts1 = vmovl_s8(vget_low_s8(bytes));
+            const int16x8_t shorts2 = vmovl_s8(vget_high_s8(bytes));
+            vst1q_f32(dst, vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(shorts1))), divby127));
+            vst1q_f32(dst+4, vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(shorts1))), divby127));
+            vst1q_f32(dst+8, vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(shorts2))), divby127));
+            vst1q_f32(dst+12, vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(shorts2))), divby127));
+            i -= 16; src -= 16; dst -= 16;
+        }
+    }
+
+    src += 15; dst += 15;  /* adjust for any scalar finishing. */
+
+    /* Finish off any leftovers with scalar operations. */
+    while (i) {
+        *dst = (((float) *src) * DIVBY127);
+        i--; src--; dst--;
+    }
+
+    cvt->len_cvt *= 4;
+    if (cvt->filters[++cvt->filter_index]) {
+        cvt->filters[cvt->filter_index](cvt, AUDIO_F32SYS);
+    }
+}
+
+static void SDLCALL
+SDL_Convert_U8_to_F32_NEON(SDL_AudioCVT *cvt, SDL_AudioFormat format)
+{
+    const Uint8 *src = ((const Uint8 *) (cvt->buf + cvt->len_cvt)) - 16;
+    float *dst = ((float *) (cvt->buf + cvt->len_cvt * 4)) - 16;
+    int i = cvt->len_cvt;
+
+    LOG_DEBUG_CONVERT("AUDIO_U8", "AUDIO_F32 (using NEON)");
+
+    {
+        /* Work backwards in blocks (since buffer is growing, we don't have to worry about overreading from src) */
+        const float32x4_t divby127 = vdupq_n_f32(DIVBY127);
+        const float32x4_t one = vdupq_n_f32(1.0f);
+        while (i >= 16) {   /* 16 * 8-bit */
+            const uint8x16_t bytes = vld1q_u8(src);  /* get 16 uint8 into a NEON register. */
+            /* widen to uint16, then to uint32, convert to float, multiply, subtract. */
+            /* (not vmlaq_f32, which may be fused and round differently than the scalar path.) */
+            const uint16x8_t shorts1 = vmovl_u8(vget_low_u8(bytes));
+            const uint16x8_t shorts2 = vmovl_u8(vget_high_u8(bytes));
+            vst1q_f32(dst, vsubq_f32(vmulq_f32(vcvtq_f32_u32(vmovl_u16(vget_low_u16(shorts1))), divby127), one));
+            vst1q_f32(dst+4, vsubq_f32(vmulq_f32(vcvtq_f32_u32(vmovl_u16(vget_high_u16(shorts1))), divby127), one));
+            vst1q_f32(dst+8, vsubq_f32(vmulq_f32(vcvtq_f32_u32(vmovl_u16(vget_low_u16(shorts2))), divby127), one));
+            vst1q_f32(dst+12, vsubq_f32(vmulq_f32(vcvtq_f32_u32(vmovl_u16(vget_high_u16(shorts2))), divby127), one));
+            i -= 16; src -= 16; dst -= 16;
+        }
+    }
+
+    src += 15; dst += 15;  /* adjust for any scalar finishing. */
+
+    /* Finish off any leftovers with scalar operations. */
+    while (i) {
+        *dst = ((((float) *src) * DIVBY127) - 1.0f);
+        i--; src--; dst--;
+    }
+
+    cvt->len_cvt *= 4;
+    if (cvt->filters[++cvt->filter_index]) {
+        cvt->filters[cvt->filter_index](cvt, AUDIO_F32SYS);
+    }
+}
+
+static void SDLCALL
+SDL_Convert_S16_to_F32_NEON(SDL_AudioCVT *cvt, SDL_AudioFormat format)
+{
+    const Sint16 *src = ((const Sint16 *) (cvt->buf + cvt->len_cvt)) - 8;
+    float *dst = ((float *) (cvt->buf + cvt->len_cvt * 2)) - 8;
+    int i = cvt->len_cvt / sizeof (Sint16);
+
+    LOG_DEBUG_CONVERT("AUDIO_S16", "AUDIO_F32 (using NEON)");
+
+    {
+        /* Work backwards in blocks (since buffer is growing, we don't have to worry about overreading from src) */
+        const float32x4_t divby32767 = vdupq_n_f32(DIVBY32767);
+        while (i >= 8) {   /* 8 * 16-bit */
+            const int16x8_t ints = vld1q_s16(src);  /* get 8 sint16 into a NEON register. */
+            /* widen to sint32, convert to float, multiply, store. */
+            vst1q_f32(dst, vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(ints))), divby32767));
+            vst1q_f32(dst+4, vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(ints))), divby32767));
+            i -= 8; src -= 8; dst -= 8;
+        }
+    }
+
+    src += 7; dst += 7;  /* adjust for any scalar finishing. */
+
+    /* Finish off any leftovers with scalar operations. */
+    while (i) {
+        *dst = (((float) *src) * DIVBY32767);
+        i--; src--; dst--;
+    }
+
+    cvt->len_cvt *= 2;
+    if (cvt->filters[++cvt->filter_index]) {
+        cvt->filters[cvt->filter_index](cvt, AUDIO_F32SYS);
+    }
+}
+
+static void SDLCALL
+SDL_Convert_U16_to_F32_NEON(SDL_AudioCVT *cvt, SDL_AudioFormat format)
+{
+    const Uint16 *src = ((const Uint16 *) (cvt->buf + cvt->len_cvt)) - 8;
+    float *dst = ((float *) (cvt->buf + cvt->len_cvt * 2)) - 8;
+    int i = cvt->len_cvt / sizeof (Uint16);
+
+    LOG_DEBUG_CONVERT("AUDIO_U16", "AUDIO_F32 (using NEON)");
+
+    {
+        /* Work backwards in blocks (since buffer is growing, we don't have to worry about overreading from src) */
+        const float32x4_t divby32767 = vdupq_n_f32(DIVBY32767);
+        const float32x4_t one = vdupq_n_f32(1.0f);
+        while (i >= 8) {   /* 8 * 16-bit */
+            const uint16x8_t ints = vld1q_u16(src);  /* get 8 uint16 into a NEON register. */
+            /* widen to uint32, convert to float, multiply, subtract, store. */
+            vst1q_f32(dst, vsubq_f32(vmulq_f32(vcvtq_f32_u32(vmovl_u16(vget_low_u16(ints))), divby32767), one));
+            vst1q_f32(dst+4, vsubq_f32(vmulq_f32(vcvtq_f32_u32(vmovl_u16(vget_high_u16(ints))), divby32767), one));
+            i -= 8; src -= 8; dst -= 8;
+        }
+    }
+
+    src += 7; dst += 7;  /* adjust for any scalar finishing. */
+
+    /* Finish off any leftovers with scalar operations. */
+    while (i) {
+        *dst = ((((float) *src) * DIVBY32767) - 1.0f);
+        i--; src--; dst--;
+    }
+
+    cvt->len_cvt *= 2;
+    if (cvt->filters[++cvt->filter_index]) {
+        cvt->filters[cvt->filter_index](cvt, AUDIO_F32SYS);
+    }
+}
+
+static void SDLCALL
+SDL_Convert_S32_to_F32_NEON(SDL_AudioCVT *cvt, SDL_AudioFormat format)
+{
+    const Sint32 *src = (const Sint32 *) cvt->buf;
+    float *dst = (float *) cvt->buf;
+    int i = cvt->len_cvt / sizeof (Sint32);
+
+    LOG_DEBUG_CONVERT("AUDIO_S32", "AUDIO_F32 (using NEON)");
+
+    /* DIVBY2147483647 rounds to exactly 2^-31 as a float, so a fixed-point
+       conversion with 31 fractional bits gives the same single rounding
+       that the scalar path gets by going through a double. */
+    while (i >= 4) {   /* 4 * sint32 */
+        vst1q_f32(dst, vcvtq_n_f32_s32(vld1q_s32(src), 31));
+        i -= 4; src += 4; dst += 4;
+    }
+
+    /* Finish off any leftovers with scalar operations. */
+    while (i) {
+        *dst = (float) (((double) *src) * DIVBY2147483647);
+        i--; src++; dst++;
+    }
+
+    if (cvt->filters[++cvt->filter_index]) {
+        cvt->filters[cvt->filter_index](cvt, AUDIO_F32SYS);
+    }
+}
+
+static void SDLCALL
+SDL_Convert_F32_to_S8_NEON(SDL_AudioCVT *cvt, SDL_AudioFormat format)
+{
+    const float *src = (const float *) cvt->buf;
+    Sint8 *dst = (Sint8 *) cvt->buf;
+    int i = cvt->len_cvt / sizeof (float);
+
+    LOG_DEBUG_CONVERT("AUDIO_F32", "AUDIO_S8 (using NEON)");
+
+    {
+        const float32x4_t mulby127 = vdupq_n_f32(127.0f);
+        while (i >= 16) {   /* 16 * float32 */
+            /* multiply, convert to sint32 (truncating, like the scalar cast), pack down with saturation, store out. */
+            const int32x4_t ints1 = vcvtq_s32_f32(vmulq_f32(vld1q_f32(src), mulby127));
+            const int32x4_t ints2 = vcvtq_s32_f32(vmulq_f32(vld1q_f32(src+4), mulby127));
+            const int32x4_t ints3 = vcvtq_s32_f32(vmulq_f32(vld1q_f32(src+8), mulby127));
+            const int32x4_t ints4 = vcvtq_s32_f32(vmulq_f32(vld1q_f32(src+12), mulby127));
+            const int16x8_t shorts1 = vcombine_s16(vqmovn_s32(ints1), vqmovn_s32(ints2));
+            const int16x8_t shorts2 = vcombine_s16(vqmovn_s32(ints3), vqmovn_s32(ints4));
+            vst1q_s8(dst, vcombine_s8(vqmovn_s16(shorts1), vqmovn_s16(shorts2)));
+            i -= 16; src += 16; dst += 16;
+        }
+    }
+
+    /* Finish off any leftovers with scalar operations. */
+    while (i) {
+        *dst = (Sint8) (*src * 127.0f);
+        i--; src++; dst++;
+    }
+
+    cvt->len_cvt /= 4;
+    if (cvt->filters[++cvt->filter_index]) {
+        cvt->filters[cvt->filter_index](cvt, AUDIO_S8);
+    }
+}
+
+static void SDLCALL
+SDL_Convert_F32_to_U8_NEON(SDL_AudioCVT *cvt, SDL_AudioFormat format)
+{
+    const float *src = (const float *) cvt->buf;
+    Uint8 *dst = (Uint8 *) cvt->buf;
+    int i = cvt->len_cvt / sizeof (float);
+
+    LOG_DEBUG_CONVERT("AUDIO_F32", "AUDIO_U8 (using NEON)");
+
+    {
+        const float32x4_t add1 = vdupq_n_f32(1.0f);
+        const float32x4_t mulby127 = vdupq_n_f32(127.0f);
+        while (i >= 16) {   /* 16 * float32 */
+            /* add, multiply, convert to uint32 (truncating, like the scalar cast), pack down with saturation, store out. */
+            const uint32x4_t ints1 = vcvtq_u32_f32(vmulq_f32(vaddq_f32(vld1q_f32(src), add1), mulby127));
+            const uint32x4_t ints2 = vcvtq_u32_f32(vmulq_f32(vaddq_f32(vld1q_f32(src+4), add1), mulby127));
+            const uint32x4_t ints3 = vcvtq_u32_f32(vmulq_f32(vaddq_f32(vld1q_f32(src+8), add1), mulby127));
+            const uint32x4_t ints4 = vcvtq_u32_f32(vmulq_f32(vaddq_f32(vld1q_f32(src+12), add1), mulby127));
+            const uint16x8_t shorts1 = vcombine_u16(vqmovn_u32(ints1), vqmovn_u32(ints2));
+            const uint16x8_t shorts2 = vcombine_u16(vqmovn_u32(ints3), vqmovn_u32(ints4));
+            vst1q_u8(dst, vcombine_u8(vqmovn_u16(shorts1), vqmovn_u16(shorts2)));
+            i -= 16; src += 16; dst += 16;
+        }
+    }
+
+    /* Finish off any leftovers with scalar operations. */
+    while (i) {
+        *dst = (Uint8) ((*src + 1.0f) * 127.0f);
+        i--; src++; dst++;
+    }
+
+    cvt->len_cvt /= 4;
+    if (cvt->filters[++cvt->filter_index]) {
+        cvt->filters[cvt->filter_index](cvt, AUDIO_U8);
+    }
+}
+
+static void SDLCALL
+SDL_Convert_F32_to_S16_NEON(SDL_AudioCVT *cvt, SDL_AudioFormat format)
+{
+    const float *src = (const float *) cvt->buf;
+    Sint16 *dst = (Sint16 *) cvt->buf;
+    int i = cvt->len_cvt / sizeof (float);
+
+    LOG_DEBUG_CONVERT("AUDIO_F32", "AUDIO_S16 (using NEON)");
+
+    {
+        const float32x4_t mulby32767 = vdupq_n_f32(32767.0f);
+        while (i >= 8) {   /* 8 * float32 */
+            /* multiply, convert to sint32 (truncating, like the scalar cast), pack down with saturation, store out. */
+            const int32x4_t ints1 = vcvtq_s32_f32(vmulq_f32(vld1q_f32(src), mulby32767));
+            const int32x4_t ints2 = vcvtq_s32_f32(vmulq_f32(vld1q_f32(src+4), mulby32767));
+            vst1q_s16(dst, vcombine_s16(vqmovn_s32(ints1), vqmovn_s32(ints2)));
+            i -= 8; src += 8; dst += 8;
+        }
+    }
+
+    /* Finish off any leftovers with scalar operations. */
+    while (i) {
+        *dst = (Sint16) (*src * 32767.0f);
+        i--; src++; dst++;
+    }
+
+    cvt->len_cvt /= 2;
+    if (cvt->filters[++cvt->filter_index]) {
+        cvt->filters[cvt->filter_index](cvt, AUDIO_S16SYS);
+    }
+}
+
+static void SDLCALL
+SDL_Convert_F32_to_U16_NEON(SDL_AudioCVT *cvt, SDL_AudioFormat format)
+{
+    const float *src = (const float *) cvt->buf;
+    Uint16 *dst = (Uint16 *) cvt->buf;
+    int i = cvt->len_cvt / sizeof (float);
+
+    LOG_DEBUG_CONVERT("AUDIO_F32", "AUDIO_U16 (using NEON)");
+
+    {
+        const float32x4_t add1 = vdupq_n_f32(1.0f);
+        const float32x4_t mulby32767 = vdupq_n_f32(32767.0f);
+        while (i >= 8) {   /* 8 * float32 */
+            /* add, multiply, convert to uint32 (truncating, like the scalar cast), pack down with saturation, store out. */
+            const uint32x4_t ints1 = vcvtq_u32_f32(vmulq_f32(vaddq_f32(vld1q_f32(src), add1), mulby32767));
+            const uint32x4_t ints2 = vcvtq_u32_f32(vmulq_f32(vaddq_f32(vld1q_f32(src+4), add1), mulby32767));
+            vst1q_u16(dst, vcombine_u16(vqmovn_u32(ints1), vqmovn_u32(ints2)));
+            i -= 8; src += 8; dst += 8;
+        }
+    }
+
+    /* Finish off any leftovers with scalar operations. */
+    while (i) {
+        *dst = (Uint16) ((*src + 1.0f) * 32767.0f);
+        i--; src++; dst++;
+    }
+
+    cvt->len_cvt /= 2;
+    if (cvt->filters[++cvt->filter_index]) {
+        cvt->filters[cvt->filter_index](cvt, AUDIO_U16SYS);
+    }
+}
+
+static void SDLCALL
+SDL_Convert_F32_to_S32_NEON(SDL_AudioCVT *cvt, SDL_AudioFormat format)
+{
+    const float *src = (const float *) cvt->buf;
+    Sint32 *dst = (Sint32 *) cvt->buf;
+    int i = cvt->len_cvt / sizeof (float);
+
+    LOG_DEBUG_CONVERT("AUDIO_F32", "AUDIO_S32 (using NEON)");
+
+#if defined(__aarch64__)
+    {
+        /* The scalar path multiplies in double precision; AArch64 can too.
+           32-bit ARM NEON has no double-precision vectors, so there we
+           leave all of it to the scalar loop below. */
+        const float64x2_t mulby2147483647 = vdupq_n_f64(2147483647.0);
+        while (i >= 4) {   /* 4 * float32 */
+            const float32x4_t floats = vld1q_f32(src);
+            const int64x2_t ints1 = vcvtq_s64_f64(vmulq_f64(vcvt_f64_f32(vget_low_f32(floats)), mulby2147483647));
+            const int64x2_t ints2 = vcvtq_s64_f64(vmulq_f64(vcvt_high_f64_f32(floats), mulby2147483647));
+            vst1q_s32(dst, vcombine_s32(vmovn_s64(ints1), vmovn_s64(ints2)));
+            i -= 4; src += 4; dst += 4;
+        }
+    }
+#endif
+
+    /* Finish off any leftovers with scalar operations. */
+    while (i) {
+        *dst = (Sint32) (((double) *src) * 2147483647.0);
+        i--; src++; dst++;
+    }
+
+    if (cvt->filters[++cvt->filter_index]) {
+        cvt->filters[cvt->filter_index](cvt, AUDIO_S32SYS);
+    }
+}
+
+static void SDLCALL
+SDL_Convert_Byteswap_NEON(SDL_AudioCVT *cvt, SDL_AudioFormat format)
+{
+    const int bitsize = SDL_AUDIO_BITSIZE(format);
+    Uint8 *ptr = cvt->buf;
+    int i = cvt->len_cvt;
+
+    LOG_DEBUG_CONVERT("byte order", "swapped byte order (using NEON)");
+
+    if (bitsize == 16) {
+        for (; i >= 16; i -= 16, ptr += 16) {
+            vst1q_u8(ptr, vrev16q_u8(vld1q_u8(ptr)));
+        }
+    } else if (bitsize == 32) {
+        for (; i >= 16; i -= 16, ptr += 16) {
+            vst1q_u8(ptr, vrev32q_u8(vld1q_u8(ptr)));
+        }
+    } else if (bitsize == 64) {
+        for (; i >= 16; i -= 16, ptr += 16) {
+            vst1q_u8(ptr, vrev64q_u8(vld1q_u8(ptr)));
+        }
+    }
+
+    /* Finish off any leftovers with scalar operations. */
+    SDL_SwapSamplesScalar(ptr, i, bitsize);
+
+    SDL_RunFilterAfterByteswap(cvt, format);
+}
+#endif
+
+/* Planar <-> interleaved shuffles. These only move bits around, so one
+   version of each handles every sample type of a given size. */
+#define PLANAR_SHUFFLE_FUNCS(bits) \
+    static void \
+    SDL_InterleaveAudio##bits##_Scalar(Uint##bits *dst, const Uint8 *src, const int pitch, const int channels, const int frames, int i) { \
+        int c; \
+        for (c = 0; c < channels; c++) { \
+            const Uint##bits *plane = (const Uint##bits *) (src + (c * pitch)); \
+            Uint##bits *ptr = dst + (i * channels) + c; \
+            int j; \
+            for (j = i; j < frames; j++, ptr += channels) { \
+                *ptr = plane[j]; \
+            } \
+        } \
+    } \
+    static void \
+    SDL_DeinterleaveAudio##bits##_Scalar(Uint8 *dst, const int pitch, const Uint##bits *src, const int channels, const int frames, int i) { \
+        int c; \
+        for (c = 0; c < channels; c++) { \
+            Uint##bits *plane = (Uint##bits *) (dst + (c * pitch)); \
+            const Uint##bits *ptr = src + (i * channels) + c; \
+            int j; \
+            for (j = i; j < frames; j++, ptr += channels) { \
+                plane[j] = *ptr; \
+            } \
+        } \
+    }
+PLANAR_SHUFFLE_FUNCS(8)
+PLANAR_SHUFFLE_FUNCS(16)
+PLANAR_SHUFFLE_FUNCS(32)
+#undef PLANAR_SHUFFLE_FUNCS
+
+#if HAVE_SSE2_INTRINSICS
+/* Stereo only; returns how many frames it did, the caller does the rest. */
+static int
+SDL_InterleaveStereo16_SSE2(Uint16 *dst, const Uint16 *left, const Uint16 *right, const int frames)
+{
+    int i;
+    for (i = 0; (i + 8) <= frames; i += 8) {
+        const __m128i l = _mm_loadu_si128((const __m128i *) (left + i));
+        const __m128i r = _mm_loadu_si128((const __m128i *) (right + i));
+        _mm_storeu_si128((__m128i *) (dst + (i * 2)), _mm_unpacklo_epi16(l, r));
+        _mm_storeu_si128((__m128i *) (dst + (i * 2) + 8), _mm_unpackhi_epi16(l, r));
+    }
+    return i;
+}
+
+static int
+SDL_InterleaveStereo32_SSE2(Uint32 *dst, const Uint32 *left, const Uint32 *right, const int frames)
+{
+    int i;
+    for (i = 0; (i + 4) <= frames; i += 4) {
+        const __m128i l = _mm_loadu_si128((const __m128i *) (left + i));
+        const __m128i r = _mm_loadu_si128((const __m128i *) (right + i));
+        _mm_storeu_si128((__m128i *) (dst + (i * 2)), _mm_unpacklo_epi32(l, r));
+        _mm_storeu_si128((__m128i *) (dst + (i * 2) + 4), _mm_unpackhi_epi32(l, r));
+    }
+    return i;
+}
+
+static int
+SDL_DeinterleaveStereo16_SSE2(Uint16 *left, Uint16 *right, const Uint16 *src, const int frames)
+{
+    int i;
+    for (i = 0; (i + 8) <= frames; i += 8) {
+        const __m128i a = _mm_loadu_si128((const __m128i *) (src + (i * 2)));
+        const __m128i b = _mm_loadu_si128((const __m128i *) (src + (i * 2) + 8));
+        /* sign-extend each half to 32 bits, so packing it back is exact. */
+        const __m128i la = _mm_srai_epi32(_mm_slli_epi32(a, 16), 16);
+        const __m128i lb = _mm_srai_epi32(_mm_slli_epi32(b, 16), 16);
+        _mm_storeu_si128((__m128i *) (left + i), _mm_packs_epi32(la, lb));
+        _mm_storeu_si128((__m128i *) (right + i), _mm_packs_epi32(_mm_srai_epi32(a, 16), _mm_srai_epi32(b, 16)));
+    }
+    return i;
+}
+
+static int
+SDL_DeinterleaveStereo32_SSE2(Uint32 *left, Uint32 *right, const Uint32 *src, const int frames)
+{
+    int i;
+    for (i = 0; (i + 4) <= frames; i += 4) {
+        const __m128 a = _mm_castsi128_ps(_mm_loadu_si128((const __m128i *) (src + (i * 2))));
+        const __m128 b = _mm_castsi128_ps(_mm_loadu_si128((const __m128i *) (src + (i * 2) + 4)));
+        _mm_storeu_si128((__m128i *) (left + i), _mm_castps_si128(_mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0))));
+        _mm_storeu_si128((__m128i *) (right + i), _mm_castps_si128(_mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1))));
+    }
+    return i;
+}
 #endif
 
+#if HAVE_NEON_INTRINSICS
+static int
+SDL_InterleaveStereo16_NEON(Uint16 *dst, const Uint16 *left, const Uint16 *right, const int frames)
+{
+    int i;
+    for (i = 0; (i + 8) <= frames; i += 8) {
+        uint16x8x2_t lr;
+        lr.val[0] = vld1q_u16(left + i);
+        lr.val[1] = vld1q_u16(right + i);
+        vst2q_u16(dst + (i * 2), lr);
+    }
+    return i;
+}
+
+static int
+SDL_InterleaveStereo32_NEON(Uint32 *dst, const Uint32 *left, const Uint32 *right, const int frames)
+{
+    int i;
+    for (i = 0; (i + 4) <= frames; i += 4) {
+        uint32x4x2_t lr;
+        lr.val[0] = vld1q_u32(left + i);
+        lr.val[1] = vld1q_u32(right + i);
+        vst2q_u32(dst + (i * 2), lr);
+    }
+    return i;
+}
+
+static int
+SDL_DeinterleaveStereo16_NEON(Uint16 *left, Uint16 *right, const Uint16 *src, const int frames)
+{
+    int i;
+    for (i = 0; (i + 8) <= frames; i += 8) {
+        const uint16x8x2_t lr = vld2q_u16(src + (i * 2));
+        vst1q_u16(left + i, lr.val[0]);
+        vst1q_u16(right + i, lr.val[1]);
+    }
+    return i;
+}
+
+static int
+SDL_DeinterleaveStereo32_NEON(Uint32 *left, Uint32 *right, const Uint32 *src, const int frames)
+{
+    int i;
+    for (i = 0; (i + 4) <= frames; i += 4) {
+        const uint32x4x2_t lr = vld2q_u32(src + (i * 2));
+        vst1q_u32(left + i, lr.val[0]);
+        vst1q_u32(right + i, lr.val[1]);
+    }
+    return i;
+}
+#endif
+
+void
+SDL_InterleaveAudio(void *dst, const void *src, const int src_pitch, const int samplesize, const int channels, const int frames)
+{
+    const Uint8 *planes = (const Uint8 *) src;
+    int i = 0;
+
+    if (samplesize == 2) {
+        if (channels == 2) {
+            #if HAVE_SSE2_INTRINSICS
+            if (SDL_HasSSE2()) {
+                i = SDL_InterleaveStereo16_SSE2((Uint16 *) dst, (const Uint16 *) planes, (const Uint16 *) (planes + src_pitch), frames);
+            }
+            #endif
+            #if HAVE_NEON_INTRINSICS
+            if ((i == 0) && SDL_HasNEON()) {
+                i = SDL_InterleaveStereo16_NEON((Uint16 *) dst, (const Uint16 *) planes, (const Uint16 *) (planes + src_pitch), frames);
+            }
+            #endif
+        }
+        SDL_InterleaveAudio16_Scalar((Uint16 *) dst, planes, src_pitch, channels, frames, i);
+    } else if (samplesize == 4) {
+        if (channels == 2) {
+            #if HAVE_SSE2_INTRINSICS
+            if (SDL_HasSSE2()) {
+                i = SDL_InterleaveStereo32_SSE2((Uint32 *) dst, (const Uint32 *) planes, (const Uint32 *) (planes + src_pitch), frames);
+            }
+            #endif
+            #if HAVE_NEON_INTRINSICS
+            if ((i == 0) && SDL_HasNEON()) {
+                i = SDL_InterleaveStereo32_NEON((Uint32 *) dst, (const Uint32 *) planes, (const Uint32 *) (planes + src_pitch), frames);
+            }
+            #endif
+        }
+        SDL_InterleaveAudio32_Scalar((Uint32 *) dst, planes, src_pitch, channels, frames, i);
+    } else {
+        SDL_assert(samplesize == 1);
+        SDL_InterleaveAudio8_Scalar((Uint8 *) dst, planes, src_pitch, channels, frames, 0);
+    }
+}
+
+void
+SDL_DeinterleaveAudio(void *dst, const int dst_pitch, const void *src, const int samplesize, const int channels, const int frames)
+{
+    Uint8 *planes = (Uint8 *) dst;
+    int i = 0;
+
+    if (samplesize == 2) {
+        if (channels == 2) {
+            #if HAVE_SSE2_INTRINSICS
+            if (SDL_HasSSE2()) {
+                i = SDL_DeinterleaveStereo16_SSE2((Uint16 *) planes, (Uint16 *) (planes + dst_pitch), (const Uint16 *) src, frames);
+            }
+            #endif
+            #if HAVE_NEON_INTRINSICS
+            if ((i == 0) && SDL_HasNEON()) {
+                i = SDL_DeinterleaveStereo16_NEON((Uint16 *) planes, (Uint16 *) (planes + dst_pitch), (const Uint16 *) src, frames);
+            }
+            #endif
+        }
+        SDL_DeinterleaveAudio16_Scalar(planes, dst_pitch, (const Uint16 *) src, channels, frames, i);
+    } else if (samplesize == 4) {
+        if (channels == 2) {
+            #if HAVE_SSE2_INTRINSICS
+            if (SDL_HasSSE2()) {
+                i = SDL_DeinterleaveStereo32_SSE2((Uint32 *) planes, (Uint32 *) (planes + dst_pitch), (const Uint32 *) src, frames);
+            }
+            #endif
+            #if HAVE_NEON_INTRINSICS
+            if ((i == 0) && SDL_HasNEON()) {
+                i = SDL_DeinterleaveStereo32_NEON((Uint32 *) planes, (Uint32 *) (planes + dst_pitch), (const Uint32 *) src, frames);
+            }
+            #endif
+        }
+        SDL_DeinterleaveAudio32_Scalar(planes, dst_pitch, (const Uint32 *) src, channels, frames, i);
+    } else {
+        SDL_assert(samplesize == 1);
+        SDL_DeinterleaveAudio8_Scalar(planes, dst_pitch, (const Uint8 *) src, channels, frames, 0);
+    }
+}
 
 void SDL_ChooseAudioConverters(void)
 {
@@ -763,19 +1480,28 @@ void SDL_ChooseAudioConverters(void)
         SDL_Convert_F32_to_S16 = SDL_Convert_F32_to_S16_##fntype; \
         SDL_Convert_F32_to_U16 = SDL_Convert_F32_to_U16_##fntype; \
         SDL_Convert_F32_to_S32 = SDL_Convert_F32_to_S32_##fntype; \
+        SDL_Convert_Byteswap = SDL_Convert_Byteswap_##fntype; \
         converters_chosen = SDL_TRUE
 
     #if HAVE_SSE2_INTRINSICS
     if (SDL_HasSSE2()) {
         SET_CONVERTER_FUNCS(SSE2);
+        #if HAVE_SSSE3_INTRINSICS
+        SDL_Convert_Byteswap = SDL_Convert_Byteswap_SSSE3;
+        #endif
         return;
     }
     #endif
 
-    #if NEED_SCALAR_CONVERTER_FALLBACKS
-    SET_CONVERTER_FUNCS(Scalar);
+    #if HAVE_NEON_INTRINSICS
+    if (SDL_HasNEON()) {
+        SET_CONVERTER_FUNCS(NEON);
+        return;
+    }
     #endif
 
+    SET_CONVERTER_FUNCS(Scalar);
+
     #undef SET_CONVERTER_FUNCS
 
     SDL_assert(converters_chosen == SDL_TRUE);
@@ -26,6 +26,38 @@
 #include "SDL_timer.h"
 #include "SDL_audio.h"
 #include "SDL_sysaudio.h"
+#include "SDL_assert.h"
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define HAVE_NEON_INTRINSICS 1
+#include <arm_neon.h>
+#endif
+
+#ifdef __SSE2__
+#define HAVE_SSE2_INTRINSICS 1
+#endif
+
+/* The AVX2 mixers are compiled with a function-level target attribute, so
+   they're available even when SDL itself is built for a baseline x86 CPU,
+   and are only called after SDL_HasAVX2() says the CPU can run them. */
+#if defined(__AVX2__)
+#define HAVE_AVX2_INTRINSICS 1
+#define SDL_TARGETING_AVX2
+#elif (defined(__i386__) || defined(__x86_64__)) && defined(__clang__)
+#if (__clang_major__ > 3) || ((__clang_major__ == 3) && (__clang_minor__ >= 8))
+#define HAVE_AVX2_INTRINSICS 1
+#define SDL_TARGETING_AVX2 __attribute__((target("avx2")))
+#endif
+#elif (defined(__i386__) || defined(__x86_64__)) && defined(__GNUC__)
+#if (__GNUC__ > 4) || ((__GNUC__ == 4) && (__GNUC_MINOR__ >= 9))
+#define HAVE_AVX2_INTRINSICS 1
+#define SDL_TARGETING_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+#if HAVE_AVX2_INTRINSICS
+#include <immintrin.h>
+#endif
 
 /* This table is used to add two sound values together and pin
  * the value to avoid overflow.  (used with permission from ARDI)
@@ -85,6 +117,293 @@ static const Uint8 mix8[] = {
 #define ADJUST_VOLUME(s, v) (s = (s*v)/SDL_MIX_MAXVOLUME)
 #define ADJUST_VOLUME_U8(s, v)  (s = (((s-128)*v)/SDL_MIX_MAXVOLUME)+128)
 
+/* The SIMD mixers below produce exactly the same output as the scalar code
+ * in SDL_MixAudioFormat(): samples are scaled with ADJUST_VOLUME's
+ * round-toward-zero division and then added with saturation. They only
+ * handle native-endian S16, S32 and F32 data; everything else (and the
+ * leftover samples that don't fill a whole vector) is mixed by the scalar
+ * code. Each returns the number of samples it mixed.
+ *
+ * The integer versions divide by SDL_MIX_MAXVOLUME with a shift, and are
+ * only used for volumes up to SDL_MIX_MAXVOLUME, so the scaled sample
+ * always fits in the source type.
+ */
+
+#if HAVE_SSE2_INTRINSICS
+static Uint32
+SDL_MixAudio_S16_SSE2(Sint16 * dst, const Sint16 * src, const Uint32 num_samples, const int volume)
+{
+    const __m128i vol = _mm_set1_epi16((Sint16) volume);
+    const __m128i round = _mm_set1_epi32(SDL_MIX_MAXVOLUME - 1);
+    const Uint32 total = num_samples & ~7;
+    Uint32 i;
+
+    for (i = 0; i < total; i += 8) {
+        const __m128i s = _mm_loadu_si128((const __m128i *) &src[i]);
+        const __m128i d = _mm_loadu_si128((const __m128i *) &dst[i]);
+        const __m128i prodlo = _mm_mullo_epi16(s, vol);
+        const __m128i prodhi = _mm_mulhi_epi16(s, vol);
+        __m128i lo = _mm_unpacklo_epi16(prodlo, prodhi);
+        __m128i hi = _mm_unpackhi_epi16(prodlo, prodhi);
+        /* bias negative values so the arithmetic shift rounds toward zero. */
+        lo = _mm_srai_epi32(_mm_add_epi32(lo, _mm_and_si128(_mm_srai_epi32(lo, 31), round)), 7);
+        hi = _mm_srai_epi32(_mm_add_epi32(hi, _mm_and_si128(_mm_srai_epi32(hi, 31), round)), 7);
+        _mm_storeu_si128((__m128i *) &dst[i], _mm_adds_epi16(_mm_packs_epi32(lo, hi), d));
+    }
+    return total;
+}
+
+static Uint32
+SDL_MixAudio_S32_SSE2(Sint32 * dst, const Sint32 * src, const Uint32 num_samples, const int volume)
+{
+    /* A scaled 32-bit sample, and the sum of two of them, are exact in a double. */
+    const __m128d vol = _mm_set1_pd(((double) volume) / ((double) SDL_MIX_MAXVOLUME));
+    const __m128d max_audioval = _mm_set1_pd(2147483647.0);
+    const __m128d min_audioval = _mm_set1_pd(-2147483648.0);
+    const Uint32 total = num_samples & ~3;
+    Uint32 i;
+
+    for (i = 0; i < total; i += 4) {
+        const __m128i s = _mm_loadu_si128((const __m128i *) &src[i]);
+        const __m128i d = _mm_loadu_si128((const __m128i *) &dst[i]);
+        const __m128i shigh = _mm_shuffle_epi32(s, _MM_SHUFFLE(1, 0, 3, 2));
+        const __m128i dhigh = _mm_shuffle_epi32(d, _MM_SHUFFLE(1, 0, 3, 2));
+        __m128d lo = _mm_cvtepi32_pd(_mm_cvttpd_epi32(_mm_mul_pd(_mm_cvtepi32_pd(s), vol)));
+        __m128d hi = _mm_cvtepi32_pd(_mm_cvttpd_epi32(_mm_mul_pd(_mm_cvtepi32_pd(shigh), vol)));
+        lo = _mm_add_pd(lo, _mm_cvtepi32_pd(d));
+        hi = _mm_add_pd(hi, _mm_cvtepi32_pd(dhigh));
+        lo = _mm_max_pd(_mm_min_pd(lo, max_audioval), min_audioval);
+        hi = _mm_max_pd(_mm_min_pd(hi, max_audioval), min_audioval);
+        _mm_storeu_si128((__m128i *) &dst[i], _mm_unpacklo_epi64(_mm_cvttpd_epi32(lo), _mm_cvttpd_epi32(hi)));
+    }
+    return total;
+}
+
+static Uint32
+SDL_MixAudio_F32_SSE2(float * dst, const float * src, const Uint32 num_samples, const int volume)
+{
+    const __m128 fvolume = _mm_set1_ps((float) volume);
+    const __m128 fmaxvolume = _mm_set1_ps(1.0f / ((float) SDL_MIX_MAXVOLUME));
+    const __m128 max_audioval = _mm_set1_ps(3.402823466e+38F);
+    const __m128 min_audioval = _mm_set1_ps(-3.402823466e+38F);
+    const Uint32 total = num_samples & ~3;
+    Uint32 i;
+
+    for (i = 0; i < total; i += 4) {
+        const __m128 s = _mm_loadu_ps(&src[i]);
+        const __m128 d = _mm_loadu_ps(&dst[i]);
+        const __m128 sum = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(s, fvolume), fmaxvolume), d);
+        /* clamp overflow to +/-FLT_MAX; the operand order lets NaNs through, like the scalar code. */
+        _mm_storeu_ps(&dst[i], _mm_max_ps(min_audioval, _mm_min_ps(max_audioval, sum)));
+    }
+    return total;
+}
+#endif
+
+#if HAVE_AVX2_INTRINSICS
+static Uint32 SDL_TARGETING_AVX2
+SDL_MixAudio_S16_AVX2(Sint16 * dst, const Sint16 * src, const Uint32 num_samples, const int volume)
+{
+    const __m256i vol = _mm256_set1_epi16((Sint16) volume);
+    const __m256i round = _mm256_set1_epi32(SDL_MIX_MAXVOLUME - 1);
+    const Uint32 total = num_samples & ~15;
+    Uint32 i;
+
+    for (i = 0; i < total; i += 16) {
+        const __m256i s = _mm256_loadu_si256((const __m256i *) &src[i]);
+        const __m256i d = _mm256_loadu_si256((const __m256i *) &dst[i]);
+        const __m256i prodlo = _mm256_mullo_epi16(s, vol);
+        const __m256i prodhi = _mm256_mulhi_epi16(s, vol);
+        /* unpack and pack both work within 128-bit lanes, so they undo each other's ordering. */
+        __m256i lo = _mm256_unpacklo_epi16(prodlo, prodhi);
+        __m256i hi = _mm256_unpackhi_epi16(prodlo, prodhi);
+        lo = _mm256_srai_epi32(_mm256_add_epi32(lo, _mm256_and_si256(_mm256_srai_epi32(lo, 31), round)), 7);
+        hi = _mm256_srai_epi32(_mm256_add_epi32(hi, _mm256_and_si256(_mm256_srai_epi32(hi, 31), round)), 7);
+        _mm256_storeu_si256((__m256i *) &dst[i], _mm256_adds_epi16(_mm256_packs_epi32(lo, hi), d));
+    }
+    return total;
+}
+
+static Uint32 SDL_TARGETING_AVX2
+SDL_MixAudio_S32_AVX2(Sint32 * dst, const Sint32 * src, const Uint32 num_samples, const int volume)
+{
+    const __m256d vol = _mm256_set1_pd(((double) volume) / ((double) SDL_MIX_MAXVOLUME));
+    const __m256d max_audioval = _mm256_set1_pd(2147483647.0);
+    const __m256d min_audioval = _mm256_set1_pd(-2147483648.0);
+    const Uint32 total = num_samples & ~7;
+    Uint32 i;
+
+    for (i = 0; i < total; i += 8) {
+        const __m128i slo = _mm_loadu_si128((const __m128i *) &src[i]);
+        const __m128i shi = _mm_loadu_si128((const __m128i *) &src[i + 4]);
+        const __m128i dlo = _mm_loadu_si128((const __m128i *) &dst[i]);
+        const __m128i dhi = _mm_loadu_si128((const __m128i *) &dst[i + 4]);
+        __m256d lo = _mm256_cvtepi32_pd(_mm256_cvttpd_epi32(_mm256_mul_pd(_mm256_cvtepi32_pd(slo), vol)));
+        __m256d hi = _mm256_cvtepi32_pd(_mm256_cvttpd_epi32(_mm256_mul_pd(_mm256_cvtepi32_pd(shi), vol)));
+        lo = _mm256_add_pd(lo, _mm256_cvtepi32_pd(dlo));
+        hi = _mm256_add_pd(hi, _mm256_cvtepi32_pd(dhi));
+        lo = _mm256_max_pd(_mm256_min_pd(lo, max_audioval), min_audioval);
+        hi = _mm256_max_pd(_mm256_min_pd(hi, max_audioval), min_audioval);
+        _mm_storeu_si128((__m128i *) &dst[i], _mm256_cvttpd_epi32(lo));
+        _mm_storeu_si128((__m128i *) &dst[i + 4], _mm256_cvttpd_epi32(hi));
+    }
+    return total;
+}
+
+static Uint32 SDL_TARGETING_AVX2
+SDL_MixAudio_F32_AVX2(float * dst, const float * src, const Uint32 num_samples, const int volume)
+{
+    const __m256 fvolume = _mm256_set1_ps((float) volume);
+    const __m256 fmaxvolume = _mm256_set1_ps(1.0f / ((float) SDL_MIX_MAXVOLUME));
+    const __m256 max_audioval = _mm256_set1_ps(3.402823466e+38F);
+    const __m256 min_audioval = _mm256_set1_ps(-3.402823466e+38F);
+    const Uint32 total = num_samples & ~7;
+    Uint32 i;
+
+    for (i = 0; i < total; i += 8) {
+        const __m256 s = _mm256_loadu_ps(&src[i]);
+        const __m256 d = _mm256_loadu_ps(&dst[i]);
+        /* separate multiplies and add (no FMA), to round exactly like the scalar code. */
+        const __m256 sum = _mm256_add_ps(_mm256_mul_ps(_mm256_mul_ps(s, fvolume), fmaxvolume), d);
+        _mm256_storeu_ps(&dst[i], _mm256_max_ps(min_audioval, _mm256_min_ps(max_audioval, sum)));
+    }
+    return total;
+}
+#endif
+
+#if HAVE_NEON_INTRINSICS
+static Uint32
+SDL_MixAudio_S16_NEON(Sint16 * dst, const Sint16 * src, const Uint32 num_samples, const int volume)
+{
+    const int16x4_t vol = vdup_n_s16((Sint16) volume);
+    const int32x4_t round = vdupq_n_s32(SDL_MIX_MAXVOLUME - 1);
+    const Uint32 total = num_samples & ~7;
+    Uint32 i;
+
+    for (i = 0; i < total; i += 8) {
+        const int16x8_t s = vld1q_s16(&src[i]);
+        const int16x8_t d = vld1q_s16(&dst[i]);
+        int32x4_t lo = vmull_s16(vget_low_s16(s), vol);
+        int32x4_t hi = vmull_s16(vget_high_s16(s), vol);
+        /* bias negative values so the arithmetic shift rounds toward zero. */
+        lo = vaddq_s32(lo, vandq_s32(vshrq_n_s32(lo, 31), round));
+        hi = vaddq_s32(hi, vandq_s32(vshrq_n_s32(hi, 31), round));
+        vst1q_s16(&dst[i], vqaddq_s16(vcombine_s16(vshrn_n_s32(lo, 7), vshrn_n_s32(hi, 7)), d));
+    }
+    return total;
+}
+
+static Uint32
+SDL_MixAudio_S32_NEON(Sint32 * dst, const Sint32 * src, const Uint32 num_samples, const int volume)
+{
+    const int32x2_t vol = vdup_n_s32(volume);
+    const int64x2_t round = vdupq_n_s64(SDL_MIX_MAXVOLUME - 1);
+    const Uint32 total = num_samples & ~3;
+    Uint32 i;
+
+    for (i = 0; i < total; i += 4) {
+        const int32x4_t s = vld1q_s32(&src[i]);
+        const int32x4_t d = vld1q_s32(&dst[i]);
+        int64x2_t lo = vmull_s32(vget_low_s32(s), vol);
+        int64x2_t hi = vmull_s32(vget_high_s32(s), vol);
+        lo = vshrq_n_s64(vaddq_s64(lo, vandq_s64(vshrq_n_s64(lo, 63), round)), 7);
+        hi = vshrq_n_s64(vaddq_s64(hi, vandq_s64(vshrq_n_s64(hi, 63), round)), 7);
+        vst1q_s32(&dst[i], vqaddq_s32(vcombine_s32(vmovn_s64(lo), vmovn_s64(hi)), d));
+    }
+    return total;
+}
+
+static Uint32
+SDL_MixAudio_F32_NEON(float * dst, const float * src, const Uint32 num_samples, const int volume)
+{
+    const float32x4_t max_audioval = vdupq_n_f32(3.402823466e+38F);
+    const float32x4_t min_audioval = vdupq_n_f32(-3.402823466e+38F);
+    const float fvolume = (float) volume;
+    const float fmaxvolume = 1.0f / ((float) SDL_MIX_MAXVOLUME);
+    const Uint32 total = num_samples & ~3;
+    Uint32 i;
+
+    for (i = 0; i < total; i += 4) {
+        const float32x4_t s = vld1q_f32(&src[i]);
+        const float32x4_t d = vld1q_f32(&dst[i]);
+        const float32x4_t sum = vaddq_f32(vmulq_n_f32(vmulq_n_f32(s, fvolume), fmaxvolume), d);
+        vst1q_f32(&dst[i], vmaxq_f32(vminq_f32(sum, max_audioval), min_audioval));
+    }
+    return total;
+}
+#endif
+
+/* These pick the best mixer for this CPU at runtime, or return 0 to leave
+   the whole buffer to the scalar code. */
+static Uint32
+SDL_MixAudio_S16_SIMD(Sint16 * dst, const Sint16 * src, const Uint32 num_samples, const int volume)
+{
+    if (volume > SDL_MIX_MAXVOLUME) {
+        return 0;
+    }
+#if HAVE_AVX2_INTRINSICS
+    if (SDL_HasAVX2()) {
+        return SDL_MixAudio_S16_AVX2(dst, src, num_samples, volume);
+    }
+#endif
+#if HAVE_SSE2_INTRINSICS
+    if (SDL_HasSSE2()) {
+        return SDL_MixAudio_S16_SSE2(dst, src, num_samples, volume);
+    }
+#endif
+#if HAVE_NEON_INTRINSICS
+    if (SDL_HasNEON()) {
+        return SDL_MixAudio_S16_NEON(dst, src, num_samples, volume);
+    }
+#endif
+    return 0;
+}
+
+static Uint32
+SDL_MixAudio_S32_SIMD(Sint32 * dst, const Sint32 * src, const Uint32 num_samples, const int volume)
+{
+    if (volume > SDL_MIX_MAXVOLUME) {
+        return 0;
+    }
+#if HAVE_AVX2_INTRINSICS
+    if (SDL_HasAVX2()) {
+        return SDL_MixAudio_S32_AVX2(dst, src, num_samples, volume);
+    }
+#endif
+#if HAVE_SSE2_INTRINSICS
+    if (SDL_HasSSE2()) {
+        return SDL_MixAudio_S32_SSE2(dst, src, num_samples, volume);
+    }
+#endif
+#if HAVE_NEON_INTRINSICS
+    if (SDL_HasNEON()) {
+        return SDL_MixAudio_S32_NEON(dst, src, num_samples, volume);
+    }
+#endif
+    return 0;
+}
+
+static Uint32
+SDL_MixAudio_F32_SIMD(float * dst, const float * src, const Uint32 num_samples, const int volume)
+{
+#if HAVE_AVX2_INTRINSICS
+    if (SDL_HasAVX2()) {
+        return SDL_MixAudio_F32_AVX2(dst, src, num_samples, volume);
+    }
+#endif
+#if HAVE_SSE2_INTRINSICS
+    if (SDL_HasSSE2()) {
+        return SDL_MixAudio_F32_SSE2(dst, src, num_samples, volume);
+    }
+#endif
+#if HAVE_NEON_INTRINSICS
+    if (SDL_HasNEON()) {
+        return SDL_MixAudio_F32_NEON(dst, src, num_samples, volume);
+    }
+#endif
+    return 0;
+}
+
 
 void
 SDL_MixAudioFormat(Uint8 * dst, const Uint8 * src, SDL_AudioFormat format,
@@ -151,6 +470,14 @@ SDL_MixAudioFormat(Uint8 * dst, const Uint8 * src, SDL_AudioFormat format,
             const int min_audioval = -(1 << (16 - 1));
 
             len /= 2;
+#if SDL_BYTEORDER == SDL_LIL_ENDIAN
+            {
+                const Uint32 mixed = SDL_MixAudio_S16_SIMD((Sint16 *) dst, (const Sint16 *) src, len, volume);
+                src += mixed * 2;
+                dst += mixed * 2;
+                len -= mixed;
+            }
+#endif
             while (len--) {
                 src1 = ((src[1]) << 8 | src[0]);
                 ADJUST_VOLUME(src1, volume);
@@ -182,6 +509,14 @@ SDL_MixAudioFormat(Uint8 * dst, const Uint8 * src, SDL_AudioFormat format,
             const int min_audioval = -(1 << (16 - 1));
 
             len /= 2;
+#if SDL_BYTEORDER == SDL_BIG_ENDIAN
+            {
+                const Uint32 mixed = SDL_MixAudio_S16_SIMD((Sint16 *) dst, (const Sint16 *) src, len, volume);
+                src += mixed * 2;
+                dst += mixed * 2;
+                len -= mixed;
+            }
+#endif
             while (len--) {
                 src1 = ((src[0]) << 8 | src[1]);
                 ADJUST_VOLUME(src1, volume);
@@ -260,6 +595,14 @@ SDL_MixAudioFormat(Uint8 * dst, const Uint8 * src, SDL_AudioFormat format,
             const Sint64 min_audioval = -(((Sint64) 1) << (32 - 1));
 
             len /= 4;
+#if SDL_BYTEORDER == SDL_LIL_ENDIAN
+            {
+                const Uint32 mixed = SDL_MixAudio_S32_SIMD((Sint32 *) dst32, (const Sint32 *) src32, len, volume);
+                src32 += mixed;
+                dst32 += mixed;
+                len -= mixed;
+            }
+#endif
             while (len--) {
                 src1 = (Sint64) ((Sint32) SDL_SwapLE32(*src32));
                 src32++;
@@ -286,6 +629,14 @@ SDL_MixAudioFormat(Uint8 * dst, const Uint8 * src, SDL_AudioFormat format,
             const Sint64 min_audioval = -(((Sint64) 1) << (32 - 1));
 
             len /= 4;
+#if SDL_BYTEORDER == SDL_BIG_ENDIAN
+            {
+                const Uint32 mixed = SDL_MixAudio_S32_SIMD((Sint32 *) dst32, (const Sint32 *) src32, len, volume);
+                src32 += mixed;
+                dst32 += mixed;
+                len -= mixed;
+            }
+#endif
             while (len--) {
                 src1 = (Sint64) ((Sint32) SDL_SwapBE32(*src32));
                 src32++;
@@ -315,6 +666,14 @@ SDL_MixAudioFormat(Uint8 * dst, const Uint8 * src, SDL_AudioFormat format,
             const double min_audioval = -3.402823466e+38F;
 
             len /= 4;
+#if SDL_BYTEORDER == SDL_LIL_ENDIAN
+            {
+                const Uint32 mixed = SDL_MixAudio_F32_SIMD((float *) dst32, (const float *) src32, len, volume);
+                src32 += mixed;
+                dst32 += mixed;
+                len -= mixed;
+            }
+#endif
             while (len--) {
                 src1 = ((SDL_SwapFloatLE(*src32) * fvolume) * fmaxvolume);
                 src2 = SDL_SwapFloatLE(*dst32);
@@ -344,6 +703,14 @@ SDL_MixAudioFormat(Uint8 * dst, const Uint8 * src, SDL_AudioFormat format,
             const double min_audioval = -3.402823466e+38F;
 
             len /= 4;
+#if SDL_BYTEORDER == SDL_BIG_ENDIAN
+            {
+                const Uint32 mixed = SDL_MixAudio_F32_SIMD((float *) dst32, (const float *) src32, len, volume);
+                src32 += mixed;
+                dst32 += mixed;
+                len -= mixed;
+            }
+#endif
             while (len--) {
                 src1 = ((SDL_SwapFloatBE(*src32) * fvolume) * fmaxvolume);
                 src2 = SDL_SwapFloatBE(*dst32);
@@ -366,4 +733,678 @@ SDL_MixAudioFormat(Uint8 * dst, const Uint8 * src, SDL_AudioFormat format,
     }
 }
 
+
+/* SDL_AudioMixer: each voice keeps its data queued in an SDL_AudioStream,
+ * in the voice's own rate. Native-endian S16 and F32 data is queued as-is,
+ * anything else is type-converted to F32 by the stream when it's put.
+ *
+ * The mixer then works on blocks of MIXER_BLOCK_FRAMES output frames: for
+ * each voice it pulls just the source frames that block needs into a small
+ * window, and one kernel converts, resamples (linear interpolation), applies
+ * gain/pan and accumulates into a float mix bus. The bus is then clamped and
+ * converted to the output format. Both the bus and the window are sized to
+ * stay in L1 cache, and are shared by all voices.
+ *
+ * Resampling positions are 32.32 fixed point, relative to the first of the
+ * two source frames each voice keeps from its previous pass; an output frame
+ * at position p interpolates between window frames (p >> 32) and
+ * (p >> 32) + 1. This way a pass never has to look at a source frame it
+ * doesn't also consume.
+ */
+
+#define MIXER_BLOCK_FRAMES 256
+#define MIXER_WINDOW_FRAMES 1024
+#define MIXER_MAX_CHANNELS 8
+#define MIXER_FRAC_ONE (((Uint64) 1) << 32)
+
+typedef void (*SDL_MixVoiceFunc)(const SDL_AudioVoice *voice, const void *window,
+                                 float *bus, const int stride, const int frames, Uint64 pos);
+
+struct SDL_AudioMixer
+{
+    float bus[MIXER_BLOCK_FRAMES * MIXER_MAX_CHANNELS];
+    float window[(MIXER_WINDOW_FRAMES + 2) * 2];
+    SDL_mutex *lock;
+    SDL_AudioFormat format;
+    int channels;
+    int freq;
+    int framelen;
+    SDL_AudioCVT cvt;  /* mix bus to output format. */
+    SDL_AudioVoice *voices;
+};
+
+struct SDL_AudioVoice
+{
+    SDL_AudioMixer *mixer;
+    SDL_AudioStream *stream;
+    SDL_AudioFormat format;  /* what comes out of the stream: AUDIO_S16SYS or AUDIO_F32SYS. */
+    int channels;
+    int framelen;
+    Uint64 step;  /* source frames per output frame. */
+    Uint64 position;
+    union
+    {
+        Sint16 si16[4];
+        float f[4];
+    } history;  /* the last two source frames of the previous pass. */
+    float gain;
+    float pan;
+    float channel_gain[2];  /* gain and pan for each source channel, scaled for the source type. */
+    SDL_MixVoiceFunc mix_func;
+    SDL_AudioVoice *prev;
+    SDL_AudioVoice *next;
+};
+
+#define DIVBY32767 3.05185094759972e-05f
+#define DIVBY4294967296 2.3283064365386963e-10f
+
+/* Scalar kernels, for any rate: _c1/_c2 is the voice's channel count, and
+   _to1/_to2 is mono output or two-plus channel output (only the first two
+   output channels get anything). */
+#define MIXVOICE_FUNCS(typ, ctype) \
+    static void \
+    SDL_MixVoice_##typ##_c1_to1(const SDL_AudioVoice *voice, const void *_window, \
+                                float *bus, const int stride, const int frames, Uint64 pos) \
+    { \
+        const ctype *window = (const ctype *) _window; \
+        const Uint64 step = voice->step; \
+        const float gain = voice->channel_gain[0]; \
+        int i; \
+        for (i = 0; i < frames; i++, pos += step, bus += stride) { \
+            const int idx = (int) (pos >> 32); \
+            const float t = ((float) (Uint32) pos) * DIVBY4294967296; \
+            const float a = (float) window[idx]; \
+            const float b = (float) window[idx + 1]; \
+            bus[0] += (a + ((b - a) * t)) * gain; \
+        } \
+    } \
+    static void \
+    SDL_MixVoice_##typ##_c1_to2(const SDL_AudioVoice *voice, const void *_window, \
+                                float *bus, const int stride, const int frames, Uint64 pos) \
+    { \
+        const ctype *window = (const ctype *) _window; \
+        const Uint64 step = voice->step; \
+        const float left = voice->channel_gain[0]; \
+        const float right = voice->channel_gain[1]; \
+        int i; \
+        for (i = 0; i < frames; i++, pos += step, bus += stride) { \
+            const int idx = (int) (pos >> 32); \
+            const float t = ((float) (Uint32) pos) * DIVBY4294967296; \
+            const float a = (float) window[idx]; \
+            const float b = (float) window[idx + 1]; \
+            const float val = a + ((b - a) * t); \
+            bus[0] += val * left; \
+            bus[1] += val * right; \
+        } \
+    } \
+    static void \
+    SDL_MixVoice_##typ##_c2_to1(const SDL_AudioVoice *voice, const void *_window, \
+                                float *bus, const int stride, const int frames, Uint64 pos) \
+    { \
+        const ctype *window = (const ctype *) _window; \
+        const Uint64 step = voice->step; \
+        const float left = voice->channel_gain[0]; \
+        const float right = voice->channel_gain[1]; \
+        int i; \
+        for (i = 0; i < frames; i++, pos += step, bus += stride) { \
+            const int idx = ((int) (pos >> 32)) * 2; \
+            const float t = ((float) (Uint32) pos) * DIVBY4294967296; \
+            const float a1 = (float) window[idx]; \
+            const float a2 = (float) window[idx + 1]; \
+            const float b1 = (float) window[idx + 2]; \
+            const float b2 = (float) window[idx + 3]; \
+            bus[0] += ((a1 + ((b1 - a1) * t)) * left) + ((a2 + ((b2 - a2) * t)) * right); \
+        } \
+    } \
+    static void \
+    SDL_MixVoice_##typ##_c2_to2(const SDL_AudioVoice *voice, const void *_window, \
+                                float *bus, const int stride, const int frames, Uint64 pos) \
+    { \
+        const ctype *window = (const ctype *) _window; \
+        const Uint64 step = voice->step; \
+        const float left = voice->channel_gain[0]; \
+        const float right = voice->channel_gain[1]; \
+        int i; \
+        for (i = 0; i < frames; i++, pos += step, bus += stride) { \
+            const int idx = ((int) (pos >> 32)) * 2; \
+            const float t = ((float) (Uint32) pos) * DIVBY4294967296; \
+            const float a1 = (float) window[idx]; \
+            const float a2 = (float) window[idx + 1]; \
+            const float b1 = (float) window[idx + 2]; \
+            const float b2 = (float) window[idx + 3]; \
+            bus[0] += (a1 + ((b1 - a1) * t)) * left; \
+            bus[1] += (a2 + ((b2 - a2) * t)) * right; \
+        } \
+    }
+
+MIXVOICE_FUNCS(S16, Sint16)
+MIXVOICE_FUNCS(F32, float)
+#undef MIXVOICE_FUNCS
+
+/* When the voice doesn't need resampling, (pos) is always zero and output
+   frame i is just window frame i, so these can work a vector at a time.
+   They're only used for stereo output. */
+#if HAVE_SSE2_INTRINSICS
+static void
+SDL_MixVoice_S16_c1_to2_SSE2(const SDL_AudioVoice *voice, const void *_window,
+                             float *bus, const int stride, const int frames, Uint64 pos)
+{
+    const Sint16 *window = (const Sint16 *) _window;
+    const __m128 gain = _mm_setr_ps(voice->channel_gain[0], voice->channel_gain[1], voice->channel_gain[0], voice->channel_gain[1]);
+    int i;
+
+    SDL_assert(stride == 2);
+    for (i = 0; i < (frames & ~7); i += 8) {
+        const __m128i x = _mm_loadu_si128((const __m128i *) &window[i]);
+        const __m128 lo = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16));
+        const __m128 hi = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(x, x), 16));
+        float *dst = &bus[i * 2];
+        _mm_storeu_ps(dst, _mm_add_ps(_mm_loadu_ps(dst), _mm_mul_ps(_mm_unpacklo_ps(lo, lo), gain)));
+        _mm_storeu_ps(dst + 4, _mm_add_ps(_mm_loadu_ps(dst + 4), _mm_mul_ps(_mm_unpackhi_ps(lo, lo), gain)));
+        _mm_storeu_ps(dst + 8, _mm_add_ps(_mm_loadu_ps(dst + 8), _mm_mul_ps(_mm_unpacklo_ps(hi, hi), gain)));
+        _mm_storeu_ps(dst + 12, _mm_add_ps(_mm_loadu_ps(dst + 12), _mm_mul_ps(_mm_unpackhi_ps(hi, hi), gain)));
+    }
+    SDL_MixVoice_S16_c1_to2(voice, window + i, bus + (i * 2), stride, frames - i, pos);
+}
+
+static void
+SDL_MixVoice_S16_c2_to2_SSE2(const SDL_AudioVoice *voice, const void *_window,
+                             float *bus, const int stride, const int frames, Uint64 pos)
+{
+    const Sint16 *window = (const Sint16 *) _window;
+    const __m128 gain = _mm_setr_ps(voice->channel_gain[0], voice->channel_gain[1], voice->channel_gain[0], voice->channel_gain[1]);
+    int i;
+
+    SDL_assert(stride == 2);
+    for (i = 0; i < (frames & ~3); i += 4) {
+        const __m128i x = _mm_loadu_si128((const __m128i *) &window[i * 2]);
+        const __m128 lo = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16));
+        const __m128 hi = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(x, x), 16));
+        float *dst = &bus[i * 2];
+        _mm_storeu_ps(dst, _mm_add_ps(_mm_loadu_ps(dst), _mm_mul_ps(lo, gain)));
+        _mm_storeu_ps(dst + 4, _mm_add_ps(_mm_loadu_ps(dst + 4), _mm_mul_ps(hi, gain)));
+    }
+    SDL_MixVoice_S16_c2_to2(voice, window + (i * 2), bus + (i * 2), stride, frames - i, pos);
+}
+
+static void
+SDL_MixVoice_F32_c1_to2_SSE2(const SDL_AudioVoice *voice, const void *_window,
+                             float *bus, const int stride, const int frames, Uint64 pos)
+{
+    const float *window = (const float *) _window;
+    const __m128 gain = _mm_setr_ps(voice->channel_gain[0], voice->channel_gain[1], voice->channel_gain[0], voice->channel_gain[1]);
+    int i;
+
+    SDL_assert(stride == 2);
+    for (i = 0; i < (frames & ~3); i += 4) {
+        const __m128 x = _mm_loadu_ps(&window[i]);
+        float *dst = &bus[i * 2];
+        _mm_storeu_ps(dst, _mm_add_ps(_mm_loadu_ps(dst), _mm_mul_ps(_mm_unpacklo_ps(x, x), gain)));
+        _mm_storeu_ps(dst + 4, _mm_add_ps(_mm_loadu_ps(dst + 4), _mm_mul_ps(_mm_unpackhi_ps(x, x), gain)));
+    }
+    SDL_MixVoice_F32_c1_to2(voice, window + i, bus + (i * 2), stride, frames - i, pos);
+}
+
+static void
+SDL_MixVoice_F32_c2_to2_SSE2(const SDL_AudioVoice *voice, const void *_window,
+                             float *bus, const int stride, const int frames, Uint64 pos)
+{
+    const float *window = (const float *) _window;
+    const __m128 gain = _mm_setr_ps(voice->channel_gain[0], voice->channel_gain[1], voice->channel_gain[0], voice->channel_gain[1]);
+    int i;
+
+    SDL_assert(stride == 2);
+    for (i = 0; i < (frames & ~1); i += 2) {
+        float *dst = &bus[i * 2];
+        _mm_storeu_ps(dst, _mm_add_ps(_mm_loadu_ps(dst), _mm_mul_ps(_mm_loadu_ps(&window[i * 2]), gain)));
+    }
+    SDL_MixVoice_F32_c2_to2(voice, window + (i * 2), bus + (i * 2), stride, frames - i, pos);
+}
+#endif
+
+#if HAVE_NEON_INTRINSICS
+static void
+SDL_MixVoice_S16_c1_to2_NEON(const SDL_AudioVoice *voice, const void *_window,
+                             float *bus, const int stride, const int frames, Uint64 pos)
+{
+    const Sint16 *window = (const Sint16 *) _window;
+    const float gains[4] = { voice->channel_gain[0], voice->channel_gain[1], voice->channel_gain[0], voice->channel_gain[1] };
+    const float32x4_t gain = vld1q_f32(gains);
+    int i;
+
+    SDL_assert(stride == 2);
+    for (i = 0; i < (frames & ~7); i += 8) {
+        const int16x8_t x = vld1q_s16(&window[i]);
+        const float32x4x2_t lo = vzipq_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(x))), vcvtq_f32_s32(vmovl_s16(vget_low_s16(x))));
+        const float32x4x2_t hi = vzipq_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(x))), vcvtq_f32_s32(vmovl_s16(vget_high_s16(x))));
+        float *dst = &bus[i * 2];
+        vst1q_f32(dst, vmlaq_f32(vld1q_f32(dst), lo.val[0], gain));
+        vst1q_f32(dst + 4, vmlaq_f32(vld1q_f32(dst + 4), lo.val[1], gain));
+        vst1q_f32(dst + 8, vmlaq_f32(vld1q_f32(dst + 8), hi.val[0], gain));
+        vst1q_f32(dst + 12, vmlaq_f32(vld1q_f32(dst + 12), hi.val[1], gain));
+    }
+    SDL_MixVoice_S16_c1_to2(voice, window + i, bus + (i * 2), stride, frames - i, pos);
+}
+
+static void
+SDL_MixVoice_S16_c2_to2_NEON(const SDL_AudioVoice *voice, const void *_window,
+                             float *bus, const int stride, const int frames, Uint64 pos)
+{
+    const Sint16 *window = (const Sint16 *) _window;
+    const float gains[4] = { voice->channel_gain[0], voice->channel_gain[1], voice->channel_gain[0], voice->channel_gain[1] };
+    const float32x4_t gain = vld1q_f32(gains);
+    int i;
+
+    SDL_assert(stride == 2);
+    for (i = 0; i < (frames & ~3); i += 4) {
+        const int16x8_t x = vld1q_s16(&window[i * 2]);
+        float *dst = &bus[i * 2];
+        vst1q_f32(dst, vmlaq_f32(vld1q_f32(dst), vcvtq_f32_s32(vmovl_s16(vget_low_s16(x))), gain));
+        vst1q_f32(dst + 4, vmlaq_f32(vld1q_f32(dst + 4), vcvtq_f32_s32(vmovl_s16(vget_high_s16(x))), gain));
+    }
+    SDL_MixVoice_S16_c2_to2(voice, window + (i * 2), bus + (i * 2), stride, frames - i, pos);
+}
+
+static void
+SDL_MixVoice_F32_c1_to2_NEON(const SDL_AudioVoice *voice, const void *_window,
+                             float *bus, const int stride, const int frames, Uint64 pos)
+{
+    const float *window = (const float *) _window;
+    const float gains[4] = { voice->channel_gain[0], voice->channel_gain[1], voice->channel_gain[0], voice->channel_gain[1] };
+    const float32x4_t gain = vld1q_f32(gains);
+    int i;
+
+    SDL_assert(stride == 2);
+    for (i = 0; i < (frames & ~3); i += 4) {
+        const float32x4_t x = vld1q_f32(&window[i]);
+        const float32x4x2_t dup = vzipq_f32(x, x);
+        float *dst = &bus[i * 2];
+        vst1q_f32(dst, vmlaq_f32(vld1q_f32(dst), dup.val[0], gain));
+        vst1q_f32(dst + 4, vmlaq_f32(vld1q_f32(dst + 4), dup.val[1], gain));
+    }
+    SDL_MixVoice_F32_c1_to2(voice, window + i, bus + (i * 2), stride, frames - i, pos);
+}
+
+static void
+SDL_MixVoice_F32_c2_to2_NEON(const SDL_AudioVoice *voice, const void *_window,
+                             float *bus, const int stride, const int frames, Uint64 pos)
+{
+    const float *window = (const float *) _window;
+    const float gains[4] = { voice->channel_gain[0], voice->channel_gain[1], voice->channel_gain[0], voice->channel_gain[1] };
+    const float32x4_t gain = vld1q_f32(gains);
+    int i;
+
+    SDL_assert(stride == 2);
+    for (i = 0; i < (frames & ~1); i += 2) {
+        float *dst = &bus[i * 2];
+        vst1q_f32(dst, vmlaq_f32(vld1q_f32(dst), vld1q_f32(&window[i * 2]), gain));
+    }
+    SDL_MixVoice_F32_c2_to2(voice, window + (i * 2), bus + (i * 2), stride, frames - i, pos);
+}
+#endif
+
+static void
+SDL_ChooseVoiceMixer(SDL_AudioVoice *voice)
+{
+    const SDL_bool is_s16 = (voice->format == AUDIO_S16SYS);
+    const SDL_bool stereo_out = (voice->mixer->channels >= 2);
+
+#if HAVE_SSE2_INTRINSICS || HAVE_NEON_INTRINSICS
+    if ((voice->step == MIXER_FRAC_ONE) && (voice->mixer->channels == 2)) {
+#if HAVE_SSE2_INTRINSICS
+        if (SDL_HasSSE2()) {
+            if (voice->channels == 1) {
+                voice->mix_func = is_s16 ? SDL_MixVoice_S16_c1_to2_SSE2 : SDL_MixVoice_F32_c1_to2_SSE2;
+            } else {
+                voice->mix_func = is_s16 ? SDL_MixVoice_S16_c2_to2_SSE2 : SDL_MixVoice_F32_c2_to2_SSE2;
+            }
+            return;
+        }
+#endif
+#if HAVE_NEON_INTRINSICS
+        if (SDL_HasNEON()) {
+            if (voice->channels == 1) {
+                voice->mix_func = is_s16 ? SDL_MixVoice_S16_c1_to2_NEON : SDL_MixVoice_F32_c1_to2_NEON;
+            } else {
+                voice->mix_func = is_s16 ? SDL_MixVoice_S16_c2_to2_NEON : SDL_MixVoice_F32_c2_to2_NEON;
+            }
+            return;
+        }
+#endif
+    }
+#endif
+
+    if (voice->channels == 1) {
+        if (is_s16) {
+            voice->mix_func = stereo_out ? SDL_MixVoice_S16_c1_to2 : SDL_MixVoice_S16_c1_to1;
+        } else {
+            voice->mix_func = stereo_out ? SDL_MixVoice_F32_c1_to2 : SDL_MixVoice_F32_c1_to1;
+        }
+    } else {
+        if (is_s16) {
+            voice->mix_func = stereo_out ? SDL_MixVoice_S16_c2_to2 : SDL_MixVoice_S16_c2_to1;
+        } else {
+            voice->mix_func = stereo_out ? SDL_MixVoice_F32_c2_to2 : SDL_MixVoice_F32_c2_to1;
+        }
+    }
+}
+
+/* call with the mixer locked. */
+static void
+SDL_UpdateVoiceGain(SDL_AudioVoice *voice)
+{
+    const float scale = (voice->format == AUDIO_S16SYS) ? DIVBY32767 : 1.0f;
+    const float left = voice->gain * ((voice->pan > 0.0f) ? (1.0f - voice->pan) : 1.0f);
+    const float right = voice->gain * ((voice->pan < 0.0f) ? (1.0f + voice->pan) : 1.0f);
+
+    if (voice->mixer->channels == 1) {  /* no panning in mono; stereo voices are averaged. */
+        voice->channel_gain[0] = voice->channel_gain[1] = voice->gain * scale * ((voice->channels == 2) ? 0.5f : 1.0f);
+    } else {
+        voice->channel_gain[0] = left * scale;
+        voice->channel_gain[1] = right * scale;
+    }
+}
+
+/* Mix up to (frames) output frames of one voice into the mix bus. call with the mixer locked. */
+static void
+SDL_MixVoice(SDL_AudioMixer *mixer, SDL_AudioVoice *voice, const int frames)
+{
+    float *bus = mixer->bus;
+    int done = 0;
+
+    while (done < frames) {
+        const Uint64 pos = voice->position;
+        const int available = SDL_AudioStreamAvailable(voice->stream) / voice->framelen;
+        const Uint64 limit = (Uint64) SDL_min(available, MIXER_WINDOW_FRAMES);
+        Uint64 total = ((((limit + 1) << 32) - 1) - pos) / voice->step;
+        Uint8 *window = (Uint8 *) mixer->window;
+        int consumed;
+
+        if (total == 0) {
+            break;  /* out of data, the rest is silence. */
+        } else if (total > (Uint64) (frames - done)) {
+            total = (Uint64) (frames - done);
+        }
+
+        consumed = (int) ((pos + (total * voice->step)) >> 32);
+        SDL_assert(consumed <= available);
+
+        SDL_memcpy(window, &voice->history, voice->framelen * 2);
+        if (consumed > 0) {
+            SDL_AudioStreamGet(voice->stream, window + (voice->framelen * 2), consumed * voice->framelen);
+        }
+
+        voice->mix_func(voice, window, bus + (done * mixer->channels), mixer->channels, (int) total, pos);
+
+        SDL_memcpy(&voice->history, window + (consumed * voice->framelen), voice->framelen * 2);
+        voice->position = (pos + (total * voice->step)) & (MIXER_FRAC_ONE - 1);
+        done += (int) total;
+    }
+}
+
+SDL_AudioMixer *
+SDL_NewAudioMixer(SDL_AudioFormat format, Uint8 channels, int freq)
+{
+    SDL_AudioMixer *mixer;
+
+    if ((channels < 1) || (channels > MIXER_MAX_CHANNELS)) {
+        SDL_SetError("Unsupported number of audio channels.");
+        return NULL;
+    } else if (freq <= 0) {
+        SDL_InvalidParamError("freq");
+        return NULL;
+    }
+
+    mixer = (SDL_AudioMixer *) SDL_calloc(1, sizeof (SDL_AudioMixer));
+    if (!mixer) {
+        SDL_OutOfMemory();
+        return NULL;
+    }
+
+    if (SDL_BuildAudioCVT(&mixer->cvt, AUDIO_F32SYS, channels, freq, format, channels, freq) < 0) {
+        SDL_free(mixer);
+        return NULL;  /* SDL_BuildAudioCVT should have called SDL_SetError. */
+    }
+
+    mixer->lock = SDL_CreateMutex();
+    if (!mixer->lock) {
+        SDL_free(mixer);
+        return NULL;
+    }
+
+    mixer->format = format;
+    mixer->channels = channels;
+    mixer->freq = freq;
+    mixer->framelen = (SDL_AUDIO_BITSIZE(format) / 8) * channels;
+    return mixer;
+}
+
+SDL_AudioVoice *
+SDL_AudioMixerAddVoice(SDL_AudioMixer *mixer, SDL_AudioFormat format, Uint8 channels, int freq)
+{
+    SDL_AudioVoice *voice;
+    SDL_AudioFormat queued_format = AUDIO_F32SYS;
+
+    if (!mixer) {
+        SDL_InvalidParamError("mixer");
+        return NULL;
+    } else if ((channels != 1) && (channels != 2)) {
+        SDL_SetError("Only mono and stereo voices are supported");
+        return NULL;
+    } else if (freq <= 0) {
+        SDL_InvalidParamError("freq");
+        return NULL;
+    }
+
+    voice = (SDL_AudioVoice *) SDL_calloc(1, sizeof (SDL_AudioVoice));
+    if (!voice) {
+        SDL_OutOfMemory();
+        return NULL;
+    }
+
+    /* the kernels read native S16 directly; everything else becomes float. */
+    if (format == AUDIO_S16SYS) {
+        queued_format = AUDIO_S16SYS;
+    }
+
+    voice->stream = SDL_NewAudioStream(format, channels, freq, queued_format, channels, freq);
+    if (!voice->stream) {
+        SDL_free(voice);
+        return NULL;  /* SDL_NewAudioStream should have called SDL_SetError. */
+    }
+
+    voice->mixer = mixer;
+    voice->format = queued_format;
+    voice->channels = channels;
+    voice->framelen = (SDL_AUDIO_BITSIZE(queued_format) / 8) * channels;
+    voice->step = (((Uint64) freq) << 32) / ((Uint64) mixer->freq);
+    voice->gain = 1.0f;
+    voice->pan = 0.0f;
+
+    if (voice->step == 0) {
+        SDL_FreeAudioStream(voice->stream);
+        SDL_free(voice);
+        SDL_SetError("Voice sample rate is too low");
+        return NULL;
+    } else if (voice->step > (((Uint64) MIXER_WINDOW_FRAMES) << 32)) {
+        SDL_FreeAudioStream(voice->stream);
+        SDL_free(voice);
+        SDL_SetError("Voice sample rate is too high");
+        return NULL;
+    }
+
+    SDL_LockMutex(mixer->lock);
+    SDL_UpdateVoiceGain(voice);
+    SDL_ChooseVoiceMixer(voice);
+    voice->next = mixer->voices;
+    if (mixer->voices) {
+        mixer->voices->prev = voice;
+    }
+    mixer->voices = voice;
+    SDL_UnlockMutex(mixer->lock);
+
+    return voice;
+}
+
+void
+SDL_AudioMixerRemoveVoice(SDL_AudioVoice *voice)
+{
+    SDL_AudioMixer *mixer;
+
+    if (!voice) {
+        SDL_InvalidParamError("voice");
+        return;
+    }
+
+    mixer = voice->mixer;
+    SDL_LockMutex(mixer->lock);
+    if (voice->prev) {
+        voice->prev->next = voice->next;
+    } else {
+        mixer->voices = voice->next;
+    }
+    if (voice->next) {
+        voice->next->prev = voice->prev;
+    }
+    SDL_UnlockMutex(mixer->lock);
+
+    SDL_FreeAudioStream(voice->stream);
+    SDL_free(voice);
+}
+
+int
+SDL_AudioVoicePut(SDL_AudioVoice *voice, const void *buf, Uint32 len)
+{
+    int retval;
+
+    if (!voice) {
+        return SDL_InvalidParamError("voice");
+    }
+
+    SDL_LockMutex(voice->mixer->lock);
+    retval = SDL_AudioStreamPut(voice->stream, buf, len);
+    SDL_UnlockMutex(voice->mixer->lock);
+    return retval;
+}
+
+int
+SDL_AudioVoiceQueued(SDL_AudioVoice *voice)
+{
+    int retval;
+
+    if (!voice) {
+        return 0;
+    }
+
+    SDL_LockMutex(voice->mixer->lock);
+    retval = SDL_AudioStreamAvailable(voice->stream);
+    SDL_UnlockMutex(voice->mixer->lock);
+    return retval;
+}
+
+void
+SDL_AudioVoiceClear(SDL_AudioVoice *voice)
+{
+    if (!voice) {
+        SDL_InvalidParamError("voice");
+        return;
+    }
+
+    SDL_LockMutex(voice->mixer->lock);
+    SDL_AudioStreamClear(voice->stream);
+    SDL_zero(voice->history);
+    voice->position = 0;
+    SDL_UnlockMutex(voice->mixer->lock);
+}
+
+int
+SDL_SetAudioVoiceGain(SDL_AudioVoice *voice, float gain, float pan)
+{
+    if (!voice) {
+        return SDL_InvalidParamError("voice");
+    } else if (gain < 0.0f) {
+        return SDL_InvalidParamError("gain");
+    }
+
+    SDL_LockMutex(voice->mixer->lock);
+    voice->gain = gain;
+    voice->pan = SDL_max(-1.0f, SDL_min(1.0f, pan));
+    SDL_UpdateVoiceGain(voice);
+    SDL_UnlockMutex(voice->mixer->lock);
+    return 0;
+}
+
+int
+SDL_AudioMixerMix(SDL_AudioMixer *mixer, void *buf, Uint32 len)
+{
+    Uint8 *dst = (Uint8 *) buf;
+    int frames;
+
+    if (!mixer) {
+        return SDL_InvalidParamError("mixer");
+    } else if (!buf) {
+        return SDL_InvalidParamError("buf");
+    } else if ((len % mixer->framelen) != 0) {
+        return SDL_SetError("Can't mix partial sample frames");
+    }
+
+    frames = (int) (len / mixer->framelen);
+
+    SDL_LockMutex(mixer->lock);
+    while (frames > 0) {
+        const int total = SDL_min(frames, MIXER_BLOCK_FRAMES);
+        const int samples = total * mixer->channels;
+        SDL_AudioVoice *voice;
+        int i;
+
+        SDL_memset(mixer->bus, '\0', samples * sizeof (float));
+        for (voice = mixer->voices; voice != NULL; voice = voice->next) {
+            SDL_MixVoice(mixer, voice, total);
+        }
+
+        if (!SDL_AUDIO_ISFLOAT(mixer->format)) {  /* the integer converters don't clamp. */
+            float *bus = mixer->bus;
+            for (i = 0; i < samples; i++) {
+                if (bus[i] > 1.0f) {
+                    bus[i] = 1.0f;
+                } else if (bus[i] < -1.0f) {
+                    bus[i] = -1.0f;
+                }
+            }
+        }
+
+        if (mixer->cvt.needed) {
+            mixer->cvt.buf = (Uint8 *) mixer->bus;
+            mixer->cvt.len = samples * sizeof (float);
+            if (SDL_ConvertAudio(&mixer->cvt) < 0) {
+                SDL_UnlockMutex(mixer->lock);
+                return -1;
+            }
+        }
+
+        SDL_memcpy(dst, mixer->bus, total * mixer->framelen);
+        dst += total * mixer->framelen;
+        frames -= total;
+    }
+    SDL_UnlockMutex(mixer->lock);
+
+    return 0;
+}
+
+void
+SDL_FreeAudioMixer(SDL_AudioMixer *mixer)
+{
+    if (mixer) {
+        SDL_AudioVoice *voice = mixer->voices;
+        while (voice) {
+            SDL_AudioVoice *next = voice->next;
+            SDL_FreeAudioStream(voice->stream);
+            SDL_free(voice);
+            voice = next;
+        }
+        SDL_DestroyMutex(mixer->lock);
+        SDL_free(mixer);
+    }
+}
+
 /* vi: set ts=4 sw=4 expandtab: */
@@ -51,6 +51,28 @@ extern void SDL_RemoveAudioDevice(const int iscapture, void *handle);
    as appropriate so SDL's list of devices is accurate. */
 extern void SDL_OpenedAudioDeviceDisconnected(SDL_AudioDevice *device);
 
+/* Audio targets should call this when an opened device runs out of data to
+   play (or, for capture, drops data the app didn't read in time), so it
+   shows up in SDL_GetAudioDeviceStats(). Safe to call from any thread. */
+extern void SDL_AudioDeviceUnderrun(SDL_AudioDevice *device);
+
+/* Targets without real hardware (dummy, disk) use this to consume or
+   produce audio at the rate a real device would, and to simulate a loaded
+   system as SDL_HINT_AUDIO_SIMULATED_LOAD asks. Call SDL_InitAudioClock()
+   when opening the device and SDL_WaitAudioClock() once per buffer; it
+   sleeps as needed and reports underruns when the simulated device runs
+   dry. */
+typedef struct SDL_AudioClock
+{
+    Uint64 deadline;    /* performance counter value at which the device runs out of data */
+    Uint32 stall_ms;    /* maximum simulated stall per buffer */
+    Uint32 seed;        /* for picking stall lengths */
+} SDL_AudioClock;
+
+extern void SDL_InitAudioClock(SDL_AudioClock *clock);
+extern void SDL_WaitAudioClock(SDL_AudioDevice *device, SDL_AudioClock *clock);
+extern int SDL_GetAudioClockLatency(SDL_AudioDevice *device, SDL_AudioClock *clock);
+
 /* This is the size of a packet when using SDL_QueueAudio(). We allocate
    these as necessary and pool them, under the assumption that we'll
    eventually end up with a handful that keep recycling, meeting whatever
@@ -71,6 +93,9 @@ typedef struct SDL_AudioDriverImpl
     void (*WaitDevice) (_THIS);
     void (*PlayDevice) (_THIS);
     int (*GetPendingBytes) (_THIS);
+    void (*GetDeviceBufferSize) (_THIS, int *period_frames, int *buffer_frames);
+    int (*GetDeviceLatency) (_THIS);  /**< microseconds until data written now is heard. */
+    int (*ResizeDevice) (_THIS, int samples);  /**< Called by the audio thread for adaptive buffer sizing */
     Uint8 *(*GetDeviceBuf) (_THIS);
     int (*CaptureFromDevice) (_THIS, void *buffer, int buflen);
     void (*FlushCapture) (_THIS);
@@ -163,6 +188,52 @@ struct SDL_AudioDevice
     /* Queued buffers (if app not using callback). */
     SDL_DataQueue *buffer_queue;
 
+    /* Timing statistics, see SDL_GetAudioDeviceStats(). The audio thread
+       updates these with mixer_lock held; drivers bump underruns. */
+    SDL_AudioDeviceStats stats;
+    SDL_atomic_t underruns;
+    Uint64 callback_ticks;
+    Uint64 jitter_ticks;
+    Uint32 jitter_count;
+    Uint64 last_callback_start;
+
+    /* Device clock, see SDL_GetAudioDevicePosition(): frames handed to (or
+       read from) the driver, and frames the callback has produced. The
+       audio thread updates these with mixer_lock held. */
+    Sint64 device_frames;
+    Sint64 callback_frames;
+
+    /* The app queues planar data; buffer_queue holds it interleaved. */
+    SDL_bool queue_planar;
+
+    /* Frame at which buffer_queue starts playing, or -1 for right away. */
+    Sint64 queue_start;
+
+    /* Capture ring (SDL_HINT_AUDIO_CAPTURE_RING_MS), used instead of
+       buffer_queue: ring_slots blocks of callbackspec.size bytes, each with
+       the capture time of its first frame. Only the capture thread moves
+       ring_write and only readers (holding ring_lock) move ring_read, so
+       neither side waits for the other. */
+    Uint8 *ring;
+    Uint64 *ring_stamps;
+    Uint32 ring_slots;
+    SDL_atomic_t ring_write;
+    SDL_atomic_t ring_read;
+    Uint32 ring_offset;
+    Uint64 ring_next_stamp;  /* earliest stamp the next block can get */
+    SDL_SpinLock ring_lock;
+    SDL_atomic_t capture_overruns;
+
+    /* Adaptive buffer sizing (SDL_HINT_AUDIO_ADAPTIVE_LATENCY_USEC).
+       Only the audio thread touches these. */
+    SDL_bool adaptive;
+    Uint16 adaptive_min_samples;
+    Uint16 adaptive_max_samples;
+    Uint32 adaptive_frames;
+    int adaptive_underruns;
+    int adaptive_calm_windows;
+    int adaptive_calm_needed;
+
     /* * * */
     /* Data private to this driver */
     struct SDL_PrivateAudioData *hidden;
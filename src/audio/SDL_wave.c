@@ -23,10 +23,16 @@
 /* Microsoft WAVE file loading routines */
 
 #include "SDL_audio.h"
+#include "SDL_hints.h"
+#include "SDL_cpuinfo.h"
+#include "SDL_thread.h"
 #include "SDL_wave.h"
+#include "SDL_audio_c.h"
 
 
+static int ReadChunkHeader(SDL_RWops * src, Chunk * chunk);
 static int ReadChunk(SDL_RWops * src, Chunk * chunk);
+static int SkipChunk(SDL_RWops * src, Chunk * chunk);
 
 struct MS_ADPCM_decodestate
 {
@@ -35,7 +41,7 @@ struct MS_ADPCM_decodestate
     Sint16 iSamp1;
     Sint16 iSamp2;
 };
-static struct MS_ADPCM_decoder
+struct MS_ADPCM_decoder
 {
     WaveFMT wavefmt;
     Uint16 wSamplesPerBlock;
@@ -43,175 +49,182 @@ static struct MS_ADPCM_decoder
     Sint16 aCoeff[7][2];
     /* * * */
     struct MS_ADPCM_decodestate state[2];
-} MS_ADPCM_state;
+};
 
 static int
-InitMS_ADPCM(WaveFMT * format)
+InitMS_ADPCM(struct MS_ADPCM_decoder *decoder, WaveFMT * format, Uint32 fmtlen)
 {
     Uint8 *rogue_feel;
+    Uint16 channels;
     int i;
 
+    /* format, extra info size, samples per block, then the coefficients */
+    if (fmtlen < sizeof(*format) + (3 * sizeof(Uint16)) + sizeof(decoder->aCoeff)) {
+        SDL_SetError("bogus MS_ADPCM .wav header");
+        return (-1);
+    }
+
     /* Set the rogue pointer to the MS_ADPCM specific data */
-    MS_ADPCM_state.wavefmt.encoding = SDL_SwapLE16(format->encoding);
-    MS_ADPCM_state.wavefmt.channels = SDL_SwapLE16(format->channels);
-    MS_ADPCM_state.wavefmt.frequency = SDL_SwapLE32(format->frequency);
-    MS_ADPCM_state.wavefmt.byterate = SDL_SwapLE32(format->byterate);
-    MS_ADPCM_state.wavefmt.blockalign = SDL_SwapLE16(format->blockalign);
-    MS_ADPCM_state.wavefmt.bitspersample =
+    decoder->wavefmt.encoding = SDL_SwapLE16(format->encoding);
+    decoder->wavefmt.channels = SDL_SwapLE16(format->channels);
+    decoder->wavefmt.frequency = SDL_SwapLE32(format->frequency);
+    decoder->wavefmt.byterate = SDL_SwapLE32(format->byterate);
+    decoder->wavefmt.blockalign = SDL_SwapLE16(format->blockalign);
+    decoder->wavefmt.bitspersample =
         SDL_SwapLE16(format->bitspersample);
     rogue_feel = (Uint8 *) format + sizeof(*format);
     if (sizeof(*format) == 16) {
         /* const Uint16 extra_info = ((rogue_feel[1] << 8) | rogue_feel[0]); */
         rogue_feel += sizeof(Uint16);
     }
-    MS_ADPCM_state.wSamplesPerBlock = ((rogue_feel[1] << 8) | rogue_feel[0]);
+    decoder->wSamplesPerBlock = ((rogue_feel[1] << 8) | rogue_feel[0]);
     rogue_feel += sizeof(Uint16);
-    MS_ADPCM_state.wNumCoef = ((rogue_feel[1] << 8) | rogue_feel[0]);
+    decoder->wNumCoef = ((rogue_feel[1] << 8) | rogue_feel[0]);
     rogue_feel += sizeof(Uint16);
-    if (MS_ADPCM_state.wNumCoef != 7) {
+    if (decoder->wNumCoef != 7) {
         SDL_SetError("Unknown set of MS_ADPCM coefficients");
         return (-1);
     }
-    for (i = 0; i < MS_ADPCM_state.wNumCoef; ++i) {
-        MS_ADPCM_state.aCoeff[i][0] = ((rogue_feel[1] << 8) | rogue_feel[0]);
+    for (i = 0; i < decoder->wNumCoef; ++i) {
+        decoder->aCoeff[i][0] = ((rogue_feel[1] << 8) | rogue_feel[0]);
         rogue_feel += sizeof(Uint16);
-        MS_ADPCM_state.aCoeff[i][1] = ((rogue_feel[1] << 8) | rogue_feel[0]);
+        decoder->aCoeff[i][1] = ((rogue_feel[1] << 8) | rogue_feel[0]);
         rogue_feel += sizeof(Uint16);
     }
+
+    /* Make sure a block holds what the header says it does, so decoding
+       one can't run off the end of it. */
+    channels = decoder->wavefmt.channels;
+    if ((channels < 1) || (channels > SDL_arraysize(decoder->state))) {
+        SDL_SetError("MS ADPCM decoder can only handle %u channels",
+                     (unsigned int)SDL_arraysize(decoder->state));
+        return (-1);
+    }
+    if ((decoder->wSamplesPerBlock < 2) ||
+        (((decoder->wSamplesPerBlock - 2) * channels) % 2) ||
+        (decoder->wavefmt.blockalign <
+         ((7 * channels) + (((decoder->wSamplesPerBlock - 2) * channels) / 2)))) {
+        SDL_SetError("Invalid MS ADPCM block size");
+        return (-1);
+    }
     return (0);
 }
 
-static Sint32
+/* How the step size adapts to each nybble, and the nybble's signed value. */
+static const Sint32 MS_ADPCM_adaptive[16] = {
+    230, 230, 230, 230, 307, 409, 512, 614,
+    768, 614, 512, 409, 307, 230, 230, 230
+};
+static const Sint32 MS_ADPCM_signed[16] = {
+    0, 1, 2, 3, 4, 5, 6, 7,
+    -8, -7, -6, -5, -4, -3, -2, -1
+};
+
+static SDL_INLINE Sint32
 MS_ADPCM_nibble(struct MS_ADPCM_decodestate *state,
-                Uint8 nybble, Sint16 * coeff)
+                Uint8 nybble, const Sint16 * coeff)
 {
     const Sint32 max_audioval = ((1 << (16 - 1)) - 1);
     const Sint32 min_audioval = -(1 << (16 - 1));
-    const Sint32 adaptive[] = {
-        230, 230, 230, 230, 307, 409, 512, 614,
-        768, 614, 512, 409, 307, 230, 230, 230
-    };
     Sint32 new_sample, delta;
 
     new_sample = ((state->iSamp1 * coeff[0]) +
                   (state->iSamp2 * coeff[1])) / 256;
-    if (nybble & 0x08) {
-        new_sample += state->iDelta * (nybble - 0x10);
-    } else {
-        new_sample += state->iDelta * nybble;
-    }
-    if (new_sample < min_audioval) {
-        new_sample = min_audioval;
-    } else if (new_sample > max_audioval) {
-        new_sample = max_audioval;
-    }
-    delta = ((Sint32) state->iDelta * adaptive[nybble]) / 256;
-    if (delta < 16) {
-        delta = 16;
-    }
-    state->iDelta = (Uint16) delta;
+    new_sample += state->iDelta * MS_ADPCM_signed[nybble];
+    new_sample = SDL_max(SDL_min(new_sample, max_audioval), min_audioval);
+
+    delta = ((Sint32) state->iDelta * MS_ADPCM_adaptive[nybble]) / 256;
+    state->iDelta = (Uint16) SDL_max(delta, 16);
     state->iSamp2 = state->iSamp1;
     state->iSamp1 = (Sint16) new_sample;
     return (new_sample);
 }
 
+/* Decode one block: wSamplesPerBlock sample frames of 16-bit audio. */
 static int
-MS_ADPCM_decode(Uint8 ** audio_buf, Uint32 * audio_len)
+MS_ADPCM_decode_block(struct MS_ADPCM_decoder *decoder,
+                      const Uint8 * encoded, Uint8 * decoded)
 {
     struct MS_ADPCM_decodestate *state[2];
-    Uint8 *freeable, *encoded, *decoded;
-    Sint32 encoded_len, samplesleft;
+    Sint32 samplesleft;
     Sint8 nybble;
     Uint8 stereo;
     Sint16 *coeff[2];
     Sint32 new_sample;
 
-    /* Allocate the proper sized output buffer */
-    encoded_len = *audio_len;
-    encoded = *audio_buf;
-    freeable = *audio_buf;
-    *audio_len = (encoded_len / MS_ADPCM_state.wavefmt.blockalign) *
-        MS_ADPCM_state.wSamplesPerBlock *
-        MS_ADPCM_state.wavefmt.channels * sizeof(Sint16);
-    *audio_buf = (Uint8 *) SDL_malloc(*audio_len);
-    if (*audio_buf == NULL) {
-        return SDL_OutOfMemory();
+    stereo = (decoder->wavefmt.channels == 2);
+    state[0] = &decoder->state[0];
+    state[1] = &decoder->state[stereo];
+
+    /* Grab the initial information for this block */
+    state[0]->hPredictor = *encoded++;
+    if (stereo) {
+        state[1]->hPredictor = *encoded++;
     }
-    decoded = *audio_buf;
-
-    /* Get ready... Go! */
-    stereo = (MS_ADPCM_state.wavefmt.channels == 2);
-    state[0] = &MS_ADPCM_state.state[0];
-    state[1] = &MS_ADPCM_state.state[stereo];
-    while (encoded_len >= MS_ADPCM_state.wavefmt.blockalign) {
-        /* Grab the initial information for this block */
-        state[0]->hPredictor = *encoded++;
-        if (stereo) {
-            state[1]->hPredictor = *encoded++;
-        }
-        state[0]->iDelta = ((encoded[1] << 8) | encoded[0]);
+    if ((state[0]->hPredictor >= decoder->wNumCoef) ||
+        (state[1]->hPredictor >= decoder->wNumCoef)) {
+        return -1;  /* the caller sets the error; we might be on a worker thread. */
+    }
+    state[0]->iDelta = ((encoded[1] << 8) | encoded[0]);
+    encoded += sizeof(Sint16);
+    if (stereo) {
+        state[1]->iDelta = ((encoded[1] << 8) | encoded[0]);
         encoded += sizeof(Sint16);
-        if (stereo) {
-            state[1]->iDelta = ((encoded[1] << 8) | encoded[0]);
-            encoded += sizeof(Sint16);
-        }
-        state[0]->iSamp1 = ((encoded[1] << 8) | encoded[0]);
+    }
+    state[0]->iSamp1 = ((encoded[1] << 8) | encoded[0]);
+    encoded += sizeof(Sint16);
+    if (stereo) {
+        state[1]->iSamp1 = ((encoded[1] << 8) | encoded[0]);
         encoded += sizeof(Sint16);
-        if (stereo) {
-            state[1]->iSamp1 = ((encoded[1] << 8) | encoded[0]);
-            encoded += sizeof(Sint16);
-        }
-        state[0]->iSamp2 = ((encoded[1] << 8) | encoded[0]);
+    }
+    state[0]->iSamp2 = ((encoded[1] << 8) | encoded[0]);
+    encoded += sizeof(Sint16);
+    if (stereo) {
+        state[1]->iSamp2 = ((encoded[1] << 8) | encoded[0]);
         encoded += sizeof(Sint16);
-        if (stereo) {
-            state[1]->iSamp2 = ((encoded[1] << 8) | encoded[0]);
-            encoded += sizeof(Sint16);
-        }
-        coeff[0] = MS_ADPCM_state.aCoeff[state[0]->hPredictor];
-        coeff[1] = MS_ADPCM_state.aCoeff[state[1]->hPredictor];
+    }
+    coeff[0] = decoder->aCoeff[state[0]->hPredictor];
+    coeff[1] = decoder->aCoeff[state[1]->hPredictor];
 
-        /* Store the two initial samples we start with */
-        decoded[0] = state[0]->iSamp2 & 0xFF;
-        decoded[1] = state[0]->iSamp2 >> 8;
+    /* Store the two initial samples we start with */
+    decoded[0] = state[0]->iSamp2 & 0xFF;
+    decoded[1] = state[0]->iSamp2 >> 8;
+    decoded += 2;
+    if (stereo) {
+        decoded[0] = state[1]->iSamp2 & 0xFF;
+        decoded[1] = state[1]->iSamp2 >> 8;
         decoded += 2;
-        if (stereo) {
-            decoded[0] = state[1]->iSamp2 & 0xFF;
-            decoded[1] = state[1]->iSamp2 >> 8;
-            decoded += 2;
-        }
-        decoded[0] = state[0]->iSamp1 & 0xFF;
-        decoded[1] = state[0]->iSamp1 >> 8;
+    }
+    decoded[0] = state[0]->iSamp1 & 0xFF;
+    decoded[1] = state[0]->iSamp1 >> 8;
+    decoded += 2;
+    if (stereo) {
+        decoded[0] = state[1]->iSamp1 & 0xFF;
+        decoded[1] = state[1]->iSamp1 >> 8;
         decoded += 2;
-        if (stereo) {
-            decoded[0] = state[1]->iSamp1 & 0xFF;
-            decoded[1] = state[1]->iSamp1 >> 8;
-            decoded += 2;
-        }
+    }
 
-        /* Decode and store the other samples in this block */
-        samplesleft = (MS_ADPCM_state.wSamplesPerBlock - 2) *
-            MS_ADPCM_state.wavefmt.channels;
-        while (samplesleft > 0) {
-            nybble = (*encoded) >> 4;
-            new_sample = MS_ADPCM_nibble(state[0], nybble, coeff[0]);
-            decoded[0] = new_sample & 0xFF;
-            new_sample >>= 8;
-            decoded[1] = new_sample & 0xFF;
-            decoded += 2;
-
-            nybble = (*encoded) & 0x0F;
-            new_sample = MS_ADPCM_nibble(state[1], nybble, coeff[1]);
-            decoded[0] = new_sample & 0xFF;
-            new_sample >>= 8;
-            decoded[1] = new_sample & 0xFF;
-            decoded += 2;
-
-            ++encoded;
-            samplesleft -= 2;
-        }
-        encoded_len -= MS_ADPCM_state.wavefmt.blockalign;
+    /* Decode and store the other samples in this block */
+    samplesleft = (decoder->wSamplesPerBlock - 2) *
+        decoder->wavefmt.channels;
+    while (samplesleft > 0) {
+        nybble = (*encoded) >> 4;
+        new_sample = MS_ADPCM_nibble(state[0], nybble, coeff[0]);
+        decoded[0] = new_sample & 0xFF;
+        new_sample >>= 8;
+        decoded[1] = new_sample & 0xFF;
+        decoded += 2;
+
+        nybble = (*encoded) & 0x0F;
+        new_sample = MS_ADPCM_nibble(state[1], nybble, coeff[1]);
+        decoded[0] = new_sample & 0xFF;
+        new_sample >>= 8;
+        decoded[1] = new_sample & 0xFF;
+        decoded += 2;
+
+        ++encoded;
+        samplesleft -= 2;
     }
-    SDL_free(freeable);
     return (0);
 }
 
@@ -220,93 +233,267 @@ struct IMA_ADPCM_decodestate
     Sint32 sample;
     Sint8 index;
 };
-static struct IMA_ADPCM_decoder
+struct IMA_ADPCM_decoder
 {
     WaveFMT wavefmt;
     Uint16 wSamplesPerBlock;
     /* * * */
     struct IMA_ADPCM_decodestate state[2];
-} IMA_ADPCM_state;
+};
 
 static int
-InitIMA_ADPCM(WaveFMT * format)
+InitIMA_ADPCM(struct IMA_ADPCM_decoder *decoder, WaveFMT * format, Uint32 fmtlen)
 {
     Uint8 *rogue_feel;
+    Uint16 channels;
+
+    /* format, extra info size, then samples per block */
+    if (fmtlen < sizeof(*format) + (2 * sizeof(Uint16))) {
+        SDL_SetError("bogus IMA_ADPCM .wav header");
+        return (-1);
+    }
 
     /* Set the rogue pointer to the IMA_ADPCM specific data */
-    IMA_ADPCM_state.wavefmt.encoding = SDL_SwapLE16(format->encoding);
-    IMA_ADPCM_state.wavefmt.channels = SDL_SwapLE16(format->channels);
-    IMA_ADPCM_state.wavefmt.frequency = SDL_SwapLE32(format->frequency);
-    IMA_ADPCM_state.wavefmt.byterate = SDL_SwapLE32(format->byterate);
-    IMA_ADPCM_state.wavefmt.blockalign = SDL_SwapLE16(format->blockalign);
-    IMA_ADPCM_state.wavefmt.bitspersample =
+    decoder->wavefmt.encoding = SDL_SwapLE16(format->encoding);
+    decoder->wavefmt.channels = SDL_SwapLE16(format->channels);
+    decoder->wavefmt.frequency = SDL_SwapLE32(format->frequency);
+    decoder->wavefmt.byterate = SDL_SwapLE32(format->byterate);
+    decoder->wavefmt.blockalign = SDL_SwapLE16(format->blockalign);
+    decoder->wavefmt.bitspersample =
         SDL_SwapLE16(format->bitspersample);
     rogue_feel = (Uint8 *) format + sizeof(*format);
     if (sizeof(*format) == 16) {
         /* const Uint16 extra_info = ((rogue_feel[1] << 8) | rogue_feel[0]); */
         rogue_feel += sizeof(Uint16);
     }
-    IMA_ADPCM_state.wSamplesPerBlock = ((rogue_feel[1] << 8) | rogue_feel[0]);
+    decoder->wSamplesPerBlock = ((rogue_feel[1] << 8) | rogue_feel[0]);
+
+    /* Check to make sure we have enough variables in the state array */
+    channels = decoder->wavefmt.channels;
+    if ((channels < 1) || (channels > SDL_arraysize(decoder->state))) {
+        SDL_SetError("IMA ADPCM decoder can only handle %u channels",
+                     (unsigned int)SDL_arraysize(decoder->state));
+        return (-1);
+    }
+    /* Samples after the first come in groups of 8 per channel. */
+    if ((decoder->wSamplesPerBlock < 1) ||
+        ((decoder->wSamplesPerBlock - 1) % 8) ||
+        (decoder->wavefmt.blockalign <
+         ((4 * channels) + (((decoder->wSamplesPerBlock - 1) * channels) / 2)))) {
+        SDL_SetError("Invalid IMA ADPCM block size");
+        return (-1);
+    }
     return (0);
 }
 
-static Sint32
+/* IMA_ADPCM_diff[index][nybble & 7] is the size of the step a nybble
+   makes at that step index, and IMA_ADPCM_next[index][nybble & 7] the
+   (clamped) index the next nybble uses. */
+static const Uint16 IMA_ADPCM_diff[89][8] = {
+    { 0, 1, 3, 4, 7, 8, 10, 11 },
+    { 1, 3, 5, 7, 9, 11, 13, 15 },
+    { 1, 3, 5, 7, 10, 12, 14, 16 },
+    { 1, 3, 6, 8, 11, 13, 16, 18 },
+    { 1, 3, 6, 8, 12, 14, 17, 19 },
+    { 1, 4, 7, 10, 13, 16, 19, 22 },
+    { 1, 4, 7, 10, 14, 17, 20, 23 },
+    { 1, 4, 8, 11, 15, 18, 22, 25 },
+    { 2, 6, 10, 14, 18, 22, 26, 30 },
+    { 2, 6, 10, 14, 19, 23, 27, 31 },
+    { 2, 6, 11, 15, 21, 25, 30, 34 },
+    { 2, 7, 12, 17, 23, 28, 33, 38 },
+    { 2, 7, 13, 18, 25, 30, 36, 41 },
+    { 3, 9, 15, 21, 28, 34, 40, 46 },
+    { 3, 10, 17, 24, 31, 38, 45, 52 },
+    { 3, 10, 18, 25, 34, 41, 49, 56 },
+    { 4, 12, 21, 29, 38, 46, 55, 63 },
+    { 4, 13, 22, 31, 41, 50, 59, 68 },
+    { 5, 15, 25, 35, 46, 56, 66, 76 },
+    { 5, 16, 27, 38, 50, 61, 72, 83 },
+    { 6, 18, 31, 43, 56, 68, 81, 93 },
+    { 6, 19, 33, 46, 61, 74, 88, 101 },
+    { 7, 22, 37, 52, 67, 82, 97, 112 },
+    { 8, 24, 41, 57, 74, 90, 107, 123 },
+    { 9, 27, 45, 63, 82, 100, 118, 136 },
+    { 10, 30, 50, 70, 90, 110, 130, 150 },
+    { 11, 33, 55, 77, 99, 121, 143, 165 },
+    { 12, 36, 60, 84, 109, 133, 157, 181 },
+    { 13, 39, 66, 92, 120, 146, 173, 199 },
+    { 14, 43, 73, 102, 132, 161, 191, 220 },
+    { 16, 48, 81, 113, 146, 178, 211, 243 },
+    { 17, 52, 88, 123, 160, 195, 231, 266 },
+    { 19, 58, 97, 136, 176, 215, 254, 293 },
+    { 21, 64, 107, 150, 194, 237, 280, 323 },
+    { 23, 70, 118, 165, 213, 260, 308, 355 },
+    { 26, 78, 130, 182, 235, 287, 339, 391 },
+    { 28, 85, 143, 200, 258, 315, 373, 430 },
+    { 31, 94, 157, 220, 284, 347, 410, 473 },
+    { 34, 103, 173, 242, 313, 382, 452, 521 },
+    { 38, 114, 191, 267, 345, 421, 498, 574 },
+    { 42, 126, 210, 294, 379, 463, 547, 631 },
+    { 46, 138, 231, 323, 417, 509, 602, 694 },
+    { 51, 153, 255, 357, 459, 561, 663, 765 },
+    { 56, 168, 280, 392, 505, 617, 729, 841 },
+    { 61, 184, 308, 431, 555, 678, 802, 925 },
+    { 68, 204, 340, 476, 612, 748, 884, 1020 },
+    { 74, 223, 373, 522, 672, 821, 971, 1120 },
+    { 82, 246, 411, 575, 740, 904, 1069, 1233 },
+    { 90, 271, 452, 633, 814, 995, 1176, 1357 },
+    { 99, 298, 497, 696, 895, 1094, 1293, 1492 },
+    { 109, 328, 547, 766, 985, 1204, 1423, 1642 },
+    { 120, 360, 601, 841, 1083, 1323, 1564, 1804 },
+    { 132, 397, 662, 927, 1192, 1457, 1722, 1987 },
+    { 145, 436, 728, 1019, 1311, 1602, 1894, 2185 },
+    { 160, 480, 801, 1121, 1442, 1762, 2083, 2403 },
+    { 176, 528, 881, 1233, 1587, 1939, 2292, 2644 },
+    { 194, 582, 970, 1358, 1746, 2134, 2522, 2910 },
+    { 213, 639, 1066, 1492, 1920, 2346, 2773, 3199 },
+    { 234, 703, 1173, 1642, 2112, 2581, 3051, 3520 },
+    { 258, 774, 1291, 1807, 2324, 2840, 3357, 3873 },
+    { 284, 852, 1420, 1988, 2556, 3124, 3692, 4260 },
+    { 312, 936, 1561, 2185, 2811, 3435, 4060, 4684 },
+    { 343, 1030, 1717, 2404, 3092, 3779, 4466, 5153 },
+    { 378, 1134, 1890, 2646, 3402, 4158, 4914, 5670 },
+    { 415, 1246, 2078, 2909, 3742, 4573, 5405, 6236 },
+    { 457, 1372, 2287, 3202, 4117, 5032, 5947, 6862 },
+    { 503, 1509, 2516, 3522, 4529, 5535, 6542, 7548 },
+    { 553, 1660, 2767, 3874, 4981, 6088, 7195, 8302 },
+    { 608, 1825, 3043, 4260, 5479, 6696, 7914, 9131 },
+    { 669, 2008, 3348, 4687, 6027, 7366, 8706, 10045 },
+    { 736, 2209, 3683, 5156, 6630, 8103, 9577, 11050 },
+    { 810, 2431, 4052, 5673, 7294, 8915, 10536, 12157 },
+    { 891, 2674, 4457, 6240, 8023, 9806, 11589, 13372 },
+    { 980, 2941, 4902, 6863, 8825, 10786, 12747, 14708 },
+    { 1078, 3235, 5393, 7550, 9708, 11865, 14023, 16180 },
+    { 1186, 3559, 5932, 8305, 10679, 13052, 15425, 17798 },
+    { 1305, 3915, 6526, 9136, 11747, 14357, 16968, 19578 },
+    { 1435, 4306, 7178, 10049, 12922, 15793, 18665, 21536 },
+    { 1579, 4737, 7896, 11054, 14214, 17372, 20531, 23689 },
+    { 1737, 5211, 8686, 12160, 15636, 19110, 22585, 26059 },
+    { 1911, 5733, 9555, 13377, 17200, 21022, 24844, 28666 },
+    { 2102, 6306, 10511, 14715, 18920, 23124, 27329, 31533 },
+    { 2312, 6937, 11562, 16187, 20812, 25437, 30062, 34687 },
+    { 2543, 7630, 12718, 17805, 22893, 27980, 33068, 38155 },
+    { 2798, 8394, 13990, 19586, 25183, 30779, 36375, 41971 },
+    { 3077, 9232, 15388, 21543, 27700, 33855, 40011, 46166 },
+    { 3385, 10156, 16928, 23699, 30471, 37242, 44014, 50785 },
+    { 3724, 11172, 18621, 26069, 33518, 40966, 48415, 55863 },
+    { 4095, 12286, 20478, 28669, 36862, 45053, 53245, 61436 }
+};
+static const Uint8 IMA_ADPCM_next[89][8] = {
+    { 0, 0, 0, 0, 2, 4, 6, 8 },
+    { 0, 0, 0, 0, 3, 5, 7, 9 },
+    { 1, 1, 1, 1, 4, 6, 8, 10 },
+    { 2, 2, 2, 2, 5, 7, 9, 11 },
+    { 3, 3, 3, 3, 6, 8, 10, 12 },
+    { 4, 4, 4, 4, 7, 9, 11, 13 },
+    { 5, 5, 5, 5, 8, 10, 12, 14 },
+    { 6, 6, 6, 6, 9, 11, 13, 15 },
+    { 7, 7, 7, 7, 10, 12, 14, 16 },
+    { 8, 8, 8, 8, 11, 13, 15, 17 },
+    { 9, 9, 9, 9, 12, 14, 16, 18 },
+    { 10, 10, 10, 10, 13, 15, 17, 19 },
+    { 11, 11, 11, 11, 14, 16, 18, 20 },
+    { 12, 12, 12, 12, 15, 17, 19, 21 },
+    { 13, 13, 13, 13, 16, 18, 20, 22 },
+    { 14, 14, 14, 14, 17, 19, 21, 23 },
+    { 15, 15, 15, 15, 18, 20, 22, 24 },
+    { 16, 16, 16, 16, 19, 21, 23, 25 },
+    { 17, 17, 17, 17, 20, 22, 24, 26 },
+    { 18, 18, 18, 18, 21, 23, 25, 27 },
+    { 19, 19, 19, 19, 22, 24, 26, 28 },
+    { 20, 20, 20, 20, 23, 25, 27, 29 },
+    { 21, 21, 21, 21, 24, 26, 28, 30 },
+    { 22, 22, 22, 22, 25, 27, 29, 31 },
+    { 23, 23, 23, 23, 26, 28, 30, 32 },
+    { 24, 24, 24, 24, 27, 29, 31, 33 },
+    { 25, 25, 25, 25, 28, 30, 32, 34 },
+    { 26, 26, 26, 26, 29, 31, 33, 35 },
+    { 27, 27, 27, 27, 30, 32, 34, 36 },
+    { 28, 28, 28, 28, 31, 33, 35, 37 },
+    { 29, 29, 29, 29, 32, 34, 36, 38 },
+    { 30, 30, 30, 30, 33, 35, 37, 39 },
+    { 31, 31, 31, 31, 34, 36, 38, 40 },
+    { 32, 32, 32, 32, 35, 37, 39, 41 },
+    { 33, 33, 33, 33, 36, 38, 40, 42 },
+    { 34, 34, 34, 34, 37, 39, 41, 43 },
+    { 35, 35, 35, 35, 38, 40, 42, 44 },
+    { 36, 36, 36, 36, 39, 41, 43, 45 },
+    { 37, 37, 37, 37, 40, 42, 44, 46 },
+    { 38, 38, 38, 38, 41, 43, 45, 47 },
+    { 39, 39, 39, 39, 42, 44, 46, 48 },
+    { 40, 40, 40, 40, 43, 45, 47, 49 },
+    { 41, 41, 41, 41, 44, 46, 48, 50 },
+    { 42, 42, 42, 42, 45, 47, 49, 51 },
+    { 43, 43, 43, 43, 46, 48, 50, 52 },
+    { 44, 44, 44, 44, 47, 49, 51, 53 },
+    { 45, 45, 45, 45, 48, 50, 52, 54 },
+    { 46, 46, 46, 46, 49, 51, 53, 55 },
+    { 47, 47, 47, 47, 50, 52, 54, 56 },
+    { 48, 48, 48, 48, 51, 53, 55, 57 },
+    { 49, 49, 49, 49, 52, 54, 56, 58 },
+    { 50, 50, 50, 50, 53, 55, 57, 59 },
+    { 51, 51, 51, 51, 54, 56, 58, 60 },
+    { 52, 52, 52, 52, 55, 57, 59, 61 },
+    { 53, 53, 53, 53, 56, 58, 60, 62 },
+    { 54, 54, 54, 54, 57, 59, 61, 63 },
+    { 55, 55, 55, 55, 58, 60, 62, 64 },
+    { 56, 56, 56, 56, 59, 61, 63, 65 },
+    { 57, 57, 57, 57, 60, 62, 64, 66 },
+    { 58, 58, 58, 58, 61, 63, 65, 67 },
+    { 59, 59, 59, 59, 62, 64, 66, 68 },
+    { 60, 60, 60, 60, 63, 65, 67, 69 },
+    { 61, 61, 61, 61, 64, 66, 68, 70 },
+    { 62, 62, 62, 62, 65, 67, 69, 71 },
+    { 63, 63, 63, 63, 66, 68, 70, 72 },
+    { 64, 64, 64, 64, 67, 69, 71, 73 },
+    { 65, 65, 65, 65, 68, 70, 72, 74 },
+    { 66, 66, 66, 66, 69, 71, 73, 75 },
+    { 67, 67, 67, 67, 70, 72, 74, 76 },
+    { 68, 68, 68, 68, 71, 73, 75, 77 },
+    { 69, 69, 69, 69, 72, 74, 76, 78 },
+    { 70, 70, 70, 70, 73, 75, 77, 79 },
+    { 71, 71, 71, 71, 74, 76, 78, 80 },
+    { 72, 72, 72, 72, 75, 77, 79, 81 },
+    { 73, 73, 73, 73, 76, 78, 80, 82 },
+    { 74, 74, 74, 74, 77, 79, 81, 83 },
+    { 75, 75, 75, 75, 78, 80, 82, 84 },
+    { 76, 76, 76, 76, 79, 81, 83, 85 },
+    { 77, 77, 77, 77, 80, 82, 84, 86 },
+    { 78, 78, 78, 78, 81, 83, 85, 87 },
+    { 79, 79, 79, 79, 82, 84, 86, 88 },
+    { 80, 80, 80, 80, 83, 85, 87, 88 },
+    { 81, 81, 81, 81, 84, 86, 88, 88 },
+    { 82, 82, 82, 82, 85, 87, 88, 88 },
+    { 83, 83, 83, 83, 86, 88, 88, 88 },
+    { 84, 84, 84, 84, 87, 88, 88, 88 },
+    { 85, 85, 85, 85, 88, 88, 88, 88 },
+    { 86, 86, 86, 86, 88, 88, 88, 88 },
+    { 87, 87, 87, 87, 88, 88, 88, 88 }
+};
+
+static SDL_INLINE Sint32
 IMA_ADPCM_nibble(struct IMA_ADPCM_decodestate *state, Uint8 nybble)
 {
     const Sint32 max_audioval = ((1 << (16 - 1)) - 1);
     const Sint32 min_audioval = -(1 << (16 - 1));
-    const int index_table[16] = {
-        -1, -1, -1, -1,
-        2, 4, 6, 8,
-        -1, -1, -1, -1,
-        2, 4, 6, 8
-    };
-    const Sint32 step_table[89] = {
-        7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31,
-        34, 37, 41, 45, 50, 55, 60, 66, 73, 80, 88, 97, 107, 118, 130,
-        143, 157, 173, 190, 209, 230, 253, 279, 307, 337, 371, 408,
-        449, 494, 544, 598, 658, 724, 796, 876, 963, 1060, 1166, 1282,
-        1411, 1552, 1707, 1878, 2066, 2272, 2499, 2749, 3024, 3327,
-        3660, 4026, 4428, 4871, 5358, 5894, 6484, 7132, 7845, 8630,
-        9493, 10442, 11487, 12635, 13899, 15289, 16818, 18500, 20350,
-        22385, 24623, 27086, 29794, 32767
-    };
-    Sint32 delta, step;
-
-    /* Compute difference and new sample value */
-    if (state->index > 88) {
-        state->index = 88;
-    } else if (state->index < 0) {
-        state->index = 0;
-    }
-    /* explicit cast to avoid gcc warning about using 'char' as array index */
-    step = step_table[(int)state->index];
-    delta = step >> 3;
-    if (nybble & 0x04)
-        delta += step;
-    if (nybble & 0x02)
-        delta += (step >> 1);
-    if (nybble & 0x01)
-        delta += (step >> 2);
-    if (nybble & 0x08)
-        delta = -delta;
-    state->sample += delta;
-
-    /* Update index value */
-    state->index += index_table[nybble];
+    const Sint32 sign = -(Sint32) (nybble >> 3);  /* 0 or -1 */
+    const Sint32 delta = IMA_ADPCM_diff[(int) state->index][nybble & 0x07];
+    Sint32 new_sample;
+
+    /* state->index is always in range here; see IMA_ADPCM_decode_block(). */
+    new_sample = state->sample + ((delta ^ sign) - sign);
+    state->index = IMA_ADPCM_next[(int) state->index][nybble & 0x07];
 
     /* Clamp output sample */
-    if (state->sample > max_audioval) {
-        state->sample = max_audioval;
-    } else if (state->sample < min_audioval) {
-        state->sample = min_audioval;
-    }
-    return (state->sample);
+    new_sample = SDL_max(SDL_min(new_sample, max_audioval), min_audioval);
+    state->sample = new_sample;
+    return (new_sample);
 }
 
 /* Fill the decode buffer with a channel block of data (8 samples) */
 static void
-Fill_IMA_ADPCM_block(Uint8 * decoded, Uint8 * encoded,
+Fill_IMA_ADPCM_block(Uint8 * decoded, const Uint8 * encoded,
                      int channel, int numchannels,
                      struct IMA_ADPCM_decodestate *state)
 {
@@ -334,72 +521,54 @@ Fill_IMA_ADPCM_block(Uint8 * decoded, Uint8 * encoded,
     }
 }
 
+/* Decode one block: wSamplesPerBlock sample frames of 16-bit audio. */
 static int
-IMA_ADPCM_decode(Uint8 ** audio_buf, Uint32 * audio_len)
+IMA_ADPCM_decode_block(struct IMA_ADPCM_decoder *decoder,
+                       const Uint8 * encoded, Uint8 * decoded)
 {
-    struct IMA_ADPCM_decodestate *state;
-    Uint8 *freeable, *encoded, *decoded;
-    Sint32 encoded_len, samplesleft;
-    unsigned int c, channels;
+    struct IMA_ADPCM_decodestate *state = decoder->state;
+    /* InitIMA_ADPCM() checked this already; this just tells the compiler. */
+    const unsigned int channels = SDL_min(decoder->wavefmt.channels, SDL_arraysize(decoder->state));
+    Sint32 samplesleft;
+    unsigned int c;
 
-    /* Check to make sure we have enough variables in the state array */
-    channels = IMA_ADPCM_state.wavefmt.channels;
-    if (channels > SDL_arraysize(IMA_ADPCM_state.state)) {
-        SDL_SetError("IMA ADPCM decoder can only handle %u channels",
-                     (unsigned int)SDL_arraysize(IMA_ADPCM_state.state));
-        return (-1);
-    }
-    state = IMA_ADPCM_state.state;
+    /* Grab the initial information for this block */
+    for (c = 0; c < channels; ++c) {
+        /* Fill the state information for this block */
+        state[c].sample = ((encoded[1] << 8) | encoded[0]);
+        encoded += 2;
+        if (state[c].sample & 0x8000) {
+            state[c].sample -= 0x10000;
+        }
+        state[c].index = (Sint8) *encoded++;
+        /* Clamp it once here, and the tables keep it in range after. */
+        if (state[c].index > 88) {
+            state[c].index = 88;
+        } else if (state[c].index < 0) {
+            state[c].index = 0;
+        }
+        /* Reserved byte in buffer header, should be 0 */
+        if (*encoded++ != 0) {
+            /* Uh oh, corrupt data?  Buggy code? */ ;
+        }
 
-    /* Allocate the proper sized output buffer */
-    encoded_len = *audio_len;
-    encoded = *audio_buf;
-    freeable = *audio_buf;
-    *audio_len = (encoded_len / IMA_ADPCM_state.wavefmt.blockalign) *
-        IMA_ADPCM_state.wSamplesPerBlock *
-        IMA_ADPCM_state.wavefmt.channels * sizeof(Sint16);
-    *audio_buf = (Uint8 *) SDL_malloc(*audio_len);
-    if (*audio_buf == NULL) {
-        return SDL_OutOfMemory();
+        /* Store the initial sample we start with */
+        decoded[0] = (Uint8) (state[c].sample & 0xFF);
+        decoded[1] = (Uint8) (state[c].sample >> 8);
+        decoded += 2;
     }
-    decoded = *audio_buf;
 
-    /* Get ready... Go! */
-    while (encoded_len >= IMA_ADPCM_state.wavefmt.blockalign) {
-        /* Grab the initial information for this block */
+    /* Decode and store the other samples in this block */
+    samplesleft = (decoder->wSamplesPerBlock - 1) * channels;
+    while (samplesleft > 0) {
         for (c = 0; c < channels; ++c) {
-            /* Fill the state information for this block */
-            state[c].sample = ((encoded[1] << 8) | encoded[0]);
-            encoded += 2;
-            if (state[c].sample & 0x8000) {
-                state[c].sample -= 0x10000;
-            }
-            state[c].index = *encoded++;
-            /* Reserved byte in buffer header, should be 0 */
-            if (*encoded++ != 0) {
-                /* Uh oh, corrupt data?  Buggy code? */ ;
-            }
-
-            /* Store the initial sample we start with */
-            decoded[0] = (Uint8) (state[c].sample & 0xFF);
-            decoded[1] = (Uint8) (state[c].sample >> 8);
-            decoded += 2;
-        }
-
-        /* Decode and store the other samples in this block */
-        samplesleft = (IMA_ADPCM_state.wSamplesPerBlock - 1) * channels;
-        while (samplesleft > 0) {
-            for (c = 0; c < channels; ++c) {
-                Fill_IMA_ADPCM_block(decoded, encoded,
-                                     c, channels, &state[c]);
-                encoded += 4;
-                samplesleft -= 8;
-            }
-            decoded += (channels * 8 * 2);
+            Fill_IMA_ADPCM_block(decoded, encoded,
+                                 c, channels, &state[c]);
+            encoded += 4;
+            samplesleft -= 8;
         }
-        encoded_len -= IMA_ADPCM_state.wavefmt.blockalign;
+        decoded += (channels * 8 * 2);
     }
-    SDL_free(freeable);
     return (0);
 }
 
@@ -407,73 +576,62 @@ IMA_ADPCM_decode(Uint8 ** audio_buf, Uint32 * audio_len)
 static const Uint8 extensible_pcm_guid[16] = { 1, 0, 0, 0, 0, 0, 16, 0, 128, 0, 0, 170, 0, 56, 155, 113 };
 static const Uint8 extensible_ieee_guid[16] = { 3, 0, 0, 0, 0, 0, 16, 0, 128, 0, 0, 170, 0, 56, 155, 113 };
 
-SDL_AudioSpec *
-SDL_LoadWAV_RW(SDL_RWops * src, int freesrc,
-               SDL_AudioSpec * spec, Uint8 ** audio_buf, Uint32 * audio_len)
-{
-    int was_error;
-    Chunk chunk;
-    int lenread;
-    int IEEE_float_encoded, MS_ADPCM_encoded, IMA_ADPCM_encoded;
-    int samplesize;
+/* How many sample frames of raw PCM we read (or convert) at a time. */
+#define WAVSTREAM_CHUNK_FRAMES 4096
 
-    /* WAV magic header */
-    Uint32 RIFFchunk;
-    Uint32 wavelen = 0;
-    Uint32 WAVEmagic;
-    Uint32 headerDiff = 0;
+/* Big reads decode whole ADPCM blocks straight into the caller's buffer,
+   up to this much encoded data at a time, spread over up to this many
+   threads, each getting at least this many blocks. */
+#define WAVSTREAM_BATCH_BYTES (256 * 1024)
+#define WAVSTREAM_MAX_THREADS 8
+#define WAVSTREAM_MIN_THREAD_BLOCKS 16
 
-    /* FMT chunk */
-    WaveFMT *format = NULL;
-    WaveExtensibleFMT *ext = NULL;
+struct SDL_WAVStream
+{
+    SDL_RWops *src;
+    int freesrc;
+    SDL_AudioSpec spec;         /* the decoded data, as the file has it */
+    Uint16 encoding;            /* PCM_CODE, MS_ADPCM_CODE or IMA_ADPCM_CODE */
+    int framesize;              /* bytes per decoded sample frame */
+    Sint64 data_start;          /* where the data chunk's samples begin */
+    Uint32 data_len;
+    Sint64 riff_end;            /* just past the end of the RIFF chunk */
+    Sint64 total_frames;        /* ADPCM can decode to more than 4G frames */
+    Sint64 position;            /* next sample frame we'll decode */
 
-    SDL_zero(chunk);
+    /* ADPCM files are decoded a block, or a batch of blocks, at a time. */
+    struct MS_ADPCM_decoder ms;
+    struct IMA_ADPCM_decoder ima;
+    int blockalign;
+    int blockframes;
+    int batchblocks;
+    int threads;
+    Uint8 *block;               /* the encoded blocks... */
+    Uint8 *decoded;             /* ...and the last partly read one, decoded. */
+    int decoded_len;
+    int decoded_pos;
 
-    /* Make sure we are passed a valid data source */
-    was_error = 0;
-    if (src == NULL) {
-        was_error = 1;
-        goto done;
-    }
+    /* Set up by SDL_SetWAVStreamFormat() */
+    SDL_AudioStream *cvtstream;
+    int cvtframesize;
+    Uint8 *cvtbuf;
+    int cvtbuflen;
+};
 
-    /* Check the magic header */
-    RIFFchunk = SDL_ReadLE32(src);
-    wavelen = SDL_ReadLE32(src);
-    if (wavelen == WAVE) {      /* The RIFFchunk has already been read */
-        WAVEmagic = wavelen;
-        wavelen = RIFFchunk;
-        RIFFchunk = RIFF;
-    } else {
-        WAVEmagic = SDL_ReadLE32(src);
-    }
-    if ((RIFFchunk != RIFF) || (WAVEmagic != WAVE)) {
-        SDL_SetError("Unrecognized file type (not WAVE)");
-        was_error = 1;
-        goto done;
-    }
-    headerDiff += sizeof(Uint32);       /* for WAVE */
+static int
+ParseWaveFormat(SDL_WAVStream *wav, WaveFMT * format, Uint32 fmtlen)
+{
+    SDL_AudioSpec *spec = &wav->spec;
+    int IEEE_float_encoded, MS_ADPCM_encoded, IMA_ADPCM_encoded;
+    int was_error = 0;
 
-    /* Read the audio data format chunk */
-    chunk.data = NULL;
-    do {
-        SDL_free(chunk.data);
-        chunk.data = NULL;
-        lenread = ReadChunk(src, &chunk);
-        if (lenread < 0) {
-            was_error = 1;
-            goto done;
-        }
-        /* 2 Uint32's for chunk header+len, plus the lenread */
-        headerDiff += lenread + 2 * sizeof(Uint32);
-    } while ((chunk.magic == FACT) || (chunk.magic == LIST) || (chunk.magic == BEXT) || (chunk.magic == JUNK));
+    /* FMT chunk */
+    WaveExtensibleFMT *ext = NULL;
 
-    /* Decode the audio data format */
-    format = (WaveFMT *) chunk.data;
-    if (chunk.magic != FMT) {
-        SDL_SetError("Complex WAVE files not supported");
-        was_error = 1;
-        goto done;
+    if (fmtlen < sizeof(*format)) {
+        return SDL_SetError("bogus .wav header");
     }
+
     IEEE_float_encoded = MS_ADPCM_encoded = IMA_ADPCM_encoded = 0;
     switch (SDL_SwapLE16(format->encoding)) {
     case PCM_CODE:
@@ -485,17 +643,15 @@ SDL_LoadWAV_RW(SDL_RWops * src, int freesrc,
         break;
     case MS_ADPCM_CODE:
         /* Try to understand this */
-        if (InitMS_ADPCM(format) < 0) {
-            was_error = 1;
-            goto done;
+        if (InitMS_ADPCM(&wav->ms, format, fmtlen) < 0) {
+            return (-1);
         }
         MS_ADPCM_encoded = 1;
         break;
     case IMA_ADPCM_CODE:
         /* Try to understand this */
-        if (InitIMA_ADPCM(format) < 0) {
-            was_error = 1;
-            goto done;
+        if (InitIMA_ADPCM(&wav->ima, format, fmtlen) < 0) {
+            return (-1);
         }
         IMA_ADPCM_encoded = 1;
         break;
@@ -505,10 +661,8 @@ SDL_LoadWAV_RW(SDL_RWops * src, int freesrc,
            to get things that didn't really _need_ WAVE_FORMAT_EXTENSIBLE
            to be useful working when they use this format flag. */
         ext = (WaveExtensibleFMT *) format;
-        if (SDL_SwapLE16(ext->size) < 22) {
-            SDL_SetError("bogus extended .wav header");
-            was_error = 1;
-            goto done;
+        if ((fmtlen < sizeof(*ext)) || (SDL_SwapLE16(ext->size) < 22)) {
+            return SDL_SetError("bogus extended .wav header");
         }
         if (SDL_memcmp(ext->subformat, extensible_pcm_guid, 16) == 0) {
             break;  /* cool. */
@@ -518,14 +672,10 @@ SDL_LoadWAV_RW(SDL_RWops * src, int freesrc,
         }
         break;
     case MP3_CODE:
-        SDL_SetError("MPEG Layer 3 data not supported");
-        was_error = 1;
-        goto done;
+        return SDL_SetError("MPEG Layer 3 data not supported");
     default:
-        SDL_SetError("Unknown WAVE data format: 0x%.4x",
-                     SDL_SwapLE16(format->encoding));
-        was_error = 1;
-        goto done;
+        return SDL_SetError("Unknown WAVE data format: 0x%.4x",
+                            SDL_SwapLE16(format->encoding));
     }
     SDL_zerop(spec);
     spec->freq = SDL_SwapLE32(format->frequency);
@@ -561,61 +711,521 @@ SDL_LoadWAV_RW(SDL_RWops * src, int freesrc,
     }
 
     if (was_error) {
-        SDL_SetError("Unknown %d-bit PCM data format",
-                     SDL_SwapLE16(format->bitspersample));
-        goto done;
+        return SDL_SetError("Unknown %d-bit PCM data format",
+                            SDL_SwapLE16(format->bitspersample));
     }
     spec->channels = (Uint8) SDL_SwapLE16(format->channels);
     spec->samples = 4096;       /* Good default buffer size */
+    if (spec->channels == 0) {
+        return SDL_SetError("bogus .wav header");
+    }
 
-    /* Read the audio data chunk */
-    *audio_buf = NULL;
+    wav->framesize = ((SDL_AUDIO_BITSIZE(spec->format)) / 8) * spec->channels;
+    if (MS_ADPCM_encoded) {
+        wav->encoding = MS_ADPCM_CODE;
+        wav->blockalign = wav->ms.wavefmt.blockalign;
+        wav->blockframes = wav->ms.wSamplesPerBlock;
+    } else if (IMA_ADPCM_encoded) {
+        wav->encoding = IMA_ADPCM_CODE;
+        wav->blockalign = wav->ima.wavefmt.blockalign;
+        wav->blockframes = wav->ima.wSamplesPerBlock;
+    } else {
+        wav->encoding = PCM_CODE;
+    }
+    return (0);
+}
+
+SDL_WAVStream *
+SDL_OpenWAVStream_RW(SDL_RWops * src, int freesrc, SDL_AudioSpec * spec)
+{
+    SDL_WAVStream *wav = NULL;
+    Chunk chunk;
+    Sint64 start;
+    Sint64 size;
+
+    /* WAV magic header */
+    Uint32 RIFFchunk;
+    Uint32 wavelen = 0;
+    Uint32 WAVEmagic;
+
+    SDL_zero(chunk);
+
+    /* Make sure we are passed a valid data source */
+    if (src == NULL) {
+        return NULL;  /* SDL_RWFromFile() or whatever already set an error. */
+    }
+
+    wav = (SDL_WAVStream *) SDL_calloc(1, sizeof (*wav));
+    if (wav == NULL) {
+        SDL_OutOfMemory();
+        goto error;
+    }
+    wav->src = src;
+    wav->freesrc = freesrc;
+
+    /* Check the magic header */
+    start = SDL_RWtell(src);
+    RIFFchunk = SDL_ReadLE32(src);
+    wavelen = SDL_ReadLE32(src);
+    if (wavelen == WAVE) {      /* The RIFFchunk has already been read */
+        WAVEmagic = wavelen;
+        wavelen = RIFFchunk;
+        RIFFchunk = RIFF;
+        start -= sizeof(Uint32);
+    } else {
+        WAVEmagic = SDL_ReadLE32(src);
+    }
+    if ((RIFFchunk != RIFF) || (WAVEmagic != WAVE)) {
+        SDL_SetError("Unrecognized file type (not WAVE)");
+        goto error;
+    }
+    wav->riff_end = (start < 0) ? -1 : (start + (2 * sizeof(Uint32)) + wavelen);
+
+    /* Read the audio data format chunk */
+    chunk.data = NULL;
     do {
-        SDL_free(*audio_buf);
-        *audio_buf = NULL;
-        lenread = ReadChunk(src, &chunk);
-        if (lenread < 0) {
-            was_error = 1;
-            goto done;
+        SDL_free(chunk.data);
+        chunk.data = NULL;
+        if (ReadChunk(src, &chunk) < 0) {
+            goto error;
         }
-        *audio_len = lenread;
-        *audio_buf = chunk.data;
-        if (chunk.magic != DATA)
-            headerDiff += lenread + 2 * sizeof(Uint32);
-    } while (chunk.magic != DATA);
-    headerDiff += 2 * sizeof(Uint32);   /* for the data chunk and len */
+    } while ((chunk.magic == FACT) || (chunk.magic == LIST) || (chunk.magic == BEXT) || (chunk.magic == JUNK));
 
-    if (MS_ADPCM_encoded) {
-        if (MS_ADPCM_decode(audio_buf, audio_len) < 0) {
-            was_error = 1;
-            goto done;
+    /* Decode the audio data format */
+    if (chunk.magic != FMT) {
+        SDL_SetError("Complex WAVE files not supported");
+        goto error;
+    }
+    if (ParseWaveFormat(wav, (WaveFMT *) chunk.data, chunk.length) < 0) {
+        goto error;
+    }
+    SDL_free(chunk.data);
+    chunk.data = NULL;
+
+    /* Find the audio data chunk; only its header is read here. */
+    for (;;) {
+        if (ReadChunkHeader(src, &chunk) < 0) {
+            goto error;
+        } else if (chunk.magic == DATA) {
+            break;
+        } else if (SkipChunk(src, &chunk) < 0) {
+            goto error;
         }
     }
-    if (IMA_ADPCM_encoded) {
-        if (IMA_ADPCM_decode(audio_buf, audio_len) < 0) {
-            was_error = 1;
-            goto done;
+    wav->data_start = SDL_RWtell(src);
+    wav->data_len = chunk.length;
+
+    /* Files that were never finished (a recording that was cut off, say)
+       may claim more data than there is. */
+    size = SDL_RWsize(src);
+    if ((size >= 0) && (wav->data_start >= 0) &&
+        ((wav->data_start + wav->data_len) > size)) {
+        wav->data_len = (Uint32) (size - wav->data_start);
+    }
+
+    if (wav->encoding == PCM_CODE) {
+        wav->total_frames = wav->data_len / wav->framesize;
+    } else {
+        const char *hint = SDL_GetHint(SDL_HINT_WAVE_DECODE_THREADS);
+        wav->total_frames = ((Sint64) (wav->data_len / wav->blockalign)) * wav->blockframes;
+        wav->threads = (hint && *hint) ? SDL_atoi(hint) : SDL_GetCPUCount();
+        wav->threads = SDL_max(SDL_min(wav->threads, WAVSTREAM_MAX_THREADS), 1);
+        wav->batchblocks = SDL_max(WAVSTREAM_BATCH_BYTES / wav->blockalign, 1);
+        wav->block = (Uint8 *) SDL_malloc(wav->batchblocks * wav->blockalign);
+        wav->decoded = (Uint8 *) SDL_malloc(wav->blockframes * wav->framesize);
+        if ((wav->block == NULL) || (wav->decoded == NULL)) {
+            SDL_OutOfMemory();
+            goto error;
         }
     }
 
-    /* Don't return a buffer that isn't a multiple of samplesize */
-    samplesize = ((SDL_AUDIO_BITSIZE(spec->format)) / 8) * spec->channels;
-    *audio_len &= ~(samplesize - 1);
+    if (spec) {
+        SDL_memcpy(spec, &wav->spec, sizeof (*spec));
+    }
+    return wav;
 
-  done:
-    SDL_free(format);
-    if (src) {
-        if (freesrc) {
-            SDL_RWclose(src);
-        } else {
-            /* seek to the end of the file (given by the RIFF chunk) */
-            SDL_RWseek(src, wavelen - chunk.length - headerDiff, RW_SEEK_CUR);
+  error:
+    SDL_free(chunk.data);
+    if (wav) {
+        wav->freesrc = 0;  /* we'll deal with this below. */
+        SDL_CloseWAVStream(wav);
+    }
+    if (freesrc) {
+        SDL_RWclose(src);
+    }
+    return NULL;
+}
+
+int
+SDL_SetWAVStreamFormat(SDL_WAVStream * wav, const SDL_AudioSpec * spec)
+{
+    SDL_AudioStream *cvtstream = NULL;
+    Uint8 *cvtbuf = NULL;
+    int cvtbuflen;
+
+    if (!wav) {
+        return SDL_InvalidParamError("wav");
+    } else if (!spec) {
+        return SDL_InvalidParamError("spec");
+    }
+
+    cvtbuflen = WAVSTREAM_CHUNK_FRAMES * wav->framesize;
+    if ((spec->format != wav->spec.format) ||
+        (spec->channels != wav->spec.channels) ||
+        (spec->freq != wav->spec.freq)) {
+        cvtstream = SDL_NewAudioStream(wav->spec.format, wav->spec.channels,
+                                       wav->spec.freq, spec->format,
+                                       spec->channels, spec->freq);
+        if (!cvtstream) {
+            return -1;  /* SDL_NewAudioStream() set the error. */
+        }
+        cvtbuf = (Uint8 *) SDL_malloc(cvtbuflen);
+        if (!cvtbuf) {
+            SDL_FreeAudioStream(cvtstream);
+            return SDL_OutOfMemory();
         }
     }
-    if (was_error) {
-        spec = NULL;
+
+    SDL_FreeAudioStream(wav->cvtstream);
+    SDL_free(wav->cvtbuf);
+    wav->cvtstream = cvtstream;
+    wav->cvtbuf = cvtbuf;
+    wav->cvtbuflen = cvtbuflen;
+    wav->cvtframesize = (SDL_AUDIO_BITSIZE(spec->format) / 8) * spec->channels;
+    return 0;
+}
+
+/* A run of ADPCM blocks for one thread to decode. Blocks don't depend on
+   each other, so each run just needs its own copy of the decoder state. */
+typedef struct WAVDecodeJob
+{
+    SDL_WAVStream *wav;
+    const Uint8 *encoded;
+    Uint8 *decoded;
+    int blocks;
+    int retval;
+} WAVDecodeJob;
+
+static int SDLCALL
+RunWAVDecodeJob(void *data)
+{
+    WAVDecodeJob *job = (WAVDecodeJob *) data;
+    const SDL_WAVStream *wav = job->wav;
+    const int decodedlen = wav->blockframes * wav->framesize;
+    const Uint8 *encoded = job->encoded;
+    Uint8 *decoded = job->decoded;
+    int i;
+
+    job->retval = 0;
+    if (wav->encoding == MS_ADPCM_CODE) {
+        struct MS_ADPCM_decoder decoder = wav->ms;
+        for (i = 0; (i < job->blocks) && (job->retval == 0); i++) {
+            job->retval = MS_ADPCM_decode_block(&decoder, encoded, decoded);
+            encoded += wav->blockalign;
+            decoded += decodedlen;
+        }
+    } else {
+        struct IMA_ADPCM_decoder decoder = wav->ima;
+        for (i = 0; (i < job->blocks) && (job->retval == 0); i++) {
+            job->retval = IMA_ADPCM_decode_block(&decoder, encoded, decoded);
+            encoded += wav->blockalign;
+            decoded += decodedlen;
+        }
+    }
+    return 0;
+}
+
+/* Decode whole ADPCM blocks, on worker threads if there are enough. */
+static int
+DecodeWAVBlocks(SDL_WAVStream * wav, const Uint8 * encoded, Uint8 * decoded, int blocks)
+{
+    const int decodedlen = wav->blockframes * wav->framesize;
+    WAVDecodeJob jobs[WAVSTREAM_MAX_THREADS];
+    SDL_Thread *threads[WAVSTREAM_MAX_THREADS];
+    int numjobs = SDL_min(wav->threads, blocks / WAVSTREAM_MIN_THREAD_BLOCKS);
+    int retval = 0;
+    int i;
+
+    numjobs = SDL_max(numjobs, 1);
+    for (i = 0; i < numjobs; i++) {
+        /* spread any leftover blocks over the first few jobs. */
+        const int count = (blocks / numjobs) + ((i < (blocks % numjobs)) ? 1 : 0);
+        jobs[i].wav = wav;
+        jobs[i].encoded = encoded;
+        jobs[i].decoded = decoded;
+        jobs[i].blocks = count;
+        encoded += count * wav->blockalign;
+        decoded += count * decodedlen;
+    }
+
+    /* Hand all but the first job to other threads, and do that one here. */
+    threads[0] = NULL;
+    for (i = 1; i < numjobs; i++) {
+        threads[i] = SDL_CreateThread(RunWAVDecodeJob, "SDLWaveDecode", &jobs[i]);
+        if (threads[i] == NULL) {
+            RunWAVDecodeJob(&jobs[i]);  /* oh well, do it ourselves. */
+        }
+    }
+    RunWAVDecodeJob(&jobs[0]);
+
+    for (i = 0; i < numjobs; i++) {
+        if (threads[i]) {
+            SDL_WaitThread(threads[i], NULL);
+        }
+        if (jobs[i].retval < 0) {
+            retval = -1;
+        }
+    }
+
+    if (retval < 0) {
+        return SDL_SetError("Invalid %s block", (wav->encoding == MS_ADPCM_CODE) ? "MS ADPCM" : "IMA ADPCM");
+    }
+    return 0;
+}
+
+/* Decode the next ADPCM block. Returns 0 at the end of the data. */
+static int
+DecodeWAVBlock(SDL_WAVStream * wav)
+{
+    if (SDL_RWread(wav->src, wav->block, wav->blockalign, 1) != 1) {
+        wav->total_frames = wav->position;  /* truncated? */
+        return 0;
+    }
+    if (DecodeWAVBlocks(wav, wav->block, wav->decoded, 1) < 0) {
+        return -1;
+    }
+    wav->decoded_len = wav->blockframes * wav->framesize;
+    wav->decoded_pos = 0;
+    return 1;
+}
+
+/* Read whole decoded sample frames, as the file has them. */
+static int
+ReadWAVFrames(SDL_WAVStream * wav, Uint8 * buf, int len)
+{
+    Uint32 frames = (Uint32) (len / wav->framesize);
+    Uint8 *ptr = buf;
+
+    if (frames > (wav->total_frames - wav->position)) {
+        frames = (Uint32) (wav->total_frames - wav->position);
+    }
+
+    if (wav->encoding == PCM_CODE) {
+        const size_t br = SDL_RWread(wav->src, buf, wav->framesize, frames);
+        if (br < frames) {
+            wav->total_frames = wav->position + (Sint64) br;  /* truncated? */
+        }
+        wav->position += (Sint64) br;
+        return (int) (br * wav->framesize);
+    }
+
+    while (frames > 0) {
+        int cpy;
+        if (wav->decoded_pos >= wav->decoded_len) {
+            const int blocks = SDL_min((int) (frames / wav->blockframes), wav->batchblocks);
+            if (blocks > 1) {
+                /* Decode whole blocks straight into the caller's buffer. */
+                const int got = (int) SDL_RWread(wav->src, wav->block, wav->blockalign, blocks);
+                const Uint32 gotframes = ((Uint32) got) * wav->blockframes;
+                if ((got > 0) && (DecodeWAVBlocks(wav, wav->block, ptr, got) < 0)) {
+                    return -1;
+                }
+                ptr += gotframes * wav->framesize;
+                frames -= gotframes;
+                wav->position += gotframes;
+                if (got < blocks) {
+                    wav->total_frames = wav->position;  /* truncated? */
+                    break;
+                }
+                continue;
+            }
+        }
+
+        if (wav->decoded_pos >= wav->decoded_len) {
+            const int rc = DecodeWAVBlock(wav);
+            if (rc < 0) {
+                return -1;
+            } else if (rc == 0) {
+                break;
+            }
+        }
+
+        cpy = SDL_min(wav->decoded_len - wav->decoded_pos, (int) (frames * wav->framesize));
+        SDL_memcpy(ptr, wav->decoded + wav->decoded_pos, cpy);
+        wav->decoded_pos += cpy;
+        ptr += cpy;
+        frames -= cpy / wav->framesize;
+        wav->position += cpy / wav->framesize;
+    }
+
+    return (int) (ptr - buf);
+}
+
+int
+SDL_WAVStreamRead(SDL_WAVStream * wav, void *buf, int len)
+{
+    if (!wav) {
+        return SDL_InvalidParamError("wav");
+    } else if (!buf) {
+        return SDL_InvalidParamError("buf");
+    } else if (len <= 0) {
+        return 0;
+    }
+
+    if (!wav->cvtstream) {
+        return ReadWAVFrames(wav, (Uint8 *) buf, len);
+    }
+
+    /* Feed the converter a chunk at a time until it has enough. */
+    len -= len % wav->cvtframesize;
+    while (SDL_AudioStreamAvailable(wav->cvtstream) < len) {
+        const int br = ReadWAVFrames(wav, wav->cvtbuf, wav->cvtbuflen);
+        if (br < 0) {
+            return -1;
+        } else if (br == 0) {
+            break;  /* end of the file; hand back what we've got. */
+        } else if (SDL_AudioStreamPut(wav->cvtstream, wav->cvtbuf, br) < 0) {
+            return -1;
+        }
+    }
+
+    len = SDL_min(len, SDL_AudioStreamAvailable(wav->cvtstream));
+    len -= len % wav->cvtframesize;
+    return SDL_AudioStreamGet(wav->cvtstream, buf, len);
+}
+
+int
+SDL_WAVStreamSeek(SDL_WAVStream * wav, Sint64 frame)
+{
+    int skip = 0;
+    Sint64 offset;
+
+    if (!wav) {
+        return SDL_InvalidParamError("wav");
+    } else if (frame < 0) {
+        return SDL_InvalidParamError("frame");
+    } else if (frame > wav->total_frames) {
+        return SDL_SetError("Seek past the end of the WAVE data");
+    } else if (wav->data_start < 0) {
+        return SDL_SetError("WAVE data source isn't seekable");
+    }
+
+    if (wav->encoding == PCM_CODE) {
+        offset = frame * wav->framesize;
+    } else {
+        /* start at the block holding this frame, and skip into it. */
+        offset = (frame / wav->blockframes) * wav->blockalign;
+        skip = (int) (frame % wav->blockframes);
+    }
+
+    if (SDL_RWseek(wav->src, wav->data_start + offset, RW_SEEK_SET) < 0) {
+        return -1;
+    }
+
+    wav->position = frame - skip;
+    wav->decoded_len = wav->decoded_pos = 0;
+    if (wav->cvtstream) {
+        SDL_AudioStreamClear(wav->cvtstream);
+    }
+
+    if (skip > 0) {
+        if (DecodeWAVBlock(wav) < 0) {
+            return -1;
+        }
+        wav->position = frame;
+        wav->decoded_pos = skip * wav->framesize;
+    }
+    return 0;
+}
+
+Sint64
+SDL_WAVStreamTell(SDL_WAVStream * wav)
+{
+    if (!wav) {
+        SDL_InvalidParamError("wav");
+        return -1;
+    }
+    return wav->position;
+}
+
+Sint64
+SDL_WAVStreamLength(SDL_WAVStream * wav)
+{
+    if (!wav) {
+        SDL_InvalidParamError("wav");
+        return -1;
+    }
+    return wav->total_frames;
+}
+
+void
+SDL_CloseWAVStream(SDL_WAVStream * wav)
+{
+    if (wav) {
+        if (wav->freesrc) {
+            SDL_RWclose(wav->src);
+        }
+        SDL_FreeAudioStream(wav->cvtstream);
+        SDL_free(wav->cvtbuf);
+        SDL_free(wav->block);
+        SDL_free(wav->decoded);
+        SDL_free(wav);
+    }
+}
+
+SDL_AudioSpec *
+SDL_LoadWAV_RW(SDL_RWops * src, int freesrc,
+               SDL_AudioSpec * spec, Uint8 ** audio_buf, Uint32 * audio_len)
+{
+    SDL_WAVStream *wav;
+    Uint32 len;
+    int br;
+
+    /* ADPCM data is decoded a block at a time, so we never hold the
+       encoded and decoded data in memory at once. */
+    *audio_buf = NULL;
+    wav = SDL_OpenWAVStream_RW(src, 0, spec);
+    if (wav == NULL) {
+        goto done;
+    }
+
+    if (wav->total_frames > (0x7FFFFFFF / wav->framesize)) {
+        SDL_SetError("WAVE data is too large");
+        goto done;
+    }
+    len = (Uint32) (wav->total_frames * wav->framesize);
+    *audio_buf = (Uint8 *) SDL_malloc(len ? len : 1);
+    if (*audio_buf == NULL) {
+        SDL_OutOfMemory();
+        goto done;
+    }
+    br = (len > 0) ? ReadWAVFrames(wav, *audio_buf, (int) len) : 0;
+    if (br < 0) {
+        goto done;
+    } else if ((Uint32) br != len) {
+        SDL_Error(SDL_EFREAD);
+        goto done;
+    }
+    *audio_len = len;
+
+    if (!freesrc && (wav->riff_end >= 0)) {
+        /* seek to the end of the file (given by the RIFF chunk) */
+        SDL_RWseek(src, wav->riff_end, RW_SEEK_SET);
+    }
+    SDL_CloseWAVStream(wav);
+    if (freesrc) {
+        SDL_RWclose(src);
     }
     return (spec);
+
+  done:
+    SDL_free(*audio_buf);
+    *audio_buf = NULL;
+    SDL_CloseWAVStream(wav);
+    if (src && freesrc) {
+        SDL_RWclose(src);
+    }
+    return NULL;
 }
 
 /* Since the WAV memory is allocated in the shared library, it must also
@@ -627,11 +1237,24 @@ SDL_FreeWAV(Uint8 * audio_buf)
     SDL_free(audio_buf);
 }
 
+static int
+ReadChunkHeader(SDL_RWops * src, Chunk * chunk)
+{
+    Uint8 header[8];
+    if (SDL_RWread(src, header, sizeof (header), 1) != 1) {
+        return SDL_Error(SDL_EFREAD);
+    }
+    chunk->magic = (header[3] << 24) | (header[2] << 16) | (header[1] << 8) | header[0];
+    chunk->length = (header[7] << 24) | (header[6] << 16) | (header[5] << 8) | header[4];
+    return 0;
+}
+
 static int
 ReadChunk(SDL_RWops * src, Chunk * chunk)
 {
-    chunk->magic = SDL_ReadLE32(src);
-    chunk->length = SDL_ReadLE32(src);
+    if (ReadChunkHeader(src, chunk) < 0) {
+        return -1;
+    }
     chunk->data = (Uint8 *) SDL_malloc(chunk->length);
     if (chunk->data == NULL) {
         return SDL_OutOfMemory();
@@ -644,4 +1267,25 @@ ReadChunk(SDL_RWops * src, Chunk * chunk)
     return (chunk->length);
 }
 
+/* Skip the data of a chunk whose header was just read. Sources that can't
+   seek are read through instead. */
+static int
+SkipChunk(SDL_RWops * src, Chunk * chunk)
+{
+    Uint8 buf[512];
+    Uint32 left = chunk->length;
+
+    if (SDL_RWseek(src, left, RW_SEEK_CUR) >= 0) {
+        return 0;
+    }
+    while (left > 0) {
+        const size_t len = SDL_min(left, sizeof (buf));
+        if (SDL_RWread(src, buf, len, 1) != 1) {
+            return SDL_Error(SDL_EFREAD);
+        }
+        left -= (Uint32) len;
+    }
+    return 0;
+}
+
 /* vi: set ts=4 sw=4 expandtab: */
@@ -29,7 +29,18 @@
 #include <errno.h>
 #include <string.h>
 
+/* Where we can, the hotplug thread sleeps until /dev/snd changes
+   instead of polling. */
+#ifdef __LINUX__
+#define ALSA_HOTPLUG_INOTIFY 1
+#include <sys/inotify.h>
+#include <poll.h>
+#include <unistd.h>
+#include <fcntl.h>
+#endif
+
 #include "SDL_assert.h"
+#include "SDL_hints.h"
 #include "SDL_timer.h"
 #include "SDL_audio.h"
 #include "../SDL_audio_c.h"
@@ -88,6 +99,19 @@ static int (*ALSA_snd_pcm_wait)(snd_pcm_t *, int);
 static int (*ALSA_snd_pcm_sw_params_set_avail_min)
   (snd_pcm_t *, snd_pcm_sw_params_t *, snd_pcm_uframes_t);
 static int (*ALSA_snd_pcm_reset)(snd_pcm_t *);
+static int (*ALSA_snd_pcm_start)(snd_pcm_t *);
+static snd_pcm_state_t (*ALSA_snd_pcm_state)(snd_pcm_t *);
+static snd_pcm_sframes_t (*ALSA_snd_pcm_avail_update)(snd_pcm_t *);
+static int (*ALSA_snd_pcm_delay)(snd_pcm_t *, snd_pcm_sframes_t *);
+static int (*ALSA_snd_pcm_mmap_begin)
+  (snd_pcm_t *, const snd_pcm_channel_area_t **, snd_pcm_uframes_t *, snd_pcm_uframes_t *);
+static snd_pcm_sframes_t (*ALSA_snd_pcm_mmap_commit)
+  (snd_pcm_t *, snd_pcm_uframes_t, snd_pcm_uframes_t);
+static int (*ALSA_snd_pcm_poll_descriptors_count) (snd_pcm_t *);
+static int (*ALSA_snd_pcm_poll_descriptors)
+  (snd_pcm_t *, struct pollfd *, unsigned int);
+static int (*ALSA_snd_pcm_poll_descriptors_revents)
+  (snd_pcm_t *, struct pollfd *, unsigned int, unsigned short *);
 static int (*ALSA_snd_device_name_hint) (int, const char *, void ***);
 static char* (*ALSA_snd_device_name_get_hint) (const void *, const char *);
 static int (*ALSA_snd_device_name_free_hint) (void **);
@@ -156,6 +180,15 @@ load_alsa_syms(void)
     SDL_ALSA_SYM(snd_pcm_wait);
     SDL_ALSA_SYM(snd_pcm_sw_params_set_avail_min);
     SDL_ALSA_SYM(snd_pcm_reset);
+    SDL_ALSA_SYM(snd_pcm_start);
+    SDL_ALSA_SYM(snd_pcm_state);
+    SDL_ALSA_SYM(snd_pcm_avail_update);
+    SDL_ALSA_SYM(snd_pcm_delay);
+    SDL_ALSA_SYM(snd_pcm_mmap_begin);
+    SDL_ALSA_SYM(snd_pcm_mmap_commit);
+    SDL_ALSA_SYM(snd_pcm_poll_descriptors_count);
+    SDL_ALSA_SYM(snd_pcm_poll_descriptors);
+    SDL_ALSA_SYM(snd_pcm_poll_descriptors_revents);
     SDL_ALSA_SYM(snd_device_name_hint);
     SDL_ALSA_SYM(snd_device_name_get_hint);
     SDL_ALSA_SYM(snd_device_name_free_hint);
@@ -240,11 +273,84 @@ get_audio_device(void *handle, const int channels)
 }
 
 
+/* Get going again after an error, counting xruns for SDL_GetAudioDeviceStats(). */
+static int
+ALSA_RecoverDevice(_THIS, int err)
+{
+    if (err == -EPIPE) {
+        SDL_AudioDeviceUnderrun(this);
+    }
+    return ALSA_snd_pcm_recover(this->hidden->pcm_handle, err, 0);
+}
+
+/* Low-latency mode: sleep on the device's poll descriptors until at least
+   (frames) frames can be written (or read, for capture). Returns the number
+   of frames available, 0 if the device was disabled meanwhile, or a
+   negative ALSA error code. */
+static snd_pcm_sframes_t
+ALSA_WaitForFrames(_THIS, const snd_pcm_uframes_t frames)
+{
+    snd_pcm_t *pcm_handle = this->hidden->pcm_handle;
+
+    while (SDL_AtomicGet(&this->enabled)) {
+        const snd_pcm_sframes_t avail = ALSA_snd_pcm_avail_update(pcm_handle);
+        unsigned short revents = 0;
+        int status;
+
+        if (avail < 0) {  /* xrun or suspend; get things going again. */
+            status = ALSA_RecoverDevice(this, (int) avail);
+            if (status < 0) {
+                return status;
+            }
+            continue;
+        } else if (((snd_pcm_uframes_t) avail) >= frames) {
+            return avail;
+        }
+
+        /* mmap access doesn't start the stream by itself. A capture device
+           needs this to get going at all, and a playback device that hasn't
+           got enough room left needs this to make some. */
+        if (ALSA_snd_pcm_state(pcm_handle) == SND_PCM_STATE_PREPARED) {
+            status = ALSA_snd_pcm_start(pcm_handle);
+            if (status < 0) {
+                return status;
+            }
+        }
+
+        /* The timeout is the same work-around for unplugged USB devices
+           that ALSA_PlayDevice uses. */
+        status = poll(this->hidden->pfds, this->hidden->nfds, 1000);
+        if (status == 0) {
+            return -ETIMEDOUT;
+        } else if (status < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -errno;
+        }
+
+        status = ALSA_snd_pcm_poll_descriptors_revents(pcm_handle,
+                    this->hidden->pfds, this->hidden->nfds, &revents);
+        if (status < 0) {
+            return status;
+        }
+        /* POLLERR means an xrun; snd_pcm_avail_update() reports it above. */
+    }
+
+    return 0;
+}
+
 /* This function waits until it is possible to write a full sound buffer */
 static void
 ALSA_WaitDevice(_THIS)
 {
-    /* We're in blocking mode, so there's nothing to do here */
+    if (this->hidden->mmap_access) {
+        if (ALSA_WaitForFrames(this, this->spec.samples) < 0) {
+            SDL_OpenedAudioDeviceDisconnected(this);
+        }
+    }
+
+    /* Otherwise we're in blocking mode, so there's nothing to do here */
 }
 
 
@@ -320,6 +426,83 @@ no_swizzle(_THIS, void *buffer, Uint32 bufferlen)
 #endif /* SND_CHMAP_API_VERSION */
 
 
+/* Low-latency mode: hand the next period to the hardware. */
+static void
+ALSA_PlayDeviceMmap(_THIS)
+{
+    snd_pcm_t *pcm_handle = this->hidden->pcm_handle;
+    const Uint8 *sample_buf = (const Uint8 *) this->hidden->mixbuf;
+    const int frame_size = (((int) SDL_AUDIO_BITSIZE(this->spec.format)) / 8) *
+                                this->spec.channels;
+    snd_pcm_uframes_t frames_left = ((snd_pcm_uframes_t) this->spec.samples);
+    snd_pcm_sframes_t status;
+
+    if (this->hidden->mmap_direct) {
+        /* The callback rendered straight into the ring buffer. */
+        this->hidden->mmap_direct = SDL_FALSE;
+        this->hidden->swizzle_func(this, this->hidden->mmap_buf, frames_left);
+        status = ALSA_snd_pcm_mmap_commit(pcm_handle,
+                                          this->hidden->mmap_offset,
+                                          frames_left);
+        if (status < 0) {
+            /* This period is lost, but we can carry on with the next one. */
+            status = ALSA_RecoverDevice(this, (int) status);
+        } else {
+            this->hidden->frames_written = frames_left;
+        }
+        frames_left = 0;
+    } else {
+        /* The free space wrapped around the end of the ring buffer, so the
+           callback used mixbuf; copy it over in as many pieces as needed. */
+        this->hidden->swizzle_func(this, this->hidden->mixbuf, frames_left);
+        status = 0;
+    }
+
+    while ( frames_left > 0 && SDL_AtomicGet(&this->enabled) ) {
+        const snd_pcm_channel_area_t *areas = NULL;
+        snd_pcm_uframes_t offset = 0;
+        snd_pcm_uframes_t frames = frames_left;
+
+        status = ALSA_WaitForFrames(this, 1);
+        if (status <= 0) {
+            break;
+        }
+
+        status = ALSA_snd_pcm_mmap_begin(pcm_handle, &areas, &offset, &frames);
+        if (status < 0) {
+            break;
+        }
+
+        SDL_memcpy(((Uint8 *) areas[0].addr) + (areas[0].first / 8) +
+                       (offset * (areas[0].step / 8)),
+                   sample_buf, frames * frame_size);
+
+        status = ALSA_snd_pcm_mmap_commit(pcm_handle, offset, frames);
+        if (status < 0) {
+            status = ALSA_RecoverDevice(this, (int) status);
+            if (status < 0) {
+                break;
+            }
+            continue;
+        }
+
+        sample_buf += frames * frame_size;
+        frames_left -= frames;
+        this->hidden->frames_written += frames;
+    }
+
+    this->hidden->frames_written = 0;
+
+    if (status < 0) {
+        /* Hmm, not much we can do - abort */
+        fprintf(stderr, "ALSA write failed (unrecoverable): %s\n",
+                ALSA_snd_strerror((int) status));
+        SDL_OpenedAudioDeviceDisconnected(this);
+    } else if (ALSA_snd_pcm_state(pcm_handle) == SND_PCM_STATE_PREPARED) {
+        ALSA_snd_pcm_start(pcm_handle);
+    }
+}
+
 static void
 ALSA_PlayDevice(_THIS)
 {
@@ -328,6 +511,11 @@ ALSA_PlayDevice(_THIS)
                                 this->spec.channels;
     snd_pcm_uframes_t frames_left = ((snd_pcm_uframes_t) this->spec.samples);
 
+    if (this->hidden->mmap_access) {
+        ALSA_PlayDeviceMmap(this);
+        return;
+    }
+
     this->hidden->swizzle_func(this, this->hidden->mixbuf, frames_left);
 
     while ( frames_left > 0 && SDL_AtomicGet(&this->enabled) ) {
@@ -340,6 +528,7 @@ ALSA_PlayDevice(_THIS)
         status = ALSA_snd_pcm_wait(this->hidden->pcm_handle, 1000);
         if (status == 0) {
             /*fprintf(stderr, "ALSA timeout waiting for available buffer space\n");*/
+            this->hidden->frames_written = 0;
             SDL_OpenedAudioDeviceDisconnected(this);
             return;
         }
@@ -354,11 +543,12 @@ ALSA_PlayDevice(_THIS)
                 SDL_Delay(1);
                 continue;
             }
-            status = ALSA_snd_pcm_recover(this->hidden->pcm_handle, status, 0);
+            status = ALSA_RecoverDevice(this, status);
             if (status < 0) {
                 /* Hmm, not much we can do - abort */
                 fprintf(stderr, "ALSA write failed (unrecoverable): %s\n",
                         ALSA_snd_strerror(status));
+                this->hidden->frames_written = 0;
                 SDL_OpenedAudioDeviceDisconnected(this);
                 return;
             }
@@ -373,15 +563,120 @@ ALSA_PlayDevice(_THIS)
 
         sample_buf += status * frame_size;
         frames_left -= status;
+        this->hidden->frames_written += status;
     }
+
+    this->hidden->frames_written = 0;
 }
 
 static Uint8 *
 ALSA_GetDeviceBuf(_THIS)
 {
+    if (this->hidden->mmap_access) {
+        /* If the next period's worth of free space is contiguous in the
+           ring buffer, let the callback render right into it. */
+        snd_pcm_t *pcm_handle = this->hidden->pcm_handle;
+        const unsigned int frame_bits = SDL_AUDIO_BITSIZE(this->spec.format) *
+                                            this->spec.channels;
+        const snd_pcm_channel_area_t *areas = NULL;
+        snd_pcm_uframes_t offset = 0;
+        snd_pcm_uframes_t frames = this->spec.samples;
+
+        this->hidden->mmap_direct = SDL_FALSE;
+        if ((ALSA_WaitForFrames(this, frames) > 0) &&
+            (ALSA_snd_pcm_mmap_begin(pcm_handle, &areas, &offset, &frames) >= 0) &&
+            (frames == this->spec.samples) &&
+            (areas[0].first == 0) && (areas[0].step == frame_bits)) {
+            this->hidden->mmap_direct = SDL_TRUE;
+            this->hidden->mmap_offset = offset;
+            this->hidden->mmap_buf = ((Uint8 *) areas[0].addr) + (offset * (frame_bits / 8));
+            return this->hidden->mmap_buf;
+        }
+    }
+
     return (this->hidden->mixbuf);
 }
 
+static void
+ALSA_GetDeviceBufferSize(_THIS, int *period_frames, int *buffer_frames)
+{
+    *period_frames = (int) this->hidden->period_size;
+    *buffer_frames = (int) this->hidden->buffer_size;
+}
+
+static int
+ALSA_GetDeviceLatency(_THIS)
+{
+    snd_pcm_sframes_t delay = 0;
+
+    /* snd_pcm_delay() counts what PlayDevice has written so far, but SDL
+       only counts the buffer once PlayDevice returns, so leave that out. */
+    if (ALSA_snd_pcm_delay(this->hidden->pcm_handle, &delay) < 0) {
+        delay = (snd_pcm_sframes_t) this->hidden->buffer_size;
+    } else if (!this->iscapture) {
+        delay -= this->hidden->frames_written;
+    }
+
+    if (delay < 0) {
+        delay = 0;
+    }
+    return (int) ((((Sint64) delay) * 1000000) / this->spec.freq);
+}
+
+/* Low-latency mode: copy whatever the hardware has captured, sleeping in
+   poll() when nothing is there yet. */
+static int
+ALSA_CaptureFromDeviceMmap(_THIS, void *buffer, int buflen)
+{
+    snd_pcm_t *pcm_handle = this->hidden->pcm_handle;
+    Uint8 *sample_buf = (Uint8 *) buffer;
+    const int frame_size = (((int) SDL_AUDIO_BITSIZE(this->spec.format)) / 8) *
+                                this->spec.channels;
+    const int total_frames = buflen / frame_size;
+    snd_pcm_uframes_t frames_left = total_frames;
+
+    SDL_assert((buflen % frame_size) == 0);
+
+    while ( frames_left > 0 && SDL_AtomicGet(&this->enabled) ) {
+        const snd_pcm_channel_area_t *areas = NULL;
+        snd_pcm_uframes_t offset = 0;
+        snd_pcm_uframes_t frames = frames_left;
+        snd_pcm_sframes_t status;
+
+        status = ALSA_WaitForFrames(this, 1);
+        if (status == 0) {
+            break;  /* device was disabled while we waited. */
+        } else if (status > 0) {
+            status = ALSA_snd_pcm_mmap_begin(pcm_handle, &areas, &offset, &frames);
+        }
+        if (status < 0) {
+            /* Hmm, not much we can do - abort */
+            fprintf(stderr, "ALSA read failed (unrecoverable): %s\n",
+                    ALSA_snd_strerror((int) status));
+            return -1;
+        }
+
+        SDL_memcpy(sample_buf,
+                   ((const Uint8 *) areas[0].addr) + (areas[0].first / 8) +
+                       (offset * (areas[0].step / 8)),
+                   frames * frame_size);
+
+        status = ALSA_snd_pcm_mmap_commit(pcm_handle, offset, frames);
+        if (status < 0) {
+            /* overrun while we were copying; this data may be torn, so retry. */
+            ALSA_RecoverDevice(this, (int) status);
+            continue;
+        }
+
+        sample_buf += frames * frame_size;
+        frames_left -= frames;
+    }
+
+    this->hidden->swizzle_func(this, buffer, total_frames - frames_left);
+
+    return (total_frames - frames_left) * frame_size;
+}
+
 static int
 ALSA_CaptureFromDevice(_THIS, void *buffer, int buflen)
 {
@@ -394,6 +689,10 @@ ALSA_CaptureFromDevice(_THIS, void *buffer, int buflen)
 
     SDL_assert((buflen % frame_size) == 0);
 
+    if (this->hidden->mmap_access) {
+        return ALSA_CaptureFromDeviceMmap(this, buffer, buflen);
+    }
+
     while ( frames_left > 0 && SDL_AtomicGet(&this->enabled) ) {
         int status;
 
@@ -406,7 +705,7 @@ ALSA_CaptureFromDevice(_THIS, void *buffer, int buflen)
         }
         else if (status < 0) {
             /*printf("ALSA: capture error %d\n", status);*/
-            status = ALSA_snd_pcm_recover(this->hidden->pcm_handle, status, 0);
+            status = ALSA_RecoverDevice(this, status);
             if (status < 0) {
                 /* Hmm, not much we can do - abort */
                 fprintf(stderr, "ALSA read failed (unrecoverable): %s\n",
@@ -444,6 +743,7 @@ ALSA_CloseDevice(_THIS)
 
         ALSA_snd_pcm_close(this->hidden->pcm_handle);
     }
+    SDL_free(this->hidden->pfds);
     SDL_free(this->hidden->mixbuf);
     SDL_free(this->hidden);
 }
@@ -472,17 +772,21 @@ ALSA_finalize_hardware(_THIS, snd_pcm_hw_params_t *hwparams, int override)
     /* !!! FIXME: Is this safe to do? */
     this->spec.samples = bufsize / 2;
 
+    /* Remember what we got, for SDL_GetAudioDeviceBufferSize(). */
+    this->hidden->buffer_size = bufsize;
+    this->hidden->period_size = this->spec.samples;
+    ALSA_snd_pcm_hw_params_get_period_size(hwparams, &this->hidden->period_size, NULL);
+
     /* This is useful for debugging */
     if ( SDL_getenv("SDL_AUDIO_ALSA_DEBUG") ) {
-        snd_pcm_uframes_t persize = 0;
         unsigned int periods = 0;
 
-        ALSA_snd_pcm_hw_params_get_period_size(hwparams, &persize, NULL);
         ALSA_snd_pcm_hw_params_get_periods(hwparams, &periods, NULL);
 
         fprintf(stderr,
-            "ALSA: period size = %ld, periods = %u, buffer size = %lu\n",
-            persize, periods, bufsize);
+            "ALSA: period size = %lu, periods = %u, buffer size = %lu%s\n",
+            this->hidden->period_size, periods, bufsize,
+            this->hidden->mmap_access ? " (low-latency mmap mode)" : "");
     }
 
     return(0);
@@ -606,9 +910,18 @@ ALSA_OpenDevice(_THIS, void *handle, const char *devname, int iscapture)
                             ALSA_snd_strerror(status));
     }
 
-    /* SDL only uses interleaved sample output */
-    status = ALSA_snd_pcm_hw_params_set_access(pcm_handle, hwparams,
-                                               SND_PCM_ACCESS_RW_INTERLEAVED);
+    /* SDL only uses interleaved sample output. In low-latency mode, try
+       to map the ring buffer, falling back to read/write if we can't. */
+    status = -1;
+    if (SDL_GetHintBoolean(SDL_HINT_AUDIO_ALSA_LOW_LATENCY, SDL_FALSE)) {
+        status = ALSA_snd_pcm_hw_params_set_access(pcm_handle, hwparams,
+                                                   SND_PCM_ACCESS_MMAP_INTERLEAVED);
+        this->hidden->mmap_access = (status >= 0) ? SDL_TRUE : SDL_FALSE;
+    }
+    if (status < 0) {
+        status = ALSA_snd_pcm_hw_params_set_access(pcm_handle, hwparams,
+                                                   SND_PCM_ACCESS_RW_INTERLEAVED);
+    }
     if (status < 0) {
         return SDL_SetError("ALSA: Couldn't set interleaved access: %s",
                      ALSA_snd_strerror(status));
@@ -738,6 +1051,24 @@ ALSA_OpenDevice(_THIS, void *handle, const char *devname, int iscapture)
                             ALSA_snd_strerror(status));
     }
 
+    /* Low-latency mode sleeps on the device's descriptors itself. */
+    if (this->hidden->mmap_access) {
+        const int nfds = ALSA_snd_pcm_poll_descriptors_count(pcm_handle);
+        if (nfds <= 0) {
+            return SDL_SetError("ALSA: Couldn't get poll descriptors");
+        }
+        this->hidden->pfds = (struct pollfd *) SDL_calloc(nfds, sizeof (struct pollfd));
+        if (this->hidden->pfds == NULL) {
+            return SDL_OutOfMemory();
+        }
+        status = ALSA_snd_pcm_poll_descriptors(pcm_handle, this->hidden->pfds, nfds);
+        if (status < 0) {
+            return SDL_SetError("ALSA: Couldn't get poll descriptors: %s",
+                                ALSA_snd_strerror(status));
+        }
+        this->hidden->nfds = status;
+    }
+
     /* Calculate the final parameters for this audio specification */
     SDL_CalculateAudioSpec(&this->spec);
 
@@ -751,7 +1082,7 @@ ALSA_OpenDevice(_THIS, void *handle, const char *devname, int iscapture)
         SDL_memset(this->hidden->mixbuf, this->spec.silence, this->hidden->mixlen);
     }
 
-    if (!iscapture) {
+    if (!iscapture && !this->hidden->mmap_access) {
         ALSA_snd_pcm_nonblock(pcm_handle, 0);
     }
 
@@ -759,6 +1090,39 @@ ALSA_OpenDevice(_THIS, void *handle, const char *devname, int iscapture)
     return 0;
 }
 
+static int
+ALSA_ResizeDevice(_THIS, int samples)
+{
+    const SDL_AudioSpec prev = this->spec;
+    snd_pcm_t *pcm_handle = this->hidden->pcm_handle;
+
+    /* The hardware parameters can't change while the PCM is running, so let
+       what we queued play out, then open the device again at the new size.
+       Asking for what we got last time gets the same format back. */
+    if (!this->iscapture) {
+        ALSA_snd_pcm_nonblock(pcm_handle, 0);
+        ALSA_snd_pcm_drain(pcm_handle);
+    }
+    ALSA_snd_pcm_close(pcm_handle);
+    SDL_free(this->hidden->pfds);
+    SDL_free(this->hidden->mixbuf);
+    SDL_free(this->hidden);
+    this->hidden = NULL;
+
+    this->spec.samples = (Uint16) samples;
+    if (ALSA_OpenDevice(this, this->handle, NULL, this->iscapture) < 0) {
+        SDL_OpenedAudioDeviceDisconnected(this);
+        return -1;
+    } else if ((this->spec.format != prev.format) ||
+               (this->spec.channels != prev.channels) ||
+               (this->spec.freq != prev.freq)) {
+        SDL_OpenedAudioDeviceDisconnected(this);
+        return SDL_SetError("ALSA: Device changed format while resizing");
+    }
+
+    return 0;
+}
+
 typedef struct ALSA_Device
 {
     char *name;
@@ -825,6 +1189,116 @@ add_device(const int iscapture, const char *name, void *hint, ALSA_Device **pSee
 static SDL_atomic_t ALSA_hotplug_shutdown;
 static SDL_Thread *ALSA_hotplug_thread;
 
+#if ALSA_HOTPLUG_INOTIFY
+/* ALSA_Deinitialize() writes to this to wake the hotplug thread. */
+static int ALSA_hotplug_pipe[2] = { -1, -1 };
+
+/* Watch /dev/snd for sound devices coming and going. Without sound
+   hardware there might not be a /dev/snd yet, so watch /dev for it. */
+static void
+ALSA_HotplugWatch(int fd, int *wd, SDL_bool *watching_snd)
+{
+    *wd = inotify_add_watch(fd, "/dev/snd", IN_CREATE | IN_DELETE | IN_ATTRIB | IN_MOVED_FROM | IN_MOVED_TO);
+    *watching_snd = (*wd >= 0) ? SDL_TRUE : SDL_FALSE;
+    if (*wd < 0) {
+        *wd = inotify_add_watch(fd, "/dev", IN_CREATE | IN_MOVED_TO);
+    }
+}
+
+/* Drain pending inotify events. Returns SDL_TRUE if any of them might
+   mean a device was added or removed. */
+static SDL_bool
+ALSA_HotplugReadEvents(int fd, int *wd, SDL_bool *watching_snd)
+{
+    /* aligned for the inotify_event structs we read out of it, as in inotify(7). */
+    char buf[1024] __attribute__((aligned(__alignof__(struct inotify_event))));
+    SDL_bool changed = SDL_FALSE;
+    ssize_t readsize;
+
+    while ((readsize = read(fd, buf, sizeof (buf))) > 0) {
+        char *p;
+        for (p = buf; p < buf + readsize; /**/) {
+            const struct inotify_event *event = (const struct inotify_event *) p;
+            if (event->mask & IN_Q_OVERFLOW) {
+                /* events were lost, so anything could have changed. If
+                   /dev/snd wasn't there, it might be now. */
+                if (!*watching_snd) {
+                    inotify_rm_watch(fd, *wd);
+                    ALSA_HotplugWatch(fd, wd, watching_snd);
+                }
+                changed = SDL_TRUE;
+            } else if (event->wd != *wd) {
+                /* left over from a watch we dropped. */
+            } else if (event->mask & IN_IGNORED) {
+                /* /dev/snd went away; go back to waiting for it. */
+                ALSA_HotplugWatch(fd, wd, watching_snd);
+                changed = SDL_TRUE;
+            } else if (*watching_snd) {
+                /* the PCM and control nodes are what enumeration looks at. */
+                if ((event->len > 0) &&
+                    ((SDL_strncmp(event->name, "pcmC", 4) == 0) ||
+                     (SDL_strncmp(event->name, "controlC", 8) == 0))) {
+                    changed = SDL_TRUE;
+                }
+            } else if ((event->len > 0) && (SDL_strcmp(event->name, "snd") == 0)) {
+                inotify_rm_watch(fd, *wd);
+                ALSA_HotplugWatch(fd, wd, watching_snd);
+                changed = SDL_TRUE;
+            }
+            p += sizeof (struct inotify_event) + event->len;
+        }
+    }
+
+    return changed;
+}
+#endif
+
+/* Block until the device list might have changed, or we're told to stop. */
+static void
+ALSA_HotplugWait(int fd, int *wd, SDL_bool *watching_snd)
+{
+    Uint32 ticks;
+
+#if ALSA_HOTPLUG_INOTIFY
+    if (ALSA_hotplug_pipe[0] >= 0) {
+        struct pollfd pfd[2];
+        const nfds_t nfds = ((fd >= 0) && (*wd >= 0)) ? 2 : 1;
+        int timeout = (nfds > 1) ? -1 : 5000;  /* no inotify? check now and then. */
+
+        pfd[0].fd = ALSA_hotplug_pipe[0];
+        pfd[0].events = POLLIN;
+        pfd[1].fd = fd;
+        pfd[1].events = POLLIN;
+
+        while (!SDL_AtomicGet(&ALSA_hotplug_shutdown)) {
+            const int rc = poll(pfd, nfds, timeout);
+            if ((rc < 0) && (errno == EINTR)) {
+                continue;
+            } else if (rc < 0) {
+                SDL_Delay(1000);  /* don't spin if poll() is broken. */
+                return;
+            } else if (rc == 0) {
+                return;
+            } else if (pfd[0].revents) {
+                return;  /* shutting down. */
+            } else if ((nfds > 1) && pfd[1].revents) {
+                /* udev makes several nodes and fixes their permissions
+                   one at a time; let it settle before looking. */
+                if (ALSA_HotplugReadEvents(fd, wd, watching_snd)) {
+                    timeout = 250;
+                }
+            }
+        }
+        return;
+    }
+#endif
+
+    ticks = SDL_GetTicks() + 5000;
+    while (!SDL_AtomicGet(&ALSA_hotplug_shutdown) && !SDL_TICKS_PASSED(SDL_GetTicks(), ticks)) {
+        SDL_Delay(100);
+    }
+}
+
 static int SDLCALL
 ALSA_HotplugThread(void *arg)
 {
@@ -832,10 +1306,26 @@ ALSA_HotplugThread(void *arg)
     ALSA_Device *devices = NULL;
     ALSA_Device *next;
     ALSA_Device *dev;
-    Uint32 ticks;
+    int fd = -1;
+    int wd = -1;
+    SDL_bool watching_snd = SDL_FALSE;
 
     SDL_SetThreadPriority(SDL_THREAD_PRIORITY_LOW);
 
+#if ALSA_HOTPLUG_INOTIFY
+    /* Start watching before the first look, so we can't miss anything. */
+    fd = inotify_init();
+    if (fd >= 0) {
+        fcntl(fd, F_SETFL, O_NONBLOCK);
+        fcntl(fd, F_SETFD, FD_CLOEXEC);
+        ALSA_HotplugWatch(fd, &wd, &watching_snd);
+        if (wd < 0) {
+            close(fd);
+            fd = -1;
+        }
+    }
+#endif
+
     while (!SDL_AtomicGet(&ALSA_hotplug_shutdown)) {
         void **hints = NULL;
         ALSA_Device *unseen;
@@ -962,12 +1452,15 @@ ALSA_HotplugThread(void *arg)
             first_run_semaphore = NULL;  /* let other thread clean it up. */
         }
 
-        /* Block awhile before checking again, unless we're told to stop. */
-        ticks = SDL_GetTicks() + 5000;
-        while (!SDL_AtomicGet(&ALSA_hotplug_shutdown) && !SDL_TICKS_PASSED(SDL_GetTicks(), ticks)) {
-            SDL_Delay(100);
-        }
+        /* Block until something changes, unless we're told to stop. */
+        ALSA_HotplugWait(fd, &wd, &watching_snd);
+    }
+
+#if ALSA_HOTPLUG_INOTIFY
+    if (fd >= 0) {
+        close(fd);
     }
+#endif
 
     /* Shutting down! Clean up any data we've gathered. */
     for (dev = devices; dev; dev = next) {
@@ -991,6 +1484,15 @@ ALSA_DetectDevices(void)
 
     SDL_AtomicSet(&ALSA_hotplug_shutdown, 0);
 
+#if ALSA_HOTPLUG_INOTIFY
+    if (pipe(ALSA_hotplug_pipe) < 0) {
+        ALSA_hotplug_pipe[0] = ALSA_hotplug_pipe[1] = -1;  /* poll instead. */
+    } else {
+        fcntl(ALSA_hotplug_pipe[0], F_SETFD, FD_CLOEXEC);
+        fcntl(ALSA_hotplug_pipe[1], F_SETFD, FD_CLOEXEC);
+    }
+#endif
+
     ALSA_hotplug_thread = SDL_CreateThread(ALSA_HotplugThread, "SDLHotplugALSA", semaphore);
     if (ALSA_hotplug_thread) {
         SDL_SemWait(semaphore);  /* wait for the first iteration to finish. */
@@ -1004,10 +1506,26 @@ ALSA_Deinitialize(void)
 {
     if (ALSA_hotplug_thread != NULL) {
         SDL_AtomicSet(&ALSA_hotplug_shutdown, 1);
+#if ALSA_HOTPLUG_INOTIFY
+        if (ALSA_hotplug_pipe[1] >= 0) {
+            const char wake = 1;
+            if (write(ALSA_hotplug_pipe[1], &wake, 1) < 0) {
+                /* the pipe can't be full; nothing else we can do anyhow. */
+            }
+        }
+#endif
         SDL_WaitThread(ALSA_hotplug_thread, NULL);
         ALSA_hotplug_thread = NULL;
     }
 
+#if ALSA_HOTPLUG_INOTIFY
+    if (ALSA_hotplug_pipe[0] >= 0) {
+        close(ALSA_hotplug_pipe[0]);
+        close(ALSA_hotplug_pipe[1]);
+        ALSA_hotplug_pipe[0] = ALSA_hotplug_pipe[1] = -1;
+    }
+#endif
+
     UnloadALSALibrary();
 }
 
@@ -1023,6 +1541,9 @@ ALSA_Init(SDL_AudioDriverImpl * impl)
     impl->OpenDevice = ALSA_OpenDevice;
     impl->WaitDevice = ALSA_WaitDevice;
     impl->GetDeviceBuf = ALSA_GetDeviceBuf;
+    impl->GetDeviceBufferSize = ALSA_GetDeviceBufferSize;
+    impl->GetDeviceLatency = ALSA_GetDeviceLatency;
+    impl->ResizeDevice = ALSA_ResizeDevice;
     impl->PlayDevice = ALSA_PlayDevice;
     impl->CloseDevice = ALSA_CloseDevice;
     impl->Deinitialize = ALSA_Deinitialize;
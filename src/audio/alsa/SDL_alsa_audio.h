@@ -24,6 +24,7 @@
 #define SDL_ALSA_audio_h_
 
 #include <alsa/asoundlib.h>
+#include <poll.h>
 
 #include "../SDL_sysaudio.h"
 
@@ -41,6 +42,23 @@ struct SDL_PrivateAudioData
 
     /* swizzle function */
     void (*swizzle_func)(_THIS, void *buffer, Uint32 bufferlen);
+
+    /* What the hardware was really configured for, in frames */
+    snd_pcm_uframes_t period_size;
+    snd_pcm_uframes_t buffer_size;
+
+    /* Low-latency mode: mmap access, sleeping in poll() */
+    SDL_bool mmap_access;
+    struct pollfd *pfds;
+    int nfds;
+
+    /* Set if GetDeviceBuf handed out a piece of the ring buffer itself */
+    SDL_bool mmap_direct;
+    snd_pcm_uframes_t mmap_offset;
+    Uint8 *mmap_buf;
+
+    /* Frames of the current buffer PlayDevice has handed over so far */
+    snd_pcm_sframes_t frames_written;
 };
 
 #endif /* SDL_ALSA_audio_h_ */
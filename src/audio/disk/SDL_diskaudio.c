@@ -29,11 +29,13 @@
 #endif
 
 #include "SDL_rwops.h"
+#include "SDL_endian.h"
 #include "SDL_timer.h"
 #include "SDL_audio.h"
 #include "../SDL_audio_c.h"
 #include "SDL_diskaudio.h"
 #include "SDL_log.h"
+#include "../../thread/SDL_systhread.h"
 
 /* !!! FIXME: these should be SDL hints, not environment variables. */
 /* environment variables and defaults. */
@@ -41,31 +43,150 @@
 #define DISKDEFAULT_OUTFILE      "sdlaudio.raw"
 #define DISKENVR_INFILE         "SDL_DISKAUDIOFILEIN"
 #define DISKDEFAULT_INFILE      "sdlaudio-in.raw"
-#define DISKENVR_IODELAY      "SDL_DISKAUDIODELAY"
+#define DISKENVR_IODELAY      "SDL_DISKAUDIODELAY"  /* "0" runs as fast as the app can keep up. */
+/* without DISKENVR_IODELAY, we run at the device's rate and honor SDL_HINT_AUDIO_SIMULATED_LOAD. */
+
+/* Output files whose names end in this get a WAV header. */
+#define DISK_WAV_EXTENSION  ".wav"
+
+/* The writer thread writes this much at a time, and the audio thread blocks
+   when this many buffers are waiting for it. */
+#define DISK_WRITE_CHUNK    (64 * 1024)
+#define DISK_QUEUED_BUFFERS 16
 
 /* This function waits until it is possible to write a full sound buffer */
 static void
 DISKAUDIO_WaitDevice(_THIS)
 {
-    SDL_Delay(this->hidden->io_delay);
+    if (this->hidden->realtime) {
+        SDL_WaitAudioClock(this, &this->hidden->clock);
+    } else if (this->hidden->io_delay > 0) {
+        SDL_Delay(this->hidden->io_delay);
+    }
+    /* with no delay, we're free-running: render as fast as we can. */
 }
 
 static void
 DISKAUDIO_PlayDevice(_THIS)
 {
-    const size_t written = SDL_RWwrite(this->hidden->io,
-                                       this->hidden->mixbuf,
-                                       1, this->spec.size);
+    struct SDL_PrivateAudioData *h = this->hidden;
+    const size_t maxqueued = this->spec.size * DISK_QUEUED_BUFFERS;
+    SDL_bool failed;
+
+    /* hand the buffer to the writer thread, waiting if it's falling behind. */
+    SDL_LockMutex(h->lock);
+    while (!h->failed && (SDL_CountDataQueue(h->queue) >= maxqueued)) {
+        SDL_CondWait(h->cond, h->lock);
+    }
+    failed = h->failed;
+    if (!failed) {
+        failed = (SDL_WriteToDataQueue(h->queue, h->mixbuf, this->spec.size) < 0) ? SDL_TRUE : SDL_FALSE;
+        SDL_CondSignal(h->cond);
+    }
+    SDL_UnlockMutex(h->lock);
 
     /* If we couldn't write, assume fatal error for now */
-    if (written != this->spec.size) {
+    if (failed) {
         SDL_OpenedAudioDeviceDisconnected(this);
     }
 #ifdef DEBUG_AUDIO
-    fprintf(stderr, "Wrote %d bytes of audio data\n", written);
+    fprintf(stderr, "Queued %d bytes of audio data\n", (int) this->spec.size);
 #endif
 }
 
+/* this runs as a thread while a playback device is open, so slow disk i/o
+   doesn't hold up the audio thread. */
+static int SDLCALL
+DISKAUDIO_WriterThread(void *data)
+{
+    struct SDL_PrivateAudioData *h = (struct SDL_PrivateAudioData *) data;
+    Uint8 *buf = (Uint8 *) SDL_malloc(DISK_WRITE_CHUNK);
+
+    SDL_LockMutex(h->lock);
+    if (buf == NULL) {
+        h->failed = SDL_TRUE;
+    }
+    while (!h->failed) {
+        size_t len;
+        if (SDL_CountDataQueue(h->queue) == 0) {
+            if (h->shutdown) {
+                break;  /* everything is written, we're done. */
+            }
+            SDL_CondWait(h->cond, h->lock);
+            continue;
+        }
+
+        len = SDL_ReadFromDataQueue(h->queue, buf, DISK_WRITE_CHUNK);
+        SDL_CondSignal(h->cond);  /* there's room for the audio thread again. */
+        SDL_UnlockMutex(h->lock);
+
+        if (SDL_RWwrite(h->io, buf, 1, len) != len) {
+            SDL_LockMutex(h->lock);
+            h->failed = SDL_TRUE;
+            SDL_CondSignal(h->cond);
+            break;
+        }
+
+        SDL_LockMutex(h->lock);
+        h->bytes_written += len;
+    }
+    SDL_UnlockMutex(h->lock);
+
+    SDL_free(buf);
+    return 0;
+}
+
+/* Write a canonical 44-byte WAV header. The sizes are placeholders until
+   DISKAUDIO_FinishWAV() knows how much data there was. */
+static int
+DISKAUDIO_WriteWAVHeader(SDL_RWops *io, const SDL_AudioSpec *spec)
+{
+    const Uint16 bits = (Uint16) SDL_AUDIO_BITSIZE(spec->format);
+    const Uint16 blockalign = (Uint16) ((bits / 8) * spec->channels);
+    const Uint16 encoding = SDL_AUDIO_ISFLOAT(spec->format) ? 0x0003 : 0x0001;  /* IEEE float or PCM */
+    size_t ok = 1;
+
+    ok &= SDL_WriteLE32(io, 0x46464952);  /* "RIFF" */
+    ok &= SDL_WriteLE32(io, 36);
+    ok &= SDL_WriteLE32(io, 0x45564157);  /* "WAVE" */
+    ok &= SDL_WriteLE32(io, 0x20746D66);  /* "fmt " */
+    ok &= SDL_WriteLE32(io, 16);
+    ok &= SDL_WriteLE16(io, encoding);
+    ok &= SDL_WriteLE16(io, spec->channels);
+    ok &= SDL_WriteLE32(io, (Uint32) spec->freq);
+    ok &= SDL_WriteLE32(io, (Uint32) (spec->freq * blockalign));
+    ok &= SDL_WriteLE16(io, blockalign);
+    ok &= SDL_WriteLE16(io, bits);
+    ok &= SDL_WriteLE32(io, 0x61746164);  /* "data" */
+    ok &= SDL_WriteLE32(io, 0);
+
+    return ok ? 0 : -1;
+}
+
+static void
+DISKAUDIO_FinishWAV(SDL_RWops *io, const Uint64 datalen)
+{
+    /* WAV sizes are 32-bit; players cope with a clamped size well enough. */
+    const Uint32 len = (datalen > 0xFFFFFFFF - 36) ? (0xFFFFFFFF - 36) : (Uint32) datalen;
+    if (SDL_RWseek(io, 4, RW_SEEK_SET) == 4) {
+        SDL_WriteLE32(io, len + 36);
+    }
+    if (SDL_RWseek(io, 40, RW_SEEK_SET) == 40) {
+        SDL_WriteLE32(io, len);
+    }
+}
+
+static int
+DISKAUDIO_GetDeviceLatency(_THIS)
+{
+    /* if we aren't pretending to be a real device, the data is in the
+       file as soon as we write it. */
+    if (this->hidden->realtime) {
+        return SDL_GetAudioClockLatency(this, &this->hidden->clock);
+    }
+    return 0;
+}
+
 static Uint8 *
 DISKAUDIO_GetDeviceBuf(_THIS)
 {
@@ -78,7 +199,11 @@ DISKAUDIO_CaptureFromDevice(_THIS, void *buffer, int buflen)
     struct SDL_PrivateAudioData *h = this->hidden;
     const int origbuflen = buflen;
 
-    SDL_Delay(h->io_delay);
+    if (h->realtime) {
+        SDL_WaitAudioClock(this, &h->clock);
+    } else if (h->io_delay > 0) {
+        SDL_Delay(h->io_delay);
+    }
 
     if (h->io) {
         const size_t br = SDL_RWread(h->io, buffer, 1, buflen);
@@ -96,6 +221,20 @@ DISKAUDIO_CaptureFromDevice(_THIS, void *buffer, int buflen)
     return origbuflen;
 }
 
+static int
+DISKAUDIO_ResizeDevice(_THIS, int samples)
+{
+    /* The writer thread takes whatever size it gets; just resize mixbuf. */
+    const Uint32 size = samples * (SDL_AUDIO_BITSIZE(this->spec.format) / 8) * this->spec.channels;
+    Uint8 *mixbuf = (Uint8 *) SDL_realloc(this->hidden->mixbuf, size);
+    if (mixbuf == NULL) {
+        return SDL_OutOfMemory();
+    }
+    this->hidden->mixbuf = mixbuf;
+    this->spec.samples = (Uint16) samples;
+    return 0;
+}
+
 static void
 DISKAUDIO_FlushCapture(_THIS)
 {
@@ -106,11 +245,52 @@ DISKAUDIO_FlushCapture(_THIS)
 static void
 DISKAUDIO_CloseDevice(_THIS)
 {
-    if (this->hidden->io != NULL) {
-        SDL_RWclose(this->hidden->io);
+    struct SDL_PrivateAudioData *h = this->hidden;
+
+    if (h->writer != NULL) {
+        const int framelen = (SDL_AUDIO_BITSIZE(this->spec.format) / 8) * this->spec.channels;
+        double secs;
+        Uint64 frames;
+
+        /* let the writer thread empty the queue, then report how it went. */
+        SDL_LockMutex(h->lock);
+        h->shutdown = SDL_TRUE;
+        SDL_CondSignal(h->cond);
+        SDL_UnlockMutex(h->lock);
+        SDL_WaitThread(h->writer, NULL);
+
+        secs = ((double) (SDL_GetPerformanceCounter() - h->start_time)) /
+                    ((double) SDL_GetPerformanceFrequency());
+        frames = h->bytes_written / framelen;
+        SDL_LogCritical(SDL_LOG_CATEGORY_AUDIO,
+                    " Wrote %" SDL_PRIu64 " frames in %.3f seconds (%.0f frames/sec, %.1fx realtime).\n",
+                    frames, secs, (secs > 0.0) ? (frames / secs) : 0.0,
+                    (secs > 0.0) ? ((frames / secs) / this->spec.freq) : 0.0);
+    }
+
+    if (h->io != NULL) {
+        if (h->wav) {
+            DISKAUDIO_FinishWAV(h->io, h->bytes_written);
+        }
+        SDL_RWclose(h->io);
     }
-    SDL_free(this->hidden->mixbuf);
-    SDL_free(this->hidden);
+    if (h->cond != NULL) {
+        SDL_DestroyCond(h->cond);
+    }
+    if (h->lock != NULL) {
+        SDL_DestroyMutex(h->lock);
+    }
+    SDL_FreeDataQueue(h->queue);
+    SDL_free(h->mixbuf);
+    SDL_free(h);
+}
+
+static SDL_bool
+is_wav_filename(const char *fname)
+{
+    const size_t len = SDL_strlen(fname);
+    const size_t extlen = SDL_strlen(DISK_WAV_EXTENSION);
+    return ((len > extlen) && (SDL_strcasecmp(fname + len - extlen, DISK_WAV_EXTENSION) == 0)) ? SDL_TRUE : SDL_FALSE;
 }
 
 
@@ -143,7 +323,8 @@ DISKAUDIO_OpenDevice(_THIS, void *handle, const char *devname, int iscapture)
     if (envr != NULL) {
         this->hidden->io_delay = SDL_atoi(envr);
     } else {
-        this->hidden->io_delay = ((this->spec.samples * 1000) / this->spec.freq);
+        this->hidden->realtime = SDL_TRUE;
+        SDL_InitAudioClock(&this->hidden->clock);
     }
 
     /* Open the audio device */
@@ -152,6 +333,22 @@ DISKAUDIO_OpenDevice(_THIS, void *handle, const char *devname, int iscapture)
         return -1;
     }
 
+    /* WAV files are little endian, 8-bit data is unsigned and 16-bit data
+       is signed; SDL converts to whatever we pick here. */
+    if (!iscapture && is_wav_filename(fname)) {
+        switch (SDL_AUDIO_BITSIZE(this->spec.format)) {
+            case 8: this->spec.format = AUDIO_U8; break;
+            case 16: this->spec.format = AUDIO_S16LSB; break;
+            default: this->spec.format = SDL_AUDIO_ISFLOAT(this->spec.format) ? AUDIO_F32LSB : AUDIO_S32LSB; break;
+        }
+        SDL_CalculateAudioSpec(&this->spec);
+
+        if (DISKAUDIO_WriteWAVHeader(this->hidden->io, &this->spec) < 0) {
+            return -1;
+        }
+        this->hidden->wav = SDL_TRUE;
+    }
+
     /* Allocate mixing buffer */
     if (!iscapture) {
         this->hidden->mixbuf = (Uint8 *) SDL_malloc(this->spec.size);
@@ -159,6 +356,19 @@ DISKAUDIO_OpenDevice(_THIS, void *handle, const char *devname, int iscapture)
             return SDL_OutOfMemory();
         }
         SDL_memset(this->hidden->mixbuf, this->spec.silence, this->spec.size);
+
+        this->hidden->queue = SDL_NewDataQueue(SDL_AUDIOBUFFERQUEUE_PACKETLEN, this->spec.size * 2);
+        this->hidden->lock = SDL_CreateMutex();
+        this->hidden->cond = SDL_CreateCond();
+        if (!this->hidden->queue || !this->hidden->lock || !this->hidden->cond) {
+            return SDL_OutOfMemory();
+        }
+
+        this->hidden->start_time = SDL_GetPerformanceCounter();
+        this->hidden->writer = SDL_CreateThreadInternal(DISKAUDIO_WriterThread, "SDLDiskAudioWriter", 64 * 1024, this->hidden);
+        if (this->hidden->writer == NULL) {
+            return -1;  /* SDL_CreateThreadInternal set the error. */
+        }
     }
 
     SDL_LogCritical(SDL_LOG_CATEGORY_AUDIO,
@@ -166,6 +376,10 @@ DISKAUDIO_OpenDevice(_THIS, void *handle, const char *devname, int iscapture)
     SDL_LogCritical(SDL_LOG_CATEGORY_AUDIO,
                 " %s file [%s].\n", iscapture ? "Reading from" : "Writing to",
                 fname);
+    if (!this->hidden->realtime && (this->hidden->io_delay == 0)) {
+        SDL_LogCritical(SDL_LOG_CATEGORY_AUDIO,
+                    " Free-running: not waiting between buffers.\n");
+    }
 
     /* We're ready to rock and roll. :-) */
     return 0;
@@ -186,6 +400,8 @@ DISKAUDIO_Init(SDL_AudioDriverImpl * impl)
     impl->WaitDevice = DISKAUDIO_WaitDevice;
     impl->PlayDevice = DISKAUDIO_PlayDevice;
     impl->GetDeviceBuf = DISKAUDIO_GetDeviceBuf;
+    impl->GetDeviceLatency = DISKAUDIO_GetDeviceLatency;
+    impl->ResizeDevice = DISKAUDIO_ResizeDevice;
     impl->CaptureFromDevice = DISKAUDIO_CaptureFromDevice;
     impl->FlushCapture = DISKAUDIO_FlushCapture;
 
@@ -24,7 +24,10 @@
 #define SDL_diskaudio_h_
 
 #include "SDL_rwops.h"
+#include "SDL_mutex.h"
+#include "SDL_thread.h"
 #include "../SDL_sysaudio.h"
+#include "../../SDL_dataqueue.h"
 
 /* Hidden "this" pointer for the audio functions */
 #define _THIS   SDL_AudioDevice *this
@@ -34,7 +37,24 @@ struct SDL_PrivateAudioData
     /* The file descriptor for the audio device */
     SDL_RWops *io;
     Uint32 io_delay;
+
+    /* Without an explicit delay, we're paced like a real device */
+    SDL_bool realtime;
+    SDL_AudioClock clock;
     Uint8 *mixbuf;
+
+    /* Playback: the audio thread queues buffers, a writer thread saves them */
+    SDL_Thread *writer;
+    SDL_mutex *lock;
+    SDL_cond *cond;
+    SDL_DataQueue *queue;
+    SDL_bool shutdown;
+    SDL_bool failed;
+
+    /* Set if writing a WAV file; its header is finished on close */
+    SDL_bool wav;
+    Uint64 bytes_written;
+    Uint64 start_time;
 };
 
 #endif /* SDL_diskaudio_h_ */
@@ -30,26 +30,88 @@
 static int
 DUMMYAUDIO_OpenDevice(_THIS, void *handle, const char *devname, int iscapture)
 {
+    this->hidden = (struct SDL_PrivateAudioData *)
+        SDL_malloc(sizeof (*this->hidden));
+    if (this->hidden == NULL) {
+        return SDL_OutOfMemory();
+    }
+    SDL_zerop(this->hidden);
+
+    if (!iscapture) {
+        this->hidden->mixlen = this->spec.size;
+        this->hidden->mixbuf = (Uint8 *) SDL_malloc(this->hidden->mixlen);
+        if (this->hidden->mixbuf == NULL) {
+            return SDL_OutOfMemory();
+        }
+    }
+
+    SDL_InitAudioClock(&this->hidden->clock);
+
     return 0;                   /* always succeeds. */
 }
 
+static void
+DUMMYAUDIO_WaitDevice(_THIS)
+{
+    /* "play" the buffer at the rate a real device would. */
+    SDL_WaitAudioClock(this, &this->hidden->clock);
+}
+
+static int
+DUMMYAUDIO_GetDeviceLatency(_THIS)
+{
+    return SDL_GetAudioClockLatency(this, &this->hidden->clock);
+}
+
+static Uint8 *
+DUMMYAUDIO_GetDeviceBuf(_THIS)
+{
+    return this->hidden->mixbuf;
+}
+
+static int
+DUMMYAUDIO_ResizeDevice(_THIS, int samples)
+{
+    const Uint32 mixlen = samples * (SDL_AUDIO_BITSIZE(this->spec.format) / 8) * this->spec.channels;
+    Uint8 *mixbuf = (Uint8 *) SDL_realloc(this->hidden->mixbuf, mixlen);
+    if (mixbuf == NULL) {
+        return SDL_OutOfMemory();
+    }
+    this->hidden->mixbuf = mixbuf;
+    this->hidden->mixlen = mixlen;
+    this->spec.samples = (Uint16) samples;
+    return 0;
+}
+
 static int
 DUMMYAUDIO_CaptureFromDevice(_THIS, void *buffer, int buflen)
 {
     /* Delay to make this sort of simulate real audio input. */
-    SDL_Delay((this->spec.samples * 1000) / this->spec.freq);
+    SDL_WaitAudioClock(this, &this->hidden->clock);
 
     /* always return a full buffer of silence. */
     SDL_memset(buffer, this->spec.silence, buflen);
     return buflen;
 }
 
+static void
+DUMMYAUDIO_CloseDevice(_THIS)
+{
+    SDL_free(this->hidden->mixbuf);
+    SDL_free(this->hidden);
+}
+
 static int
 DUMMYAUDIO_Init(SDL_AudioDriverImpl * impl)
 {
     /* Set the function pointers */
     impl->OpenDevice = DUMMYAUDIO_OpenDevice;
+    impl->WaitDevice = DUMMYAUDIO_WaitDevice;
+    impl->GetDeviceBuf = DUMMYAUDIO_GetDeviceBuf;
+    impl->GetDeviceLatency = DUMMYAUDIO_GetDeviceLatency;
+    impl->ResizeDevice = DUMMYAUDIO_ResizeDevice;
     impl->CaptureFromDevice = DUMMYAUDIO_CaptureFromDevice;
+    impl->CloseDevice = DUMMYAUDIO_CloseDevice;
 
     impl->OnlyHasDefaultOutputDevice = 1;
     impl->OnlyHasDefaultCaptureDevice = 1;
@@ -35,6 +35,9 @@ struct SDL_PrivateAudioData
     Uint32 mixlen;
     Uint32 write_delay;
     Uint32 initial_calls;
+
+    /* Paces us like a real device, optionally simulating load */
+    SDL_AudioClock clock;
 };
 
 #endif /* SDL_dummyaudio_h_ */
@@ -40,6 +40,7 @@
 #include <errno.h>
 #include <pulse/pulseaudio.h>
 
+#include "SDL_hints.h"
 #include "SDL_timer.h"
 #include "SDL_audio.h"
 #include "../SDL_audio_c.h"
@@ -76,6 +77,18 @@ static int (*PULSEAUDIO_pa_mainloop_run) (pa_mainloop *, int *);
 static void (*PULSEAUDIO_pa_mainloop_quit) (pa_mainloop *, int);
 static void (*PULSEAUDIO_pa_mainloop_free) (pa_mainloop *);
 
+static pa_threaded_mainloop * (*PULSEAUDIO_pa_threaded_mainloop_new) (void);
+static pa_mainloop_api * (*PULSEAUDIO_pa_threaded_mainloop_get_api) (
+    pa_threaded_mainloop *);
+static int (*PULSEAUDIO_pa_threaded_mainloop_start) (pa_threaded_mainloop *);
+static void (*PULSEAUDIO_pa_threaded_mainloop_stop) (pa_threaded_mainloop *);
+static void (*PULSEAUDIO_pa_threaded_mainloop_lock) (pa_threaded_mainloop *);
+static void (*PULSEAUDIO_pa_threaded_mainloop_unlock) (pa_threaded_mainloop *);
+static void (*PULSEAUDIO_pa_threaded_mainloop_wait) (pa_threaded_mainloop *);
+static void (*PULSEAUDIO_pa_threaded_mainloop_signal) (pa_threaded_mainloop *,
+    int);
+static void (*PULSEAUDIO_pa_threaded_mainloop_free) (pa_threaded_mainloop *);
+
 static pa_operation_state_t (*PULSEAUDIO_pa_operation_get_state) (
     pa_operation *);
 static void (*PULSEAUDIO_pa_operation_cancel) (pa_operation *);
@@ -92,6 +105,7 @@ static pa_operation * (*PULSEAUDIO_pa_context_get_source_info_by_index) (pa_cont
 static pa_context_state_t (*PULSEAUDIO_pa_context_get_state) (pa_context *);
 static pa_operation * (*PULSEAUDIO_pa_context_subscribe) (pa_context *, pa_subscription_mask_t, pa_context_success_cb_t, void *);
 static void (*PULSEAUDIO_pa_context_set_subscribe_callback) (pa_context *, pa_context_subscribe_cb_t, void *);
+static void (*PULSEAUDIO_pa_context_set_state_callback) (pa_context *, pa_context_notify_cb_t, void *);
 static void (*PULSEAUDIO_pa_context_disconnect) (pa_context *);
 static void (*PULSEAUDIO_pa_context_unref) (pa_context *);
 
@@ -114,6 +128,26 @@ static pa_operation * (*PULSEAUDIO_pa_stream_flush)	(pa_stream *,
     pa_stream_success_cb_t, void *);
 static int (*PULSEAUDIO_pa_stream_disconnect) (pa_stream *);
 static void (*PULSEAUDIO_pa_stream_unref) (pa_stream *);
+static void (*PULSEAUDIO_pa_stream_set_state_callback) (pa_stream *,
+    pa_stream_notify_cb_t, void *);
+static void (*PULSEAUDIO_pa_stream_set_write_callback) (pa_stream *,
+    pa_stream_request_cb_t, void *);
+static void (*PULSEAUDIO_pa_stream_set_read_callback) (pa_stream *,
+    pa_stream_request_cb_t, void *);
+static void (*PULSEAUDIO_pa_stream_set_underflow_callback) (pa_stream *,
+    pa_stream_notify_cb_t, void *);
+static void (*PULSEAUDIO_pa_stream_set_overflow_callback) (pa_stream *,
+    pa_stream_notify_cb_t, void *);
+static pa_operation * (*PULSEAUDIO_pa_stream_set_buffer_attr) (pa_stream *,
+    const pa_buffer_attr *, pa_stream_success_cb_t, void *);
+static int (*PULSEAUDIO_pa_stream_get_latency) (pa_stream *, pa_usec_t *,
+    int *);
+static const pa_buffer_attr * (*PULSEAUDIO_pa_stream_get_buffer_attr) (
+    pa_stream *);
+static size_t (*PULSEAUDIO_pa_usec_to_bytes) (pa_usec_t,
+    const pa_sample_spec *);
+static pa_usec_t (*PULSEAUDIO_pa_bytes_to_usec) (uint64_t,
+    const pa_sample_spec *);
 
 static int load_pulseaudio_syms(void);
 
@@ -196,6 +230,15 @@ load_pulseaudio_syms(void)
     SDL_PULSEAUDIO_SYM(pa_mainloop_run);
     SDL_PULSEAUDIO_SYM(pa_mainloop_quit);
     SDL_PULSEAUDIO_SYM(pa_mainloop_free);
+    SDL_PULSEAUDIO_SYM(pa_threaded_mainloop_new);
+    SDL_PULSEAUDIO_SYM(pa_threaded_mainloop_get_api);
+    SDL_PULSEAUDIO_SYM(pa_threaded_mainloop_start);
+    SDL_PULSEAUDIO_SYM(pa_threaded_mainloop_stop);
+    SDL_PULSEAUDIO_SYM(pa_threaded_mainloop_lock);
+    SDL_PULSEAUDIO_SYM(pa_threaded_mainloop_unlock);
+    SDL_PULSEAUDIO_SYM(pa_threaded_mainloop_wait);
+    SDL_PULSEAUDIO_SYM(pa_threaded_mainloop_signal);
+    SDL_PULSEAUDIO_SYM(pa_threaded_mainloop_free);
     SDL_PULSEAUDIO_SYM(pa_operation_get_state);
     SDL_PULSEAUDIO_SYM(pa_operation_cancel);
     SDL_PULSEAUDIO_SYM(pa_operation_unref);
@@ -208,6 +251,7 @@ load_pulseaudio_syms(void)
     SDL_PULSEAUDIO_SYM(pa_context_get_state);
     SDL_PULSEAUDIO_SYM(pa_context_subscribe);
     SDL_PULSEAUDIO_SYM(pa_context_set_subscribe_callback);
+    SDL_PULSEAUDIO_SYM(pa_context_set_state_callback);
     SDL_PULSEAUDIO_SYM(pa_context_disconnect);
     SDL_PULSEAUDIO_SYM(pa_context_unref);
     SDL_PULSEAUDIO_SYM(pa_stream_new);
@@ -223,6 +267,16 @@ load_pulseaudio_syms(void)
     SDL_PULSEAUDIO_SYM(pa_stream_drop);
     SDL_PULSEAUDIO_SYM(pa_stream_flush);
     SDL_PULSEAUDIO_SYM(pa_stream_unref);
+    SDL_PULSEAUDIO_SYM(pa_stream_set_state_callback);
+    SDL_PULSEAUDIO_SYM(pa_stream_set_write_callback);
+    SDL_PULSEAUDIO_SYM(pa_stream_set_read_callback);
+    SDL_PULSEAUDIO_SYM(pa_stream_set_underflow_callback);
+    SDL_PULSEAUDIO_SYM(pa_stream_set_overflow_callback);
+    SDL_PULSEAUDIO_SYM(pa_stream_set_buffer_attr);
+    SDL_PULSEAUDIO_SYM(pa_stream_get_latency);
+    SDL_PULSEAUDIO_SYM(pa_stream_get_buffer_attr);
+    SDL_PULSEAUDIO_SYM(pa_usec_to_bytes);
+    SDL_PULSEAUDIO_SYM(pa_bytes_to_usec);
     SDL_PULSEAUDIO_SYM(pa_channel_map_init_auto);
     SDL_PULSEAUDIO_SYM(pa_strerror);
     return 0;
@@ -337,23 +391,181 @@ ConnectToPulseServer(pa_mainloop **_mainloop, pa_context **_context)
 }
 
 
+/* When aiming for a latency, a device's stream lives on a threaded main
+   loop, whose thread services the server while the audio thread sleeps
+   until the server asks for more data. Everything that touches the stream
+   or context has to hold the main loop's lock; these helpers do nothing
+   for devices that use a private pa_mainloop instead. */
+static void
+ThreadedContextStateCallback(pa_context *c, void *userdata)
+{
+    PULSEAUDIO_pa_threaded_mainloop_signal((pa_threaded_mainloop *) userdata, 0);
+}
+
+static void
+ThreadedStreamStateCallback(pa_stream *s, void *userdata)
+{
+    PULSEAUDIO_pa_threaded_mainloop_signal((pa_threaded_mainloop *) userdata, 0);
+}
+
+static void
+ThreadedStreamRequestCallback(pa_stream *s, size_t nbytes, void *userdata)
+{
+    /* the server wants more data (or has some for us, if capturing). */
+    PULSEAUDIO_pa_threaded_mainloop_signal((pa_threaded_mainloop *) userdata, 0);
+}
+
+static void
+stream_operation_complete_signal(pa_stream *s, int success, void *userdata)
+{
+    PULSEAUDIO_pa_threaded_mainloop_signal((pa_threaded_mainloop *) userdata, 0);
+}
+
+static void
+StreamUnderflowCallback(pa_stream *s, void *userdata)
+{
+    /* the server ran out of data to play (or overflowed, capturing). */
+    SDL_AudioDeviceUnderrun((SDL_AudioDevice *) userdata);
+}
+
+static void
+LockPulseDevice(struct SDL_PrivateAudioData *h)
+{
+    if (h->threaded_mainloop) {
+        PULSEAUDIO_pa_threaded_mainloop_lock(h->threaded_mainloop);
+    }
+}
+
+static void
+UnlockPulseDevice(struct SDL_PrivateAudioData *h)
+{
+    if (h->threaded_mainloop) {
+        PULSEAUDIO_pa_threaded_mainloop_unlock(h->threaded_mainloop);
+    }
+}
+
+/* Wait for something to happen: one iteration of the private main loop, or
+   a signal from the threaded one's callbacks (with its lock held). */
+static int
+IteratePulseDevice(struct SDL_PrivateAudioData *h)
+{
+    if (h->threaded_mainloop) {
+        PULSEAUDIO_pa_threaded_mainloop_wait(h->threaded_mainloop);
+        return 0;
+    }
+    return PULSEAUDIO_pa_mainloop_iterate(h->mainloop, 1, NULL);
+}
+
+/* Like WaitForPulseOperation(), for an operation on a device's context. On
+   a threaded main loop, the operation's callback must signal it. */
+static void
+WaitForDeviceOperation(struct SDL_PrivateAudioData *h, pa_operation *o)
+{
+    if (!h->threaded_mainloop) {
+        WaitForPulseOperation(h->mainloop, o);
+    } else if (o) {
+        while (PULSEAUDIO_pa_operation_get_state(o) == PA_OPERATION_RUNNING) {
+            PULSEAUDIO_pa_threaded_mainloop_wait(h->threaded_mainloop);
+        }
+        PULSEAUDIO_pa_operation_unref(o);
+    }
+}
+
+static void
+DisconnectFromPulseServerThreaded(pa_threaded_mainloop *mainloop, pa_context *context)
+{
+    if (mainloop != NULL) {
+        PULSEAUDIO_pa_threaded_mainloop_stop(mainloop);
+    }
+    if (context) {
+        PULSEAUDIO_pa_context_disconnect(context);
+        PULSEAUDIO_pa_context_unref(context);
+    }
+    if (mainloop != NULL) {
+        PULSEAUDIO_pa_threaded_mainloop_free(mainloop);
+    }
+}
+
+static int
+ConnectToPulseServerThreaded_Internal(pa_threaded_mainloop **_mainloop, pa_context **_context)
+{
+    pa_threaded_mainloop *mainloop = NULL;
+    pa_context *context = NULL;
+    int state = 0;
+
+    *_mainloop = NULL;
+    *_context = NULL;
+
+    if (!(mainloop = PULSEAUDIO_pa_threaded_mainloop_new())) {
+        return SDL_SetError("pa_threaded_mainloop_new() failed");
+    }
+    *_mainloop = mainloop;
+
+    context = PULSEAUDIO_pa_context_new(PULSEAUDIO_pa_threaded_mainloop_get_api(mainloop), getAppName());
+    if (!context) {
+        return SDL_SetError("pa_context_new() failed");
+    }
+    *_context = context;
+
+    PULSEAUDIO_pa_context_set_state_callback(context, ThreadedContextStateCallback, mainloop);
+
+    /* Connect to the PulseAudio server */
+    if (PULSEAUDIO_pa_context_connect(context, NULL, 0, NULL) < 0) {
+        return SDL_SetError("Could not setup connection to PulseAudio");
+    }
+
+    if (PULSEAUDIO_pa_threaded_mainloop_start(mainloop) < 0) {
+        return SDL_SetError("pa_threaded_mainloop_start() failed");
+    }
+
+    PULSEAUDIO_pa_threaded_mainloop_lock(mainloop);
+    while (((state = PULSEAUDIO_pa_context_get_state(context)) != PA_CONTEXT_READY) && PA_CONTEXT_IS_GOOD(state)) {
+        PULSEAUDIO_pa_threaded_mainloop_wait(mainloop);
+    }
+    PULSEAUDIO_pa_threaded_mainloop_unlock(mainloop);
+
+    if (state != PA_CONTEXT_READY) {
+        return SDL_SetError("Could not connect to PulseAudio");
+    }
+
+    return 0;  /* connected and ready! */
+}
+
+static int
+ConnectToPulseServerThreaded(pa_threaded_mainloop **_mainloop, pa_context **_context)
+{
+    const int retval = ConnectToPulseServerThreaded_Internal(_mainloop, _context);
+    if (retval < 0) {
+        DisconnectFromPulseServerThreaded(*_mainloop, *_context);
+    }
+    return retval;
+}
+
+
 /* This function waits until it is possible to write a full sound buffer */
 static void
 PULSEAUDIO_WaitDevice(_THIS)
 {
     struct SDL_PrivateAudioData *h = this->hidden;
 
+    LockPulseDevice(h);
     while (SDL_AtomicGet(&this->enabled)) {
         if (PULSEAUDIO_pa_context_get_state(h->context) != PA_CONTEXT_READY ||
             PULSEAUDIO_pa_stream_get_state(h->stream) != PA_STREAM_READY ||
-            PULSEAUDIO_pa_mainloop_iterate(h->mainloop, 1, NULL) < 0) {
+            (!h->threaded_mainloop && PULSEAUDIO_pa_mainloop_iterate(h->mainloop, 1, NULL) < 0)) {
+            UnlockPulseDevice(h);
             SDL_OpenedAudioDeviceDisconnected(this);
             return;
         }
         if (PULSEAUDIO_pa_stream_writable_size(h->stream) >= h->mixlen) {
-            return;
+            break;
+        }
+        if (h->threaded_mainloop) {
+            /* sleep until the server asks for more (or the stream fails). */
+            PULSEAUDIO_pa_threaded_mainloop_wait(h->threaded_mainloop);
         }
     }
+    UnlockPulseDevice(h);
 }
 
 static void
@@ -362,7 +574,11 @@ PULSEAUDIO_PlayDevice(_THIS)
     /* Write the audio data */
     struct SDL_PrivateAudioData *h = this->hidden;
     if (SDL_AtomicGet(&this->enabled)) {
-        if (PULSEAUDIO_pa_stream_write(h->stream, h->mixbuf, h->mixlen, NULL, 0LL, PA_SEEK_RELATIVE) < 0) {
+        int rc;
+        LockPulseDevice(h);
+        rc = PULSEAUDIO_pa_stream_write(h->stream, h->mixbuf, h->mixlen, NULL, 0LL, PA_SEEK_RELATIVE);
+        UnlockPulseDevice(h);
+        if (rc < 0) {
             SDL_OpenedAudioDeviceDisconnected(this);
         }
     }
@@ -374,6 +590,97 @@ PULSEAUDIO_GetDeviceBuf(_THIS)
     return (this->hidden->mixbuf);
 }
 
+static void
+PULSEAUDIO_GetDeviceBufferSize(_THIS, int *period_frames, int *buffer_frames)
+{
+    const pa_buffer_attr *attr = &this->hidden->paattr;
+    const int framelen = (SDL_AUDIO_BITSIZE(this->spec.format) / 8) * this->spec.channels;
+
+    if (this->iscapture) {
+        *period_frames = *buffer_frames = (int) (attr->fragsize / framelen);
+    } else {
+        *period_frames = (int) (attr->minreq / framelen);
+        *buffer_frames = (int) (attr->tlength / framelen);
+    }
+}
+
+static int
+PULSEAUDIO_GetDeviceLatency(_THIS)
+{
+    struct SDL_PrivateAudioData *h = this->hidden;
+    pa_usec_t usec = 0;
+    int negative = 0;
+
+    /* Only the threaded main loop keeps timing info up to date, and we
+       can't touch a private main loop from outside the audio thread. */
+    if (h->threaded_mainloop) {
+        int rc;
+        PULSEAUDIO_pa_threaded_mainloop_lock(h->threaded_mainloop);
+        rc = PULSEAUDIO_pa_stream_get_latency(h->stream, &usec, &negative);
+        PULSEAUDIO_pa_threaded_mainloop_unlock(h->threaded_mainloop);
+        if (rc == 0) {
+            return negative ? 0 : (int) usec;
+        }
+    }
+
+    /* no timing info (yet?), assume the buffer is full. */
+    usec = PULSEAUDIO_pa_bytes_to_usec(this->iscapture ? h->paattr.fragsize : h->paattr.tlength, &h->paspec);
+    return (int) usec;
+}
+
+static int
+PULSEAUDIO_ResizeDevice(_THIS, int samples)
+{
+    struct SDL_PrivateAudioData *h = this->hidden;
+    const int mixlen = samples * (SDL_AUDIO_BITSIZE(this->spec.format) / 8) * this->spec.channels;
+    pa_buffer_attr paattr = h->paattr;
+    pa_operation *o;
+    Uint8 *mixbuf;
+
+    if (this->iscapture) {
+        return SDL_Unsupported();
+    }
+
+    /* never smaller than mixlen, in case the server refuses the new size. */
+    mixbuf = (Uint8 *) SDL_realloc(h->mixbuf, SDL_max(mixlen, h->mixlen));
+    if (mixbuf == NULL) {
+        return SDL_OutOfMemory();
+    }
+    h->mixbuf = mixbuf;
+
+    /* Same buffering rules as PULSEAUDIO_OpenDevice(), for the new size.
+       The server changes this on the fly, without reconnecting. */
+#ifdef PA_STREAM_ADJUST_LATENCY
+    paattr.tlength = mixlen * 4;
+    if (h->latency_usec > 0) {
+        paattr.tlength = SDL_max((Uint32) PULSEAUDIO_pa_usec_to_bytes(h->latency_usec, &h->paspec), (Uint32) (mixlen * 2));
+    }
+#else
+    paattr.tlength = mixlen*2;
+    paattr.prebuf = mixlen*2;
+    paattr.maxlength = mixlen*2;
+#endif
+    paattr.minreq = mixlen;
+
+    LockPulseDevice(h);
+    if (h->threaded_mainloop) {
+        o = PULSEAUDIO_pa_stream_set_buffer_attr(h->stream, &paattr, stream_operation_complete_signal, h->threaded_mainloop);
+    } else {
+        o = PULSEAUDIO_pa_stream_set_buffer_attr(h->stream, &paattr, stream_operation_complete_no_op, NULL);
+    }
+    if (o == NULL) {
+        UnlockPulseDevice(h);
+        return SDL_SetError("Could not resize PulseAudio stream");
+    }
+    WaitForDeviceOperation(h, o);
+    h->paattr = *PULSEAUDIO_pa_stream_get_buffer_attr(h->stream);
+    UnlockPulseDevice(h);
+
+    h->mixlen = mixlen;
+    this->spec.samples = (Uint16) samples;
+    return 0;
+}
+
 
 static int
 PULSEAUDIO_CaptureFromDevice(_THIS, void *buffer, int buflen)
@@ -382,6 +689,7 @@ PULSEAUDIO_CaptureFromDevice(_THIS, void *buffer, int buflen)
     const void *data = NULL;
     size_t nbytes = 0;
 
+    LockPulseDevice(h);
     while (SDL_AtomicGet(&this->enabled)) {
         if (h->capturebuf != NULL) {
             const int cpy = SDL_min(buflen, h->capturelen);
@@ -393,17 +701,23 @@ PULSEAUDIO_CaptureFromDevice(_THIS, void *buffer, int buflen)
                 h->capturebuf = NULL;
                 PULSEAUDIO_pa_stream_drop(h->stream);  /* done with this fragment. */
             }
+            UnlockPulseDevice(h);
             return cpy;  /* new data, return it. */
         }
 
         if (PULSEAUDIO_pa_context_get_state(h->context) != PA_CONTEXT_READY ||
             PULSEAUDIO_pa_stream_get_state(h->stream) != PA_STREAM_READY ||
-            PULSEAUDIO_pa_mainloop_iterate(h->mainloop, 1, NULL) < 0) {
+            (!h->threaded_mainloop && PULSEAUDIO_pa_mainloop_iterate(h->mainloop, 1, NULL) < 0)) {
+            UnlockPulseDevice(h);
             SDL_OpenedAudioDeviceDisconnected(this);
             return -1;  /* uhoh, pulse failed! */
         }
 
         if (PULSEAUDIO_pa_stream_readable_size(h->stream) == 0) {
+            if (h->threaded_mainloop) {
+                /* sleep until the server has data for us. */
+                PULSEAUDIO_pa_threaded_mainloop_wait(h->threaded_mainloop);
+            }
             continue;  /* no data available yet. */
         }
 
@@ -419,6 +733,7 @@ PULSEAUDIO_CaptureFromDevice(_THIS, void *buffer, int buflen)
             h->capturelen = nbytes;
         }
     }
+    UnlockPulseDevice(h);
 
     return -1;  /* not enabled? */
 }
@@ -428,18 +743,29 @@ PULSEAUDIO_FlushCapture(_THIS)
 {
     struct SDL_PrivateAudioData *h = this->hidden;
 
+    LockPulseDevice(h);
     if (h->capturebuf != NULL) {
         PULSEAUDIO_pa_stream_drop(h->stream);
         h->capturebuf = NULL;
         h->capturelen = 0;
     }
 
-    WaitForPulseOperation(h->mainloop, PULSEAUDIO_pa_stream_flush(h->stream, stream_operation_complete_no_op, NULL));
+    if (h->threaded_mainloop) {
+        WaitForDeviceOperation(h, PULSEAUDIO_pa_stream_flush(h->stream, stream_operation_complete_signal, h->threaded_mainloop));
+    } else {
+        WaitForDeviceOperation(h, PULSEAUDIO_pa_stream_flush(h->stream, stream_operation_complete_no_op, NULL));
+    }
+    UnlockPulseDevice(h);
 }
 
 static void
 PULSEAUDIO_CloseDevice(_THIS)
 {
+    if (this->hidden->threaded_mainloop) {
+        /* stop servicing the stream before we tear it down. */
+        PULSEAUDIO_pa_threaded_mainloop_stop(this->hidden->threaded_mainloop);
+    }
+
     if (this->hidden->stream) {
         if (this->hidden->capturebuf != NULL) {
             PULSEAUDIO_pa_stream_drop(this->hidden->stream);
@@ -448,7 +774,11 @@ PULSEAUDIO_CloseDevice(_THIS)
         PULSEAUDIO_pa_stream_unref(this->hidden->stream);
     }
 
-    DisconnectFromPulseServer(this->hidden->mainloop, this->hidden->context);
+    if (this->hidden->threaded_mainloop) {
+        DisconnectFromPulseServerThreaded(this->hidden->threaded_mainloop, this->hidden->context);
+    } else {
+        DisconnectFromPulseServer(this->hidden->mainloop, this->hidden->context);
+    }
     SDL_free(this->hidden->mixbuf);
     SDL_free(this->hidden->device_name);
     SDL_free(this->hidden);
@@ -457,18 +787,24 @@ PULSEAUDIO_CloseDevice(_THIS)
 static void
 SinkDeviceNameCallback(pa_context *c, const pa_sink_info *i, int is_last, void *data)
 {
+    struct SDL_PrivateAudioData *h = (struct SDL_PrivateAudioData *) data;
     if (i) {
-        char **devname = (char **) data;
-        *devname = SDL_strdup(i->name);
+        h->device_name = SDL_strdup(i->name);
+    }
+    if (h->threaded_mainloop) {
+        PULSEAUDIO_pa_threaded_mainloop_signal(h->threaded_mainloop, 0);
     }
 }
 
 static void
 SourceDeviceNameCallback(pa_context *c, const pa_source_info *i, int is_last, void *data)
 {
+    struct SDL_PrivateAudioData *h = (struct SDL_PrivateAudioData *) data;
     if (i) {
-        char **devname = (char **) data;
-        *devname = SDL_strdup(i->name);
+        h->device_name = SDL_strdup(i->name);
+    }
+    if (h->threaded_mainloop) {
+        PULSEAUDIO_pa_threaded_mainloop_signal(h->threaded_mainloop, 0);
     }
 }
 
@@ -482,18 +818,99 @@ FindDeviceName(struct SDL_PrivateAudioData *h, const int iscapture, void *handle
     }
 
     if (iscapture) {
-        WaitForPulseOperation(h->mainloop,
+        WaitForDeviceOperation(h,
             PULSEAUDIO_pa_context_get_source_info_by_index(h->context, idx,
-                SourceDeviceNameCallback, &h->device_name));
+                SourceDeviceNameCallback, h));
     } else {
-        WaitForPulseOperation(h->mainloop,
+        WaitForDeviceOperation(h,
             PULSEAUDIO_pa_context_get_sink_info_by_index(h->context, idx,
-                SinkDeviceNameCallback, &h->device_name));
+                SinkDeviceNameCallback, h));
     }
 
     return (h->device_name != NULL);
 }
 
+/* Set up and connect the device's stream. Called with the device locked. */
+static int
+PULSEAUDIO_ConnectStream(_THIS, void *handle, int iscapture,
+                         const pa_sample_spec *paspec,
+                         const pa_buffer_attr *paattr,
+                         pa_stream_flags_t flags)
+{
+    struct SDL_PrivateAudioData *h = this->hidden;
+    pa_channel_map pacmap;
+    int state = 0;
+    int rc = 0;
+
+    if (!FindDeviceName(h, iscapture, handle)) {
+        return SDL_SetError("Requested PulseAudio sink/source missing?");
+    }
+
+    /* The SDL ALSA output hints us that we use Windows' channel mapping */
+    /* http://bugzilla.libsdl.org/show_bug.cgi?id=110 */
+    PULSEAUDIO_pa_channel_map_init_auto(&pacmap, this->spec.channels,
+                                        PA_CHANNEL_MAP_WAVEEX);
+
+    h->stream = PULSEAUDIO_pa_stream_new(
+        h->context,
+        "Simple DirectMedia Layer", /* stream description */
+        paspec,     /* sample format spec */
+        &pacmap     /* channel map */
+        );
+
+    if (h->stream == NULL) {
+        return SDL_SetError("Could not set up PulseAudio stream");
+    }
+
+    if (h->threaded_mainloop) {
+        /* wake the audio thread when the server wants (or has) data. */
+        PULSEAUDIO_pa_stream_set_state_callback(h->stream, ThreadedStreamStateCallback, h->threaded_mainloop);
+        if (iscapture) {
+            PULSEAUDIO_pa_stream_set_read_callback(h->stream, ThreadedStreamRequestCallback, h->threaded_mainloop);
+        } else {
+            PULSEAUDIO_pa_stream_set_write_callback(h->stream, ThreadedStreamRequestCallback, h->threaded_mainloop);
+        }
+    }
+
+    if (iscapture) {
+        PULSEAUDIO_pa_stream_set_overflow_callback(h->stream, StreamUnderflowCallback, this);
+    } else {
+        PULSEAUDIO_pa_stream_set_underflow_callback(h->stream, StreamUnderflowCallback, this);
+    }
+
+    /* now that we have multi-device support, don't move a stream from
+        a device that was unplugged to something else, unless we're default. */
+    if (h->device_name != NULL) {
+        flags |= PA_STREAM_DONT_MOVE;
+    }
+
+    if (iscapture) {
+        rc = PULSEAUDIO_pa_stream_connect_record(h->stream, h->device_name, paattr, flags);
+    } else {
+        rc = PULSEAUDIO_pa_stream_connect_playback(h->stream, h->device_name, paattr, flags, NULL, NULL);
+    }
+
+    if (rc < 0) {
+        return SDL_SetError("Could not connect PulseAudio stream");
+    }
+
+    do {
+        if (IteratePulseDevice(h) < 0) {
+            return SDL_SetError("pa_mainloop_iterate() failed");
+        }
+        state = PULSEAUDIO_pa_stream_get_state(h->stream);
+        if (!PA_STREAM_IS_GOOD(state)) {
+            return SDL_SetError("Could not connect PulseAudio stream");
+        }
+    } while (state != PA_STREAM_READY);
+
+    /* Remember what the server settled on. */
+    h->paspec = *paspec;
+    h->paattr = *PULSEAUDIO_pa_stream_get_buffer_attr(h->stream);
+
+    return 0;
+}
+
 static int
 PULSEAUDIO_OpenDevice(_THIS, void *handle, const char *devname, int iscapture)
 {
@@ -501,9 +918,8 @@ PULSEAUDIO_OpenDevice(_THIS, void *handle, const char *devname, int iscapture)
     Uint16 test_format = 0;
     pa_sample_spec paspec;
     pa_buffer_attr paattr;
-    pa_channel_map pacmap;
     pa_stream_flags_t flags = 0;
-    int state = 0;
+    Uint32 latency_usec = 0;
     int rc = 0;
 
     /* Initialize all variables that we clean on shutdown */
@@ -560,6 +976,21 @@ PULSEAUDIO_OpenDevice(_THIS, void *handle, const char *devname, int iscapture)
     /* Calculate the final parameters for this audio specification */
 #ifdef PA_STREAM_ADJUST_LATENCY
     this->spec.samples /= 2; /* Mix in smaller chunck to avoid underruns */
+
+    {
+        const char *hint = SDL_GetHint(SDL_HINT_AUDIO_PULSEAUDIO_LATENCY_USEC);
+        if (hint) {
+            latency_usec = (Uint32) SDL_strtoul(hint, NULL, 10);
+        }
+    }
+    if (latency_usec > 0) {
+        /* Mix at most half the target at a time, so the server has the
+           other half to play while we mix the next chunk. */
+        const Uint32 frames = (Uint32) ((((Uint64) latency_usec) * this->spec.freq) / 1000000);
+        if (this->spec.samples > (frames / 2)) {
+            this->spec.samples = (Uint16) SDL_max(frames / 2, 1);
+        }
+    }
 #endif
     SDL_CalculateAudioSpec(&this->spec);
 
@@ -585,6 +1016,14 @@ PULSEAUDIO_OpenDevice(_THIS, void *handle, const char *devname, int iscapture)
     /* -1 can lead to pa_stream_writable_size() >= mixlen never being true */
     paattr.minreq = h->mixlen;
     flags = PA_STREAM_ADJUST_LATENCY;
+
+    if (latency_usec > 0) {
+        /* With ADJUST_LATENCY, tlength (and fragsize, for capture) is the
+           whole latency, including what the server adds itself. */
+        paattr.tlength = (Uint32) PULSEAUDIO_pa_usec_to_bytes(latency_usec, &paspec);
+        paattr.fragsize = paattr.tlength;
+        flags |= PA_STREAM_INTERPOLATE_TIMING | PA_STREAM_AUTO_TIMING_UPDATE;
+    }
 #else
     paattr.tlength = h->mixlen*2;
     paattr.prebuf = h->mixlen*2;
@@ -592,56 +1031,22 @@ PULSEAUDIO_OpenDevice(_THIS, void *handle, const char *devname, int iscapture)
     paattr.minreq = h->mixlen;
 #endif
 
-    if (ConnectToPulseServer(&h->mainloop, &h->context) < 0) {
+    h->latency_usec = latency_usec;
+    if (latency_usec > 0) {
+        if (ConnectToPulseServerThreaded(&h->threaded_mainloop, &h->context) < 0) {
+            return SDL_SetError("Could not connect to PulseAudio server");
+        }
+    } else if (ConnectToPulseServer(&h->mainloop, &h->context) < 0) {
         return SDL_SetError("Could not connect to PulseAudio server");
     }
 
-    if (!FindDeviceName(h, iscapture, handle)) {
-        return SDL_SetError("Requested PulseAudio sink/source missing?");
-    }
-
-    /* The SDL ALSA output hints us that we use Windows' channel mapping */
-    /* http://bugzilla.libsdl.org/show_bug.cgi?id=110 */
-    PULSEAUDIO_pa_channel_map_init_auto(&pacmap, this->spec.channels,
-                                        PA_CHANNEL_MAP_WAVEEX);
-
-    h->stream = PULSEAUDIO_pa_stream_new(
-        h->context,
-        "Simple DirectMedia Layer", /* stream description */
-        &paspec,    /* sample format spec */
-        &pacmap     /* channel map */
-        );
-
-    if (h->stream == NULL) {
-        return SDL_SetError("Could not set up PulseAudio stream");
-    }
-
-    /* now that we have multi-device support, don't move a stream from
-        a device that was unplugged to something else, unless we're default. */
-    if (h->device_name != NULL) {
-        flags |= PA_STREAM_DONT_MOVE;
-    }
-
-    if (iscapture) {
-        rc = PULSEAUDIO_pa_stream_connect_record(h->stream, h->device_name, &paattr, flags);
-    } else {
-        rc = PULSEAUDIO_pa_stream_connect_playback(h->stream, h->device_name, &paattr, flags, NULL, NULL);
-    }
-
+    LockPulseDevice(h);
+    rc = PULSEAUDIO_ConnectStream(this, handle, iscapture, &paspec, &paattr, flags);
+    UnlockPulseDevice(h);
     if (rc < 0) {
-        return SDL_SetError("Could not connect PulseAudio stream");
+        return rc;
     }
 
-    do {
-        if (PULSEAUDIO_pa_mainloop_iterate(h->mainloop, 1, NULL) < 0) {
-            return SDL_SetError("pa_mainloop_iterate() failed");
-        }
-        state = PULSEAUDIO_pa_stream_get_state(h->stream);
-        if (!PA_STREAM_IS_GOOD(state)) {
-            return SDL_SetError("Could not connect PulseAudio stream");
-        }
-    } while (state != PA_STREAM_READY);
-
     /* We're ready to rock and roll. :-) */
     return 0;
 }
@@ -753,6 +1158,9 @@ PULSEAUDIO_Init(SDL_AudioDriverImpl * impl)
     impl->PlayDevice = PULSEAUDIO_PlayDevice;
     impl->WaitDevice = PULSEAUDIO_WaitDevice;
     impl->GetDeviceBuf = PULSEAUDIO_GetDeviceBuf;
+    impl->GetDeviceBufferSize = PULSEAUDIO_GetDeviceBufferSize;
+    impl->GetDeviceLatency = PULSEAUDIO_GetDeviceLatency;
+    impl->ResizeDevice = PULSEAUDIO_ResizeDevice;
     impl->CloseDevice = PULSEAUDIO_CloseDevice;
     impl->Deinitialize = PULSEAUDIO_Deinitialize;
     impl->CaptureFromDevice = PULSEAUDIO_CaptureFromDevice;
@@ -36,9 +36,17 @@ struct SDL_PrivateAudioData
 
     /* pulseaudio structures */
     pa_mainloop *mainloop;
+    pa_threaded_mainloop *threaded_mainloop;  /* instead of mainloop, when aiming for a latency */
     pa_context *context;
     pa_stream *stream;
 
+    /* The latency we were asked to aim for, or zero */
+    pa_usec_t latency_usec;
+
+    /* What the stream ended up with */
+    pa_sample_spec paspec;
+    pa_buffer_attr paattr;
+
     /* Raw mixing buffer */
     Uint8 *mixbuf;
     int mixlen;
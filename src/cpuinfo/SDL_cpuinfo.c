@@ -31,6 +31,7 @@
 /* CPU feature detection for SDL */
 
 #include "SDL_cpuinfo.h"
+#include "SDL_hints.h"
 
 #ifdef HAVE_SYSCONF
 #include <unistd.h>
@@ -553,6 +554,56 @@ SDL_GetCPUCacheLineSize(void)
 
 static Uint32 SDL_CPUFeatures = 0xFFFFFFFF;
 
+#ifndef TEST_MAIN
+/* Features named in SDL_HINT_CPU_DISABLE_FEATURES. Turning one off also
+   turns off the ones that build on it, since code checking for those
+   assumes the older instructions are there too. */
+static const struct
+{
+    const char *name;
+    Uint32 mask;
+} CPU_FeatureNames[] = {
+    { "all", ~((Uint32) CPU_HAS_RDTSC) },
+    { "altivec", CPU_HAS_ALTIVEC },
+    { "mmx", CPU_HAS_MMX | CPU_HAS_3DNOW },
+    { "3dnow", CPU_HAS_3DNOW },
+    { "sse", CPU_HAS_SSE | CPU_HAS_SSE2 | CPU_HAS_SSE3 | CPU_HAS_SSE41 | CPU_HAS_SSE42 | CPU_HAS_AVX | CPU_HAS_AVX2 },
+    { "sse2", CPU_HAS_SSE2 | CPU_HAS_SSE3 | CPU_HAS_SSE41 | CPU_HAS_SSE42 | CPU_HAS_AVX | CPU_HAS_AVX2 },
+    { "sse3", CPU_HAS_SSE3 | CPU_HAS_SSE41 | CPU_HAS_SSE42 | CPU_HAS_AVX | CPU_HAS_AVX2 },
+    { "sse41", CPU_HAS_SSE41 | CPU_HAS_SSE42 | CPU_HAS_AVX | CPU_HAS_AVX2 },
+    { "sse42", CPU_HAS_SSE42 | CPU_HAS_AVX | CPU_HAS_AVX2 },
+    { "avx", CPU_HAS_AVX | CPU_HAS_AVX2 },
+    { "avx2", CPU_HAS_AVX2 },
+    { "neon", CPU_HAS_NEON }
+};
+
+static Uint32
+CPU_disabledFeatures(void)
+{
+    const char *hint = SDL_GetHint(SDL_HINT_CPU_DISABLE_FEATURES);
+    Uint32 disabled = 0;
+    int i;
+
+    while (hint && *hint) {
+        size_t len = 0;
+        while (hint[len] && (hint[len] != ',') && (hint[len] != ' ')) {
+            ++len;
+        }
+        for (i = 0; i < SDL_arraysize(CPU_FeatureNames); ++i) {
+            if ((SDL_strlen(CPU_FeatureNames[i].name) == len) &&
+                (SDL_strncasecmp(CPU_FeatureNames[i].name, hint, len) == 0)) {
+                disabled |= CPU_FeatureNames[i].mask;
+            }
+        }
+        hint += len;
+        while ((*hint == ',') || (*hint == ' ')) {
+            ++hint;
+        }
+    }
+    return disabled;
+}
+#endif
+
 static Uint32
 SDL_GetCPUFeatures(void)
 {
@@ -595,6 +646,9 @@ SDL_GetCPUFeatures(void)
         if (CPU_haveNEON()) {
             SDL_CPUFeatures |= CPU_HAS_NEON;
         }
+#ifndef TEST_MAIN
+        SDL_CPUFeatures &= ~CPU_disabledFeatures();
+#endif
     }
     return SDL_CPUFeatures;
 }
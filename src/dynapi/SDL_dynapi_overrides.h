@@ -624,3 +624,26 @@
 #define SDL_MemoryBarrierReleaseFunction SDL_MemoryBarrierReleaseFunction_REAL
 #define SDL_MemoryBarrierAcquireFunction SDL_MemoryBarrierAcquireFunction_REAL
 #define SDL_JoystickGetDeviceInstanceID SDL_JoystickGetDeviceInstanceID_REAL
+#define SDL_NewAudioMixer SDL_NewAudioMixer_REAL
+#define SDL_AudioMixerAddVoice SDL_AudioMixerAddVoice_REAL
+#define SDL_AudioMixerRemoveVoice SDL_AudioMixerRemoveVoice_REAL
+#define SDL_AudioVoicePut SDL_AudioVoicePut_REAL
+#define SDL_AudioVoiceQueued SDL_AudioVoiceQueued_REAL
+#define SDL_AudioVoiceClear SDL_AudioVoiceClear_REAL
+#define SDL_SetAudioVoiceGain SDL_SetAudioVoiceGain_REAL
+#define SDL_AudioMixerMix SDL_AudioMixerMix_REAL
+#define SDL_FreeAudioMixer SDL_FreeAudioMixer_REAL
+#define SDL_GetAudioDeviceBufferSize SDL_GetAudioDeviceBufferSize_REAL
+#define SDL_GetAudioDeviceLatency SDL_GetAudioDeviceLatency_REAL
+#define SDL_GetAudioDeviceStats SDL_GetAudioDeviceStats_REAL
+#define SDL_GetAudioDevicePosition SDL_GetAudioDevicePosition_REAL
+#define SDL_QueueAudioAt SDL_QueueAudioAt_REAL
+#define SDL_OpenWAVStream_RW SDL_OpenWAVStream_RW_REAL
+#define SDL_SetWAVStreamFormat SDL_SetWAVStreamFormat_REAL
+#define SDL_WAVStreamRead SDL_WAVStreamRead_REAL
+#define SDL_WAVStreamSeek SDL_WAVStreamSeek_REAL
+#define SDL_WAVStreamTell SDL_WAVStreamTell_REAL
+#define SDL_WAVStreamLength SDL_WAVStreamLength_REAL
+#define SDL_CloseWAVStream SDL_CloseWAVStream_REAL
+#define SDL_DequeueAudioWithTimestamp SDL_DequeueAudioWithTimestamp_REAL
+#define SDL_SoftStretchLinear SDL_SoftStretchLinear_REAL
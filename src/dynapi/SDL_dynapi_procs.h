@@ -656,3 +656,26 @@ SDL_DYNAPI_PROC(SDL_JoystickType,SDL_JoystickGetType,(SDL_Joystick *a),(a),retur
 SDL_DYNAPI_PROC(void,SDL_MemoryBarrierReleaseFunction,(void),(),)
 SDL_DYNAPI_PROC(void,SDL_MemoryBarrierAcquireFunction,(void),(),)
 SDL_DYNAPI_PROC(SDL_JoystickID,SDL_JoystickGetDeviceInstanceID,(int a),(a),return)
+SDL_DYNAPI_PROC(SDL_AudioMixer*,SDL_NewAudioMixer,(SDL_AudioFormat a, Uint8 b, int c),(a,b,c),return)
+SDL_DYNAPI_PROC(SDL_AudioVoice*,SDL_AudioMixerAddVoice,(SDL_AudioMixer *a, SDL_AudioFormat b, Uint8 c, int d),(a,b,c,d),return)
+SDL_DYNAPI_PROC(void,SDL_AudioMixerRemoveVoice,(SDL_AudioVoice *a),(a),)
+SDL_DYNAPI_PROC(int,SDL_AudioVoicePut,(SDL_AudioVoice *a, const void *b, Uint32 c),(a,b,c),return)
+SDL_DYNAPI_PROC(int,SDL_AudioVoiceQueued,(SDL_AudioVoice *a),(a),return)
+SDL_DYNAPI_PROC(void,SDL_AudioVoiceClear,(SDL_AudioVoice *a),(a),)
+SDL_DYNAPI_PROC(int,SDL_SetAudioVoiceGain,(SDL_AudioVoice *a, float b, float c),(a,b,c),return)
+SDL_DYNAPI_PROC(int,SDL_AudioMixerMix,(SDL_AudioMixer *a, void *b, Uint32 c),(a,b,c),return)
+SDL_DYNAPI_PROC(void,SDL_FreeAudioMixer,(SDL_AudioMixer *a),(a),)
+SDL_DYNAPI_PROC(int,SDL_GetAudioDeviceBufferSize,(SDL_AudioDeviceID a, int *b, int *c),(a,b,c),return)
+SDL_DYNAPI_PROC(int,SDL_GetAudioDeviceLatency,(SDL_AudioDeviceID a),(a),return)
+SDL_DYNAPI_PROC(int,SDL_GetAudioDeviceStats,(SDL_AudioDeviceID a, SDL_AudioDeviceStats *b),(a,b),return)
+SDL_DYNAPI_PROC(Sint64,SDL_GetAudioDevicePosition,(SDL_AudioDeviceID a, Uint64 *b),(a,b),return)
+SDL_DYNAPI_PROC(int,SDL_QueueAudioAt,(SDL_AudioDeviceID a, Sint64 b, const void *c, Uint32 d),(a,b,c,d),return)
+SDL_DYNAPI_PROC(SDL_WAVStream*,SDL_OpenWAVStream_RW,(SDL_RWops *a, int b, SDL_AudioSpec *c),(a,b,c),return)
+SDL_DYNAPI_PROC(int,SDL_SetWAVStreamFormat,(SDL_WAVStream *a, const SDL_AudioSpec *b),(a,b),return)
+SDL_DYNAPI_PROC(int,SDL_WAVStreamRead,(SDL_WAVStream *a, void *b, int c),(a,b,c),return)
+SDL_DYNAPI_PROC(int,SDL_WAVStreamSeek,(SDL_WAVStream *a, Sint64 b),(a,b),return)
+SDL_DYNAPI_PROC(Sint64,SDL_WAVStreamTell,(SDL_WAVStream *a),(a),return)
+SDL_DYNAPI_PROC(Sint64,SDL_WAVStreamLength,(SDL_WAVStream *a),(a),return)
+SDL_DYNAPI_PROC(void,SDL_CloseWAVStream,(SDL_WAVStream *a),(a),)
+SDL_DYNAPI_PROC(Uint32,SDL_DequeueAudioWithTimestamp,(SDL_AudioDeviceID a, void *b, Uint32 c, Uint64 *d),(a,b,c,d),return)
+SDL_DYNAPI_PROC(int,SDL_SoftStretchLinear,(SDL_Surface *a, const SDL_Rect *b, SDL_Surface *c, const SDL_Rect *d),(a,b,c,d),return)
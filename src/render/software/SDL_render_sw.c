@@ -549,6 +549,61 @@ SW_RenderFillRects(SDL_Renderer * renderer, const SDL_FRect * rects, int count)
     return status;
 }
 
+static int
+GetScaleQuality(void)
+{
+    const char *hint = SDL_GetHint(SDL_HINT_RENDER_SCALE_QUALITY);
+
+    if (!hint || *hint == '0' || SDL_strcasecmp(hint, "nearest") == 0) {
+        return 0;
+    } else {
+        return 1;
+    }
+}
+
+/* Filter the source into a surface the size of the visible part of the
+   destination rect, and blit that with the texture's blend mode and
+   modulation. */
+static int
+SW_BlitScaledLinear(SDL_Surface * src, const SDL_Rect * srcrect,
+                    SDL_Surface * surface, const SDL_Rect * final_rect)
+{
+    Uint32 format = src->format->format;
+    SDL_Surface *scaled;
+    SDL_Rect visible;
+    SDL_BlendMode blendmode;
+    Uint8 alphaMod, rMod, gMod, bMod;
+    int retval;
+
+    if (!SDL_IntersectRect(final_rect, &surface->clip_rect, &visible)) {
+        return 0;
+    }
+
+    if (src->format->BitsPerPixel != 32 || SDL_PIXELLAYOUT(format) != SDL_PACKEDLAYOUT_8888) {
+        format = SDL_PIXELFORMAT_ARGB8888;
+    }
+    scaled = SDL_CreateRGBSurfaceWithFormat(0, visible.w, visible.h, 32, format);
+    if (scaled == NULL) {
+        return -1;
+    }
+
+    SDL_GetSurfaceBlendMode(src, &blendmode);
+    SDL_GetSurfaceAlphaMod(src, &alphaMod);
+    SDL_GetSurfaceColorMod(src, &rMod, &gMod, &bMod);
+    SDL_SetSurfaceBlendMode(scaled, blendmode);
+    SDL_SetSurfaceAlphaMod(scaled, alphaMod);
+    SDL_SetSurfaceColorMod(scaled, rMod, gMod, bMod);
+
+    retval = SDL_StretchLinearPart(src, srcrect, final_rect->w, final_rect->h,
+                                   visible.x - final_rect->x, visible.y - final_rect->y,
+                                   scaled, &scaled->clip_rect);
+    if (!retval) {
+        retval = SDL_BlitSurface(scaled, NULL, surface, &visible);
+    }
+    SDL_FreeSurface(scaled);
+    return retval;
+}
+
 static int
 SW_RenderCopy(SDL_Renderer * renderer, SDL_Texture * texture,
               const SDL_Rect * srcrect, const SDL_FRect * dstrect)
@@ -573,6 +628,8 @@ SW_RenderCopy(SDL_Renderer * renderer, SDL_Texture * texture,
 
     if ( srcrect->w == final_rect.w && srcrect->h == final_rect.h ) {
         return SDL_BlitSurface(src, srcrect, surface, &final_rect);
+    } else if (GetScaleQuality()) {
+        return SW_BlitScaledLinear(src, srcrect, surface, &final_rect);
     } else {
         /* If scaling is ever done, permanently disable RLE (which doesn't support scaling)
          * to avoid potentially frequent RLE encoding/decoding.
@@ -582,18 +639,6 @@ SW_RenderCopy(SDL_Renderer * renderer, SDL_Texture * texture,
     }
 }
 
-static int
-GetScaleQuality(void)
-{
-    const char *hint = SDL_GetHint(SDL_HINT_RENDER_SCALE_QUALITY);
-
-    if (!hint || *hint == '0' || SDL_strcasecmp(hint, "nearest") == 0) {
-        return 0;
-    } else {
-        return 1;
-    }
-}
-
 static int
 SW_RenderCopyEx(SDL_Renderer * renderer, SDL_Texture * texture,
                 const SDL_Rect * srcrect, const SDL_FRect * dstrect,
@@ -700,7 +745,12 @@ SW_RenderCopyEx(SDL_Renderer * renderer, SDL_Texture * texture,
             retval = -1;
         } else {
             SDL_SetSurfaceBlendMode(src_clone, SDL_BLENDMODE_NONE);
-            retval = SDL_BlitScaled(src_clone, srcrect, src_scaled, &scale_rect);
+            if (GetScaleQuality() && !applyModulation &&
+                (srcrect->w != final_rect.w || srcrect->h != final_rect.h)) {
+                retval = SDL_SoftStretchLinear(src_clone, srcrect, src_scaled, &scale_rect);
+            } else {
+                retval = SDL_BlitScaled(src_clone, srcrect, src_scaled, &scale_rect);
+            }
             SDL_FreeSurface(src_clone);
             src_clone = src_scaled;
             src_scaled = NULL;
@@ -21,6 +21,9 @@
 #include "../SDL_internal.h"
 
 #include "SDL_video.h"
+#include "SDL_atomic.h"
+#include "SDL_hints.h"
+#include "SDL_thread.h"
 #include "SDL_sysvideo.h"
 #include "SDL_blit.h"
 #include "SDL_blit_auto.h"
@@ -29,6 +32,181 @@
 #include "SDL_RLEaccel_c.h"
 #include "SDL_pixels_c.h"
 
+/* Big blits are split into bands of rows, one per thread. The first band
+   runs on the calling thread and the rest go to a pool of worker threads,
+   which stays around until SDL_Quit(). */
+#define BLIT_MAX_THREADS 8
+#define BLIT_MIN_BAND_PIXELS (64 * 1024)
+
+typedef struct
+{
+    SDL_BlitBandFunc func;
+    void *data;
+    int y, h;
+} SDL_BlitBand;
+
+static SDL_SpinLock blit_pool_spinlock;
+static SDL_SpinLock blit_pool_busy;    /* not a mutex: blits can nest */
+static SDL_sem *blit_pool_done;
+static SDL_sem *blit_pool_start[BLIT_MAX_THREADS];
+static SDL_Thread *blit_pool_threads[BLIT_MAX_THREADS];
+static SDL_BlitBand blit_pool_bands[BLIT_MAX_THREADS];
+static int blit_pool_workers;       /* workers run bands 1 through this */
+static SDL_bool blit_pool_quit;
+
+static int SDLCALL
+SDL_BlitWorker(void *data)
+{
+    const int i = (int) (size_t) data;
+
+    for (;;) {
+        SDL_SemWait(blit_pool_start[i]);
+        if (blit_pool_quit) {
+            break;
+        }
+        blit_pool_bands[i].func(blit_pool_bands[i].data,
+                                blit_pool_bands[i].y, blit_pool_bands[i].h);
+        SDL_SemPost(blit_pool_done);
+    }
+    return 0;
+}
+
+static SDL_bool
+SDL_SurfacePixelsOverlap(SDL_Surface * src, SDL_Surface * dst)
+{
+    const Uint8 *srcpixels = (const Uint8 *) src->pixels;
+    const Uint8 *dstpixels = (const Uint8 *) dst->pixels;
+
+    return ((srcpixels < dstpixels + dst->h * dst->pitch) &&
+            (dstpixels < srcpixels + src->h * src->pitch)) ? SDL_TRUE : SDL_FALSE;
+}
+
+void
+SDL_RunBlitBands(SDL_Surface * src, SDL_Surface * dst, int rows, int width,
+                 SDL_BlitBandFunc func, void *data)
+{
+    const char *hint;
+    int numbands = (int) SDL_min(rows, ((Sint64) rows * width) / BLIT_MIN_BAND_PIXELS);
+    int i, y;
+
+    /* Most blits are too small to split, so don't look up the hint for them */
+    if (numbands > 1) {
+        hint = SDL_GetHint(SDL_HINT_BLIT_THREADS);
+        numbands = SDL_min(numbands, (hint && *hint) ? SDL_atoi(hint) : SDL_GetCPUCount());
+        numbands = SDL_min(numbands, BLIT_MAX_THREADS);
+    }
+
+    /* Blitting a surface onto itself depends on the order rows are done in */
+    if ((numbands <= 1) || SDL_SurfacePixelsOverlap(src, dst)) {
+        func(data, 0, rows);
+        return;
+    }
+
+    SDL_AtomicLock(&blit_pool_spinlock);
+    if (!blit_pool_done) {
+        blit_pool_done = SDL_CreateSemaphore(0);
+    }
+    SDL_AtomicUnlock(&blit_pool_spinlock);
+
+    /* If the pool is busy with another blit, maybe one that this blit is
+       part of, don't wait for it. */
+    if (!blit_pool_done || !SDL_AtomicTryLock(&blit_pool_busy)) {
+        func(data, 0, rows);
+        return;
+    }
+
+    while (blit_pool_workers < (numbands - 1)) {
+        i = blit_pool_workers + 1;
+        blit_pool_start[i] = SDL_CreateSemaphore(0);
+        if (!blit_pool_start[i]) {
+            break;
+        }
+        blit_pool_threads[i] = SDL_CreateThread(SDL_BlitWorker, "SDLBlit", (void *) (size_t) i);
+        if (!blit_pool_threads[i]) {
+            SDL_DestroySemaphore(blit_pool_start[i]);
+            blit_pool_start[i] = NULL;
+            break;
+        }
+        blit_pool_workers = i;
+    }
+    numbands = SDL_min(numbands, blit_pool_workers + 1);
+
+    for (i = 0, y = 0; i < numbands; i++) {
+        /* spread any leftover rows over the first few bands. */
+        const int h = (rows / numbands) + ((i < (rows % numbands)) ? 1 : 0);
+        blit_pool_bands[i].func = func;
+        blit_pool_bands[i].data = data;
+        blit_pool_bands[i].y = y;
+        blit_pool_bands[i].h = h;
+        y += h;
+    }
+
+    for (i = 1; i < numbands; i++) {
+        SDL_SemPost(blit_pool_start[i]);
+    }
+    func(data, blit_pool_bands[0].y, blit_pool_bands[0].h);
+    for (i = 1; i < numbands; i++) {
+        SDL_SemWait(blit_pool_done);
+    }
+
+    SDL_AtomicUnlock(&blit_pool_busy);
+}
+
+void
+SDL_QuitBlitThreads(void)
+{
+    int i;
+
+    SDL_AtomicLock(&blit_pool_busy);
+    if (blit_pool_workers > 0) {
+        blit_pool_quit = SDL_TRUE;
+        for (i = 1; i <= blit_pool_workers; i++) {
+            SDL_SemPost(blit_pool_start[i]);
+        }
+        for (i = 1; i <= blit_pool_workers; i++) {
+            SDL_WaitThread(blit_pool_threads[i], NULL);
+            SDL_DestroySemaphore(blit_pool_start[i]);
+            blit_pool_threads[i] = NULL;
+            blit_pool_start[i] = NULL;
+        }
+        blit_pool_workers = 0;
+        blit_pool_quit = SDL_FALSE;
+    }
+    if (blit_pool_done) {
+        SDL_DestroySemaphore(blit_pool_done);
+        blit_pool_done = NULL;
+    }
+    SDL_AtomicUnlock(&blit_pool_busy);
+}
+
+typedef struct
+{
+    SDL_BlitFunc func;
+    const SDL_BlitInfo *info;
+} SDL_SoftBlitData;
+
+static void
+SDL_SoftBlitBand(void *data, int y, int h)
+{
+    const SDL_SoftBlitData *blit = (const SDL_SoftBlitData *) data;
+    SDL_BlitInfo info = *blit->info;   /* the blitters step through this */
+
+    if (info.flags & SDL_COPY_NEAREST) {
+        /* Start where a scaled blit of the whole rect would be at row y */
+        const Sint64 pos = (Sint64) y * info.src_incy;
+        info.src += (int) (pos >> 16) * info.src_pitch;
+        info.src_h -= (int) (pos >> 16);
+        info.src_posy = (int) (pos & 0xFFFF);
+    } else {
+        info.src += y * info.src_pitch;
+        info.src_h = h;
+    }
+    info.dst += y * info.dst_pitch;
+    info.dst_h = h;
+
+    blit->func(&info);
+}
+
 /* The general purpose software blit routine */
 static int
 SDL_SoftBlit(SDL_Surface * src, SDL_Rect * srcrect,
@@ -62,7 +240,7 @@ SDL_SoftBlit(SDL_Surface * src, SDL_Rect * srcrect,
 
     /* Set up source and destination buffer pointers, and BLIT! */
     if (okay && !SDL_RectEmpty(srcrect)) {
-        SDL_BlitFunc RunBlit;
+        SDL_SoftBlitData blit;
         SDL_BlitInfo *info = &src->map->info;
 
         /* Set up the blit information */
@@ -82,10 +260,14 @@ SDL_SoftBlit(SDL_Surface * src, SDL_Rect * srcrect,
         info->dst_pitch = dst->pitch;
         info->dst_skip =
             info->dst_pitch - info->dst_w * info->dst_fmt->BytesPerPixel;
-        RunBlit = (SDL_BlitFunc) src->map->data;
+        info->src_posy = 0;
+        info->src_incy = info->dst_h ? ((info->src_h << 16) / info->dst_h) : 0;
+        blit.func = (SDL_BlitFunc) src->map->data;
+        blit.info = info;
 
         /* Run the actual software blit */
-        RunBlit(info);
+        SDL_RunBlitBands(src, dst, info->dst_h, info->dst_w,
+                         SDL_SoftBlitBand, &blit);
     }
 
     /* We need to unlock the surfaces if they're locked */
@@ -153,6 +335,12 @@ SDL_ChooseBlitFunc(Uint32 src_format, Uint32 dst_format, int flags,
             if (SDL_HasSSE2()) {
                 features |= SDL_CPU_SSE2;
             }
+            if (SDL_HasAVX2()) {
+                features |= SDL_CPU_AVX2;
+            }
+            if (SDL_HasNEON()) {
+                features |= SDL_CPU_NEON;
+            }
             if (SDL_HasAltiVec()) {
                 if (SDL_UseAltivecPrefetch()) {
                     features |= SDL_CPU_ALTIVEC_PREFETCH;
@@ -211,38 +399,83 @@ SDL_ChooseBlitFunc(Uint32 src_format, Uint32 dst_format, int flags,
     return NULL;
 }
 
-/* Figure out which of many blit routines to set up on a surface */
-int
-SDL_CalculateBlit(SDL_Surface * surface)
+/* Choosing a blit function goes through a lot of tests and table lookups,
+   and a surface whose color or alpha mod changes every draw chooses one
+   every time. The choice only depends on the pixel formats, the copy flags
+   and whether the mapping is an identity, so the last few choices are kept
+   here, most recently used first. */
+#define BLIT_CACHE_SIZE 16
+
+typedef struct
 {
-    SDL_BlitFunc blit = NULL;
-    SDL_BlitMap *map = surface->map;
-    SDL_Surface *dst = map->dst;
+    Uint32 src_format;
+    Uint32 dst_format;
+    int flags;
+    int identity;
+    SDL_BlitFunc func;
+} SDL_BlitCacheEntry;
 
-    /* We don't currently support blitting to < 8 bpp surfaces */
-    if (dst->format->BitsPerPixel < 8) {
-        SDL_InvalidateMap(map);
-        return SDL_SetError("Blit combination not supported");
-    }
+static SDL_SpinLock blit_cache_lock;
+static SDL_BlitCacheEntry blit_cache[BLIT_CACHE_SIZE];
+static int blit_cache_count;
 
-    /* Clean everything out to start */
-    if ((surface->flags & SDL_RLEACCEL) == SDL_RLEACCEL) {
-        SDL_UnRLESurface(surface, 1);
+static SDL_BlitFunc
+SDL_GetCachedBlit(Uint32 src_format, Uint32 dst_format, int flags, int identity)
+{
+    SDL_BlitFunc func = NULL;
+    int i;
+
+    SDL_AtomicLock(&blit_cache_lock);
+    for (i = 0; i < blit_cache_count; ++i) {
+        const SDL_BlitCacheEntry *entry = &blit_cache[i];
+        if (entry->src_format == src_format && entry->dst_format == dst_format &&
+            entry->flags == flags && entry->identity == identity) {
+            const SDL_BlitCacheEntry found = *entry;
+            SDL_memmove(&blit_cache[1], &blit_cache[0], i * sizeof(blit_cache[0]));
+            blit_cache[0] = found;
+            func = found.func;
+            break;
+        }
     }
-    map->blit = SDL_SoftBlit;
-    map->info.src_fmt = surface->format;
-    map->info.src_pitch = surface->pitch;
-    map->info.dst_fmt = dst->format;
-    map->info.dst_pitch = dst->pitch;
+    SDL_AtomicUnlock(&blit_cache_lock);
+    return func;
+}
 
-    /* See if we can do RLE acceleration */
-    if (map->info.flags & SDL_COPY_RLE_DESIRED) {
-        if (SDL_RLESurface(surface) == 0) {
-            return 0;
-        }
+static void
+SDL_CacheBlit(Uint32 src_format, Uint32 dst_format, int flags, int identity,
+              SDL_BlitFunc func)
+{
+    SDL_AtomicLock(&blit_cache_lock);
+    if (blit_cache_count < BLIT_CACHE_SIZE) {
+        ++blit_cache_count;
     }
+    SDL_memmove(&blit_cache[1], &blit_cache[0], (blit_cache_count - 1) * sizeof(blit_cache[0]));
+    blit_cache[0].src_format = src_format;
+    blit_cache[0].dst_format = dst_format;
+    blit_cache[0].flags = flags;
+    blit_cache[0].identity = identity;
+    blit_cache[0].func = func;
+    SDL_AtomicUnlock(&blit_cache_lock);
+}
+
+void
+SDL_QuitBlitCache(void)
+{
+    SDL_AtomicLock(&blit_cache_lock);
+    blit_cache_count = 0;
+    SDL_AtomicUnlock(&blit_cache_lock);
+
+    SDL_QuitMapCache();
+}
+
+/* Pick a blit function for the surface's current mapping */
+static SDL_BlitFunc
+SDL_ChooseBlit(SDL_Surface * surface)
+{
+    SDL_BlitFunc blit = NULL;
+    SDL_BlitMap *map = surface->map;
+    SDL_Surface *dst = map->dst;
 
-    /* Choose a standard blit function */
     if (map->identity && !(map->info.flags & ~SDL_COPY_RLE_DESIRED)) {
         blit = SDL_BlitCopy;
     } else if (surface->format->BitsPerPixel < 8 &&
@@ -278,6 +511,55 @@ SDL_CalculateBlit(SDL_Surface * surface)
             blit = SDL_Blit_Slow;
         }
     }
+    return blit;
+}
+
+/* Figure out which of many blit routines to set up on a surface */
+int
+SDL_CalculateBlit(SDL_Surface * surface)
+{
+    SDL_BlitFunc blit = NULL;
+    SDL_BlitMap *map = surface->map;
+    SDL_Surface *dst = map->dst;
+    Uint32 src_format, dst_format;
+
+    /* We don't currently support blitting to < 8 bpp surfaces */
+    if (dst->format->BitsPerPixel < 8) {
+        SDL_InvalidateMap(map);
+        return SDL_SetError("Blit combination not supported");
+    }
+
+    /* Clean everything out to start */
+    if ((surface->flags & SDL_RLEACCEL) == SDL_RLEACCEL) {
+        SDL_UnRLESurface(surface, 1);
+    }
+    map->blit = SDL_SoftBlit;
+    map->info.src_fmt = surface->format;
+    map->info.src_pitch = surface->pitch;
+    map->info.dst_fmt = dst->format;
+    map->info.dst_pitch = dst->pitch;
+
+    /* See if we can do RLE acceleration */
+    if (map->info.flags & SDL_COPY_RLE_DESIRED) {
+        if (SDL_RLESurface(surface) == 0) {
+            return 0;
+        }
+    }
+
+    /* Choose a standard blit function, or the one we chose last time */
+    src_format = surface->format->format;
+    dst_format = dst->format->format;
+    if (src_format == SDL_PIXELFORMAT_UNKNOWN || dst_format == SDL_PIXELFORMAT_UNKNOWN) {
+        blit = SDL_ChooseBlit(surface);
+    } else {
+        blit = SDL_GetCachedBlit(src_format, dst_format, map->info.flags, map->identity);
+        if (blit == NULL) {
+            blit = SDL_ChooseBlit(surface);
+            if (blit) {
+                SDL_CacheBlit(src_format, dst_format, map->info.flags, map->identity, blit);
+            }
+        }
+    }
     map->data = blit;
 
     /* Make sure we have a blit function */
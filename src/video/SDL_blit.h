@@ -27,6 +27,68 @@
 #include "SDL_endian.h"
 #include "SDL_surface.h"
 
+#ifdef __SSE2__
+#define HAVE_SSE2_INTRINSICS 1
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define HAVE_NEON_INTRINSICS 1
+#include <arm_neon.h>
+#endif
+
+/* The SSE4.1, AVX and AVX2 code is compiled with a function-level target
+   attribute, so it's available even when SDL itself is built for a
+   baseline x86 CPU, and is only chosen after SDL_HasSSE41(), SDL_HasAVX()
+   or SDL_HasAVX2() says the CPU can run it. */
+#if defined(__SSE4_1__)
+#define HAVE_SSE41_INTRINSICS 1
+#define SDL_TARGETING_SSE41
+#elif (defined(__i386__) || defined(__x86_64__)) && defined(__clang__)
+#if (__clang_major__ > 3) || ((__clang_major__ == 3) && (__clang_minor__ >= 8))
+#define HAVE_SSE41_INTRINSICS 1
+#define SDL_TARGETING_SSE41 __attribute__((target("sse4.1")))
+#endif
+#elif (defined(__i386__) || defined(__x86_64__)) && defined(__GNUC__)
+#if (__GNUC__ > 4) || ((__GNUC__ == 4) && (__GNUC_MINOR__ >= 9))
+#define HAVE_SSE41_INTRINSICS 1
+#define SDL_TARGETING_SSE41 __attribute__((target("sse4.1")))
+#endif
+#endif
+
+#if defined(__AVX__)
+#define HAVE_AVX_INTRINSICS 1
+#define SDL_TARGETING_AVX
+#elif (defined(__i386__) || defined(__x86_64__)) && defined(__clang__)
+#if (__clang_major__ > 3) || ((__clang_major__ == 3) && (__clang_minor__ >= 8))
+#define HAVE_AVX_INTRINSICS 1
+#define SDL_TARGETING_AVX __attribute__((target("avx")))
+#endif
+#elif (defined(__i386__) || defined(__x86_64__)) && defined(__GNUC__)
+#if (__GNUC__ > 4) || ((__GNUC__ == 4) && (__GNUC_MINOR__ >= 9))
+#define HAVE_AVX_INTRINSICS 1
+#define SDL_TARGETING_AVX __attribute__((target("avx")))
+#endif
+#endif
+
+#if defined(__AVX2__)
+#define HAVE_AVX2_INTRINSICS 1
+#define SDL_TARGETING_AVX2
+#elif (defined(__i386__) || defined(__x86_64__)) && defined(__clang__)
+#if (__clang_major__ > 3) || ((__clang_major__ == 3) && (__clang_minor__ >= 8))
+#define HAVE_AVX2_INTRINSICS 1
+#define SDL_TARGETING_AVX2 __attribute__((target("avx2")))
+#endif
+#elif (defined(__i386__) || defined(__x86_64__)) && defined(__GNUC__)
+#if (__GNUC__ > 4) || ((__GNUC__ == 4) && (__GNUC_MINOR__ >= 9))
+#define HAVE_AVX2_INTRINSICS 1
+#define SDL_TARGETING_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+#if HAVE_SSE41_INTRINSICS || HAVE_AVX_INTRINSICS || HAVE_AVX2_INTRINSICS
+#include <immintrin.h>
+#endif
+
 /* Table to do pixel byte expansion */
 extern Uint8* SDL_expand_byte[9];
 
@@ -51,6 +113,8 @@ extern Uint8* SDL_expand_byte[9];
 #define SDL_CPU_SSE2                0x00000008
 #define SDL_CPU_ALTIVEC_PREFETCH    0x00000010
 #define SDL_CPU_ALTIVEC_NOPREFETCH  0x00000020
+#define SDL_CPU_AVX2                0x00000040
+#define SDL_CPU_NEON                0x00000080
 
 typedef struct
 {
@@ -58,6 +122,7 @@ typedef struct
     int src_w, src_h;
     int src_pitch;
     int src_skip;
+    int src_posy, src_incy;     /* 16.16 source row stepping, for scaled blits */
     Uint8 *dst;
     int dst_w, dst_h;
     int dst_pitch;
@@ -99,6 +164,26 @@ typedef struct SDL_BlitMap
 /* Functions found in SDL_blit.c */
 extern int SDL_CalculateBlit(SDL_Surface * surface);
 
+/* Runs func over (rows) rows of a (width) pixel wide blit from src to dst,
+   splitting big blits into bands of rows that run on several threads.
+   Each call gets the first row and the number of rows in its band. */
+typedef void (*SDL_BlitBandFunc) (void *data, int y, int h);
+extern void SDL_RunBlitBands(SDL_Surface * src, SDL_Surface * dst,
+                             int rows, int width,
+                             SDL_BlitBandFunc func, void *data);
+extern void SDL_QuitBlitThreads(void);
+
+/* Forgets the blit functions and tables remembered by SDL_MapSurface() */
+extern void SDL_QuitBlitCache(void);
+
+/* Functions found in SDL_stretch.c */
+/* Does what SDL_SoftStretchLinear() would do stretching srcrect to a
+   full_w by full_h rect, but only for the part of it at (x, y) the size
+   of dstrect, which goes to dstrect. The rects aren't checked. */
+extern int SDL_StretchLinearPart(SDL_Surface * src, const SDL_Rect * srcrect,
+                                 int full_w, int full_h, int x, int y,
+                                 SDL_Surface * dst, const SDL_Rect * dstrect);
+
 /* Functions found in SDL_blit_*.c */
 extern SDL_BlitFunc SDL_CalculateBlit0(SDL_Surface * surface);
 extern SDL_BlitFunc SDL_CalculateBlit1(SDL_Surface * surface);
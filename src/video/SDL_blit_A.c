@@ -456,6 +456,30 @@ BlitRGBtoRGBSurfaceAlpha(SDL_BlitInfo * info)
     }
 }
 
+/* ARGB888->(A)RGB888 blend of one pixel with 0 < alpha < 255. The SIMD
+   blitters below use this for leftover pixels, and match it exactly. */
+static SDL_INLINE Uint32
+BlendRGBtoRGBPixel(Uint32 s, Uint32 d)
+{
+    Uint32 alpha = s >> 24;
+    Uint32 dalpha = d >> 24;
+    Uint32 s1;
+    Uint32 d1;
+
+    /*
+     * take out the middle component (green), and process
+     * the other two in parallel. One multiply less.
+     */
+    s1 = s & 0xff00ff;
+    d1 = d & 0xff00ff;
+    d1 = (d1 + ((s1 - d1) * alpha >> 8)) & 0xff00ff;
+    s &= 0xff00;
+    d &= 0xff00;
+    d = (d + ((s - d) * alpha >> 8)) & 0xff00;
+    dalpha = alpha + (dalpha * (alpha ^ 0xFF) >> 8);
+    return d1 | d | (dalpha << 24);
+}
+
 /* fast ARGB888->(A)RGB888 blending with pixel alpha */
 static void
 BlitRGBtoRGBPixelAlpha(SDL_BlitInfo * info)
@@ -470,10 +494,6 @@ BlitRGBtoRGBPixelAlpha(SDL_BlitInfo * info)
     while (height--) {
 	    /* *INDENT-OFF* */
 	    DUFFS_LOOP4({
-		Uint32 dalpha;
-		Uint32 d;
-		Uint32 s1;
-		Uint32 d1;
 		Uint32 s = *srcp;
 		Uint32 alpha = s >> 24;
 		/* FIXME: Here we special-case opaque alpha since the
@@ -484,20 +504,7 @@ BlitRGBtoRGBPixelAlpha(SDL_BlitInfo * info)
 		  if (alpha == SDL_ALPHA_OPAQUE) {
 			  *dstp = *srcp;
 		  } else {
-		    /*
-		     * take out the middle component (green), and process
-		     * the other two in parallel. One multiply less.
-		     */
-		    d = *dstp;
-			dalpha = d >> 24;
-		    s1 = s & 0xff00ff;
-		    d1 = d & 0xff00ff;
-		    d1 = (d1 + ((s1 - d1) * alpha >> 8)) & 0xff00ff;
-		    s &= 0xff00;
-		    d &= 0xff00;
-		    d = (d + ((s - d) * alpha >> 8)) & 0xff00;
-			dalpha = alpha + (dalpha * (alpha ^ 0xFF) >> 8);
-		    *dstp = d1 | d | (dalpha << 24);
+			  *dstp = BlendRGBtoRGBPixel(s, *dstp);
 		  }
 		}
 		++srcp;
@@ -509,6 +516,224 @@ BlitRGBtoRGBPixelAlpha(SDL_BlitInfo * info)
     }
 }
 
+/* Leftover pixels for the SIMD blitters below. */
+static SDL_INLINE void
+BlitRGBtoRGBPixelAlphaTail(const Uint32 *srcp, Uint32 *dstp, int n)
+{
+    while (n--) {
+        const Uint32 s = *srcp++;
+        const Uint32 alpha = s >> 24;
+        if (alpha == SDL_ALPHA_OPAQUE) {
+            *dstp = s;
+        } else if (alpha) {
+            *dstp = BlendRGBtoRGBPixel(s, *dstp);
+        }
+        ++dstp;
+    }
+}
+
+/* The SIMD versions of BlitRGBtoRGBPixelAlpha() compute each color channel
+   as d + ((s - d) * alpha >> 8) in 16-bit lanes. The products can wrap, but
+   only the low byte of the sum is kept, and that comes out the same as the
+   scalar code's. Destination alpha is alpha + (dalpha * (255 - alpha) >> 8),
+   and fully transparent and fully opaque pixels are special-cased, as in
+   the scalar code. */
+
+#if HAVE_SSE41_INTRINSICS
+/* fast ARGB888->(A)RGB888 blending with pixel alpha, four pixels at once */
+static void SDL_TARGETING_SSE41
+BlitRGBtoRGBPixelAlphaSSE41(SDL_BlitInfo * info)
+{
+    int width = info->dst_w;
+    int height = info->dst_h;
+    Uint32 *srcp = (Uint32 *) info->src;
+    int srcskip = info->src_skip >> 2;
+    Uint32 *dstp = (Uint32 *) info->dst;
+    int dstskip = info->dst_skip >> 2;
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i opaque = _mm_set1_epi32(0xff);
+    const __m128i rgbmask = _mm_set1_epi32(0x00ffffff);
+    const __m128i lowbytes = _mm_set1_epi16(0x00ff);
+    const __m128i alphashuffle = _mm_setr_epi8(3, 3, 3, 3, 7, 7, 7, 7,
+                                               11, 11, 11, 11, 15, 15, 15, 15);
+
+    while (height--) {
+        int n = width;
+        while (n >= 4) {
+            const __m128i s = _mm_loadu_si128((const __m128i *) srcp);
+            const __m128i alpha = _mm_srli_epi32(s, 24);
+            const __m128i transparent = _mm_cmpeq_epi32(alpha, zero);
+            const __m128i solid = _mm_cmpeq_epi32(alpha, opaque);
+
+            if (_mm_movemask_epi8(solid) == 0xFFFF) {
+                _mm_storeu_si128((__m128i *) dstp, s);
+            } else if (_mm_movemask_epi8(transparent) != 0xFFFF) {
+                const __m128i d = _mm_loadu_si128((const __m128i *) dstp);
+                const __m128i a8 = _mm_shuffle_epi8(s, alphashuffle);
+                __m128i lo, hi, dalpha, result;
+
+                /* color: d + ((s - d) * alpha >> 8), keeping the low byte */
+                lo = _mm_unpacklo_epi8(d, zero);
+                lo = _mm_add_epi16(lo, _mm_srli_epi16(_mm_mullo_epi16(
+                         _mm_sub_epi16(_mm_unpacklo_epi8(s, zero), lo),
+                         _mm_unpacklo_epi8(a8, zero)), 8));
+                hi = _mm_unpackhi_epi8(d, zero);
+                hi = _mm_add_epi16(hi, _mm_srli_epi16(_mm_mullo_epi16(
+                         _mm_sub_epi16(_mm_unpackhi_epi8(s, zero), hi),
+                         _mm_unpackhi_epi8(a8, zero)), 8));
+                result = _mm_packus_epi16(_mm_and_si128(lo, lowbytes),
+                                          _mm_and_si128(hi, lowbytes));
+
+                /* alpha: alpha + (dalpha * (255 - alpha) >> 8) */
+                dalpha = _mm_mullo_epi32(_mm_srli_epi32(d, 24), _mm_xor_si128(alpha, opaque));
+                dalpha = _mm_add_epi32(alpha, _mm_srli_epi32(dalpha, 8));
+                result = _mm_or_si128(_mm_and_si128(result, rgbmask), _mm_slli_epi32(dalpha, 24));
+
+                result = _mm_blendv_epi8(result, d, transparent);
+                result = _mm_blendv_epi8(result, s, solid);
+                _mm_storeu_si128((__m128i *) dstp, result);
+            }
+            srcp += 4;
+            dstp += 4;
+            n -= 4;
+        }
+        BlitRGBtoRGBPixelAlphaTail(srcp, dstp, n);
+        srcp += n + srcskip;
+        dstp += n + dstskip;
+    }
+}
+#endif /* HAVE_SSE41_INTRINSICS */
+
+#if HAVE_AVX2_INTRINSICS
+/* fast ARGB888->(A)RGB888 blending with pixel alpha, eight pixels at once */
+static void SDL_TARGETING_AVX2
+BlitRGBtoRGBPixelAlphaAVX2(SDL_BlitInfo * info)
+{
+    int width = info->dst_w;
+    int height = info->dst_h;
+    Uint32 *srcp = (Uint32 *) info->src;
+    int srcskip = info->src_skip >> 2;
+    Uint32 *dstp = (Uint32 *) info->dst;
+    int dstskip = info->dst_skip >> 2;
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i opaque = _mm256_set1_epi32(0xff);
+    const __m256i rgbmask = _mm256_set1_epi32(0x00ffffff);
+    const __m256i lowbytes = _mm256_set1_epi16(0x00ff);
+    const __m256i alphashuffle = _mm256_setr_epi8(3, 3, 3, 3, 7, 7, 7, 7,
+                                                  11, 11, 11, 11, 15, 15, 15, 15,
+                                                  3, 3, 3, 3, 7, 7, 7, 7,
+                                                  11, 11, 11, 11, 15, 15, 15, 15);
+
+    while (height--) {
+        int n = width;
+        while (n >= 8) {
+            const __m256i s = _mm256_loadu_si256((const __m256i *) srcp);
+            const __m256i alpha = _mm256_srli_epi32(s, 24);
+            const __m256i transparent = _mm256_cmpeq_epi32(alpha, zero);
+            const __m256i solid = _mm256_cmpeq_epi32(alpha, opaque);
+
+            if (_mm256_movemask_epi8(solid) == -1) {
+                _mm256_storeu_si256((__m256i *) dstp, s);
+            } else if (_mm256_movemask_epi8(transparent) != -1) {
+                const __m256i d = _mm256_loadu_si256((const __m256i *) dstp);
+                const __m256i a8 = _mm256_shuffle_epi8(s, alphashuffle);
+                __m256i lo, hi, dalpha, result;
+
+                /* unpack and pack work within 128-bit lanes, so the pixels
+                   come back out in the order they went in. */
+                lo = _mm256_unpacklo_epi8(d, zero);
+                lo = _mm256_add_epi16(lo, _mm256_srli_epi16(_mm256_mullo_epi16(
+                         _mm256_sub_epi16(_mm256_unpacklo_epi8(s, zero), lo),
+                         _mm256_unpacklo_epi8(a8, zero)), 8));
+                hi = _mm256_unpackhi_epi8(d, zero);
+                hi = _mm256_add_epi16(hi, _mm256_srli_epi16(_mm256_mullo_epi16(
+                         _mm256_sub_epi16(_mm256_unpackhi_epi8(s, zero), hi),
+                         _mm256_unpackhi_epi8(a8, zero)), 8));
+                result = _mm256_packus_epi16(_mm256_and_si256(lo, lowbytes),
+                                             _mm256_and_si256(hi, lowbytes));
+
+                dalpha = _mm256_mullo_epi32(_mm256_srli_epi32(d, 24), _mm256_xor_si256(alpha, opaque));
+                dalpha = _mm256_add_epi32(alpha, _mm256_srli_epi32(dalpha, 8));
+                result = _mm256_or_si256(_mm256_and_si256(result, rgbmask), _mm256_slli_epi32(dalpha, 24));
+
+                result = _mm256_blendv_epi8(result, d, transparent);
+                result = _mm256_blendv_epi8(result, s, solid);
+                _mm256_storeu_si256((__m256i *) dstp, result);
+            }
+            srcp += 8;
+            dstp += 8;
+            n -= 8;
+        }
+        BlitRGBtoRGBPixelAlphaTail(srcp, dstp, n);
+        srcp += n + srcskip;
+        dstp += n + dstskip;
+    }
+}
+#endif /* HAVE_AVX2_INTRINSICS */
+
+#if HAVE_NEON_INTRINSICS
+/* fast ARGB888->(A)RGB888 blending with pixel alpha, four pixels at once */
+static void
+BlitRGBtoRGBPixelAlphaNEON(SDL_BlitInfo * info)
+{
+    int width = info->dst_w;
+    int height = info->dst_h;
+    Uint32 *srcp = (Uint32 *) info->src;
+    int srcskip = info->src_skip >> 2;
+    Uint32 *dstp = (Uint32 *) info->dst;
+    int dstskip = info->dst_skip >> 2;
+    const uint32x4_t opaque = vdupq_n_u32(0xff);
+    const uint32x4_t rgbmask = vdupq_n_u32(0x00ffffff);
+
+    while (height--) {
+        int n = width;
+        while (n >= 4) {
+            const uint32x4_t s = vld1q_u32(srcp);
+            const uint32x4_t alpha = vshrq_n_u32(s, 24);
+            const uint32x4_t transparent = vceqq_u32(alpha, vdupq_n_u32(0));
+            const uint32x4_t solid = vceqq_u32(alpha, opaque);
+            const uint32x2_t allsolid = vand_u32(vget_low_u32(solid), vget_high_u32(solid));
+            const uint32x2_t alltransparent = vand_u32(vget_low_u32(transparent), vget_high_u32(transparent));
+
+            if (vget_lane_u32(allsolid, 0) & vget_lane_u32(allsolid, 1)) {
+                vst1q_u32(dstp, s);
+            } else if (!(vget_lane_u32(alltransparent, 0) & vget_lane_u32(alltransparent, 1))) {
+                const uint32x4_t d = vld1q_u32(dstp);
+                const uint8x16_t s8 = vreinterpretq_u8_u32(s);
+                const uint8x16_t d8 = vreinterpretq_u8_u32(d);
+                const uint8x16_t a8 = vreinterpretq_u8_u32(vmulq_n_u32(alpha, 0x01010101));
+                uint16x8_t lo, hi;
+                uint32x4_t dalpha, result;
+
+                /* color: d + ((s - d) * alpha >> 8), keeping the low byte */
+                lo = vsubl_u8(vget_low_u8(s8), vget_low_u8(d8));
+                lo = vshrq_n_u16(vmulq_u16(lo, vmovl_u8(vget_low_u8(a8))), 8);
+                lo = vaddw_u8(lo, vget_low_u8(d8));
+                hi = vsubl_u8(vget_high_u8(s8), vget_high_u8(d8));
+                hi = vshrq_n_u16(vmulq_u16(hi, vmovl_u8(vget_high_u8(a8))), 8);
+                hi = vaddw_u8(hi, vget_high_u8(d8));
+                result = vreinterpretq_u32_u8(vcombine_u8(vmovn_u16(lo), vmovn_u16(hi)));
+
+                /* alpha: alpha + (dalpha * (255 - alpha) >> 8) */
+                dalpha = vmulq_u32(vshrq_n_u32(d, 24), veorq_u32(alpha, opaque));
+                dalpha = vaddq_u32(alpha, vshrq_n_u32(dalpha, 8));
+                result = vorrq_u32(vandq_u32(result, rgbmask), vshlq_n_u32(dalpha, 24));
+
+                result = vbslq_u32(transparent, d, result);
+                result = vbslq_u32(solid, s, result);
+                vst1q_u32(dstp, result);
+            }
+            srcp += 4;
+            dstp += 4;
+            n -= 4;
+        }
+        BlitRGBtoRGBPixelAlphaTail(srcp, dstp, n);
+        srcp += n + srcskip;
+        dstp += n + dstskip;
+    }
+}
+#endif /* HAVE_NEON_INTRINSICS */
+
 #ifdef __3dNOW__
 /* fast (as in MMX with prefetch) ARGB888->(A)RGB888 blending with pixel alpha */
 static void
@@ -1222,6 +1447,185 @@ BlitNtoNSurfaceAlphaKey(SDL_BlitInfo * info)
     }
 }
 
+#if HAVE_SSE2_INTRINSICS || HAVE_NEON_INTRINSICS
+/* The ends of the rows for the colorkeyed blitters below */
+static SDL_INLINE void
+BlitRGBtoRGBSurfaceAlphaKeyTail(SDL_BlitInfo * info, const Uint32 * srcp, Uint32 * dstp, int n)
+{
+    SDL_PixelFormat *srcfmt = info->src_fmt;
+    SDL_PixelFormat *dstfmt = info->dst_fmt;
+    const Uint32 ckey = info->colorkey;
+    const unsigned sA = info->a;
+
+    while (n--) {
+        const Uint32 s = *srcp;
+        if (s != ckey) {
+            Uint32 Pixel;
+            unsigned sR, sG, sB;
+            unsigned dR, dG, dB, dA;
+            RGB_FROM_PIXEL(s, srcfmt, sR, sG, sB);
+            DISEMBLE_RGBA((Uint8 *) dstp, 4, dstfmt, Pixel, dR, dG, dB, dA);
+            ALPHA_BLEND_RGBA(sR, sG, sB, sA, dR, dG, dB, dA);
+            ASSEMBLE_RGBA((Uint8 *) dstp, 4, dstfmt, dR, dG, dB, dA);
+        }
+        srcp++;
+        dstp++;
+    }
+}
+#endif
+
+/* Colorkeyed RGB888->(A)RGB888 blending with per-surface alpha. This
+   matches BlitNtoNSurfaceAlphaKey() exactly: the color is blended as
+   d + (s - d) * alpha / 255 rounded toward zero, which is done as d plus or
+   minus |s - d| * alpha / 255, and x / 255 is (x + 1 + (x >> 8)) >> 8, which
+   is exact for every product of two bytes. */
+
+#if HAVE_SSE2_INTRINSICS
+/* x * alpha / 255 for each byte of x, rounded down */
+static SDL_INLINE __m128i
+MulDiv255SSE2(__m128i x, __m128i alpha)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i one = _mm_set1_epi16(1);
+    __m128i lo = _mm_mullo_epi16(_mm_unpacklo_epi8(x, zero), alpha);
+    __m128i hi = _mm_mullo_epi16(_mm_unpackhi_epi8(x, zero), alpha);
+
+    lo = _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(lo, one), _mm_srli_epi16(lo, 8)), 8);
+    hi = _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(hi, one), _mm_srli_epi16(hi, 8)), 8);
+    return _mm_packus_epi16(lo, hi);
+}
+
+/* four pixels at once */
+static void
+BlitRGBtoRGBSurfaceAlphaKeySSE2(SDL_BlitInfo * info)
+{
+    int width = info->dst_w;
+    int height = info->dst_h;
+    Uint32 *srcp = (Uint32 *) info->src;
+    int srcskip = info->src_skip >> 2;
+    Uint32 *dstp = (Uint32 *) info->dst;
+    int dstskip = info->dst_skip >> 2;
+    SDL_PixelFormat *dstfmt = info->dst_fmt;
+    const Uint32 rgbmask = dstfmt->Rmask | dstfmt->Gmask | dstfmt->Bmask;
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i key = _mm_set1_epi32((int) info->colorkey);
+    const __m128i alpha = _mm_set1_epi16((short) info->a);
+    const __m128i alpha8 = _mm_set1_epi8((char) info->a);
+    const __m128i colormask = _mm_set1_epi32((int) rgbmask);
+    const __m128i alphamask = _mm_set1_epi32((int) dstfmt->Amask);
+
+    if (!info->a) {
+        return;  /* nothing to blend */
+    }
+
+    while (height--) {
+        int n = width;
+        while (n >= 4) {
+            const __m128i s = _mm_loadu_si128((const __m128i *) srcp);
+            const __m128i keyed = _mm_cmpeq_epi32(s, key);
+
+            if (_mm_movemask_epi8(keyed) != 0xFFFF) {
+                const __m128i d = _mm_loadu_si128((const __m128i *) dstp);
+                const __m128i down = _mm_subs_epu8(d, s);
+                const __m128i rising = _mm_cmpeq_epi8(down, zero);
+                const __m128i q = MulDiv255SSE2(_mm_or_si128(_mm_subs_epu8(s, d), down), alpha);
+                __m128i color, dalpha, result;
+
+                /* color: d + (s - d) * alpha / 255 */
+                color = _mm_or_si128(_mm_and_si128(rising, _mm_add_epi8(d, q)),
+                                     _mm_andnot_si128(rising, _mm_sub_epi8(d, q)));
+
+                /* alpha: alpha + dalpha - alpha * dalpha / 255 */
+                dalpha = _mm_sub_epi8(_mm_add_epi8(alpha8, d), MulDiv255SSE2(d, alpha));
+
+                result = _mm_or_si128(_mm_and_si128(color, colormask),
+                                      _mm_and_si128(dalpha, alphamask));
+                result = _mm_or_si128(_mm_and_si128(keyed, d),
+                                      _mm_andnot_si128(keyed, result));
+                _mm_storeu_si128((__m128i *) dstp, result);
+            }
+            srcp += 4;
+            dstp += 4;
+            n -= 4;
+        }
+        BlitRGBtoRGBSurfaceAlphaKeyTail(info, srcp, dstp, n);
+        srcp += n + srcskip;
+        dstp += n + dstskip;
+    }
+}
+#endif /* HAVE_SSE2_INTRINSICS */
+
+#if HAVE_NEON_INTRINSICS
+/* x * alpha / 255 for each byte of x, rounded down */
+static SDL_INLINE uint8x16_t
+MulDiv255NEON(uint8x16_t x, uint8x8_t alpha)
+{
+    const uint16x8_t one = vdupq_n_u16(1);
+    const uint16x8_t lo = vmull_u8(vget_low_u8(x), alpha);
+    const uint16x8_t hi = vmull_u8(vget_high_u8(x), alpha);
+
+    return vcombine_u8(vaddhn_u16(vaddq_u16(lo, one), vshrq_n_u16(lo, 8)),
+                       vaddhn_u16(vaddq_u16(hi, one), vshrq_n_u16(hi, 8)));
+}
+
+/* four pixels at once */
+static void
+BlitRGBtoRGBSurfaceAlphaKeyNEON(SDL_BlitInfo * info)
+{
+    int width = info->dst_w;
+    int height = info->dst_h;
+    Uint32 *srcp = (Uint32 *) info->src;
+    int srcskip = info->src_skip >> 2;
+    Uint32 *dstp = (Uint32 *) info->dst;
+    int dstskip = info->dst_skip >> 2;
+    SDL_PixelFormat *dstfmt = info->dst_fmt;
+    const Uint32 rgbmask = dstfmt->Rmask | dstfmt->Gmask | dstfmt->Bmask;
+    const uint32x4_t key = vdupq_n_u32(info->colorkey);
+    const uint8x8_t alpha = vdup_n_u8(info->a);
+    const uint8x16_t alpha8 = vdupq_n_u8(info->a);
+    const uint32x4_t colormask = vdupq_n_u32(rgbmask);
+    const uint32x4_t alphamask = vdupq_n_u32(dstfmt->Amask);
+
+    if (!info->a) {
+        return;  /* nothing to blend */
+    }
+
+    while (height--) {
+        int n = width;
+        while (n >= 4) {
+            const uint32x4_t s = vld1q_u32(srcp);
+            const uint32x4_t keyed = vceqq_u32(s, key);
+            const uint32x2_t allkeyed = vand_u32(vget_low_u32(keyed), vget_high_u32(keyed));
+
+            if (!(vget_lane_u32(allkeyed, 0) & vget_lane_u32(allkeyed, 1))) {
+                const uint32x4_t d = vld1q_u32(dstp);
+                const uint8x16_t s8 = vreinterpretq_u8_u32(s);
+                const uint8x16_t d8 = vreinterpretq_u8_u32(d);
+                const uint8x16_t q = MulDiv255NEON(vabdq_u8(s8, d8), alpha);
+                uint8x16_t color, dalpha;
+                uint32x4_t result;
+
+                /* color: d + (s - d) * alpha / 255 */
+                color = vbslq_u8(vcgeq_u8(s8, d8), vaddq_u8(d8, q), vsubq_u8(d8, q));
+
+                /* alpha: alpha + dalpha - alpha * dalpha / 255 */
+                dalpha = vsubq_u8(vaddq_u8(alpha8, d8), MulDiv255NEON(d8, alpha));
+
+                result = vorrq_u32(vandq_u32(vreinterpretq_u32_u8(color), colormask),
+                                   vandq_u32(vreinterpretq_u32_u8(dalpha), alphamask));
+                vst1q_u32(dstp, vbslq_u32(keyed, d, result));
+            }
+            srcp += 4;
+            dstp += 4;
+            n -= 4;
+        }
+        BlitRGBtoRGBSurfaceAlphaKeyTail(info, srcp, dstp, n);
+        srcp += n + srcskip;
+        dstp += n + dstskip;
+    }
+}
+#endif /* HAVE_NEON_INTRINSICS */
+
 /* General (slow) N->N blending with pixel alpha */
 static void
 BlitNtoNPixelAlpha(SDL_BlitInfo * info)
@@ -1294,6 +1698,20 @@ SDL_CalculateBlitA(SDL_Surface * surface)
             if (sf->Rmask == df->Rmask
                 && sf->Gmask == df->Gmask
                 && sf->Bmask == df->Bmask && sf->BytesPerPixel == 4) {
+                if (sf->Amask == 0xff000000) {
+#if HAVE_AVX2_INTRINSICS
+                    if (SDL_HasAVX2())
+                        return BlitRGBtoRGBPixelAlphaAVX2;
+#endif
+#if HAVE_SSE41_INTRINSICS
+                    if (SDL_HasSSE41())
+                        return BlitRGBtoRGBPixelAlphaSSE41;
+#endif
+#if HAVE_NEON_INTRINSICS
+                    if (SDL_HasNEON())
+                        return BlitRGBtoRGBPixelAlphaNEON;
+#endif
+                }
 #if defined(__MMX__) || defined(__3dNOW__)
                 if (sf->Rshift % 8 == 0
                     && sf->Gshift % 8 == 0
@@ -1375,9 +1793,28 @@ SDL_CalculateBlitA(SDL_Surface * surface)
         if (sf->Amask == 0) {
             if (df->BytesPerPixel == 1) {
                 return BlitNto1SurfaceAlphaKey;
-            } else {
-                return BlitNtoNSurfaceAlphaKey;
             }
+#if HAVE_SSE2_INTRINSICS || HAVE_NEON_INTRINSICS
+            if (sf->BytesPerPixel == 4 && df->BytesPerPixel == 4
+                && sf->Rmask == df->Rmask
+                && sf->Gmask == df->Gmask
+                && sf->Bmask == df->Bmask
+                && sf->Rloss == 0 && sf->Gloss == 0 && sf->Bloss == 0
+                && sf->Rshift % 8 == 0
+                && sf->Gshift % 8 == 0
+                && sf->Bshift % 8 == 0
+                && (df->Amask == 0 || (df->Aloss == 0 && df->Ashift % 8 == 0))) {
+#if HAVE_SSE2_INTRINSICS
+                if (SDL_HasSSE2())
+                    return BlitRGBtoRGBSurfaceAlphaKeySSE2;
+#endif
+#if HAVE_NEON_INTRINSICS
+                if (SDL_HasNEON())
+                    return BlitRGBtoRGBSurfaceAlphaKeyNEON;
+#endif
+            }
+#endif
+            return BlitNtoNSurfaceAlphaKey;
         }
         break;
     }
@@ -864,6 +864,8 @@ GetBlitFeatures(void)
                         /* Feature 4 is dont-use-prefetch */
                         /* !!!! FIXME: Check for G5 or later, not the cache size! Always prefetch on a G4. */
                         | ((GetL3CacheSize() == 0) ? 4 : 0)
+                        /* Feature 8 is has-NEON */
+                        | ((SDL_HasNEON())? 8 : 0)
                 );
         }
     }
@@ -874,8 +876,8 @@ GetBlitFeatures(void)
 #pragma altivec_model off
 #endif
 #else
-/* Feature 1 is has-MMX */
-#define GetBlitFeatures() ((Uint32)(SDL_HasMMX() ? 1 : 0))
+/* Feature 1 is has-MMX, feature 8 is has-NEON */
+#define GetBlitFeatures() ((Uint32)((SDL_HasMMX() ? 1 : 0) | (SDL_HasNEON() ? 8 : 0)))
 #endif
 
 /* This is now endian dependent */
@@ -2462,6 +2464,814 @@ BlitNto2101010(SDL_BlitInfo * info)
     }
 }
 
+/* Conversions between 24 and 32 bit formats whose channels are all whole
+   bytes (ARGB8888 to ABGR8888, RGB24 to BGRA8888 and so on) only move bytes
+   around, so they can be done with a byte shuffle instead of taking every
+   pixel apart and putting it back together. */
+
+#define SWIZZLE_FILL 0x80   /* destination byte that isn't from the source */
+
+typedef struct
+{
+    int srcbpp;
+    int dstbpp;
+    Uint8 shuffle[4];   /* source byte for each destination byte */
+    Uint8 fill[4];      /* value of the SWIZZLE_FILL bytes */
+} SDL_Swizzle;
+
+/* Which byte of the pixel in memory the mask covers, or -1 */
+static int
+GetSwizzleByte(Uint32 mask, int bpp)
+{
+    int i;
+
+    for (i = 0; i < bpp; ++i) {
+        if (mask == ((Uint32) 0xFF << (i * 8))) {
+#if SDL_BYTEORDER == SDL_LIL_ENDIAN
+            return i;
+#else
+            return bpp - 1 - i;
+#endif
+        }
+    }
+    return -1;
+}
+
+/* Alpha is copied if both formats have it, set to (alpha) if only the
+   destination has it, and other destination bytes are zeroed, the same as
+   BlitNtoN() and BlitNtoNCopyAlpha() do. */
+static SDL_bool
+GetSwizzle(const SDL_PixelFormat * srcfmt, const SDL_PixelFormat * dstfmt,
+           Uint8 alpha, SDL_Swizzle * swizzle)
+{
+    Uint32 srcmasks[4], dstmasks[4];
+    int srcbytes[4], dstbytes[4];
+    int i;
+
+    if ((srcfmt->BytesPerPixel != 3 && srcfmt->BytesPerPixel != 4) ||
+        (dstfmt->BytesPerPixel != 3 && dstfmt->BytesPerPixel != 4)) {
+        return SDL_FALSE;
+    }
+    srcmasks[0] = srcfmt->Rmask;
+    srcmasks[1] = srcfmt->Gmask;
+    srcmasks[2] = srcfmt->Bmask;
+    srcmasks[3] = srcfmt->Amask;
+    dstmasks[0] = dstfmt->Rmask;
+    dstmasks[1] = dstfmt->Gmask;
+    dstmasks[2] = dstfmt->Bmask;
+    dstmasks[3] = dstfmt->Amask;
+    for (i = 0; i < 4; ++i) {
+        srcbytes[i] = GetSwizzleByte(srcmasks[i], srcfmt->BytesPerPixel);
+        dstbytes[i] = GetSwizzleByte(dstmasks[i], dstfmt->BytesPerPixel);
+        if ((srcbytes[i] < 0 && (srcmasks[i] || i < 3)) ||
+            (dstbytes[i] < 0 && (dstmasks[i] || i < 3))) {
+            return SDL_FALSE;
+        }
+    }
+
+    swizzle->srcbpp = srcfmt->BytesPerPixel;
+    swizzle->dstbpp = dstfmt->BytesPerPixel;
+    for (i = 0; i < 4; ++i) {
+        swizzle->shuffle[i] = SWIZZLE_FILL;
+        swizzle->fill[i] = 0;
+    }
+    for (i = 0; i < 3; ++i) {
+        swizzle->shuffle[dstbytes[i]] = (Uint8) srcbytes[i];
+    }
+    if (dstbytes[3] >= 0) {
+        if (srcbytes[3] >= 0) {
+            swizzle->shuffle[dstbytes[3]] = (Uint8) srcbytes[3];
+        } else {
+            swizzle->fill[dstbytes[3]] = alpha;
+        }
+    }
+    return SDL_TRUE;
+}
+
+static SDL_INLINE void
+SwizzlePixels(const SDL_Swizzle * swizzle, const Uint8 * src, Uint8 * dst, int n)
+{
+    int i;
+
+    while (n--) {
+        for (i = 0; i < swizzle->dstbpp; ++i) {
+            const Uint8 s = swizzle->shuffle[i];
+            dst[i] = (s == SWIZZLE_FILL) ? swizzle->fill[i] : src[s];
+        }
+        src += swizzle->srcbpp;
+        dst += swizzle->dstbpp;
+    }
+}
+
+#if HAVE_SSE41_INTRINSICS || HAVE_AVX2_INTRINSICS
+/* The pshufb control and the OR mask for four pixels at a time. Control
+   bytes with the top bit set make pshufb write zero. */
+static void
+GetSwizzleVectors(const SDL_Swizzle * swizzle, Uint8 shuffle[16], Uint8 fill[16])
+{
+    int i, k;
+
+    SDL_memset(shuffle, SWIZZLE_FILL, 16);
+    SDL_memset(fill, 0, 16);
+    for (k = 0; k < 4; ++k) {
+        for (i = 0; i < swizzle->dstbpp; ++i) {
+            const Uint8 s = swizzle->shuffle[i];
+            if (s != SWIZZLE_FILL) {
+                shuffle[k * swizzle->dstbpp + i] = (Uint8) (k * swizzle->srcbpp + s);
+            }
+            fill[k * swizzle->dstbpp + i] = swizzle->fill[i];
+        }
+    }
+}
+#endif
+
+#if HAVE_SSE41_INTRINSICS
+/* four pixels at a time with pshufb, which every SSE4.1 CPU has */
+static void SDL_TARGETING_SSE41
+BlitNtoNSwizzleSSE41(SDL_BlitInfo * info)
+{
+    int width = info->dst_w;
+    int height = info->dst_h;
+    Uint8 *src = info->src;
+    int srcskip = info->src_skip;
+    Uint8 *dst = info->dst;
+    int dstskip = info->dst_skip;
+    SDL_Swizzle swizzle;
+    Uint8 shuffle[16], fill[16];
+    __m128i control, mask;
+    int srcstep, dststep, minimum;
+
+    GetSwizzle(info->src_fmt, info->dst_fmt, info->a, &swizzle);
+    GetSwizzleVectors(&swizzle, shuffle, fill);
+    control = _mm_loadu_si128((const __m128i *) shuffle);
+    mask = _mm_loadu_si128((const __m128i *) fill);
+    srcstep = 4 * swizzle.srcbpp;
+    dststep = 4 * swizzle.dstbpp;
+
+    /* Four 24 bit pixels are 12 bytes, but the loads and stores are 16,
+       so leave two pixels for the tail to keep from running off the row. */
+    minimum = (swizzle.srcbpp == 3 || swizzle.dstbpp == 3) ? 6 : 4;
+
+    while (height--) {
+        int n = width;
+        while (n >= minimum) {
+            const __m128i s = _mm_loadu_si128((const __m128i *) src);
+            _mm_storeu_si128((__m128i *) dst,
+                             _mm_or_si128(_mm_shuffle_epi8(s, control), mask));
+            src += srcstep;
+            dst += dststep;
+            n -= 4;
+        }
+        SwizzlePixels(&swizzle, src, dst, n);
+        src += n * swizzle.srcbpp + srcskip;
+        dst += n * swizzle.dstbpp + dstskip;
+    }
+}
+#endif /* HAVE_SSE41_INTRINSICS */
+
+#if HAVE_AVX2_INTRINSICS
+/* eight 32 bit pixels at a time; vpshufb works within each 128-bit lane,
+   which is fine since every lane holds four whole pixels. */
+static void SDL_TARGETING_AVX2
+BlitNtoNSwizzleAVX2(SDL_BlitInfo * info)
+{
+    int width = info->dst_w;
+    int height = info->dst_h;
+    Uint8 *src = info->src;
+    int srcskip = info->src_skip;
+    Uint8 *dst = info->dst;
+    int dstskip = info->dst_skip;
+    SDL_Swizzle swizzle;
+    Uint8 shuffle[16], fill[16];
+    __m256i control, mask;
+
+    GetSwizzle(info->src_fmt, info->dst_fmt, info->a, &swizzle);
+    GetSwizzleVectors(&swizzle, shuffle, fill);
+    control = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *) shuffle));
+    mask = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *) fill));
+
+    while (height--) {
+        int n = width;
+        while (n >= 8) {
+            const __m256i s = _mm256_loadu_si256((const __m256i *) src);
+            _mm256_storeu_si256((__m256i *) dst,
+                                _mm256_or_si256(_mm256_shuffle_epi8(s, control), mask));
+            src += 32;
+            dst += 32;
+            n -= 8;
+        }
+        SwizzlePixels(&swizzle, src, dst, n);
+        src += n * 4 + srcskip;
+        dst += n * 4 + dstskip;
+    }
+}
+#endif /* HAVE_AVX2_INTRINSICS */
+
+#if HAVE_NEON_INTRINSICS
+/* sixteen pixels at a time. vld3/vld4 split the pixels into one register
+   per byte, so the shuffle is just picking registers, and vst3/vst4 put
+   them back together. This works on 32-bit ARM too, unlike vqtbl1q. */
+static void
+BlitNtoNSwizzleNEON(SDL_BlitInfo * info)
+{
+    int width = info->dst_w;
+    int height = info->dst_h;
+    Uint8 *src = info->src;
+    int srcskip = info->src_skip;
+    Uint8 *dst = info->dst;
+    int dstskip = info->dst_skip;
+    SDL_Swizzle swizzle;
+    uint8x16_t fill[4];
+    int i;
+
+    GetSwizzle(info->src_fmt, info->dst_fmt, info->a, &swizzle);
+    for (i = 0; i < 4; ++i) {
+        fill[i] = vdupq_n_u8(swizzle.fill[i]);
+    }
+
+    while (height--) {
+        int n = width;
+        while (n >= 16) {
+            uint8x16x4_t s, d;
+            if (swizzle.srcbpp == 4) {
+                s = vld4q_u8(src);
+            } else {
+                const uint8x16x3_t s3 = vld3q_u8(src);
+                s.val[0] = s3.val[0];
+                s.val[1] = s3.val[1];
+                s.val[2] = s3.val[2];
+                s.val[3] = fill[0];
+            }
+            for (i = 0; i < 4; ++i) {
+                const Uint8 b = swizzle.shuffle[i];
+                d.val[i] = (b == SWIZZLE_FILL) ? fill[i] : s.val[b];
+            }
+            if (swizzle.dstbpp == 4) {
+                vst4q_u8(dst, d);
+            } else {
+                uint8x16x3_t d3;
+                d3.val[0] = d.val[0];
+                d3.val[1] = d.val[1];
+                d3.val[2] = d.val[2];
+                vst3q_u8(dst, d3);
+            }
+            src += 16 * swizzle.srcbpp;
+            dst += 16 * swizzle.dstbpp;
+            n -= 16;
+        }
+        SwizzlePixels(&swizzle, src, dst, n);
+        src += n * swizzle.srcbpp + srcskip;
+        dst += n * swizzle.dstbpp + dstskip;
+    }
+}
+#endif /* HAVE_NEON_INTRINSICS */
+
+/* The shuffle blitter for this conversion, or NULL if there isn't one */
+static SDL_BlitFunc
+GetSwizzleBlit(const SDL_PixelFormat * srcfmt, const SDL_PixelFormat * dstfmt)
+{
+    SDL_Swizzle swizzle;
+
+    if (!GetSwizzle(srcfmt, dstfmt, 0xFF, &swizzle)) {
+        return NULL;
+    }
+#if HAVE_AVX2_INTRINSICS
+    if (SDL_HasAVX2() && swizzle.srcbpp == 4 && swizzle.dstbpp == 4) {
+        return BlitNtoNSwizzleAVX2;
+    }
+#endif
+#if HAVE_SSE41_INTRINSICS
+    if (SDL_HasSSE41()) {
+        return BlitNtoNSwizzleSSE41;
+    }
+#endif
+#if HAVE_NEON_INTRINSICS
+    if (SDL_HasNEON()) {
+        return BlitNtoNSwizzleNEON;
+    }
+#endif
+    return NULL;
+}
+
+#if HAVE_NEON_INTRINSICS
+/* NEON versions of the AltiVec converters at the top of this file. The
+   32 to 32 bit ones without a colorkey are the shuffle blitters above. */
+
+/* Special optimized blit for RGB 8-8-8 --> RGB 5-6-5, eight pixels at once */
+static void
+Blit_RGB888_RGB565NEON(SDL_BlitInfo * info)
+{
+    int width = info->dst_w;
+    int height = info->dst_h;
+    Uint32 *src = (Uint32 *) info->src;
+    int srcskip = info->src_skip / 4;
+    Uint16 *dst = (Uint16 *) info->dst;
+    int dstskip = info->dst_skip / 2;
+    const uint32x4_t rmask = vdupq_n_u32(0xF800);
+    const uint32x4_t gmask = vdupq_n_u32(0x07E0);
+    const uint32x4_t bmask = vdupq_n_u32(0x001F);
+
+    while (height--) {
+        int n = width;
+        while (n >= 8) {
+            const uint32x4_t lo = vld1q_u32(src);
+            const uint32x4_t hi = vld1q_u32(src + 4);
+            const uint32x4_t rgblo = vorrq_u32(vorrq_u32(
+                vandq_u32(vshrq_n_u32(lo, 8), rmask),
+                vandq_u32(vshrq_n_u32(lo, 5), gmask)),
+                vandq_u32(vshrq_n_u32(lo, 3), bmask));
+            const uint32x4_t rgbhi = vorrq_u32(vorrq_u32(
+                vandq_u32(vshrq_n_u32(hi, 8), rmask),
+                vandq_u32(vshrq_n_u32(hi, 5), gmask)),
+                vandq_u32(vshrq_n_u32(hi, 3), bmask));
+            vst1q_u16(dst, vcombine_u16(vmovn_u32(rgblo), vmovn_u32(rgbhi)));
+            src += 8;
+            dst += 8;
+            n -= 8;
+        }
+        while (n--) {
+            RGB888_RGB565(dst, src);
+            ++src;
+            ++dst;
+        }
+        src += srcskip;
+        dst += dstskip;
+    }
+}
+
+/* Special optimized blit for RGB 8-8-8 --> RGB 5-5-5, eight pixels at once */
+static void
+Blit_RGB888_RGB555NEON(SDL_BlitInfo * info)
+{
+    int width = info->dst_w;
+    int height = info->dst_h;
+    Uint32 *src = (Uint32 *) info->src;
+    int srcskip = info->src_skip / 4;
+    Uint16 *dst = (Uint16 *) info->dst;
+    int dstskip = info->dst_skip / 2;
+    const uint32x4_t rmask = vdupq_n_u32(0x7C00);
+    const uint32x4_t gmask = vdupq_n_u32(0x03E0);
+    const uint32x4_t bmask = vdupq_n_u32(0x001F);
+
+    while (height--) {
+        int n = width;
+        while (n >= 8) {
+            const uint32x4_t lo = vld1q_u32(src);
+            const uint32x4_t hi = vld1q_u32(src + 4);
+            const uint32x4_t rgblo = vorrq_u32(vorrq_u32(
+                vandq_u32(vshrq_n_u32(lo, 9), rmask),
+                vandq_u32(vshrq_n_u32(lo, 6), gmask)),
+                vandq_u32(vshrq_n_u32(lo, 3), bmask));
+            const uint32x4_t rgbhi = vorrq_u32(vorrq_u32(
+                vandq_u32(vshrq_n_u32(hi, 9), rmask),
+                vandq_u32(vshrq_n_u32(hi, 6), gmask)),
+                vandq_u32(vshrq_n_u32(hi, 3), bmask));
+            vst1q_u16(dst, vcombine_u16(vmovn_u32(rgblo), vmovn_u32(rgbhi)));
+            src += 8;
+            dst += 8;
+            n -= 8;
+        }
+        while (n--) {
+            RGB888_RGB555(dst, src);
+            ++src;
+            ++dst;
+        }
+        src += srcskip;
+        dst += dstskip;
+    }
+}
+
+/* Which byte of a 32 bit destination pixel R, G, B and the fourth
+   byte go in, for the 16 to 32 bit blitters */
+static void
+GetRGBXBytes(const SDL_PixelFormat * dstfmt, int bytes[4])
+{
+    bytes[0] = GetSwizzleByte(dstfmt->Rmask, 4);
+    bytes[1] = GetSwizzleByte(dstfmt->Gmask, 4);
+    bytes[2] = GetSwizzleByte(dstfmt->Bmask, 4);
+    bytes[3] = 6 - bytes[0] - bytes[1] - bytes[2];
+}
+
+/* Widens 5 bit channels in 16-bit lanes to 8 bits as x * 255 / 31, rounded
+   down, which is what the SDL_expand_byte tables and the RGB565_32 tables
+   have. Those tables build green from its top and bottom three bits
+   separately, so that one is done the same way here. */
+#define EXPAND5_NEON(x) vmovn_u16(vshrq_n_u16(vmulq_n_u16((x), 1053), 7))
+#define EXPAND565G_NEON(p, mask3) \
+    vmovn_u16(vaddq_u16( \
+        vshrq_n_u16(vmulq_n_u16(vandq_u16(vshrq_n_u16((p), 8), (mask3)), 259), 3), \
+        vshlq_n_u16(vandq_u16(vshrq_n_u16((p), 5), (mask3)), 2)))
+
+static SDL_INLINE void
+StoreRGBXNEON(Uint8 * dst, const int bytes[4], uint8x16_t r, uint8x16_t g,
+              uint8x16_t b, uint8x16_t x)
+{
+    uint8x16x4_t pixels;
+    pixels.val[bytes[0]] = r;
+    pixels.val[bytes[1]] = g;
+    pixels.val[bytes[2]] = b;
+    pixels.val[bytes[3]] = x;
+    vst4q_u8(dst, pixels);
+}
+
+/* Special optimized blit for RGB 5-6-5 --> 32-bit RGB surfaces, sixteen
+   pixels at once. The fourth byte is 0xFF, as in the RGB565_32 tables. */
+static void
+Blit_RGB565_32NEON(SDL_BlitInfo * info)
+{
+    int width = info->dst_w;
+    int height = info->dst_h;
+    Uint8 *src = info->src;
+    int srcskip = info->src_skip;
+    Uint8 *dst = info->dst;
+    int dstskip = info->dst_skip;
+    const uint16x8_t mask3 = vdupq_n_u16(0x07);
+    const uint16x8_t mask5 = vdupq_n_u16(0x1F);
+    const uint8x16_t opaque = vdupq_n_u8(0xFF);
+    int bytes[4];
+
+    GetRGBXBytes(info->dst_fmt, bytes);
+
+    while (height--) {
+        int n = width;
+        while (n >= 16) {
+            const uint16x8_t lo = vld1q_u16((const Uint16 *) src);
+            const uint16x8_t hi = vld1q_u16((const Uint16 *) (src + 16));
+            const uint8x16_t r = vcombine_u8(EXPAND5_NEON(vshrq_n_u16(lo, 11)),
+                                             EXPAND5_NEON(vshrq_n_u16(hi, 11)));
+            const uint8x16_t g = vcombine_u8(EXPAND565G_NEON(lo, mask3),
+                                             EXPAND565G_NEON(hi, mask3));
+            const uint8x16_t b = vcombine_u8(EXPAND5_NEON(vandq_u16(lo, mask5)),
+                                             EXPAND5_NEON(vandq_u16(hi, mask5)));
+            StoreRGBXNEON(dst, bytes, r, g, b, opaque);
+            src += 32;
+            dst += 64;
+            n -= 16;
+        }
+        while (n--) {
+            const unsigned pixel = *(const Uint16 *) src;
+            dst[bytes[0]] = (Uint8) (((pixel >> 11) * 1053) >> 7);
+            dst[bytes[1]] = (Uint8) (((((pixel >> 8) & 7) * 259) >> 3) + ((pixel >> 5) & 7) * 4);
+            dst[bytes[2]] = (Uint8) (((pixel & 0x1F) * 1053) >> 7);
+            dst[bytes[3]] = 0xFF;
+            src += 2;
+            dst += 4;
+        }
+        src += srcskip;
+        dst += dstskip;
+    }
+}
+
+/* Special optimized blit for RGB 5-5-5 --> 32-bit RGB surfaces, sixteen
+   pixels at once. The fourth byte is the blit alpha if the destination
+   has alpha and zero if it doesn't, as in BlitNtoN(). */
+static void
+Blit_RGB555_32NEON(SDL_BlitInfo * info)
+{
+    int width = info->dst_w;
+    int height = info->dst_h;
+    Uint8 *src = info->src;
+    int srcskip = info->src_skip;
+    Uint8 *dst = info->dst;
+    int dstskip = info->dst_skip;
+    const Uint8 alpha = info->dst_fmt->Amask ? info->a : 0;
+    const uint16x8_t mask5 = vdupq_n_u16(0x1F);
+    const uint8x16_t x = vdupq_n_u8(alpha);
+    int bytes[4];
+
+    GetRGBXBytes(info->dst_fmt, bytes);
+
+    while (height--) {
+        int n = width;
+        while (n >= 16) {
+            const uint16x8_t lo = vld1q_u16((const Uint16 *) src);
+            const uint16x8_t hi = vld1q_u16((const Uint16 *) (src + 16));
+            const uint8x16_t r = vcombine_u8(EXPAND5_NEON(vandq_u16(vshrq_n_u16(lo, 10), mask5)),
+                                             EXPAND5_NEON(vandq_u16(vshrq_n_u16(hi, 10), mask5)));
+            const uint8x16_t g = vcombine_u8(EXPAND5_NEON(vandq_u16(vshrq_n_u16(lo, 5), mask5)),
+                                             EXPAND5_NEON(vandq_u16(vshrq_n_u16(hi, 5), mask5)));
+            const uint8x16_t b = vcombine_u8(EXPAND5_NEON(vandq_u16(lo, mask5)),
+                                             EXPAND5_NEON(vandq_u16(hi, mask5)));
+            StoreRGBXNEON(dst, bytes, r, g, b, x);
+            src += 32;
+            dst += 64;
+            n -= 16;
+        }
+        while (n--) {
+            const Uint32 pixel = *(const Uint16 *) src;
+            unsigned sR, sG, sB;
+            RGB_FROM_RGB555(pixel, sR, sG, sB);
+            dst[bytes[0]] = (Uint8) sR;
+            dst[bytes[1]] = (Uint8) sG;
+            dst[bytes[2]] = (Uint8) sB;
+            dst[bytes[3]] = alpha;
+            src += 2;
+            dst += 4;
+        }
+        src += srcskip;
+        dst += dstskip;
+    }
+}
+
+/* colorkey blit between 24 and 32 bit formats that GetSwizzle() can
+   handle, sixteen pixels at once. This does what BlitNtoNKey() and
+   BlitNtoNKeyCopyAlpha() do: every source byte but alpha is compared with
+   the colorkey, and matching pixels leave the destination alone. */
+static void
+BlitNtoNKeyNEON(SDL_BlitInfo * info)
+{
+    int width = info->dst_w;
+    int height = info->dst_h;
+    Uint8 *src = info->src;
+    int srcskip = info->src_skip;
+    Uint8 *dst = info->dst;
+    int dstskip = info->dst_skip;
+    const SDL_PixelFormat *srcfmt = info->src_fmt;
+    const int srcalpha = srcfmt->Amask ? GetSwizzleByte(srcfmt->Amask, srcfmt->BytesPerPixel) : -1;
+    SDL_Swizzle swizzle;
+    Uint8 key[4];
+    uint8x16_t keys[4], fill[4];
+    int i;
+
+    GetSwizzle(srcfmt, info->dst_fmt, info->a, &swizzle);
+    for (i = 0; i < 4; ++i) {
+#if SDL_BYTEORDER == SDL_LIL_ENDIAN
+        key[i] = (Uint8) (info->colorkey >> (i * 8));
+#else
+        key[i] = (Uint8) (info->colorkey >> ((swizzle.srcbpp - 1 - i) * 8));
+#endif
+        keys[i] = vdupq_n_u8(key[i]);
+        fill[i] = vdupq_n_u8(swizzle.fill[i]);
+    }
+
+    while (height--) {
+        int n = width;
+        while (n >= 16) {
+            uint8x16x4_t s, d, old;
+            uint8x16_t match = vdupq_n_u8(0xFF);
+            if (swizzle.srcbpp == 4) {
+                s = vld4q_u8(src);
+            } else {
+                const uint8x16x3_t s3 = vld3q_u8(src);
+                s.val[0] = s3.val[0];
+                s.val[1] = s3.val[1];
+                s.val[2] = s3.val[2];
+                s.val[3] = fill[0];
+            }
+            for (i = 0; i < swizzle.srcbpp; ++i) {
+                if (i != srcalpha) {
+                    match = vandq_u8(match, vceqq_u8(s.val[i], keys[i]));
+                }
+            }
+            if (swizzle.dstbpp == 4) {
+                old = vld4q_u8(dst);
+            } else {
+                const uint8x16x3_t old3 = vld3q_u8(dst);
+                old.val[0] = old3.val[0];
+                old.val[1] = old3.val[1];
+                old.val[2] = old3.val[2];
+                old.val[3] = fill[0];
+            }
+            for (i = 0; i < swizzle.dstbpp; ++i) {
+                const Uint8 b = swizzle.shuffle[i];
+                d.val[i] = vbslq_u8(match, old.val[i], (b == SWIZZLE_FILL) ? fill[i] : s.val[b]);
+            }
+            if (swizzle.dstbpp == 4) {
+                vst4q_u8(dst, d);
+            } else {
+                uint8x16x3_t d3;
+                d3.val[0] = d.val[0];
+                d3.val[1] = d.val[1];
+                d3.val[2] = d.val[2];
+                vst3q_u8(dst, d3);
+            }
+            src += 16 * swizzle.srcbpp;
+            dst += 16 * swizzle.dstbpp;
+            n -= 16;
+        }
+        while (n--) {
+            SDL_bool matches = SDL_TRUE;
+            for (i = 0; i < swizzle.srcbpp; ++i) {
+                if (i != srcalpha && src[i] != key[i]) {
+                    matches = SDL_FALSE;
+                }
+            }
+            if (!matches) {
+                SwizzlePixels(&swizzle, src, dst, 1);
+            }
+            src += swizzle.srcbpp;
+            dst += swizzle.dstbpp;
+        }
+        src += srcskip;
+        dst += dstskip;
+    }
+}
+#endif /* HAVE_NEON_INTRINSICS */
+
+/* Colorkey blits, a register at a time: source pixels are compared with
+   the key all at once, and the ones that match keep the old destination.
+   Sprites are mostly either all key or all opaque across a register, so
+   those cases skip the merge (or the store) altogether. */
+
+#if HAVE_SSE2_INTRINSICS
+/* 16 bit to the same 16 bit format, eight pixels at once */
+static void
+Blit2to2KeySSE2(SDL_BlitInfo * info)
+{
+    int width = info->dst_w;
+    int height = info->dst_h;
+    Uint16 *srcp = (Uint16 *) info->src;
+    int srcskip = info->src_skip >> 1;
+    Uint16 *dstp = (Uint16 *) info->dst;
+    int dstskip = info->dst_skip >> 1;
+    const Uint16 rgbmask = (Uint16) ~info->src_fmt->Amask;
+    const Uint16 ckey = (Uint16) info->colorkey & rgbmask;
+    const __m128i mask = _mm_set1_epi16((short) rgbmask);
+    const __m128i key = _mm_set1_epi16((short) ckey);
+
+    while (height--) {
+        int n = width;
+        while (n >= 8) {
+            const __m128i s = _mm_loadu_si128((const __m128i *) srcp);
+            const __m128i keyed = _mm_cmpeq_epi16(_mm_and_si128(s, mask), key);
+            const int bits = _mm_movemask_epi8(keyed);
+            if (bits == 0) {
+                _mm_storeu_si128((__m128i *) dstp, s);
+            } else if (bits != 0xFFFF) {
+                const __m128i d = _mm_loadu_si128((const __m128i *) dstp);
+                _mm_storeu_si128((__m128i *) dstp,
+                                 _mm_or_si128(_mm_and_si128(keyed, d),
+                                              _mm_andnot_si128(keyed, s)));
+            }
+            srcp += 8;
+            dstp += 8;
+            n -= 8;
+        }
+        while (n--) {
+            if ((*srcp & rgbmask) != ckey) {
+                *dstp = *srcp;
+            }
+            srcp++;
+            dstp++;
+        }
+        srcp += srcskip;
+        dstp += dstskip;
+    }
+}
+#endif /* HAVE_SSE2_INTRINSICS */
+
+#if HAVE_NEON_INTRINSICS
+/* 16 bit to the same 16 bit format, eight pixels at once */
+static void
+Blit2to2KeyNEON(SDL_BlitInfo * info)
+{
+    int width = info->dst_w;
+    int height = info->dst_h;
+    Uint16 *srcp = (Uint16 *) info->src;
+    int srcskip = info->src_skip >> 1;
+    Uint16 *dstp = (Uint16 *) info->dst;
+    int dstskip = info->dst_skip >> 1;
+    const Uint16 rgbmask = (Uint16) ~info->src_fmt->Amask;
+    const Uint16 ckey = (Uint16) info->colorkey & rgbmask;
+    const uint16x8_t mask = vdupq_n_u16(rgbmask);
+    const uint16x8_t key = vdupq_n_u16(ckey);
+
+    while (height--) {
+        int n = width;
+        while (n >= 8) {
+            const uint16x8_t s = vld1q_u16(srcp);
+            const uint16x8_t keyed = vceqq_u16(vandq_u16(s, mask), key);
+            vst1q_u16(dstp, vbslq_u16(keyed, vld1q_u16(dstp), s));
+            srcp += 8;
+            dstp += 8;
+            n -= 8;
+        }
+        while (n--) {
+            if ((*srcp & rgbmask) != ckey) {
+                *dstp = *srcp;
+            }
+            srcp++;
+            dstp++;
+        }
+        srcp += srcskip;
+        dstp += dstskip;
+    }
+}
+#endif /* HAVE_NEON_INTRINSICS */
+
+#if HAVE_SSE41_INTRINSICS || HAVE_AVX2_INTRINSICS
+/* The end of a row for the 32 to 32 bit colorkey blitters below */
+static SDL_INLINE void
+BlitNtoNKeyTail(const SDL_Swizzle * swizzle, const Uint32 * src, Uint8 * dst,
+                Uint32 rgbmask, Uint32 ckey, int n)
+{
+    while (n--) {
+        if ((*src & rgbmask) != ckey) {
+            SwizzlePixels(swizzle, (const Uint8 *) src, dst, 1);
+        }
+        src++;
+        dst += 4;
+    }
+}
+#endif
+
+#if HAVE_SSE41_INTRINSICS
+/* 32 bit to 32 bit formats that GetSwizzle() can handle, four pixels at
+   once. This does what BlitNtoNKey() and BlitNtoNKeyCopyAlpha() do. */
+static void SDL_TARGETING_SSE41
+BlitNtoNKeySSE41(SDL_BlitInfo * info)
+{
+    int width = info->dst_w;
+    int height = info->dst_h;
+    Uint32 *srcp = (Uint32 *) info->src;
+    int srcskip = info->src_skip >> 2;
+    Uint8 *dst = info->dst;
+    int dstskip = info->dst_skip;
+    const Uint32 rgbmask = ~info->src_fmt->Amask;
+    const Uint32 ckey = info->colorkey & rgbmask;
+    const __m128i mask = _mm_set1_epi32((int) rgbmask);
+    const __m128i key = _mm_set1_epi32((int) ckey);
+    SDL_Swizzle swizzle;
+    Uint8 shuffle[16], fill[16];
+    __m128i control, alpha;
+
+    GetSwizzle(info->src_fmt, info->dst_fmt, info->a, &swizzle);
+    GetSwizzleVectors(&swizzle, shuffle, fill);
+    control = _mm_loadu_si128((const __m128i *) shuffle);
+    alpha = _mm_loadu_si128((const __m128i *) fill);
+
+    while (height--) {
+        int n = width;
+        while (n >= 4) {
+            const __m128i s = _mm_loadu_si128((const __m128i *) srcp);
+            const __m128i keyed = _mm_cmpeq_epi32(_mm_and_si128(s, mask), key);
+            const int bits = _mm_movemask_epi8(keyed);
+            if (bits != 0xFFFF) {
+                __m128i pixels = _mm_or_si128(_mm_shuffle_epi8(s, control), alpha);
+                if (bits != 0) {
+                    pixels = _mm_blendv_epi8(pixels, _mm_loadu_si128((const __m128i *) dst), keyed);
+                }
+                _mm_storeu_si128((__m128i *) dst, pixels);
+            }
+            srcp += 4;
+            dst += 16;
+            n -= 4;
+        }
+        BlitNtoNKeyTail(&swizzle, srcp, dst, rgbmask, ckey, n);
+        srcp += n + srcskip;
+        dst += n * 4 + dstskip;
+    }
+}
+#endif /* HAVE_SSE41_INTRINSICS */
+
+#if HAVE_AVX2_INTRINSICS
+/* The same as BlitNtoNKeySSE41(), eight pixels at once */
+static void SDL_TARGETING_AVX2
+BlitNtoNKeyAVX2(SDL_BlitInfo * info)
+{
+    int width = info->dst_w;
+    int height = info->dst_h;
+    Uint32 *srcp = (Uint32 *) info->src;
+    int srcskip = info->src_skip >> 2;
+    Uint8 *dst = info->dst;
+    int dstskip = info->dst_skip;
+    const Uint32 rgbmask = ~info->src_fmt->Amask;
+    const Uint32 ckey = info->colorkey & rgbmask;
+    const __m256i mask = _mm256_set1_epi32((int) rgbmask);
+    const __m256i key = _mm256_set1_epi32((int) ckey);
+    SDL_Swizzle swizzle;
+    Uint8 shuffle[16], fill[16];
+    __m256i control, alpha;
+
+    GetSwizzle(info->src_fmt, info->dst_fmt, info->a, &swizzle);
+    GetSwizzleVectors(&swizzle, shuffle, fill);
+    control = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *) shuffle));
+    alpha = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *) fill));
+
+    while (height--) {
+        int n = width;
+        while (n >= 8) {
+            const __m256i s = _mm256_loadu_si256((const __m256i *) srcp);
+            const __m256i keyed = _mm256_cmpeq_epi32(_mm256_and_si256(s, mask), key);
+            const int bits = _mm256_movemask_epi8(keyed);
+            if (bits != -1) {
+                __m256i pixels = _mm256_or_si256(_mm256_shuffle_epi8(s, control), alpha);
+                if (bits != 0) {
+                    pixels = _mm256_blendv_epi8(pixels, _mm256_loadu_si256((const __m256i *) dst), keyed);
+                }
+                _mm256_storeu_si256((__m256i *) dst, pixels);
+            }
+            srcp += 8;
+            dst += 32;
+            n -= 8;
+        }
+        BlitNtoNKeyTail(&swizzle, srcp, dst, rgbmask, ckey, n);
+        srcp += n + srcskip;
+        dst += n * 4 + dstskip;
+    }
+}
+#endif /* HAVE_AVX2_INTRINSICS */
+
 /* Normal N to N optimized blitters */
 #define NO_ALPHA   1
 #define SET_ALPHA  2
@@ -2487,6 +3297,25 @@ static const struct blit_table normal_blit_2[] = {
      2, Blit_RGB565_32Altivec, NO_ALPHA | COPY_ALPHA | SET_ALPHA},
     {0x00007C00, 0x000003E0, 0x0000001F, 4, 0x00000000, 0x00000000, 0x00000000,
      2, Blit_RGB555_32Altivec, NO_ALPHA | COPY_ALPHA | SET_ALPHA},
+#endif
+#if HAVE_NEON_INTRINSICS
+    /* has-neon */
+    {0x0000F800, 0x000007E0, 0x0000001F, 4, 0x00FF0000, 0x0000FF00, 0x000000FF,
+     8, Blit_RGB565_32NEON, NO_ALPHA | COPY_ALPHA | SET_ALPHA},
+    {0x0000F800, 0x000007E0, 0x0000001F, 4, 0x000000FF, 0x0000FF00, 0x00FF0000,
+     8, Blit_RGB565_32NEON, NO_ALPHA | COPY_ALPHA | SET_ALPHA},
+    {0x0000F800, 0x000007E0, 0x0000001F, 4, 0xFF000000, 0x00FF0000, 0x0000FF00,
+     8, Blit_RGB565_32NEON, NO_ALPHA | COPY_ALPHA | SET_ALPHA},
+    {0x0000F800, 0x000007E0, 0x0000001F, 4, 0x0000FF00, 0x00FF0000, 0xFF000000,
+     8, Blit_RGB565_32NEON, NO_ALPHA | COPY_ALPHA | SET_ALPHA},
+    {0x00007C00, 0x000003E0, 0x0000001F, 4, 0x00FF0000, 0x0000FF00, 0x000000FF,
+     8, Blit_RGB555_32NEON, NO_ALPHA | SET_ALPHA},
+    {0x00007C00, 0x000003E0, 0x0000001F, 4, 0x000000FF, 0x0000FF00, 0x00FF0000,
+     8, Blit_RGB555_32NEON, NO_ALPHA | SET_ALPHA},
+    {0x00007C00, 0x000003E0, 0x0000001F, 4, 0xFF000000, 0x00FF0000, 0x0000FF00,
+     8, Blit_RGB555_32NEON, NO_ALPHA | SET_ALPHA},
+    {0x00007C00, 0x000003E0, 0x0000001F, 4, 0x0000FF00, 0x00FF0000, 0xFF000000,
+     8, Blit_RGB555_32NEON, NO_ALPHA | SET_ALPHA},
 #endif
     {0x0000F800, 0x000007E0, 0x0000001F, 4, 0x00FF0000, 0x0000FF00, 0x000000FF,
      0, Blit_RGB565_ARGB8888, NO_ALPHA | COPY_ALPHA | SET_ALPHA},
@@ -2517,6 +3346,13 @@ static const struct blit_table normal_blit_4[] = {
     /* has-altivec */
     {0x00000000, 0x00000000, 0x00000000, 2, 0x0000F800, 0x000007E0, 0x0000001F,
      2, Blit_RGB888_RGB565Altivec, NO_ALPHA},
+#endif
+#if HAVE_NEON_INTRINSICS
+    /* has-neon */
+    {0x00FF0000, 0x0000FF00, 0x000000FF, 2, 0x0000F800, 0x000007E0, 0x0000001F,
+     8, Blit_RGB888_RGB565NEON, NO_ALPHA},
+    {0x00FF0000, 0x0000FF00, 0x000000FF, 2, 0x00007C00, 0x000003E0, 0x0000001F,
+     8, Blit_RGB888_RGB555NEON, NO_ALPHA},
 #endif
     {0x00FF0000, 0x0000FF00, 0x000000FF, 2, 0x0000F800, 0x000007E0, 0x0000001F,
      0, Blit_RGB888_RGB565, NO_ALPHA},
@@ -2541,6 +3377,9 @@ SDL_CalculateBlitN(SDL_Surface * surface)
     const struct blit_table *table;
     int which;
     SDL_BlitFunc blitfun;
+#if HAVE_SSE41_INTRINSICS || HAVE_AVX2_INTRINSICS || HAVE_NEON_INTRINSICS
+    SDL_Swizzle keyswizzle;
+#endif
 
     /* Set up data for choosing the blit */
     srcfmt = surface->format;
@@ -2590,7 +3429,10 @@ SDL_CalculateBlitN(SDL_Surface * surface)
             blitfun = table[which].blitfunc;
 
             if (blitfun == BlitNtoN) {  /* default C fallback catch-all. Slow! */
-                if (srcfmt->format == SDL_PIXELFORMAT_ARGB2101010) {
+                SDL_BlitFunc swizzle = GetSwizzleBlit(srcfmt, dstfmt);
+                if (swizzle) {
+                    blitfun = swizzle;
+                } else if (srcfmt->format == SDL_PIXELFORMAT_ARGB2101010) {
                     blitfun = Blit2101010toN;
                 } else if (dstfmt->format == SDL_PIXELFORMAT_ARGB2101010) {
                     blitfun = BlitNto2101010;
@@ -2622,9 +3464,17 @@ SDL_CalculateBlitN(SDL_Surface * surface)
            because RLE is the preferred fast way to deal with this.
            If a particular case turns out to be useful we'll add it. */
 
-        if (srcfmt->BytesPerPixel == 2 && surface->map->identity)
+        if (srcfmt->BytesPerPixel == 2 && surface->map->identity) {
+#if HAVE_SSE2_INTRINSICS
+            if (SDL_HasSSE2())
+                return Blit2to2KeySSE2;
+#endif
+#if HAVE_NEON_INTRINSICS
+            if (SDL_HasNEON())
+                return Blit2to2KeyNEON;
+#endif
             return Blit2to2Key;
-        else if (dstfmt->BytesPerPixel == 1)
+        } else if (dstfmt->BytesPerPixel == 1)
             return BlitNto1Key;
         else {
 #if SDL_ALTIVEC_BLITTERS
@@ -2632,6 +3482,23 @@ SDL_CalculateBlitN(SDL_Surface * surface)
                 && SDL_HasAltiVec()) {
                 return Blit32to32KeyAltivec;
             } else
+#endif
+#if HAVE_AVX2_INTRINSICS
+            if ((srcfmt->BytesPerPixel == 4) && (dstfmt->BytesPerPixel == 4)
+                && SDL_HasAVX2() && GetSwizzle(srcfmt, dstfmt, 0xFF, &keyswizzle)) {
+                return BlitNtoNKeyAVX2;
+            } else
+#endif
+#if HAVE_SSE41_INTRINSICS
+            if ((srcfmt->BytesPerPixel == 4) && (dstfmt->BytesPerPixel == 4)
+                && SDL_HasSSE41() && GetSwizzle(srcfmt, dstfmt, 0xFF, &keyswizzle)) {
+                return BlitNtoNKeySSE41;
+            } else
+#endif
+#if HAVE_NEON_INTRINSICS
+            if (SDL_HasNEON() && GetSwizzle(srcfmt, dstfmt, 0xFF, &keyswizzle)) {
+                return BlitNtoNKeyNEON;
+            } else
 #endif
             if (srcfmt->Amask && dstfmt->Amask) {
                 return BlitNtoNKeyCopyAlpha;
@@ -25,24 +25,130 @@
 #include "SDL_blit_copy.h"
 
 
+/* Copies bigger than this use non-temporal stores, so that copying a big
+   surface doesn't push everything else out of the cache. */
+#define BLITCOPY_STREAM_BYTES (4 * 1024 * 1024)
+
+/* The SIMD copies do the bytes up to an aligned destination address with
+   SDL_memcpy(), then 64 bytes (or 128 for AVX) at a time, then the rest
+   with SDL_memcpy(). The source can have any alignment. Non-temporal
+   stores are much slower unless they write whole cache lines, so those
+   start on a 64 byte boundary. */
+#define BLITCOPY_HEAD(dst, len, align) \
+    const int head = (int) ((~(uintptr_t) (dst) + 1) & (align)); \
+    if (len < head + 128) { \
+        SDL_memcpy(dst, src, len); \
+        return; \
+    } \
+    SDL_memcpy(dst, src, head); \
+    dst += head; \
+    src += head; \
+    len -= head
+
+#if HAVE_AVX_INTRINSICS
+static void SDL_TARGETING_AVX
+SDL_memcpyAVX(Uint8 * dst, const Uint8 * src, int len, SDL_bool stream)
+{
+    int i;
+    __m256i values[4];
+
+    BLITCOPY_HEAD(dst, len, stream ? 63 : 31);
+
+    if (stream) {
+        for (i = len / 128; i--;) {
+            values[0] = _mm256_loadu_si256((const __m256i *) (src + 0));
+            values[1] = _mm256_loadu_si256((const __m256i *) (src + 32));
+            values[2] = _mm256_loadu_si256((const __m256i *) (src + 64));
+            values[3] = _mm256_loadu_si256((const __m256i *) (src + 96));
+            _mm256_stream_si256((__m256i *) (dst + 0), values[0]);
+            _mm256_stream_si256((__m256i *) (dst + 32), values[1]);
+            _mm256_stream_si256((__m256i *) (dst + 64), values[2]);
+            _mm256_stream_si256((__m256i *) (dst + 96), values[3]);
+            src += 128;
+            dst += 128;
+        }
+    } else {
+        for (i = len / 128; i--;) {
+            values[0] = _mm256_loadu_si256((const __m256i *) (src + 0));
+            values[1] = _mm256_loadu_si256((const __m256i *) (src + 32));
+            values[2] = _mm256_loadu_si256((const __m256i *) (src + 64));
+            values[3] = _mm256_loadu_si256((const __m256i *) (src + 96));
+            _mm256_store_si256((__m256i *) (dst + 0), values[0]);
+            _mm256_store_si256((__m256i *) (dst + 32), values[1]);
+            _mm256_store_si256((__m256i *) (dst + 64), values[2]);
+            _mm256_store_si256((__m256i *) (dst + 96), values[3]);
+            src += 128;
+            dst += 128;
+        }
+    }
+
+    if (len & 127)
+        SDL_memcpy(dst, src, len & 127);
+}
+#endif /* HAVE_AVX_INTRINSICS */
+
 #ifdef __SSE__
-/* This assumes 16-byte aligned src and dst */
 static SDL_INLINE void
-SDL_memcpySSE(Uint8 * dst, const Uint8 * src, int len)
+SDL_memcpySSE(Uint8 * dst, const Uint8 * src, int len, SDL_bool stream)
 {
     int i;
-
     __m128 values[4];
+
+    BLITCOPY_HEAD(dst, len, stream ? 63 : 15);
+
+    if (stream) {
+        for (i = len / 64; i--;) {
+            values[0] = _mm_loadu_ps((const float *) (src + 0));
+            values[1] = _mm_loadu_ps((const float *) (src + 16));
+            values[2] = _mm_loadu_ps((const float *) (src + 32));
+            values[3] = _mm_loadu_ps((const float *) (src + 48));
+            _mm_stream_ps((float *) (dst + 0), values[0]);
+            _mm_stream_ps((float *) (dst + 16), values[1]);
+            _mm_stream_ps((float *) (dst + 32), values[2]);
+            _mm_stream_ps((float *) (dst + 48), values[3]);
+            src += 64;
+            dst += 64;
+        }
+    } else {
+        for (i = len / 64; i--;) {
+            values[0] = _mm_loadu_ps((const float *) (src + 0));
+            values[1] = _mm_loadu_ps((const float *) (src + 16));
+            values[2] = _mm_loadu_ps((const float *) (src + 32));
+            values[3] = _mm_loadu_ps((const float *) (src + 48));
+            _mm_store_ps((float *) (dst + 0), values[0]);
+            _mm_store_ps((float *) (dst + 16), values[1]);
+            _mm_store_ps((float *) (dst + 32), values[2]);
+            _mm_store_ps((float *) (dst + 48), values[3]);
+            src += 64;
+            dst += 64;
+        }
+    }
+
+    if (len & 63)
+        SDL_memcpy(dst, src, len & 63);
+}
+#endif /* __SSE__ */
+
+#if HAVE_NEON_INTRINSICS
+/* There's no intrinsic for ARM's non-temporal stores (STNP is only a
+   hint anyway), so big copies use the regular ones. */
+static SDL_INLINE void
+SDL_memcpyNEON(Uint8 * dst, const Uint8 * src, int len)
+{
+    int i;
+    uint8x16_t values[4];
+
+    BLITCOPY_HEAD(dst, len, 15);
+
     for (i = len / 64; i--;) {
-        _mm_prefetch(src, _MM_HINT_NTA);
-        values[0] = *(__m128 *) (src + 0);
-        values[1] = *(__m128 *) (src + 16);
-        values[2] = *(__m128 *) (src + 32);
-        values[3] = *(__m128 *) (src + 48);
-        _mm_stream_ps((float *) (dst + 0), values[0]);
-        _mm_stream_ps((float *) (dst + 16), values[1]);
-        _mm_stream_ps((float *) (dst + 32), values[2]);
-        _mm_stream_ps((float *) (dst + 48), values[3]);
+        values[0] = vld1q_u8(src + 0);
+        values[1] = vld1q_u8(src + 16);
+        values[2] = vld1q_u8(src + 32);
+        values[3] = vld1q_u8(src + 48);
+        vst1q_u8(dst + 0, values[0]);
+        vst1q_u8(dst + 16, values[1]);
+        vst1q_u8(dst + 32, values[2]);
+        vst1q_u8(dst + 48, values[3]);
         src += 64;
         dst += 64;
     }
@@ -50,7 +156,7 @@ SDL_memcpySSE(Uint8 * dst, const Uint8 * src, int len)
     if (len & 63)
         SDL_memcpy(dst, src, len & 63);
 }
-#endif /* __SSE__ */
+#endif /* HAVE_NEON_INTRINSICS */
 
 #ifdef __MMX__
 #ifdef _MSC_VER
@@ -91,6 +197,9 @@ void
 SDL_BlitCopy(SDL_BlitInfo * info)
 {
     SDL_bool overlap;
+#if HAVE_AVX_INTRINSICS || defined(__SSE__)
+    SDL_bool stream;
+#endif
     Uint8 *src, *dst;
     int w, h;
     int srcskip, dstskip;
@@ -127,12 +236,42 @@ SDL_BlitCopy(SDL_BlitInfo * info)
         return;
     }
 
+#if HAVE_AVX_INTRINSICS || defined(__SSE__)
+    stream = ((Sint64) w * h >= BLITCOPY_STREAM_BYTES) ? SDL_TRUE : SDL_FALSE;
+#endif
+
+#if HAVE_AVX_INTRINSICS
+    if (SDL_HasAVX()) {
+        while (h--) {
+            SDL_memcpyAVX(dst, src, w, stream);
+            src += srcskip;
+            dst += dstskip;
+        }
+        if (stream) {
+            _mm_sfence();
+        }
+        return;
+    }
+#endif
+
 #ifdef __SSE__
-    if (SDL_HasSSE() &&
-        !((uintptr_t) src & 15) && !(srcskip & 15) &&
-        !((uintptr_t) dst & 15) && !(dstskip & 15)) {
+    if (SDL_HasSSE()) {
+        while (h--) {
+            SDL_memcpySSE(dst, src, w, stream);
+            src += srcskip;
+            dst += dstskip;
+        }
+        if (stream) {
+            _mm_sfence();
+        }
+        return;
+    }
+#endif
+
+#if HAVE_NEON_INTRINSICS
+    if (SDL_HasNEON()) {
         while (h--) {
-            SDL_memcpySSE(dst, src, w);
+            SDL_memcpyNEON(dst, src, w);
             src += srcskip;
             dst += dstskip;
         }
@@ -50,8 +50,8 @@ SDL_Blit_Slow(SDL_BlitInfo * info)
     Uint32 ckey = info->colorkey & rgbmask;
 
     srcy = 0;
-    posy = 0;
-    incy = (info->src_h << 16) / info->dst_h;
+    posy = info->src_posy;
+    incy = info->src_incy;
     incx = (info->src_w << 16) / info->dst_w;
 
     while (info->dst_h--) {
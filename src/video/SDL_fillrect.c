@@ -24,9 +24,68 @@
 #include "SDL_blit.h"
 
 
-#ifdef __SSE__
+/* Fills bigger than this use non-temporal stores, so that clearing a big
+   framebuffer doesn't push everything else out of the cache. */
+#define FILLRECT_STREAM_BYTES (4 * 1024 * 1024)
+
 /* *INDENT-OFF* */
 
+/* The SIMD fills do pixels one at a time up to an aligned address, then
+   four vectors at a time, then pixels one at a time to the end of the row.
+   Non-temporal stores are much slower unless they write whole cache lines,
+   so those start on a 64 byte boundary. */
+#define DEFINE_SIMD_FILLRECT(bpp, type, isa, targeting, vecsize, BEGIN, STORE, STREAM, END) \
+static void targeting \
+SDL_FillRect##bpp##isa(Uint8 *pixels, int pitch, Uint32 color, int w, int h) \
+{ \
+    const SDL_bool stream = ((Sint64)w * h * bpp >= FILLRECT_STREAM_BYTES) ? SDL_TRUE : SDL_FALSE; \
+    const uintptr_t align = (stream ? 64 : vecsize) - 1; \
+    int i, n; \
+    Uint8 *p = NULL; \
+ \
+    BEGIN; \
+ \
+    while (h--) { \
+        n = w * bpp; \
+        p = pixels; \
+ \
+        if (n >= 4 * vecsize) { \
+            while (((uintptr_t)p & align) && !((uintptr_t)p & (bpp - 1))) { \
+                *((type *)p) = (type)color; \
+                p += bpp; \
+                n -= bpp; \
+            } \
+            if (stream && !((uintptr_t)p & align)) { \
+                for (i = n / (4 * vecsize); i--;) { \
+                    STREAM(p); \
+                    STREAM(p + vecsize); \
+                    STREAM(p + 2 * vecsize); \
+                    STREAM(p + 3 * vecsize); \
+                    p += 4 * vecsize; \
+                } \
+            } else { \
+                for (i = n / (4 * vecsize); i--;) { \
+                    STORE(p); \
+                    STORE(p + vecsize); \
+                    STORE(p + 2 * vecsize); \
+                    STORE(p + 3 * vecsize); \
+                    p += 4 * vecsize; \
+                } \
+            } \
+            n &= (4 * vecsize) - 1; \
+        } \
+        for (i = n / bpp; i--;) { \
+            *((type *)p) = (type)color; \
+            p += bpp; \
+        } \
+        pixels += pitch; \
+    } \
+ \
+    END; \
+}
+
+#ifdef __SSE__
+
 #ifdef _MSC_VER
 #define SSE_BEGIN \
     __m128 c128; \
@@ -45,90 +104,44 @@
     c128 = *(__m128 *)cccc;
 #endif
 
-#define SSE_WORK \
-    for (i = n / 64; i--;) { \
-        _mm_stream_ps((float *)(p+0), c128); \
-        _mm_stream_ps((float *)(p+16), c128); \
-        _mm_stream_ps((float *)(p+32), c128); \
-        _mm_stream_ps((float *)(p+48), c128); \
-        p += 64; \
-    }
+#define SSE_STORE(p) _mm_storeu_ps((float *)(p), c128)
+#define SSE_STREAM(p) _mm_stream_ps((float *)(p), c128)
+#define SSE_END if (stream) _mm_sfence()
 
-#define SSE_END
+DEFINE_SIMD_FILLRECT(1, Uint8, SSE, , 16, SSE_BEGIN, SSE_STORE, SSE_STREAM, SSE_END)
+DEFINE_SIMD_FILLRECT(2, Uint16, SSE, , 16, SSE_BEGIN, SSE_STORE, SSE_STREAM, SSE_END)
+DEFINE_SIMD_FILLRECT(4, Uint32, SSE, , 16, SSE_BEGIN, SSE_STORE, SSE_STREAM, SSE_END)
 
-#define DEFINE_SSE_FILLRECT(bpp, type) \
-static void \
-SDL_FillRect##bpp##SSE(Uint8 *pixels, int pitch, Uint32 color, int w, int h) \
-{ \
-    int i, n; \
-    Uint8 *p = NULL; \
- \
-    SSE_BEGIN; \
- \
-    while (h--) { \
-        n = w * bpp; \
-        p = pixels; \
- \
-        if (n > 63) { \
-            int adjust = 16 - ((uintptr_t)p & 15); \
-            if (adjust < 16) { \
-                n -= adjust; \
-                adjust /= bpp; \
-                while (adjust--) { \
-                    *((type *)p) = (type)color; \
-                    p += bpp; \
-                } \
-            } \
-            SSE_WORK; \
-        } \
-        if (n & 63) { \
-            int remainder = (n & 63); \
-            remainder /= bpp; \
-            while (remainder--) { \
-                *((type *)p) = (type)color; \
-                p += bpp; \
-            } \
-        } \
-        pixels += pitch; \
-    } \
- \
-    SSE_END; \
-}
+#endif /* __SSE__ */
 
-static void
-SDL_FillRect1SSE(Uint8 *pixels, int pitch, Uint32 color, int w, int h)
-{
-    int i, n;
+#if HAVE_AVX_INTRINSICS
 
-    SSE_BEGIN;
-    while (h--) {
-        Uint8 *p = pixels;
-        n = w;
+#define AVX_BEGIN const __m256i c256 = _mm256_set1_epi32((int)color)
+#define AVX_STORE(p) _mm256_storeu_si256((__m256i *)(p), c256)
+#define AVX_STREAM(p) _mm256_stream_si256((__m256i *)(p), c256)
+#define AVX_END if (stream) _mm_sfence()
 
-        if (n > 63) {
-            int adjust = 16 - ((uintptr_t)p & 15);
-            if (adjust) {
-                n -= adjust;
-                SDL_memset(p, color, adjust);
-                p += adjust;
-            }
-            SSE_WORK;
-        }
-        if (n & 63) {
-            int remainder = (n & 63);
-            SDL_memset(p, color, remainder);
-        }
-        pixels += pitch;
-    }
+DEFINE_SIMD_FILLRECT(1, Uint8, AVX, SDL_TARGETING_AVX, 32, AVX_BEGIN, AVX_STORE, AVX_STREAM, AVX_END)
+DEFINE_SIMD_FILLRECT(2, Uint16, AVX, SDL_TARGETING_AVX, 32, AVX_BEGIN, AVX_STORE, AVX_STREAM, AVX_END)
+DEFINE_SIMD_FILLRECT(4, Uint32, AVX, SDL_TARGETING_AVX, 32, AVX_BEGIN, AVX_STORE, AVX_STREAM, AVX_END)
 
-    SSE_END;
-}
-/* DEFINE_SSE_FILLRECT(1, Uint8) */
-DEFINE_SSE_FILLRECT(2, Uint16)
-DEFINE_SSE_FILLRECT(4, Uint32)
+#endif /* HAVE_AVX_INTRINSICS */
+
+#if HAVE_NEON_INTRINSICS
+
+/* There's no intrinsic for ARM's non-temporal stores, so big fills use
+   the regular ones. */
+#define NEON_BEGIN const uint8x16_t c128 = vreinterpretq_u8_u32(vdupq_n_u32(color))
+#define NEON_STORE(p) vst1q_u8((p), c128)
+#define NEON_END (void)stream
+
+DEFINE_SIMD_FILLRECT(1, Uint8, NEON, , 16, NEON_BEGIN, NEON_STORE, NEON_STORE, NEON_END)
+DEFINE_SIMD_FILLRECT(2, Uint16, NEON, , 16, NEON_BEGIN, NEON_STORE, NEON_STORE, NEON_END)
+DEFINE_SIMD_FILLRECT(4, Uint32, NEON, , 16, NEON_BEGIN, NEON_STORE, NEON_STORE, NEON_END)
+
+#endif /* HAVE_NEON_INTRINSICS */
 
 /* *INDENT-ON* */
-#endif /* __SSE__ */
 
 static void
 SDL_FillRect1(Uint8 * pixels, int pitch, Uint32 color, int w, int h)
@@ -230,6 +243,77 @@ SDL_FillRect4(Uint8 * pixels, int pitch, Uint32 color, int w, int h)
     }
 }
 
+typedef void (*SDL_FillRectFunc) (Uint8 * pixels, int pitch, Uint32 color, int w, int h);
+
+/* Pick the fill for this pixel size, and repeat the color to 32 bits */
+static SDL_FillRectFunc
+SDL_ChooseFillRect(int bpp, Uint32 * color)
+{
+    switch (bpp) {
+    case 1:
+        *color |= (*color << 8);
+        *color |= (*color << 16);
+#if HAVE_AVX_INTRINSICS
+        if (SDL_HasAVX()) {
+            return SDL_FillRect1AVX;
+        }
+#endif
+#ifdef __SSE__
+        if (SDL_HasSSE()) {
+            return SDL_FillRect1SSE;
+        }
+#endif
+#if HAVE_NEON_INTRINSICS
+        if (SDL_HasNEON()) {
+            return SDL_FillRect1NEON;
+        }
+#endif
+        return SDL_FillRect1;
+
+    case 2:
+        *color |= (*color << 16);
+#if HAVE_AVX_INTRINSICS
+        if (SDL_HasAVX()) {
+            return SDL_FillRect2AVX;
+        }
+#endif
+#ifdef __SSE__
+        if (SDL_HasSSE()) {
+            return SDL_FillRect2SSE;
+        }
+#endif
+#if HAVE_NEON_INTRINSICS
+        if (SDL_HasNEON()) {
+            return SDL_FillRect2NEON;
+        }
+#endif
+        return SDL_FillRect2;
+
+    case 3:
+        /* 24-bit RGB is a slow path, at least for now. */
+        return SDL_FillRect3;
+
+    case 4:
+#if HAVE_AVX_INTRINSICS
+        if (SDL_HasAVX()) {
+            return SDL_FillRect4AVX;
+        }
+#endif
+#ifdef __SSE__
+        if (SDL_HasSSE()) {
+            return SDL_FillRect4SSE;
+        }
+#endif
+#if HAVE_NEON_INTRINSICS
+        if (SDL_HasNEON()) {
+            return SDL_FillRect4NEON;
+        }
+#endif
+        return SDL_FillRect4;
+    }
+    return NULL;
+}
+
 /* 
  * This function performs a fast fill of the given rectangle with 'color'
  */
@@ -238,6 +322,7 @@ SDL_FillRect(SDL_Surface * dst, const SDL_Rect * rect, Uint32 color)
 {
     SDL_Rect clipped;
     Uint8 *pixels;
+    SDL_FillRectFunc fill;
 
     if (!dst) {
         return SDL_SetError("Passed NULL destination surface");
@@ -271,55 +356,107 @@ SDL_FillRect(SDL_Surface * dst, const SDL_Rect * rect, Uint32 color)
     pixels = (Uint8 *) dst->pixels + rect->y * dst->pitch +
                                      rect->x * dst->format->BytesPerPixel;
 
-    switch (dst->format->BytesPerPixel) {
-    case 1:
-        {
-            color |= (color << 8);
-            color |= (color << 16);
-#ifdef __SSE__
-            if (SDL_HasSSE()) {
-                SDL_FillRect1SSE(pixels, dst->pitch, color, rect->w, rect->h);
-                break;
-            }
-#endif
-            SDL_FillRect1(pixels, dst->pitch, color, rect->w, rect->h);
-            break;
+    fill = SDL_ChooseFillRect(dst->format->BytesPerPixel, &color);
+    if (fill) {
+        fill(pixels, dst->pitch, color, rect->w, rect->h);
+    }
+
+    /* We're done! */
+    return 0;
+}
+
+static int
+SDL_CompareFillRectsY(const void *a, const void *b)
+{
+    return ((const SDL_Rect *) a)->y - ((const SDL_Rect *) b)->y;
+}
+
+static int
+SDL_CompareFillSpans(const void *a, const void *b)
+{
+    return ((const int *) a)[0] - ((const int *) b)[0];
+}
+
+/* Fill the union of some clipped, overlapping rects, sorted by y. Each
+   band of rows between two rect edges has the same rects across it, so
+   their spans are merged and each pixel is only written once. */
+static int
+SDL_FillOverlappingRects(SDL_Surface * dst, const SDL_Rect * rects, int count,
+                         SDL_FillRectFunc fill, Uint32 color)
+{
+    const int bpp = dst->format->BytesPerPixel;
+    int *edges = (int *) SDL_malloc(2 * count * sizeof (int));
+    int *spans = (int *) SDL_malloc(2 * count * sizeof (int));
+    int *active = (int *) SDL_malloc(count * sizeof (int));
+    int numedges = 0;
+    int numactive = 0;
+    int next = 0;
+    int i, j, e;
+
+    if (!edges || !spans || !active) {
+        SDL_free(edges);
+        SDL_free(spans);
+        SDL_free(active);
+        return SDL_OutOfMemory();
+    }
+
+    for (i = 0; i < count; ++i) {
+        edges[numedges++] = rects[i].y;
+        edges[numedges++] = rects[i].y + rects[i].h;
+    }
+    SDL_qsort(edges, numedges, sizeof (int), SDL_CompareFillSpans);
+
+    for (e = 0; e < numedges - 1; ++e) {
+        const int top = edges[e];
+        const int bottom = edges[e + 1];
+        int numspans = 0;
+        int left, right;
+
+        if (top == bottom) {
+            continue;
         }
 
-    case 2:
-        {
-            color |= (color << 16);
-#ifdef __SSE__
-            if (SDL_HasSSE()) {
-                SDL_FillRect2SSE(pixels, dst->pitch, color, rect->w, rect->h);
-                break;
+        /* Keep track of the rects across this band */
+        while ((next < count) && (rects[next].y <= top)) {
+            active[numactive++] = next++;
+        }
+        for (i = 0, j = 0; i < numactive; ++i) {
+            if (rects[active[i]].y + rects[active[i]].h > top) {
+                active[j++] = active[i];
             }
-#endif
-            SDL_FillRect2(pixels, dst->pitch, color, rect->w, rect->h);
-            break;
         }
-
-    case 3:
-        /* 24-bit RGB is a slow path, at least for now. */
-        {
-            SDL_FillRect3(pixels, dst->pitch, color, rect->w, rect->h);
-            break;
+        numactive = j;
+        if (numactive == 0) {
+            continue;
         }
 
-    case 4:
-        {
-#ifdef __SSE__
-            if (SDL_HasSSE()) {
-                SDL_FillRect4SSE(pixels, dst->pitch, color, rect->w, rect->h);
-                break;
+        /* Merge their spans, in order of their left edges */
+        for (i = 0; i < numactive; ++i) {
+            spans[2 * numspans] = rects[active[i]].x;
+            spans[2 * numspans + 1] = rects[active[i]].x + rects[active[i]].w;
+            ++numspans;
+        }
+        SDL_qsort(spans, numspans, 2 * sizeof (int), SDL_CompareFillSpans);
+
+        left = spans[0];
+        right = spans[1];
+        for (i = 1; i <= numspans; ++i) {
+            if ((i < numspans) && (spans[2 * i] <= right)) {
+                right = SDL_max(right, spans[2 * i + 1]);
+                continue;
+            }
+            fill((Uint8 *) dst->pixels + top * dst->pitch + left * bpp,
+                 dst->pitch, color, right - left, bottom - top);
+            if (i < numspans) {
+                left = spans[2 * i];
+                right = spans[2 * i + 1];
             }
-#endif
-            SDL_FillRect4(pixels, dst->pitch, color, rect->w, rect->h);
-            break;
         }
     }
 
-    /* We're done! */
+    SDL_free(active);
+    SDL_free(spans);
+    SDL_free(edges);
     return 0;
 }
 
@@ -327,16 +464,62 @@ int
 SDL_FillRects(SDL_Surface * dst, const SDL_Rect * rects, int count,
               Uint32 color)
 {
-    int i;
+    SDL_Rect *clipped;
+    SDL_FillRectFunc fill;
+    SDL_bool overlap = SDL_FALSE;
+    int numclipped = 0;
+    int i, j;
     int status = 0;
 
     if (!rects) {
         return SDL_SetError("SDL_FillRects() passed NULL rects");
     }
+    if (count <= 1 || !dst || dst->format->BitsPerPixel < 8 || !dst->pixels) {
+        /* Nothing to merge; SDL_FillRect() reports any problems */
+        for (i = 0; i < count; ++i) {
+            status += SDL_FillRect(dst, &rects[i], color);
+        }
+        return status;
+    }
 
+    clipped = (SDL_Rect *) SDL_malloc(count * sizeof (SDL_Rect));
+    if (!clipped) {
+        return SDL_OutOfMemory();
+    }
     for (i = 0; i < count; ++i) {
-        status += SDL_FillRect(dst, &rects[i], color);
+        if (SDL_IntersectRect(&rects[i], &dst->clip_rect, &clipped[numclipped])) {
+            ++numclipped;
+        }
+    }
+
+    /* Filling top to bottom walks through memory in order, and makes it
+       cheap to see if any of the rects overlap. */
+    SDL_qsort(clipped, numclipped, sizeof (SDL_Rect), SDL_CompareFillRectsY);
+    for (i = 0; (i < numclipped) && !overlap; ++i) {
+        const int bottom = clipped[i].y + clipped[i].h;
+        for (j = i + 1; (j < numclipped) && (clipped[j].y < bottom); ++j) {
+            if ((clipped[j].x < clipped[i].x + clipped[i].w) &&
+                (clipped[i].x < clipped[j].x + clipped[j].w)) {
+                overlap = SDL_TRUE;
+                break;
+            }
+        }
     }
+
+    fill = SDL_ChooseFillRect(dst->format->BytesPerPixel, &color);
+    if (!fill) {
+        /* no fill for this pixel size */
+    } else if (overlap) {
+        status = SDL_FillOverlappingRects(dst, clipped, numclipped, fill, color);
+    } else {
+        const int bpp = dst->format->BytesPerPixel;
+        for (i = 0; i < numclipped; ++i) {
+            fill((Uint8 *) dst->pixels + clipped[i].y * dst->pitch + clipped[i].x * bpp,
+                 dst->pitch, color, clipped[i].w, clipped[i].h);
+        }
+    }
+
+    SDL_free(clipped);
     return status;
 }
 
@@ -23,6 +23,7 @@
 /* General (mostly internal) pixel/color manipulation routines for SDL */
 
 #include "SDL_endian.h"
+#include "SDL_atomic.h"
 #include "SDL_video.h"
 #include "SDL_sysvideo.h"
 #include "SDL_blit.h"
@@ -950,6 +951,178 @@ MapNto1(SDL_PixelFormat * src, SDL_PixelFormat * dst, int *identical)
     return (Map1to1(&dithered, pal, identical));
 }
 
+/* Building these tables means mapping every color, and Map1to1() and
+   MapNto1() search the destination palette for each one. A surface whose
+   color mod changes every draw, or that's blitted to one surface after
+   another, builds them over and over, so the last few tables are kept
+   here, keyed by everything that goes into them, most recently used first.
+   Palettes are compared by their colors rather than their pointer and
+   version, since a freed palette's memory can be reused. */
+#define MAP_CACHE_SIZE 8
+#define MAP_CACHE_MAX_COLORS 256
+
+enum
+{
+    MAP_1TO1,
+    MAP_1TON,
+    MAP_NTO1
+};
+
+typedef struct
+{
+    int kind;
+    Uint32 dst_format;
+    Uint8 r, g, b, a;
+    int src_ncolors;
+    int dst_ncolors;
+} SDL_MapKey;
+
+typedef struct
+{
+    Uint8 *key;         /* an SDL_MapKey, then the source and destination colors */
+    size_t keylen;
+    Uint8 *table;       /* NULL if the palettes were identical */
+    size_t tablelen;
+    int identical;
+} SDL_MapCacheEntry;
+
+static SDL_SpinLock map_cache_lock;
+static SDL_MapCacheEntry map_cache[MAP_CACHE_SIZE];
+static int map_cache_count;
+
+static Uint8 *
+SDL_DupTable(const Uint8 * table, size_t len)
+{
+    Uint8 *copy = (Uint8 *) SDL_malloc(len);
+    if (copy) {
+        SDL_memcpy(copy, table, len);
+    }
+    return (copy);
+}
+
+/* Map1to1(), Map1toN() or MapNto1(), going through the cache */
+static Uint8 *
+MapCached(int kind, SDL_PixelFormat * src, Uint8 Rmod, Uint8 Gmod,
+          Uint8 Bmod, Uint8 Amod, SDL_PixelFormat * dst, int *identical)
+{
+    SDL_Palette *srcpal = (kind == MAP_NTO1) ? NULL : src->palette;
+    SDL_Palette *dstpal = (kind == MAP_1TON) ? NULL : dst->palette;
+    Uint8 key[sizeof(SDL_MapKey) + 2 * MAP_CACHE_MAX_COLORS * sizeof(SDL_Color)];
+    SDL_MapKey header;
+    SDL_MapCacheEntry entry;
+    size_t srclen, dstlen, keylen;
+    Uint8 *table = NULL;
+    int i, same = 0;
+
+    SDL_zero(header);
+    header.kind = kind;
+    if (kind == MAP_1TON) {
+        header.dst_format = dst->format;
+        header.r = Rmod;
+        header.g = Gmod;
+        header.b = Bmod;
+        header.a = Amod;
+    }
+    header.src_ncolors = srcpal ? srcpal->ncolors : 0;
+    header.dst_ncolors = dstpal ? dstpal->ncolors : 0;
+    srclen = header.src_ncolors * sizeof(SDL_Color);
+    dstlen = header.dst_ncolors * sizeof(SDL_Color);
+    keylen = sizeof(header) + srclen + dstlen;
+
+    if (header.src_ncolors > MAP_CACHE_MAX_COLORS ||
+        header.dst_ncolors > MAP_CACHE_MAX_COLORS ||
+        (kind == MAP_1TON && dst->format == SDL_PIXELFORMAT_UNKNOWN)) {
+        keylen = 0;     /* too odd to cache */
+    } else {
+        SDL_memcpy(key, &header, sizeof(header));
+        if (srcpal) {
+            SDL_memcpy(key + sizeof(header), srcpal->colors, srclen);
+        }
+        if (dstpal) {
+            SDL_memcpy(key + sizeof(header) + srclen, dstpal->colors, dstlen);
+        }
+
+        SDL_AtomicLock(&map_cache_lock);
+        for (i = 0; i < map_cache_count; ++i) {
+            if (map_cache[i].keylen == keylen &&
+                SDL_memcmp(map_cache[i].key, key, keylen) == 0) {
+                entry = map_cache[i];
+                SDL_memmove(&map_cache[1], &map_cache[0], i * sizeof(map_cache[0]));
+                map_cache[0] = entry;
+                if (entry.table) {
+                    table = SDL_DupTable(entry.table, entry.tablelen);
+                }
+                SDL_AtomicUnlock(&map_cache_lock);
+                if (entry.table && table == NULL) {
+                    SDL_OutOfMemory();
+                }
+                if (identical) {
+                    *identical = entry.identical;
+                }
+                return (table);
+            }
+        }
+        SDL_AtomicUnlock(&map_cache_lock);
+    }
+
+    switch (kind) {
+    case MAP_1TO1:
+        table = Map1to1(srcpal, dstpal, &same);
+        entry.tablelen = srcpal->ncolors;
+        break;
+    case MAP_1TON:
+        table = Map1toN(src, Rmod, Gmod, Bmod, Amod, dst);
+        entry.tablelen = srcpal->ncolors * ((dst->BytesPerPixel == 3) ? 4 : dst->BytesPerPixel);
+        break;
+    default:
+        table = MapNto1(src, dst, &same);
+        entry.tablelen = 256;
+        break;
+    }
+    if (identical) {
+        *identical = same;
+    }
+    if (keylen == 0 || (table == NULL && !same)) {
+        return (table);
+    }
+
+    /* Remember it */
+    entry.key = SDL_DupTable(key, keylen);
+    entry.keylen = keylen;
+    entry.table = table ? SDL_DupTable(table, entry.tablelen) : NULL;
+    entry.identical = same;
+    if (entry.key == NULL || (table && entry.table == NULL)) {
+        SDL_free(entry.key);
+        SDL_free(entry.table);
+        return (table);
+    }
+    SDL_AtomicLock(&map_cache_lock);
+    if (map_cache_count == MAP_CACHE_SIZE) {
+        SDL_free(map_cache[MAP_CACHE_SIZE - 1].key);
+        SDL_free(map_cache[MAP_CACHE_SIZE - 1].table);
+    } else {
+        ++map_cache_count;
+    }
+    SDL_memmove(&map_cache[1], &map_cache[0], (map_cache_count - 1) * sizeof(map_cache[0]));
+    map_cache[0] = entry;
+    SDL_AtomicUnlock(&map_cache_lock);
+    return (table);
+}
+
+void
+SDL_QuitMapCache(void)
+{
+    int i;
+
+    SDL_AtomicLock(&map_cache_lock);
+    for (i = 0; i < map_cache_count; ++i) {
+        SDL_free(map_cache[i].key);
+        SDL_free(map_cache[i].table);
+    }
+    map_cache_count = 0;
+    SDL_AtomicUnlock(&map_cache_lock);
+}
+
 SDL_BlitMap *
 SDL_AllocBlitMap(void)
 {
@@ -1011,7 +1184,7 @@ SDL_MapSurface(SDL_Surface * src, SDL_Surface * dst)
         if (SDL_ISPIXELFORMAT_INDEXED(dstfmt->format)) {
             /* Palette --> Palette */
             map->info.table =
-                Map1to1(srcfmt->palette, dstfmt->palette, &map->identity);
+                MapCached(MAP_1TO1, srcfmt, 0, 0, 0, 0, dstfmt, &map->identity);
             if (!map->identity) {
                 if (map->info.table == NULL) {
                     return (-1);
@@ -1022,8 +1195,8 @@ SDL_MapSurface(SDL_Surface * src, SDL_Surface * dst)
         } else {
             /* Palette --> BitField */
             map->info.table =
-                Map1toN(srcfmt, src->map->info.r, src->map->info.g,
-                        src->map->info.b, src->map->info.a, dstfmt);
+                MapCached(MAP_1TON, srcfmt, src->map->info.r, src->map->info.g,
+                          src->map->info.b, src->map->info.a, dstfmt, NULL);
             if (map->info.table == NULL) {
                 return (-1);
             }
@@ -1031,7 +1204,8 @@ SDL_MapSurface(SDL_Surface * src, SDL_Surface * dst)
     } else {
         if (SDL_ISPIXELFORMAT_INDEXED(dstfmt->format)) {
             /* BitField --> Palette */
-            map->info.table = MapNto1(srcfmt, dstfmt, &map->identity);
+            map->info.table =
+                MapCached(MAP_NTO1, srcfmt, 0, 0, 0, 0, dstfmt, &map->identity);
             if (!map->identity) {
                 if (map->info.table == NULL) {
                     return (-1);
@@ -27,6 +27,7 @@
 */
 
 #include "SDL_video.h"
+#include "SDL_atomic.h"
 #include "SDL_blit.h"
 
 /* This isn't ready for general consumption yet - it should be folded
@@ -196,97 +197,48 @@ copy_row3(Uint8 * src, int src_w, Uint8 * dst, int dst_w)
     }
 }
 
-/* Perform a stretch blit between two surfaces of the same format.
-   NOTE:  This function is not safe to call from multiple threads!
-*/
-int
-SDL_SoftStretch(SDL_Surface * src, const SDL_Rect * srcrect,
-                SDL_Surface * dst, const SDL_Rect * dstrect)
+typedef struct
 {
-    int src_locked;
-    int dst_locked;
-    int pos, inc;
+    SDL_Surface *src;
+    SDL_Surface *dst;
+    const SDL_Rect *srcrect;
+    const SDL_Rect *dstrect;
+    int inc;
+#ifdef USE_ASM_STRETCH
+    SDL_bool use_asm;
+#endif
+} SDL_StretchInfo;
+
+/* Stretch rows y through y+h-1 of the destination rectangle */
+static void
+SDL_StretchRows(void *data, int y, int h)
+{
+    const SDL_StretchInfo *stretch = (const SDL_StretchInfo *) data;
+    SDL_Surface *src = stretch->src;
+    SDL_Surface *dst = stretch->dst;
+    const SDL_Rect *srcrect = stretch->srcrect;
+    const SDL_Rect *dstrect = stretch->dstrect;
+    const int bpp = dst->format->BytesPerPixel;
+    const int inc = stretch->inc;
+    const Sint64 start = (Sint64) y * inc;
+    int pos;
     int dst_maxrow;
     int src_row, dst_row;
     Uint8 *srcp = NULL;
     Uint8 *dstp;
-    SDL_Rect full_src;
-    SDL_Rect full_dst;
 #ifdef USE_ASM_STRETCH
-    SDL_bool use_asm = SDL_TRUE;
 #ifdef __GNUC__
     int u1, u2;
 #endif
 #endif /* USE_ASM_STRETCH */
-    const int bpp = dst->format->BytesPerPixel;
 
-    if (src->format->format != dst->format->format) {
-        return SDL_SetError("Only works with same format surfaces");
-    }
-
-    /* Verify the blit rectangles */
-    if (srcrect) {
-        if ((srcrect->x < 0) || (srcrect->y < 0) ||
-            ((srcrect->x + srcrect->w) > src->w) ||
-            ((srcrect->y + srcrect->h) > src->h)) {
-            return SDL_SetError("Invalid source blit rectangle");
-        }
-    } else {
-        full_src.x = 0;
-        full_src.y = 0;
-        full_src.w = src->w;
-        full_src.h = src->h;
-        srcrect = &full_src;
-    }
-    if (dstrect) {
-        if ((dstrect->x < 0) || (dstrect->y < 0) ||
-            ((dstrect->x + dstrect->w) > dst->w) ||
-            ((dstrect->y + dstrect->h) > dst->h)) {
-            return SDL_SetError("Invalid destination blit rectangle");
-        }
-    } else {
-        full_dst.x = 0;
-        full_dst.y = 0;
-        full_dst.w = dst->w;
-        full_dst.h = dst->h;
-        dstrect = &full_dst;
-    }
-
-    /* Lock the destination if it's in hardware */
-    dst_locked = 0;
-    if (SDL_MUSTLOCK(dst)) {
-        if (SDL_LockSurface(dst) < 0) {
-            return SDL_SetError("Unable to lock destination surface");
-        }
-        dst_locked = 1;
-    }
-    /* Lock the source if it's in hardware */
-    src_locked = 0;
-    if (SDL_MUSTLOCK(src)) {
-        if (SDL_LockSurface(src) < 0) {
-            if (dst_locked) {
-                SDL_UnlockSurface(dst);
-            }
-            return SDL_SetError("Unable to lock source surface");
-        }
-        src_locked = 1;
-    }
-
-    /* Set up the data... */
-    pos = 0x10000;
-    inc = (srcrect->h << 16) / dstrect->h;
-    src_row = srcrect->y;
-    dst_row = dstrect->y;
-
-#ifdef USE_ASM_STRETCH
-    /* Write the opcodes for this stretch */
-    if ((bpp == 3) || (generate_rowbytes(srcrect->w, dstrect->w, bpp) < 0)) {
-        use_asm = SDL_FALSE;
-    }
-#endif
+    /* Set up the data where a stretch of the whole rect would be at row y */
+    pos = 0x10000 + (int) (start & 0xFFFF);
+    src_row = srcrect->y + (int) (start >> 16);
+    dst_row = dstrect->y + y;
 
     /* Perform the stretch blit */
-    for (dst_maxrow = dst_row + dstrect->h; dst_row < dst_maxrow; ++dst_row) {
+    for (dst_maxrow = dst_row + h; dst_row < dst_maxrow; ++dst_row) {
         dstp = (Uint8 *) dst->pixels + (dst_row * dst->pitch)
             + (dstrect->x * bpp);
         while (pos >= 0x10000L) {
@@ -296,7 +248,7 @@ SDL_SoftStretch(SDL_Surface * src, const SDL_Rect * srcrect,
             pos -= 0x10000L;
         }
 #ifdef USE_ASM_STRETCH
-        if (use_asm) {
+        if (stretch->use_asm) {
 #ifdef __GNUC__
             __asm__ __volatile__("call *%4":"=&D"(u1), "=&S"(u2)
                                  :"0"(dstp), "1"(srcp), "r"(copy_row)
@@ -339,6 +291,102 @@ SDL_SoftStretch(SDL_Surface * src, const SDL_Rect * srcrect,
             }
         pos += inc;
     }
+}
+
+/* Check the stretch rectangles, filling in the whole surface for NULL */
+static int
+SDL_GetStretchRects(SDL_Surface * src, const SDL_Rect ** srcrect, SDL_Rect * full_src,
+                    SDL_Surface * dst, const SDL_Rect ** dstrect, SDL_Rect * full_dst)
+{
+    if (*srcrect) {
+        if (((*srcrect)->x < 0) || ((*srcrect)->y < 0) ||
+            (((*srcrect)->x + (*srcrect)->w) > src->w) ||
+            (((*srcrect)->y + (*srcrect)->h) > src->h)) {
+            return SDL_SetError("Invalid source blit rectangle");
+        }
+    } else {
+        full_src->x = 0;
+        full_src->y = 0;
+        full_src->w = src->w;
+        full_src->h = src->h;
+        *srcrect = full_src;
+    }
+    if (*dstrect) {
+        if (((*dstrect)->x < 0) || ((*dstrect)->y < 0) ||
+            (((*dstrect)->x + (*dstrect)->w) > dst->w) ||
+            (((*dstrect)->y + (*dstrect)->h) > dst->h)) {
+            return SDL_SetError("Invalid destination blit rectangle");
+        }
+    } else {
+        full_dst->x = 0;
+        full_dst->y = 0;
+        full_dst->w = dst->w;
+        full_dst->h = dst->h;
+        *dstrect = full_dst;
+    }
+    return 0;
+}
+
+/* Perform a stretch blit between two surfaces of the same format.
+   NOTE:  This function is not safe to call from multiple threads!
+*/
+int
+SDL_SoftStretch(SDL_Surface * src, const SDL_Rect * srcrect,
+                SDL_Surface * dst, const SDL_Rect * dstrect)
+{
+    int src_locked;
+    int dst_locked;
+    SDL_Rect full_src;
+    SDL_Rect full_dst;
+    SDL_StretchInfo stretch;
+
+    if (src->format->format != dst->format->format) {
+        return SDL_SetError("Only works with same format surfaces");
+    }
+
+    /* Verify the blit rectangles */
+    if (SDL_GetStretchRects(src, &srcrect, &full_src, dst, &dstrect, &full_dst) < 0) {
+        return -1;
+    }
+
+    /* Lock the destination if it's in hardware */
+    dst_locked = 0;
+    if (SDL_MUSTLOCK(dst)) {
+        if (SDL_LockSurface(dst) < 0) {
+            return SDL_SetError("Unable to lock destination surface");
+        }
+        dst_locked = 1;
+    }
+    /* Lock the source if it's in hardware */
+    src_locked = 0;
+    if (SDL_MUSTLOCK(src)) {
+        if (SDL_LockSurface(src) < 0) {
+            if (dst_locked) {
+                SDL_UnlockSurface(dst);
+            }
+            return SDL_SetError("Unable to lock source surface");
+        }
+        src_locked = 1;
+    }
+
+    /* Set up the data... */
+    stretch.src = src;
+    stretch.dst = dst;
+    stretch.srcrect = srcrect;
+    stretch.dstrect = dstrect;
+    stretch.inc = (srcrect->h << 16) / dstrect->h;
+
+#ifdef USE_ASM_STRETCH
+    /* Write the opcodes for this stretch */
+    stretch.use_asm = SDL_TRUE;
+    if ((dst->format->BytesPerPixel == 3) ||
+        (generate_rowbytes(srcrect->w, dstrect->w, dst->format->BytesPerPixel) < 0)) {
+        stretch.use_asm = SDL_FALSE;
+    }
+#endif
+
+    /* Perform the stretch blit, in bands of rows for big ones */
+    SDL_RunBlitBands(src, dst, dstrect->h, dstrect->w, SDL_StretchRows, &stretch);
 
     /* We need to unlock the surfaces if they're locked */
     if (dst_locked) {
@@ -350,4 +398,484 @@ SDL_SoftStretch(SDL_Surface * src, const SDL_Rect * srcrect,
     return (0);
 }
 
+/* Filtered stretching works on 32-bit pixels with 8-bit channels. Each
+   source row a destination row needs is filtered horizontally into 16-bit
+   channels (the 8-bit value times 128), and those rows are then filtered
+   vertically into the destination row. Enlarging an axis interpolates
+   between the two nearest pixels, shrinking it averages every pixel the
+   destination pixel covers, weighted by how much of it is covered.
+
+   Weights are 14-bit fixed point and add up to exactly 1, so flat colors
+   come through unchanged, and the SIMD versions do the same integer math
+   as the C ones, so they give the same result. */
+#define STRETCH_WEIGHT_BITS 14
+#define STRETCH_ONE         (1 << STRETCH_WEIGHT_BITS)
+#define STRETCH_HBITS       7
+#define STRETCH_VBITS       (STRETCH_HBITS + STRETCH_WEIGHT_BITS)
+
+typedef struct
+{
+    int *spans;         /* first tap and number of taps, per destination pixel */
+    int *index;         /* the source pixel each tap reads */
+    Sint16 *weight;
+    int maxtaps;        /* every span has an even number of taps */
+    int src_first;      /* the source pixels the taps read, which index */
+    int src_count;      /* counts from */
+} SDL_StretchFilter;
+
+typedef struct
+{
+    const Uint8 *src;   /* source rect, in the working format */
+    int src_pitch;
+    Uint8 *dst;         /* destination rect */
+    int dst_pitch;
+    int dst_w;
+    Uint32 work_format;
+    Uint32 dst_format;
+    SDL_StretchFilter xfilter;
+    SDL_StretchFilter yfilter;
+    SDL_atomic_t failed;
+} SDL_StretchLinearInfo;
+
+static void
+SDL_FreeStretchFilter(SDL_StretchFilter * filter)
+{
+    SDL_free(filter->spans);
+    SDL_free(filter->index);
+    SDL_free(filter->weight);
+    filter->spans = NULL;
+    filter->index = NULL;
+    filter->weight = NULL;
+}
+
+static void
+SDL_AddStretchTap(SDL_StretchFilter * filter, int *count, int index, int weight)
+{
+    filter->index[*count] = index;
+    filter->weight[*count] = (Sint16) weight;
+    ++*count;
+}
+
+/* Work out the taps for destination pixels dst_first through
+   dst_first+n-1 when stretching src_n pixels to dst_n pixels */
+static int
+SDL_BuildStretchFilter(SDL_StretchFilter * filter, int src_n, int dst_n,
+                       int dst_first, int n)
+{
+    const int maxtaps = (src_n > dst_n) ? ((src_n / dst_n) + 3) : 2;
+    int count = 0;
+    int lowest, highest;
+    int d, t;
+
+    filter->spans = (int *) SDL_malloc(2 * n * sizeof (int));
+    filter->index = (int *) SDL_malloc(n * maxtaps * sizeof (int));
+    filter->weight = (Sint16 *) SDL_malloc(n * maxtaps * sizeof (Sint16));
+    filter->maxtaps = 0;
+    if (!filter->spans || !filter->index || !filter->weight) {
+        SDL_FreeStretchFilter(filter);
+        return SDL_OutOfMemory();
+    }
+
+    for (d = dst_first; d < dst_first + n; ++d) {
+        const int first = count;
+
+        if (src_n <= dst_n) {
+            /* Interpolate between the pixels either side of this one's center */
+            Sint64 center = ((Sint64) (2 * d + 1) * src_n * 0x8000) / dst_n - 0x8000;
+            int i, w;
+            if (center < 0) {
+                center = 0;
+            }
+            i = (int) (center >> 16);
+            w = (int) (((center & 0xFFFF) + 2) >> 2);
+            if (i >= src_n - 1) {
+                i = src_n - 1;
+                w = 0;
+            }
+            SDL_AddStretchTap(filter, &count, i, STRETCH_ONE - w);
+            SDL_AddStretchTap(filter, &count, SDL_min(i + 1, src_n - 1), w);
+        } else {
+            /* Average the source pixels under this one. In units of 1/dst_n
+               source pixels, it covers [lo, hi) and source pixel i covers
+               [i * dst_n, (i + 1) * dst_n). */
+            const Sint64 lo = (Sint64) d * src_n;
+            const Sint64 hi = lo + src_n;
+            int i = (int) (lo / dst_n);
+            const int last = (int) ((hi - 1) / dst_n);
+            int total = 0;
+            int biggest = count;
+            for (; i <= last; ++i) {
+                const Sint64 left = SDL_max(lo, (Sint64) i * dst_n);
+                const Sint64 right = SDL_min(hi, (Sint64) (i + 1) * dst_n);
+                const int w = (int) ((((right - left) * STRETCH_ONE) + (src_n / 2)) / src_n);
+                if ((count == first) || (w > filter->weight[biggest])) {
+                    biggest = count;
+                }
+                SDL_AddStretchTap(filter, &count, i, w);
+                total += w;
+            }
+            /* Rounding can leave the weights a little off 1 */
+            filter->weight[biggest] += (Sint16) (STRETCH_ONE - total);
+        }
+
+        if ((count - first) & 1) {
+            SDL_AddStretchTap(filter, &count, filter->index[count - 1], 0);
+        }
+        filter->spans[2 * (d - dst_first)] = first;
+        filter->spans[2 * (d - dst_first) + 1] = count - first;
+        filter->maxtaps = SDL_max(filter->maxtaps, count - first);
+    }
+
+    /* Only read the source pixels the taps need */
+    lowest = highest = filter->index[0];
+    for (t = 1; t < count; ++t) {
+        lowest = SDL_min(lowest, filter->index[t]);
+        highest = SDL_max(highest, filter->index[t]);
+    }
+    for (t = 0; t < count; ++t) {
+        filter->index[t] -= lowest;
+    }
+    filter->src_first = lowest;
+    filter->src_count = highest - lowest + 1;
+    return 0;
+}
+
+static void
+SDL_StretchRowLinear(const Uint8 * src, const SDL_StretchFilter * filter,
+                     Sint16 * row, int width)
+{
+    int x, t, c;
+
+    for (x = 0; x < width; ++x) {
+        const int first = filter->spans[2 * x];
+        const int last = first + filter->spans[2 * x + 1];
+        for (c = 0; c < 4; ++c) {
+            Sint32 sum = 1 << (STRETCH_HBITS - 1);
+            for (t = first; t < last; ++t) {
+                sum += filter->weight[t] * src[filter->index[t] * 4 + c];
+            }
+            row[x * 4 + c] = (Sint16) (sum >> STRETCH_HBITS);
+        }
+    }
+}
+
+static void
+SDL_StretchColumnLinear(const Sint16 ** rows, const Sint16 * weights, int count,
+                        Uint8 * dst, int i, int n)
+{
+    int t;
+
+    for (; i < n; ++i) {
+        Sint32 sum = 1 << (STRETCH_VBITS - 1);
+        for (t = 0; t < count; ++t) {
+            sum += weights[t] * rows[t][i];
+        }
+        dst[i] = (Uint8) (sum >> STRETCH_VBITS);
+    }
+}
+
+#ifdef HAVE_SSE2_INTRINSICS
+static void
+SDL_StretchRowLinearSSE2(const Uint8 * src, const SDL_StretchFilter * filter,
+                         Sint16 * row, int width)
+{
+    const Uint32 *pixels = (const Uint32 *) src;
+    const __m128i zero = _mm_setzero_si128();
+    int x, t;
+
+    for (x = 0; x < width; ++x) {
+        const int first = filter->spans[2 * x];
+        const int last = first + filter->spans[2 * x + 1];
+        __m128i sum = _mm_set1_epi32(1 << (STRETCH_HBITS - 1));
+        for (t = first; t < last; t += 2) {
+            /* Pair up the channels of two taps: b0 b1 g0 g1 r0 r1 a0 a1 */
+            __m128i p = _mm_unpacklo_epi32(_mm_cvtsi32_si128(pixels[filter->index[t]]),
+                                           _mm_cvtsi32_si128(pixels[filter->index[t + 1]]));
+            const __m128i w = _mm_set1_epi32((Uint16) filter->weight[t] |
+                                             ((Uint32) (Uint16) filter->weight[t + 1] << 16));
+            p = _mm_unpacklo_epi8(p, zero);
+            p = _mm_unpacklo_epi16(p, _mm_srli_si128(p, 8));
+            sum = _mm_add_epi32(sum, _mm_madd_epi16(p, w));
+        }
+        sum = _mm_srai_epi32(sum, STRETCH_HBITS);
+        _mm_storel_epi64((__m128i *) (row + x * 4), _mm_packs_epi32(sum, sum));
+    }
+}
+
+static void
+SDL_StretchColumnLinearSSE2(const Sint16 ** rows, const Sint16 * weights, int count,
+                            Uint8 * dst, int i, int n)
+{
+    int t;
+
+    for (; (i + 8) <= n; i += 8) {
+        __m128i lo = _mm_set1_epi32(1 << (STRETCH_VBITS - 1));
+        __m128i hi = lo;
+        for (t = 0; t < count; t += 2) {
+            const __m128i a = _mm_loadu_si128((const __m128i *) (rows[t] + i));
+            const __m128i b = _mm_loadu_si128((const __m128i *) (rows[t + 1] + i));
+            const __m128i w = _mm_set1_epi32((Uint16) weights[t] |
+                                             ((Uint32) (Uint16) weights[t + 1] << 16));
+            lo = _mm_add_epi32(lo, _mm_madd_epi16(_mm_unpacklo_epi16(a, b), w));
+            hi = _mm_add_epi32(hi, _mm_madd_epi16(_mm_unpackhi_epi16(a, b), w));
+        }
+        lo = _mm_packs_epi32(_mm_srai_epi32(lo, STRETCH_VBITS),
+                             _mm_srai_epi32(hi, STRETCH_VBITS));
+        _mm_storel_epi64((__m128i *) (dst + i), _mm_packus_epi16(lo, lo));
+    }
+    SDL_StretchColumnLinear(rows, weights, count, dst, i, n);
+}
+#endif /* HAVE_SSE2_INTRINSICS */
+
+#ifdef HAVE_NEON_INTRINSICS
+static void
+SDL_StretchRowLinearNEON(const Uint8 * src, const SDL_StretchFilter * filter,
+                         Sint16 * row, int width)
+{
+    const Uint32 *pixels = (const Uint32 *) src;
+    int x, t;
+
+    for (x = 0; x < width; ++x) {
+        const int first = filter->spans[2 * x];
+        const int last = first + filter->spans[2 * x + 1];
+        uint32x4_t sum = vdupq_n_u32(0);
+        for (t = first; t < last; ++t) {
+            const uint8x8_t p = vreinterpret_u8_u32(vdup_n_u32(pixels[filter->index[t]]));
+            sum = vmlal_n_u16(sum, vget_low_u16(vmovl_u8(p)), (Uint16) filter->weight[t]);
+        }
+        vst1_u16((Uint16 *) (row + x * 4), vrshrn_n_u32(sum, STRETCH_HBITS));
+    }
+}
+
+static void
+SDL_StretchColumnLinearNEON(const Sint16 ** rows, const Sint16 * weights, int count,
+                            Uint8 * dst, int i, int n)
+{
+    int t;
+
+    for (; (i + 8) <= n; i += 8) {
+        uint32x4_t lo = vdupq_n_u32(0);
+        uint32x4_t hi = lo;
+        uint16x8_t v;
+        for (t = 0; t < count; ++t) {
+            const uint16x8_t r = vld1q_u16((const Uint16 *) (rows[t] + i));
+            lo = vmlal_n_u16(lo, vget_low_u16(r), (Uint16) weights[t]);
+            hi = vmlal_n_u16(hi, vget_high_u16(r), (Uint16) weights[t]);
+        }
+        v = vcombine_u16(vmovn_u32(vrshrq_n_u32(lo, STRETCH_VBITS)),
+                         vmovn_u32(vrshrq_n_u32(hi, STRETCH_VBITS)));
+        vst1_u8(dst + i, vmovn_u16(v));
+    }
+    SDL_StretchColumnLinear(rows, weights, count, dst, i, n);
+}
+#endif /* HAVE_NEON_INTRINSICS */
+
+/* Filter rows y through y+h-1 of the destination rectangle */
+static void
+SDL_StretchRowsLinear(void *data, int y, int h)
+{
+    SDL_StretchLinearInfo *info = (SDL_StretchLinearInfo *) data;
+    const SDL_StretchFilter *yfilter = &info->yfilter;
+    const int ncache = yfilter->maxtaps;
+    const int rowlen = info->dst_w * 4;
+    void (*StretchRow) (const Uint8 *, const SDL_StretchFilter *, Sint16 *, int) = SDL_StretchRowLinear;
+    void (*StretchColumn) (const Sint16 **, const Sint16 *, int, Uint8 *, int, int) = SDL_StretchColumnLinear;
+    Sint16 *cache;
+    int *cached;
+    const Sint16 **rows;
+    Uint8 *out = NULL;
+    int out_pitch;
+    int row, t;
+
+#ifdef HAVE_SSE2_INTRINSICS
+    if (SDL_HasSSE2()) {
+        StretchRow = SDL_StretchRowLinearSSE2;
+        StretchColumn = SDL_StretchColumnLinearSSE2;
+    }
+#endif
+#ifdef HAVE_NEON_INTRINSICS
+    if (SDL_HasNEON()) {
+        StretchRow = SDL_StretchRowLinearNEON;
+        StretchColumn = SDL_StretchColumnLinearNEON;
+    }
+#endif
+
+    /* Filtered source rows, in slots by row number. The rows one
+       destination row needs are next to each other, so they never
+       share a slot. */
+    cache = (Sint16 *) SDL_malloc(ncache * rowlen * sizeof (Sint16));
+    cached = (int *) SDL_malloc(ncache * sizeof (int));
+    rows = (const Sint16 **) SDL_malloc(ncache * sizeof (Sint16 *));
+    if (info->dst_format != info->work_format) {
+        out = (Uint8 *) SDL_malloc(h * rowlen);
+        out_pitch = rowlen;
+    } else {
+        out = info->dst + y * info->dst_pitch;
+        out_pitch = info->dst_pitch;
+    }
+    if (!cache || !cached || !rows || !out) {
+        SDL_AtomicSet(&info->failed, 1);
+        goto done;
+    }
+    for (t = 0; t < ncache; ++t) {
+        cached[t] = -1;
+    }
+
+    for (row = 0; row < h; ++row) {
+        const int first = yfilter->spans[2 * (y + row)];
+        const int count = yfilter->spans[2 * (y + row) + 1];
+        for (t = 0; t < count; ++t) {
+            const int srcy = yfilter->index[first + t];
+            const int slot = srcy % ncache;
+            Sint16 *filtered = cache + slot * rowlen;
+            if (cached[slot] != srcy) {
+                StretchRow(info->src + srcy * info->src_pitch, &info->xfilter,
+                           filtered, info->dst_w);
+                cached[slot] = srcy;
+            }
+            rows[t] = filtered;
+        }
+        StretchColumn(rows, &yfilter->weight[first], count,
+                      out + row * out_pitch, 0, rowlen);
+    }
+
+    if (info->dst_format != info->work_format) {
+        SDL_ConvertPixels(info->dst_w, h, info->work_format, out, out_pitch,
+                          info->dst_format, info->dst + y * info->dst_pitch,
+                          info->dst_pitch);
+    }
+
+  done:
+    if (info->dst_format != info->work_format) {
+        SDL_free(out);
+    }
+    SDL_free(rows);
+    SDL_free(cached);
+    SDL_free(cache);
+}
+
+static SDL_bool
+SDL_IsStretchLinearFormat(Uint32 format)
+{
+    return ((SDL_PIXELTYPE(format) == SDL_PIXELTYPE_PACKED32) &&
+            (SDL_PIXELLAYOUT(format) == SDL_PACKEDLAYOUT_8888)) ? SDL_TRUE : SDL_FALSE;
+}
+
+int
+SDL_StretchLinearPart(SDL_Surface * src, const SDL_Rect * srcrect,
+                      int full_w, int full_h, int x, int y,
+                      SDL_Surface * dst, const SDL_Rect * dstrect)
+{
+    const Uint32 src_format = src->format->format;
+    const Uint32 dst_format = dst->format->format;
+    SDL_StretchLinearInfo info;
+    SDL_Rect used;
+    Uint8 *converted = NULL;
+    int src_locked = 0;
+    int dst_locked = 0;
+    int retval = 0;
+
+    if (SDL_ISPIXELFORMAT_INDEXED(src_format) || SDL_ISPIXELFORMAT_FOURCC(src_format) ||
+        SDL_ISPIXELFORMAT_INDEXED(dst_format) || SDL_ISPIXELFORMAT_FOURCC(dst_format)) {
+        return SDL_SetError("Filtered stretching doesn't support indexed or FOURCC surfaces");
+    }
+    if (SDL_RectEmpty(srcrect) || SDL_RectEmpty(dstrect)) {
+        return 0;
+    }
+
+    SDL_zero(info);
+    if ((SDL_BuildStretchFilter(&info.xfilter, srcrect->w, full_w, x, dstrect->w) < 0) ||
+        (SDL_BuildStretchFilter(&info.yfilter, srcrect->h, full_h, y, dstrect->h) < 0)) {
+        SDL_FreeStretchFilter(&info.xfilter);
+        return -1;
+    }
+    used.x = srcrect->x + info.xfilter.src_first;
+    used.y = srcrect->y + info.yfilter.src_first;
+    used.w = info.xfilter.src_count;
+    used.h = info.yfilter.src_count;
+
+    /* Lock the destination if it's in hardware */
+    if (SDL_MUSTLOCK(dst)) {
+        if (SDL_LockSurface(dst) < 0) {
+            retval = SDL_SetError("Unable to lock destination surface");
+            goto done;
+        }
+        dst_locked = 1;
+    }
+    /* Lock the source if it's in hardware */
+    if (SDL_MUSTLOCK(src)) {
+        if (SDL_LockSurface(src) < 0) {
+            retval = SDL_SetError("Unable to lock source surface");
+            goto done;
+        }
+        src_locked = 1;
+    }
+
+    /* Filter in the source or destination format if we can, so only one
+       side (or neither) needs converting. */
+    if (SDL_IsStretchLinearFormat(src_format)) {
+        info.work_format = src_format;
+    } else if (SDL_IsStretchLinearFormat(dst_format)) {
+        info.work_format = dst_format;
+    } else {
+        info.work_format = SDL_PIXELFORMAT_ARGB8888;
+    }
+    info.dst_format = dst_format;
+    info.src = (const Uint8 *) src->pixels + used.y * src->pitch +
+        used.x * src->format->BytesPerPixel;
+    info.src_pitch = src->pitch;
+    info.dst = (Uint8 *) dst->pixels + dstrect->y * dst->pitch +
+        dstrect->x * dst->format->BytesPerPixel;
+    info.dst_pitch = dst->pitch;
+    info.dst_w = dstrect->w;
+
+    if (src_format != info.work_format) {
+        converted = (Uint8 *) SDL_malloc(used.h * used.w * 4);
+        if (!converted) {
+            retval = SDL_OutOfMemory();
+            goto done;
+        }
+        if (SDL_ConvertPixels(used.w, used.h, src_format, info.src, src->pitch,
+                              info.work_format, converted, used.w * 4) < 0) {
+            retval = -1;
+            goto done;
+        }
+        info.src = converted;
+        info.src_pitch = used.w * 4;
+    }
+
+    SDL_RunBlitBands(src, dst, dstrect->h, dstrect->w, SDL_StretchRowsLinear, &info);
+    if (SDL_AtomicGet(&info.failed)) {
+        retval = SDL_OutOfMemory();
+    }
+
+  done:
+    SDL_FreeStretchFilter(&info.xfilter);
+    SDL_FreeStretchFilter(&info.yfilter);
+    SDL_free(converted);
+
+    /* We need to unlock the surfaces if they're locked */
+    if (dst_locked) {
+        SDL_UnlockSurface(dst);
+    }
+    if (src_locked) {
+        SDL_UnlockSurface(src);
+    }
+    return retval;
+}
+
+int
+SDL_SoftStretchLinear(SDL_Surface * src, const SDL_Rect * srcrect,
+                      SDL_Surface * dst, const SDL_Rect * dstrect)
+{
+    SDL_Rect full_src;
+    SDL_Rect full_dst;
+
+    /* Verify the blit rectangles */
+    if (SDL_GetStretchRects(src, &srcrect, &full_src, dst, &dstrect, &full_dst) < 0) {
+        return -1;
+    }
+    return SDL_StretchLinearPart(src, srcrect, dstrect->w, dstrect->h, 0, 0, dst, dstrect);
+}
+
 /* vi: set ts=4 sw=4 expandtab: */
@@ -85,6 +85,46 @@ my %set_rgba_string = (
     "BGRA8888" => "_pixel = ((Uint32)_B << 24) | ((Uint32)_G << 16) | ((Uint32)_R << 8) | _A;",
 );
 
+# Bit position of each channel, for the SIMD blitters; -1 if there's none.
+my %format_shifts = (
+    "RGB888" => { "R" => 16, "G" => 8, "B" => 0, "A" => -1 },
+    "BGR888" => { "R" => 0, "G" => 8, "B" => 16, "A" => -1 },
+    "ARGB8888" => { "R" => 16, "G" => 8, "B" => 0, "A" => 24 },
+    "RGBA8888" => { "R" => 24, "G" => 16, "B" => 8, "A" => 0 },
+    "ABGR8888" => { "R" => 0, "G" => 8, "B" => 16, "A" => 24 },
+    "BGRA8888" => { "R" => 8, "G" => 16, "B" => 24, "A" => 0 },
+);
+
+# The instruction sets we generate SIMD blitters for, best first.
+# Each blitter works on "width" pixels at a time, with every channel
+# widened to 16 bits so the math matches the scalar code exactly.
+my @simd_isas = (
+    {
+        "name" => "AVX2",
+        "guard" => "HAVE_AVX2_INTRINSICS",
+        "cpu" => "SDL_CPU_AVX2",
+        "target" => "SDL_TARGETING_AVX2",
+        "type" => "__m256i",
+        "width" => 16,
+    },
+    {
+        "name" => "SSE2",
+        "guard" => "HAVE_SSE2_INTRINSICS",
+        "cpu" => "SDL_CPU_SSE2",
+        "target" => "",
+        "type" => "__m128i",
+        "width" => 8,
+    },
+    {
+        "name" => "NEON",
+        "guard" => "HAVE_NEON_INTRINSICS",
+        "cpu" => "SDL_CPU_NEON",
+        "target" => "",
+        "type" => "uint16x8_t",
+        "width" => 8,
+    },
+);
+
 sub open_file {
     my $name = shift;
     open(FILE, ">$name.new") || die "Cant' open $name.new: $!";
@@ -149,6 +189,7 @@ sub output_copyfuncname
     my $scale = shift;
     my $args = shift;
     my $suffix = shift;
+    my $isa = shift;
 
     print FILE "$prefix SDL_Blit_${src}_${dst}";
     if ( $modulate ) {
@@ -160,6 +201,9 @@ sub output_copyfuncname
     if ( $scale ) {
         print FILE "_Scale";
     }
+    if ( $isa ) {
+        print FILE "_$isa->{name}";
+    }
     if ( $args ) {
         print FILE "(SDL_BlitInfo *info)";
     }
@@ -367,8 +411,8 @@ __EOF__
     print FILE <<__EOF__;
 
     srcy = 0;
-    posy = 0;
-    incy = (info->src_h << 16) / info->dst_h;
+    posy = info->src_posy;
+    incy = info->src_incy;
     incx = (info->src_w << 16) / info->dst_w;
 
     while (info->dst_h--) {
@@ -426,6 +470,525 @@ __EOF__
 __EOF__
 }
 
+# SIMD blitters don't pay off for a plain scaled copy.
+sub has_simd_copyfunc
+{
+    my $src = shift;
+    my $dst = shift;
+    my $modulate = shift;
+    my $blend = shift;
+
+    return !( $src eq $dst && !$modulate && !$blend );
+}
+
+sub output_simd_helpers
+{
+    my $isa = shift;
+    my $name = $isa->{name};
+    my $type = $isa->{type};
+    my $target = $isa->{target};
+
+    if ( $name eq "AVX2" ) {
+        print FILE <<__EOF__;
+/* Pack and unpack work within 128-bit lanes, so channels come out of
+   SDL_Blit_AVX2_GetChannel() shuffled, but SDL_Blit_AVX2_SetChannel()
+   puts them back where they came from. */
+typedef struct { __m256i lo, hi; } SDL_Blit_AVX2_Pixels;
+
+static SDL_INLINE void ${target} SDL_Blit_AVX2_Load(SDL_Blit_AVX2_Pixels *p, const Uint32 *src)
+{
+    p->lo = _mm256_loadu_si256((const __m256i *)src);
+    p->hi = _mm256_loadu_si256((const __m256i *)(src + 8));
+}
+
+static SDL_INLINE void ${target} SDL_Blit_AVX2_Store(Uint32 *dst, const SDL_Blit_AVX2_Pixels *p)
+{
+    _mm256_storeu_si256((__m256i *)dst, p->lo);
+    _mm256_storeu_si256((__m256i *)(dst + 8), p->hi);
+}
+
+static SDL_INLINE void ${target} SDL_Blit_AVX2_Zero(SDL_Blit_AVX2_Pixels *p)
+{
+    p->lo = p->hi = _mm256_setzero_si256();
+}
+
+static SDL_INLINE __m256i ${target} SDL_Blit_AVX2_GetChannel(const SDL_Blit_AVX2_Pixels *p, int shift)
+{
+    const __m256i mask = _mm256_set1_epi32(0xFF);
+    return _mm256_packs_epi32(_mm256_and_si256(_mm256_srli_epi32(p->lo, shift), mask),
+                              _mm256_and_si256(_mm256_srli_epi32(p->hi, shift), mask));
+}
+
+static SDL_INLINE void ${target} SDL_Blit_AVX2_SetChannel(SDL_Blit_AVX2_Pixels *p, __m256i c, int shift)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    p->lo = _mm256_or_si256(p->lo, _mm256_slli_epi32(_mm256_unpacklo_epi16(c, zero), shift));
+    p->hi = _mm256_or_si256(p->hi, _mm256_slli_epi32(_mm256_unpackhi_epi16(c, zero), shift));
+}
+
+static SDL_INLINE __m256i ${target} SDL_Blit_AVX2_Splat(Uint32 value)
+{
+    return _mm256_set1_epi16((short)value);
+}
+
+/* (a * b) / 255, exactly, for a and b up to 255 */
+static SDL_INLINE __m256i ${target} SDL_Blit_AVX2_Mul255(__m256i a, __m256i b)
+{
+    const __m256i x = _mm256_mullo_epi16(a, b);
+    return _mm256_srli_epi16(_mm256_add_epi16(_mm256_add_epi16(x, _mm256_set1_epi16(1)), _mm256_srli_epi16(x, 8)), 8);
+}
+
+static SDL_INLINE __m256i ${target} SDL_Blit_AVX2_Add(__m256i a, __m256i b)
+{
+    return _mm256_add_epi16(a, b);
+}
+
+static SDL_INLINE __m256i ${target} SDL_Blit_AVX2_Sub(__m256i a, __m256i b)
+{
+    return _mm256_sub_epi16(a, b);
+}
+
+static SDL_INLINE __m256i ${target} SDL_Blit_AVX2_AddSat(__m256i a, __m256i b)
+{
+    return _mm256_min_epi16(_mm256_add_epi16(a, b), _mm256_set1_epi16(255));
+}
+__EOF__
+    } elsif ( $name eq "SSE2" ) {
+        print FILE <<__EOF__;
+typedef struct { __m128i lo, hi; } SDL_Blit_SSE2_Pixels;
+
+static SDL_INLINE void SDL_Blit_SSE2_Load(SDL_Blit_SSE2_Pixels *p, const Uint32 *src)
+{
+    p->lo = _mm_loadu_si128((const __m128i *)src);
+    p->hi = _mm_loadu_si128((const __m128i *)(src + 4));
+}
+
+static SDL_INLINE void SDL_Blit_SSE2_Store(Uint32 *dst, const SDL_Blit_SSE2_Pixels *p)
+{
+    _mm_storeu_si128((__m128i *)dst, p->lo);
+    _mm_storeu_si128((__m128i *)(dst + 4), p->hi);
+}
+
+static SDL_INLINE void SDL_Blit_SSE2_Zero(SDL_Blit_SSE2_Pixels *p)
+{
+    p->lo = p->hi = _mm_setzero_si128();
+}
+
+static SDL_INLINE __m128i SDL_Blit_SSE2_GetChannel(const SDL_Blit_SSE2_Pixels *p, int shift)
+{
+    const __m128i mask = _mm_set1_epi32(0xFF);
+    return _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(p->lo, shift), mask),
+                           _mm_and_si128(_mm_srli_epi32(p->hi, shift), mask));
+}
+
+static SDL_INLINE void SDL_Blit_SSE2_SetChannel(SDL_Blit_SSE2_Pixels *p, __m128i c, int shift)
+{
+    const __m128i zero = _mm_setzero_si128();
+    p->lo = _mm_or_si128(p->lo, _mm_slli_epi32(_mm_unpacklo_epi16(c, zero), shift));
+    p->hi = _mm_or_si128(p->hi, _mm_slli_epi32(_mm_unpackhi_epi16(c, zero), shift));
+}
+
+static SDL_INLINE __m128i SDL_Blit_SSE2_Splat(Uint32 value)
+{
+    return _mm_set1_epi16((short)value);
+}
+
+/* (a * b) / 255, exactly, for a and b up to 255 */
+static SDL_INLINE __m128i SDL_Blit_SSE2_Mul255(__m128i a, __m128i b)
+{
+    const __m128i x = _mm_mullo_epi16(a, b);
+    return _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(x, _mm_set1_epi16(1)), _mm_srli_epi16(x, 8)), 8);
+}
+
+static SDL_INLINE __m128i SDL_Blit_SSE2_Add(__m128i a, __m128i b)
+{
+    return _mm_add_epi16(a, b);
+}
+
+static SDL_INLINE __m128i SDL_Blit_SSE2_Sub(__m128i a, __m128i b)
+{
+    return _mm_sub_epi16(a, b);
+}
+
+static SDL_INLINE __m128i SDL_Blit_SSE2_AddSat(__m128i a, __m128i b)
+{
+    return _mm_min_epi16(_mm_add_epi16(a, b), _mm_set1_epi16(255));
+}
+__EOF__
+    } elsif ( $name eq "NEON" ) {
+        print FILE <<__EOF__;
+typedef struct { uint32x4_t lo, hi; } SDL_Blit_NEON_Pixels;
+
+static SDL_INLINE void SDL_Blit_NEON_Load(SDL_Blit_NEON_Pixels *p, const Uint32 *src)
+{
+    p->lo = vld1q_u32(src);
+    p->hi = vld1q_u32(src + 4);
+}
+
+static SDL_INLINE void SDL_Blit_NEON_Store(Uint32 *dst, const SDL_Blit_NEON_Pixels *p)
+{
+    vst1q_u32(dst, p->lo);
+    vst1q_u32(dst + 4, p->hi);
+}
+
+static SDL_INLINE void SDL_Blit_NEON_Zero(SDL_Blit_NEON_Pixels *p)
+{
+    p->lo = p->hi = vdupq_n_u32(0);
+}
+
+static SDL_INLINE uint16x8_t SDL_Blit_NEON_GetChannel(const SDL_Blit_NEON_Pixels *p, int shift)
+{
+    const uint32x4_t mask = vdupq_n_u32(0xFF);
+    const int32x4_t count = vdupq_n_s32(-shift);
+    return vcombine_u16(vmovn_u32(vandq_u32(vshlq_u32(p->lo, count), mask)),
+                        vmovn_u32(vandq_u32(vshlq_u32(p->hi, count), mask)));
+}
+
+static SDL_INLINE void SDL_Blit_NEON_SetChannel(SDL_Blit_NEON_Pixels *p, uint16x8_t c, int shift)
+{
+    const int32x4_t count = vdupq_n_s32(shift);
+    p->lo = vorrq_u32(p->lo, vshlq_u32(vmovl_u16(vget_low_u16(c)), count));
+    p->hi = vorrq_u32(p->hi, vshlq_u32(vmovl_u16(vget_high_u16(c)), count));
+}
+
+static SDL_INLINE uint16x8_t SDL_Blit_NEON_Splat(Uint32 value)
+{
+    return vdupq_n_u16((uint16_t)value);
+}
+
+/* (a * b) / 255, exactly, for a and b up to 255 */
+static SDL_INLINE uint16x8_t SDL_Blit_NEON_Mul255(uint16x8_t a, uint16x8_t b)
+{
+    const uint16x8_t x = vmulq_u16(a, b);
+    return vshrq_n_u16(vaddq_u16(vaddq_u16(x, vdupq_n_u16(1)), vshrq_n_u16(x, 8)), 8);
+}
+
+static SDL_INLINE uint16x8_t SDL_Blit_NEON_Add(uint16x8_t a, uint16x8_t b)
+{
+    return vaddq_u16(a, b);
+}
+
+static SDL_INLINE uint16x8_t SDL_Blit_NEON_Sub(uint16x8_t a, uint16x8_t b)
+{
+    return vsubq_u16(a, b);
+}
+
+static SDL_INLINE uint16x8_t SDL_Blit_NEON_AddSat(uint16x8_t a, uint16x8_t b)
+{
+    return vminq_u16(vaddq_u16(a, b), vdupq_n_u16(255));
+}
+__EOF__
+    }
+    print FILE "\n";
+}
+
+sub simd_get_rgba
+{
+    my $isa = shift;
+    my $prefix = shift;
+    my $format = shift;
+    my $ignore_alpha = shift;
+    my $v = "SDL_Blit_$isa->{name}";
+    my $shifts = $format_shifts{$format};
+
+    print FILE <<__EOF__;
+            ${prefix}R = ${v}_GetChannel(&pixels, $shifts->{R});
+            ${prefix}G = ${v}_GetChannel(&pixels, $shifts->{G});
+            ${prefix}B = ${v}_GetChannel(&pixels, $shifts->{B});
+__EOF__
+    if ( !$ignore_alpha ) {
+        if ( $shifts->{A} >= 0 ) {
+            print FILE <<__EOF__;
+            ${prefix}A = ${v}_GetChannel(&pixels, $shifts->{A});
+__EOF__
+        } else {
+            print FILE <<__EOF__;
+            ${prefix}A = ${v}_Splat(0xFF);
+__EOF__
+        }
+    }
+}
+
+sub simd_set_rgba
+{
+    my $isa = shift;
+    my $prefix = shift;
+    my $format = shift;
+    my $v = "SDL_Blit_$isa->{name}";
+    my $shifts = $format_shifts{$format};
+
+    print FILE <<__EOF__;
+            ${v}_Zero(&pixels);
+            ${v}_SetChannel(&pixels, ${prefix}R, $shifts->{R});
+            ${v}_SetChannel(&pixels, ${prefix}G, $shifts->{G});
+            ${v}_SetChannel(&pixels, ${prefix}B, $shifts->{B});
+__EOF__
+    if ( $shifts->{A} >= 0 ) {
+        print FILE <<__EOF__;
+            ${v}_SetChannel(&pixels, ${prefix}A, $shifts->{A});
+__EOF__
+    }
+}
+
+# The same math as output_copycore(), a vector of pixels at a time.
+sub output_simdcore
+{
+    my $isa = shift;
+    my $src = shift;
+    my $dst = shift;
+    my $modulate = shift;
+    my $blend = shift;
+    my $v = "SDL_Blit_$isa->{name}";
+    my $s = "";
+    my $d = "";
+
+    my $dst_has_alpha = ($dst =~ /A/) ? 1 : 0;
+    my $ignore_dst_alpha = !$dst_has_alpha && !$blend;
+
+    print FILE <<__EOF__;
+            ${v}_Load(&pixels, s);
+__EOF__
+    if ( $blend ) {
+        simd_get_rgba($isa, "src", $src, $ignore_dst_alpha);
+        print FILE <<__EOF__;
+            ${v}_Load(&pixels, d);
+__EOF__
+        simd_get_rgba($isa, "dst", $dst, !$dst_has_alpha);
+        $s = "src";
+        $d = "dst";
+    } else {
+        simd_get_rgba($isa, "", $src, $ignore_dst_alpha);
+    }
+
+    if ( $modulate ) {
+        print FILE <<__EOF__;
+            if (flags & SDL_COPY_MODULATE_COLOR) {
+                ${s}R = ${v}_Mul255(${s}R, modulateR);
+                ${s}G = ${v}_Mul255(${s}G, modulateG);
+                ${s}B = ${v}_Mul255(${s}B, modulateB);
+            }
+__EOF__
+        if (not $ignore_dst_alpha) {
+            print FILE <<__EOF__;
+            if (flags & SDL_COPY_MODULATE_ALPHA) {
+                ${s}A = ${v}_Mul255(${s}A, modulateA);
+            }
+__EOF__
+        }
+    }
+    if ( $blend ) {
+        # Premultiplying by an alpha of 255 changes nothing, so unlike the
+        # scalar code this doesn't need to check for it.
+        print FILE <<__EOF__;
+            if (flags & (SDL_COPY_BLEND|SDL_COPY_ADD)) {
+                ${s}R = ${v}_Mul255(${s}R, ${s}A);
+                ${s}G = ${v}_Mul255(${s}G, ${s}A);
+                ${s}B = ${v}_Mul255(${s}B, ${s}A);
+            }
+            switch (flags & (SDL_COPY_BLEND|SDL_COPY_ADD|SDL_COPY_MOD)) {
+            case SDL_COPY_BLEND:
+                invA = ${v}_Sub(${v}_Splat(255), ${s}A);
+                ${d}R = ${v}_Add(${s}R, ${v}_Mul255(invA, ${d}R));
+                ${d}G = ${v}_Add(${s}G, ${v}_Mul255(invA, ${d}G));
+                ${d}B = ${v}_Add(${s}B, ${v}_Mul255(invA, ${d}B));
+__EOF__
+
+        if ( $dst_has_alpha ) {
+            print FILE <<__EOF__;
+                ${d}A = ${v}_Add(${s}A, ${v}_Mul255(invA, ${d}A));
+__EOF__
+        }
+
+        print FILE <<__EOF__;
+                break;
+            case SDL_COPY_ADD:
+                ${d}R = ${v}_AddSat(${s}R, ${d}R);
+                ${d}G = ${v}_AddSat(${s}G, ${d}G);
+                ${d}B = ${v}_AddSat(${s}B, ${d}B);
+                break;
+            case SDL_COPY_MOD:
+                ${d}R = ${v}_Mul255(${s}R, ${d}R);
+                ${d}G = ${v}_Mul255(${s}G, ${d}G);
+                ${d}B = ${v}_Mul255(${s}B, ${d}B);
+                break;
+            }
+__EOF__
+    }
+    if ( $blend ) {
+        simd_set_rgba($isa, "dst", $dst);
+    } else {
+        simd_set_rgba($isa, "", $dst);
+    }
+    print FILE <<__EOF__;
+            ${v}_Store(d, &pixels);
+__EOF__
+}
+
+sub output_simdfunc
+{
+    my $isa = shift;
+    my $src = shift;
+    my $dst = shift;
+    my $modulate = shift;
+    my $blend = shift;
+    my $scale = shift;
+    my $v = "SDL_Blit_$isa->{name}";
+    my $type = $isa->{type};
+    my $width = $isa->{width};
+
+    my $dst_has_alpha = ($dst =~ /A/) ? 1 : 0;
+    my $ignore_dst_alpha = !$dst_has_alpha && !$blend;
+
+    output_copyfuncname($isa->{target} ? "static void $isa->{target}" : "static void", $src, $dst, $modulate, $blend, $scale, 1, "\n", $isa);
+    print FILE <<__EOF__;
+{
+__EOF__
+    if ( $modulate || $blend ) {
+        print FILE <<__EOF__;
+    const int flags = info->flags;
+__EOF__
+    }
+    if ( $modulate ) {
+        print FILE <<__EOF__;
+    const $type modulateR = ${v}_Splat(info->r);
+    const $type modulateG = ${v}_Splat(info->g);
+    const $type modulateB = ${v}_Splat(info->b);
+__EOF__
+        if (!$ignore_dst_alpha) {
+            print FILE <<__EOF__;
+    const $type modulateA = ${v}_Splat(info->a);
+__EOF__
+        }
+    }
+    if ( $blend ) {
+        print FILE <<__EOF__;
+    $type srcR, srcG, srcB, srcA, invA;
+__EOF__
+        if ($dst_has_alpha) {
+            print FILE <<__EOF__;
+    $type dstR, dstG, dstB, dstA;
+__EOF__
+        } else {
+            print FILE <<__EOF__;
+    $type dstR, dstG, dstB;
+__EOF__
+        }
+    } elsif (!$ignore_dst_alpha) {
+        print FILE <<__EOF__;
+    $type R, G, B, A;
+__EOF__
+    } else {
+        print FILE <<__EOF__;
+    $type R, G, B;
+__EOF__
+    }
+    print FILE <<__EOF__;
+    ${v}_Pixels pixels;
+    Uint32 srcbuf[$width];
+    Uint32 dstbuf[$width];
+__EOF__
+    if ( $scale ) {
+        print FILE <<__EOF__;
+    int srcy, srcx;
+    int posy, posx;
+    int incy, incx;
+    int i;
+
+    srcy = 0;
+    posy = info->src_posy;
+    incy = info->src_incy;
+    incx = (info->src_w << 16) / info->dst_w;
+
+    while (info->dst_h--) {
+        $format_type{$src} *src = 0;
+        $format_type{$dst} *dst = ($format_type{$dst} *)info->dst;
+        int n = info->dst_w;
+        srcx = -1;
+        posx = 0x10000L;
+        while (posy >= 0x10000L) {
+            ++srcy;
+            posy -= 0x10000L;
+        }
+        while (n > 0) {
+            const int count = SDL_min(n, $width);
+            const Uint32 *s = srcbuf;
+            Uint32 *d = (count < $width) ? dstbuf : dst;
+            for (i = 0; i < count; ++i) {
+                if (posx >= 0x10000L) {
+                    while (posx >= 0x10000L) {
+                        ++srcx;
+                        posx -= 0x10000L;
+                    }
+                    src = ($format_type{$src} *)(info->src + (srcy * info->src_pitch) + (srcx * $format_size{$src}));
+                }
+                srcbuf[i] = *src;
+                posx += incx;
+            }
+__EOF__
+    } else {
+        print FILE <<__EOF__;
+
+    while (info->dst_h--) {
+        $format_type{$src} *src = ($format_type{$src} *)info->src;
+        $format_type{$dst} *dst = ($format_type{$dst} *)info->dst;
+        int n = info->dst_w;
+        while (n > 0) {
+            const int count = SDL_min(n, $width);
+            const Uint32 *s = src;
+            Uint32 *d = dst;
+            if (count < $width) {
+                SDL_memcpy(srcbuf, src, count * sizeof (Uint32));
+__EOF__
+        if ( $blend ) {
+            print FILE <<__EOF__;
+                SDL_memcpy(dstbuf, dst, count * sizeof (Uint32));
+__EOF__
+        }
+        print FILE <<__EOF__;
+                s = srcbuf;
+                d = dstbuf;
+            }
+__EOF__
+    }
+    if ( $blend && $scale ) {
+        print FILE <<__EOF__;
+            if (count < $width) {
+                SDL_memcpy(dstbuf, dst, count * sizeof (Uint32));
+            }
+__EOF__
+    }
+    output_simdcore($isa, $src, $dst, $modulate, $blend);
+    print FILE <<__EOF__;
+            if (count < $width) {
+                SDL_memcpy(dst, dstbuf, count * sizeof (Uint32));
+            }
+__EOF__
+    if ( $scale ) {
+        print FILE <<__EOF__;
+            dst += count;
+            n -= count;
+        }
+        posy += incy;
+        info->dst += info->dst_pitch;
+    }
+__EOF__
+    } else {
+        print FILE <<__EOF__;
+            src += count;
+            dst += count;
+            n -= count;
+        }
+        info->src += info->src_pitch;
+        info->dst += info->dst_pitch;
+    }
+__EOF__
+    }
+    print FILE <<__EOF__;
+}
+
+__EOF__
+}
+
 sub output_copyfunc_h
 {
 }
@@ -453,7 +1016,6 @@ __EOF__
                 for (my $blend = 0; $blend <= 1; ++$blend) {
                     for (my $scale = 0; $scale <= 1; ++$scale) {
                         if ( $modulate || $blend || $scale ) {
-                            print FILE "    { SDL_PIXELFORMAT_$src, SDL_PIXELFORMAT_$dst, ";
                             my $flags = "";
                             my $flag = "";
                             if ( $modulate ) {
@@ -483,6 +1045,16 @@ __EOF__
                             if ( $flags eq "" ) {
                                 $flags = "0";
                             }
+                            if ( has_simd_copyfunc($src, $dst, $modulate, $blend) ) {
+                                foreach my $isa (@simd_isas) {
+                                    print FILE "#if $isa->{guard}\n";
+                                    print FILE "    { SDL_PIXELFORMAT_$src, SDL_PIXELFORMAT_$dst, ";
+                                    print FILE "($flags), $isa->{cpu},";
+                                    output_copyfuncname("", $src_formats[$i], $dst_formats[$j], $modulate, $blend, $scale, 0, " },\n", $isa);
+                                    print FILE "#endif\n";
+                                }
+                            }
+                            print FILE "    { SDL_PIXELFORMAT_$src, SDL_PIXELFORMAT_$dst, ";
                             print FILE "($flags), SDL_CPU_ANY,";
                             output_copyfuncname("", $src_formats[$i], $dst_formats[$j], $modulate, $blend, $scale, 0, " },\n");
                         }
@@ -514,6 +1086,24 @@ sub output_copyfunc_c
     }
 }
 
+sub output_simdfunc_c
+{
+    my $isa = shift;
+    my $src = shift;
+    my $dst = shift;
+
+    for (my $modulate = 0; $modulate <= 1; ++$modulate) {
+        for (my $blend = 0; $blend <= 1; ++$blend) {
+            for (my $scale = 0; $scale <= 1; ++$scale) {
+                if ( ($modulate || $blend || $scale) &&
+                     has_simd_copyfunc($src, $dst, $modulate, $blend) ) {
+                    output_simdfunc($isa, $src, $dst, $modulate, $blend, $scale);
+                }
+            }
+        }
+    }
+}
+
 open_file("SDL_blit_auto.h");
 output_copydefs();
 for (my $i = 0; $i <= $#src_formats; ++$i) {
@@ -531,5 +1121,15 @@ for (my $i = 0; $i <= $#src_formats; ++$i) {
         output_copyfunc_c($src_formats[$i], $dst_formats[$j]);
     }
 }
+foreach my $isa (@simd_isas) {
+    print FILE "#if $isa->{guard}\n\n";
+    output_simd_helpers($isa);
+    for (my $i = 0; $i <= $#src_formats; ++$i) {
+        for (my $j = 0; $j <= $#dst_formats; ++$j) {
+            output_simdfunc_c($isa, $src_formats[$i], $dst_formats[$j]);
+        }
+    }
+    print FILE "#endif /* $isa->{guard} */\n\n";
+}
 output_copyfunctable();
 close_file("SDL_blit_auto.c");
@@ -52,6 +52,12 @@ static void
 close_audio()
 {
     if (device != 0) {
+        SDL_AudioDeviceStats stats;
+        if (SDL_GetAudioDeviceStats(device, &stats) == 0) {
+            SDL_Log("%u callbacks, %u usec on average (max %u, %u late), %u underruns, %u buffer resizes\n",
+                    stats.callbacks, stats.callback_usec_avg, stats.callback_usec_max,
+                    stats.late_callbacks, stats.underruns, stats.resizes);
+        }
         SDL_CloseAudioDevice(device);
         device = 0;
     }
@@ -60,6 +66,8 @@ close_audio()
 static void
 open_audio()
 {
+    int period_frames, buffer_frames;
+
     /* Initialize fillerup() variables */
     device = SDL_OpenAudioDevice(NULL, SDL_FALSE, &wave.spec, NULL, 0);
     if (!device) {
@@ -68,6 +76,10 @@ open_audio()
         quit(2);
     }
 
+    if (SDL_GetAudioDeviceBufferSize(device, &period_frames, &buffer_frames) == 0) {
+        SDL_Log("Device period is %d frames, buffer is %d frames\n", period_frames, buffer_frames);
+    }
+    SDL_Log("Device latency is %d microseconds\n", SDL_GetAudioDeviceLatency(device));
 
     /* Let the audio run */
     SDL_PauseAudioDevice(device, SDL_FALSE);
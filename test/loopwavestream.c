@@ -0,0 +1,155 @@
+/*
+  Copyright (C) 1997-2017 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely.
+*/
+
+/* Program to decode a wave file a piece at a time and loop playing it
+   using SDL sound queueing */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifdef __EMSCRIPTEN__
+#include <emscripten/emscripten.h>
+#endif
+
+#include "SDL.h"
+
+#if HAVE_SIGNAL_H
+#include <signal.h>
+#endif
+
+static struct
+{
+    SDL_AudioSpec spec;
+    SDL_WAVStream *stream;      /* The open wave file */
+    Uint8 buf[16384];           /* One piece of decoded wave data */
+    int loops;                  /* Times we've started over */
+} wave;
+
+
+/* Call this instead of exit(), so we can clean up SDL: atexit() is evil. */
+static void
+quit(int rc)
+{
+    SDL_Quit();
+    exit(rc);
+}
+
+static int done = 0;
+void
+poked(int sig)
+{
+    done = 1;
+}
+
+void
+loop()
+{
+#ifdef __EMSCRIPTEN__
+    if (done || (SDL_GetAudioStatus() != SDL_AUDIO_PLAYING)) {
+        emscripten_cancel_main_loop();
+    }
+    else
+#endif
+    {
+        /* Keep about a half second queued, decoding just what we need. */
+        const Uint32 want = (Uint32) (wave.spec.freq / 2) *
+                            (SDL_AUDIO_BITSIZE(wave.spec.format) / 8) * wave.spec.channels;
+        while (!done && (SDL_GetQueuedAudioSize(1) < want)) {
+            const int len = SDL_WAVStreamRead(wave.stream, wave.buf, sizeof (wave.buf));
+            if (len < 0) {
+                SDL_Log("Decoding FAILED: %s\n", SDL_GetError());
+                done = 1;
+            } else if (len == 0) {  /* end of the data, go back to the start. */
+                SDL_Log("Looping (%d) after %d frames.\n", ++wave.loops,
+                        (int) SDL_WAVStreamLength(wave.stream));
+                if (SDL_WAVStreamSeek(wave.stream, 0) < 0) {
+                    SDL_Log("Seek FAILED: %s\n", SDL_GetError());
+                    done = 1;
+                }
+            } else if (SDL_QueueAudio(1, wave.buf, len) < 0) {
+                SDL_Log("Device FAILED to queue %d more bytes: %s\n", len, SDL_GetError());
+                done = 1;
+            }
+        }
+    }
+}
+
+int
+main(int argc, char *argv[])
+{
+    char filename[4096];
+
+    /* Enable standard application logging */
+    SDL_LogSetPriority(SDL_LOG_CATEGORY_APPLICATION, SDL_LOG_PRIORITY_INFO);
+
+    /* Load the SDL library */
+    if (SDL_Init(SDL_INIT_AUDIO) < 0) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't initialize SDL: %s\n", SDL_GetError());
+        return (1);
+    }
+
+    if (argc > 1) {
+        SDL_strlcpy(filename, argv[1], sizeof(filename));
+    } else {
+        SDL_strlcpy(filename, "sample.wav", sizeof(filename));
+    }
+    /* Open the wave file; only the headers are read here */
+    wave.stream = SDL_OpenWAVStream(filename, &wave.spec);
+    if (wave.stream == NULL) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't open %s: %s\n", filename, SDL_GetError());
+        quit(1);
+    }
+
+    wave.spec.callback = NULL;  /* we'll push audio. */
+
+#if HAVE_SIGNAL_H
+    /* Set the signals */
+#ifdef SIGHUP
+    signal(SIGHUP, poked);
+#endif
+    signal(SIGINT, poked);
+#ifdef SIGQUIT
+    signal(SIGQUIT, poked);
+#endif
+    signal(SIGTERM, poked);
+#endif /* HAVE_SIGNAL_H */
+
+    if (SDL_OpenAudio(&wave.spec, NULL) < 0) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't open audio: %s\n", SDL_GetError());
+        SDL_CloseWAVStream(wave.stream);
+        quit(2);
+    }
+
+    /* Let the audio run */
+    SDL_PauseAudio(0);
+
+    done = 0;
+
+#ifdef __EMSCRIPTEN__
+    emscripten_set_main_loop(loop, 0, 1);
+#else
+    while (!done && (SDL_GetAudioStatus() == SDL_AUDIO_PLAYING))
+    {
+        loop();
+
+        SDL_Delay(100);  /* let it play for awhile. */
+    }
+#endif
+
+    /* Clean up on signal */
+    SDL_CloseAudio();
+    SDL_CloseWAVStream(wave.stream);
+    SDL_Quit();
+    return 0;
+}
+
+/* vi: set ts=4 sw=4 expandtab: */
@@ -0,0 +1,255 @@
+/*
+  Copyright (C) 1997-2017 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely.
+*/
+
+/* Program to time SDL_ConvertAudio() for every format, channel count and
+   rate combination SDL_BuildAudioCVT() supports. Results go to stdout as
+   CSV, one line per conversion, so runs can be compared across releases:
+
+     testaudiocvtbench --dispatch scalar > scalar.csv
+     testaudiocvtbench --dispatch sse2 > sse2.csv
+
+   Forcing a dispatch hides the newer CPU features from SDL (see
+   SDL_HINT_CPU_DISABLE_FEATURES), so it can't select code the CPU lacks. */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "SDL.h"
+
+static const struct
+{
+    SDL_AudioFormat format;
+    const char *name;
+} formats[] = {
+    { AUDIO_U8, "U8" },
+    { AUDIO_S8, "S8" },
+    { AUDIO_U16LSB, "U16LSB" },
+    { AUDIO_S16LSB, "S16LSB" },
+    { AUDIO_U16MSB, "U16MSB" },
+    { AUDIO_S16MSB, "S16MSB" },
+    { AUDIO_S32LSB, "S32LSB" },
+    { AUDIO_S32MSB, "S32MSB" },
+    { AUDIO_F32LSB, "F32LSB" },
+    { AUDIO_F32MSB, "F32MSB" }
+};
+
+static const Uint8 channels[] = { 1, 2, 4, 6 };
+
+static const struct
+{
+    const char *name;
+    const char *disable;    /* SDL_HINT_CPU_DISABLE_FEATURES */
+} dispatches[] = {
+    { "auto", NULL },
+    { "scalar", "all" },
+    { "sse2", "sse3,altivec,neon" },
+    { "neon", "mmx,sse,altivec" }
+};
+
+#define MAX_RATES 16
+
+static int rates[MAX_RATES] = { 22050, 44100, 48000 };
+static int num_rates = 3;
+static int frames = 4096;
+static Uint64 min_ticks;
+
+
+static int
+parse_rates(const char *list)
+{
+    num_rates = 0;
+    while (*list && (num_rates < MAX_RATES)) {
+        char *end = NULL;
+        const long rate = SDL_strtol(list, &end, 10);
+        if ((end == list) || (rate <= 0)) {
+            return -1;
+        }
+        rates[num_rates++] = (int) rate;
+        list = (*end == ',') ? end + 1 : end;
+    }
+    return (num_rates > 0) ? 0 : -1;
+}
+
+/* Make (frames) of a quiet sine wave in (fmt), the way an app would have it. */
+static Uint8 *
+make_source(SDL_AudioFormat fmt, Uint8 chans, int rate, int *len)
+{
+    const int floatlen = frames * chans * (int) sizeof (float);
+    SDL_AudioCVT cvt;
+    float *samples;
+    int i, c;
+
+    if (SDL_BuildAudioCVT(&cvt, AUDIO_F32SYS, chans, rate, fmt, chans, rate) < 0) {
+        return NULL;
+    }
+    samples = (float *) SDL_malloc(floatlen * cvt.len_mult);
+    if (!samples) {
+        return NULL;
+    }
+    for (i = 0; i < frames; i++) {
+        const float sample = (float) (0.5 * SDL_sin((2.0 * M_PI * 440.0 * i) / rate));
+        for (c = 0; c < chans; c++) {
+            samples[(i * chans) + c] = sample;
+        }
+    }
+    cvt.buf = (Uint8 *) samples;
+    cvt.len = floatlen;
+    if (cvt.needed && (SDL_ConvertAudio(&cvt) < 0)) {
+        SDL_free(samples);
+        return NULL;
+    }
+    *len = cvt.needed ? cvt.len_cvt : floatlen;
+    return (Uint8 *) samples;
+}
+
+/* Time one conversion. Returns the number of lines printed (0 or 1). */
+static int
+bench(const char *dispatch, int sf, Uint8 sc, int sr, int df, Uint8 dc, int dr)
+{
+    const Uint64 freq = SDL_GetPerformanceFrequency();
+    SDL_AudioCVT cvt;
+    Uint8 *src;
+    int srclen = 0;
+    Uint64 total = 0;
+    Uint64 best = 0;
+    int iterations = 0;
+
+    if (SDL_BuildAudioCVT(&cvt, formats[sf].format, sc, sr, formats[df].format, dc, dr) <= 0) {
+        return 0;  /* unsupported, or nothing to convert. */
+    }
+
+    src = make_source(formats[sf].format, sc, sr, &srclen);
+    if (!src) {
+        SDL_Log("Couldn't make %s source data: %s\n", formats[sf].name, SDL_GetError());
+        return 0;
+    }
+
+    cvt.len = srclen;
+    cvt.buf = (Uint8 *) SDL_malloc(srclen * cvt.len_mult);
+    if (!cvt.buf) {
+        SDL_free(src);
+        return 0;
+    }
+
+    while ((iterations < 3) || (total < min_ticks)) {
+        Uint64 start, ticks;
+        SDL_memcpy(cvt.buf, src, srclen);  /* conversion is in place. */
+        start = SDL_GetPerformanceCounter();
+        SDL_ConvertAudio(&cvt);
+        ticks = SDL_GetPerformanceCounter() - start;
+        if ((iterations == 0) || (ticks < best)) {
+            best = ticks;
+        }
+        total += ticks;
+        iterations++;
+    }
+
+    printf("%s,%s,%d,%d,%s,%d,%d,%d,%d,%.3f,%.3f,%.2f\n",
+           dispatch, formats[sf].name, (int) sc, sr, formats[df].name, (int) dc, dr,
+           frames, iterations,
+           (best * 1000000.0) / freq,
+           ((total * 1000000.0) / freq) / iterations,
+           (frames / ((double) SDL_max(best, 1) / freq)) / 1000000.0);
+
+    SDL_free(cvt.buf);
+    SDL_free(src);
+    return 1;
+}
+
+int
+main(int argc, char **argv)
+{
+    const char *dispatch = "auto";
+    int msec = 2;
+    int sf, df, sc, dc, sr, dr, i;
+    int count = 0;
+
+    /* Enable standard application logging */
+    SDL_LogSetPriority(SDL_LOG_CATEGORY_APPLICATION, SDL_LOG_PRIORITY_INFO);
+
+    for (i = 1; i < argc; i++) {
+        if ((SDL_strcmp(argv[i], "--dispatch") == 0) && argv[i+1]) {
+            dispatch = argv[++i];
+        } else if ((SDL_strcmp(argv[i], "--frames") == 0) && argv[i+1]) {
+            frames = SDL_atoi(argv[++i]);
+        } else if ((SDL_strcmp(argv[i], "--msec") == 0) && argv[i+1]) {
+            msec = SDL_atoi(argv[++i]);
+        } else if ((SDL_strcmp(argv[i], "--rates") == 0) && argv[i+1]) {
+            if (parse_rates(argv[++i]) < 0) {
+                SDL_Log("Bad rate list '%s'\n", argv[i]);
+                return 1;
+            }
+        } else {
+            SDL_Log("USAGE: %s [--dispatch auto|scalar|sse2|neon] [--frames N] [--msec N] [--rates 22050,44100,48000]\n", argv[0]);
+            return 1;
+        }
+    }
+    if ((frames <= 0) || (msec < 0)) {
+        SDL_Log("--frames must be positive and --msec can't be negative\n");
+        return 1;
+    }
+
+    for (i = 0; i < SDL_arraysize(dispatches); i++) {
+        if (SDL_strcmp(dispatch, dispatches[i].name) == 0) {
+            break;
+        }
+    }
+    if (i == SDL_arraysize(dispatches)) {
+        SDL_Log("Unknown dispatch '%s'\n", dispatch);
+        return 1;
+    }
+
+    /* This has to happen before anything asks SDL about the CPU. */
+    if (dispatches[i].disable) {
+        SDL_SetHintWithPriority(SDL_HINT_CPU_DISABLE_FEATURES, dispatches[i].disable, SDL_HINT_OVERRIDE);
+    }
+
+    if (SDL_Init(0) == -1) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "SDL_Init() failed: %s\n", SDL_GetError());
+        return 2;
+    }
+
+    if (((SDL_strcmp(dispatch, "sse2") == 0) && !SDL_HasSSE2()) ||
+        ((SDL_strcmp(dispatch, "neon") == 0) && !SDL_HasNEON())) {
+        SDL_Log("This CPU can't run the %s code paths\n", dispatch);
+        SDL_Quit();
+        return 3;
+    }
+
+    min_ticks = (SDL_GetPerformanceFrequency() * msec) / 1000;
+
+    printf("# dispatch=%s sse2=%d sse3=%d neon=%d altivec=%d frames=%d\n",
+           dispatch, (int) SDL_HasSSE2(), (int) SDL_HasSSE3(),
+           (int) SDL_HasNEON(), (int) SDL_HasAltiVec(), frames);
+    printf("dispatch,src_format,src_channels,src_rate,dst_format,dst_channels,dst_rate,frames,iterations,best_usec,avg_usec,mframes_per_sec\n");
+
+    for (sf = 0; sf < SDL_arraysize(formats); sf++) {
+        for (sc = 0; sc < SDL_arraysize(channels); sc++) {
+            for (sr = 0; sr < num_rates; sr++) {
+                for (df = 0; df < SDL_arraysize(formats); df++) {
+                    for (dc = 0; dc < SDL_arraysize(channels); dc++) {
+                        for (dr = 0; dr < num_rates; dr++) {
+                            count += bench(dispatch, sf, channels[sc], rates[sr],
+                                           df, channels[dc], rates[dr]);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    SDL_Log("Timed %d conversions.\n", count);
+    SDL_Quit();
+    return 0;
+}
+
+/* vi: set ts=4 sw=4 expandtab: */
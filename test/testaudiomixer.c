@@ -0,0 +1,282 @@
+/*
+  Copyright (C) 1997-2017 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely.
+*/
+
+/* Sanity checks for SDL_AudioMixer, and a benchmark that mixes a lot of
+   voices in different formats and rates, reporting how many voices would
+   fit in realtime. */
+
+#include "SDL.h"
+
+#define MIX_FRAMES 1024
+
+static int failures = 0;
+
+static void
+check(const SDL_bool ok, const char *what)
+{
+    if (!ok) {
+        SDL_Log("FAILED: %s", what);
+        failures++;
+    }
+}
+
+static SDL_bool
+close_enough(const float a, const float b)
+{
+    return (SDL_fabs(a - b) < 0.00001) ? SDL_TRUE : SDL_FALSE;
+}
+
+/* A same-rate stereo voice comes out scaled, two frames late. */
+static void
+test_passthrough(void)
+{
+    SDL_AudioMixer *mixer = SDL_NewAudioMixer(AUDIO_F32SYS, 2, 48000);
+    SDL_AudioVoice *voice = mixer ? SDL_AudioMixerAddVoice(mixer, AUDIO_F32SYS, 2, 48000) : NULL;
+    float input[MIX_FRAMES * 2];
+    float output[MIX_FRAMES * 2];
+    SDL_bool ok = SDL_TRUE;
+    int i;
+
+    if (!voice) {
+        check(SDL_FALSE, "creating a F32 stereo mixer and voice");
+        SDL_FreeAudioMixer(mixer);
+        return;
+    }
+
+    for (i = 0; i < MIX_FRAMES * 2; i++) {
+        input[i] = ((float) ((i * 37) % 200) / 100.0f) - 1.0f;
+    }
+    SDL_SetAudioVoiceGain(voice, 0.5f, 0.0f);
+    SDL_AudioVoicePut(voice, input, sizeof (input));
+    SDL_AudioMixerMix(mixer, output, sizeof (output));
+
+    for (i = 4; i < MIX_FRAMES * 2; i++) {
+        ok = ok && close_enough(output[i], input[i - 4] * 0.5f);
+    }
+    check(ok && (output[0] == 0.0f) && (output[3] == 0.0f), "F32 stereo voice at the mixer's rate");
+
+    SDL_FreeAudioMixer(mixer);
+}
+
+/* A mono S16 voice panned hard left only reaches the left channel. */
+static void
+test_pan(void)
+{
+    SDL_AudioMixer *mixer = SDL_NewAudioMixer(AUDIO_F32SYS, 2, 44100);
+    SDL_AudioVoice *voice = mixer ? SDL_AudioMixerAddVoice(mixer, AUDIO_S16SYS, 1, 44100) : NULL;
+    Sint16 input[MIX_FRAMES];
+    float output[MIX_FRAMES * 2];
+    SDL_bool ok = SDL_TRUE;
+    int i;
+
+    if (!voice) {
+        check(SDL_FALSE, "creating a S16 mono voice");
+        SDL_FreeAudioMixer(mixer);
+        return;
+    }
+
+    for (i = 0; i < MIX_FRAMES; i++) {
+        input[i] = (Sint16) (((i * 1031) % 65536) - 32768);
+    }
+    SDL_SetAudioVoiceGain(voice, 1.0f, -1.0f);
+    SDL_AudioVoicePut(voice, input, sizeof (input));
+    SDL_AudioMixerMix(mixer, output, sizeof (output));
+
+    for (i = 2; i < MIX_FRAMES; i++) {
+        ok = ok && close_enough(output[i * 2], ((float) input[i - 2]) / 32767.0f);
+        ok = ok && (output[(i * 2) + 1] == 0.0f);
+    }
+    check(ok, "S16 mono voice panned left");
+
+    SDL_FreeAudioMixer(mixer);
+}
+
+/* Upsampling a ramp by two gives the ramp at half the slope. */
+static void
+test_resample(void)
+{
+    SDL_AudioMixer *mixer = SDL_NewAudioMixer(AUDIO_F32SYS, 1, 48000);
+    SDL_AudioVoice *voice = mixer ? SDL_AudioMixerAddVoice(mixer, AUDIO_F32SYS, 1, 24000) : NULL;
+    float input[MIX_FRAMES];
+    float output[MIX_FRAMES];
+    SDL_bool ok = SDL_TRUE;
+    int i;
+
+    if (!voice) {
+        check(SDL_FALSE, "creating a resampled F32 mono voice");
+        SDL_FreeAudioMixer(mixer);
+        return;
+    }
+
+    for (i = 0; i < MIX_FRAMES; i++) {
+        input[i] = ((float) i) * 0.001f;
+    }
+    SDL_AudioVoicePut(voice, input, sizeof (input));
+    SDL_AudioMixerMix(mixer, output, sizeof (output));
+
+    for (i = 4; i < MIX_FRAMES; i++) {
+        ok = ok && close_enough(output[i], (((float) i) * 0.5f - 2.0f) * 0.001f);
+    }
+    check(ok, "F32 mono voice upsampled from 24000 to 48000Hz");
+
+    SDL_FreeAudioMixer(mixer);
+}
+
+/* A 44.1kHz S16 stereo DC signal stays DC at 48kHz, and two full scale
+   voices clip instead of wrapping around. */
+static void
+test_clipping(void)
+{
+    SDL_AudioMixer *mixer = SDL_NewAudioMixer(AUDIO_S16SYS, 2, 48000);
+    SDL_AudioVoice *voice1 = mixer ? SDL_AudioMixerAddVoice(mixer, AUDIO_S16SYS, 2, 44100) : NULL;
+    SDL_AudioVoice *voice2 = mixer ? SDL_AudioMixerAddVoice(mixer, AUDIO_U8, 1, 22050) : NULL;
+    Sint16 input1[MIX_FRAMES * 2];
+    Uint8 input2[MIX_FRAMES];
+    Sint16 output[MIX_FRAMES * 2];
+    SDL_bool ok = SDL_TRUE;
+    int i;
+
+    if (!voice1 || !voice2) {
+        check(SDL_FALSE, "creating S16 and U8 voices");
+        SDL_FreeAudioMixer(mixer);
+        return;
+    }
+
+    for (i = 0; i < MIX_FRAMES * 2; i++) {
+        input1[i] = 16384;
+    }
+    SDL_AudioVoicePut(voice1, input1, sizeof (input1));
+    SDL_AudioMixerMix(mixer, output, sizeof (output));
+    for (i = 8; i < MIX_FRAMES * 2; i++) {
+        ok = ok && (output[i] == 16384);
+    }
+    check(ok, "S16 stereo DC voice resampled from 44100 to 48000Hz");
+
+    ok = SDL_TRUE;
+    SDL_memset(input2, 0xFF, sizeof (input2));
+    SDL_AudioVoicePut(voice1, input1, sizeof (input1));
+    SDL_AudioVoicePut(voice2, input2, sizeof (input2));
+    SDL_SetAudioVoiceGain(voice2, 2.0f, 0.0f);
+    SDL_AudioMixerMix(mixer, output, sizeof (output));
+    for (i = 8; i < MIX_FRAMES * 2; i++) {
+        ok = ok && (output[i] == 32767);
+    }
+    check(ok, "clipping when mixing to S16");
+
+    SDL_AudioMixerRemoveVoice(voice2);
+    SDL_FreeAudioMixer(mixer);
+}
+
+static void
+benchmark(const int num_voices, const int seconds)
+{
+    static const struct
+    {
+        SDL_AudioFormat format;
+        Uint8 channels;
+        int freq;
+    } kinds[] = {
+        { AUDIO_S16SYS, 2, 44100 },
+        { AUDIO_F32SYS, 1, 48000 },
+        { AUDIO_S16SYS, 1, 22050 },
+        { AUDIO_F32SYS, 2, 48000 },
+        { AUDIO_S16SYS, 2, 48000 }
+    };
+    const double freq = (double) SDL_GetPerformanceFrequency();
+    SDL_AudioMixer *mixer = SDL_NewAudioMixer(AUDIO_S16SYS, 2, 48000);
+    SDL_AudioVoice **voices = (SDL_AudioVoice **) SDL_calloc(num_voices, sizeof (SDL_AudioVoice *));
+    Uint8 *input = (Uint8 *) SDL_calloc(MIX_FRAMES * 2, sizeof (float) * 2);
+    Sint16 output[MIX_FRAMES * 2];
+    Uint64 total = 0;
+    double elapsed;
+    int i, j;
+
+    if (!mixer || !voices || !input) {
+        SDL_Log("Couldn't set up the benchmark: %s", SDL_GetError());
+        SDL_FreeAudioMixer(mixer);
+        SDL_free(voices);
+        SDL_free(input);
+        return;
+    }
+
+    for (i = 0; i < num_voices; i++) {
+        const int kind = i % SDL_arraysize(kinds);
+        voices[i] = SDL_AudioMixerAddVoice(mixer, kinds[kind].format, kinds[kind].channels, kinds[kind].freq);
+        SDL_SetAudioVoiceGain(voices[i], 1.0f / num_voices, ((float) (i % 9) - 4.0f) / 4.0f);
+    }
+
+    for (i = 0; i < (seconds * 48000) / MIX_FRAMES; i++) {
+        Uint64 start;
+        for (j = 0; j < num_voices; j++) {
+            const int kind = j % SDL_arraysize(kinds);
+            const int framelen = (SDL_AUDIO_BITSIZE(kinds[kind].format) / 8) * kinds[kind].channels;
+            const int frames = ((MIX_FRAMES * kinds[kind].freq) / 48000) + 1;
+            if (SDL_AudioVoiceQueued(voices[j]) < (frames * framelen)) {
+                SDL_AudioVoicePut(voices[j], input, frames * framelen);
+            }
+        }
+        start = SDL_GetPerformanceCounter();
+        SDL_AudioMixerMix(mixer, output, sizeof (output));
+        total += SDL_GetPerformanceCounter() - start;
+    }
+
+    elapsed = ((double) total) / freq;
+    SDL_Log("%d voices: %d seconds of 48kHz stereo mixed in %.3f seconds (%.1fx realtime, ~%d voices per core)",
+            num_voices, seconds, elapsed, ((double) seconds) / elapsed,
+            (int) ((((double) seconds) / elapsed) * num_voices));
+
+    SDL_FreeAudioMixer(mixer);
+    SDL_free(voices);
+    SDL_free(input);
+}
+
+int
+main(int argc, char **argv)
+{
+    int voices = 128;
+
+    /* Enable standard application logging */
+    SDL_LogSetPriority(SDL_LOG_CATEGORY_APPLICATION, SDL_LOG_PRIORITY_INFO);
+
+    if (argc > 1) {
+        voices = SDL_atoi(argv[1]);
+    }
+
+    if (SDL_Init(0) < 0) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't initialize SDL: %s\n", SDL_GetError());
+        return 1;
+    }
+
+    /* The format converters are chosen when the audio subsystem starts up;
+       the dummy driver is always there to get us that far. */
+    if (SDL_AudioInit("dummy") < 0) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't initialize dummy audio: %s\n", SDL_GetError());
+        SDL_Quit();
+        return 1;
+    }
+
+    test_passthrough();
+    test_pan();
+    test_resample();
+    test_clipping();
+    SDL_Log("Sanity checks: %s (%d failures)", failures ? "FAILED" : "passed", failures);
+
+    if (voices > 0) {
+        benchmark(voices, 10);
+    }
+
+    SDL_AudioQuit();
+    SDL_Quit();
+    return failures ? 1 : 0;
+}
+
+/* vi: set ts=4 sw=4 expandtab: */
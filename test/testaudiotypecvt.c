@@ -0,0 +1,327 @@
+/*
+  Copyright (C) 1997-2017 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely.
+*/
+
+/* Checks the sample type converters SDL picked for this CPU (scalar, SSE2,
+   NEON...) against a plain C reference, bit for bit, and then reports how
+   fast each one runs. */
+
+#include "SDL.h"
+
+/* These have to match the constants in SDL_audiotypecvt.c */
+#define DIVBY127 0.0078740157480315f
+#define DIVBY32767 3.05185094759972e-05f
+#define DIVBY2147483647 4.6566128752458e-10f
+
+static const struct
+{
+    SDL_AudioFormat format;
+    const char *name;
+} formats[] = {
+    { AUDIO_U8, "AUDIO_U8" },
+    { AUDIO_S8, "AUDIO_S8" },
+    { AUDIO_U16LSB, "AUDIO_U16LSB" },
+    { AUDIO_U16MSB, "AUDIO_U16MSB" },
+    { AUDIO_S16LSB, "AUDIO_S16LSB" },
+    { AUDIO_S16MSB, "AUDIO_S16MSB" },
+    { AUDIO_S32LSB, "AUDIO_S32LSB" },
+    { AUDIO_S32MSB, "AUDIO_S32MSB" },
+    { AUDIO_F32LSB, "AUDIO_F32LSB" },
+    { AUDIO_F32MSB, "AUDIO_F32MSB" }
+};
+
+static Uint32 seed = 0x12345678;
+
+static Uint32
+random_u32(void)
+{
+    /* xorshift32; we want the same data on every run. */
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    return seed;
+}
+
+static float
+random_float(void)
+{
+    /* Mix in the values at and around the edges of the range. */
+    switch (random_u32() % 16) {
+        case 0: return -1.0f;
+        case 1: return 1.0f;
+        case 2: return 0.0f;
+        default: break;
+    }
+    return (((float) (random_u32() % 2000001)) / 1000000.0f) - 1.0f;
+}
+
+static const char *
+format_name(const SDL_AudioFormat format)
+{
+    int i;
+    for (i = 0; i < SDL_arraysize(formats); i++) {
+        if (formats[i].format == format) {
+            return formats[i].name;
+        }
+    }
+    return "???";
+}
+
+static Uint32
+read_raw(const Uint8 *ptr, const SDL_AudioFormat format)
+{
+    const int bytes = SDL_AUDIO_BITSIZE(format) / 8;
+    Uint32 val = 0;
+    int i;
+    for (i = 0; i < bytes; i++) {
+        const int shift = SDL_AUDIO_ISBIGENDIAN(format) ? ((bytes - 1 - i) * 8) : (i * 8);
+        val |= ((Uint32) ptr[i]) << shift;
+    }
+    return val;
+}
+
+static void
+write_raw(Uint8 *ptr, const SDL_AudioFormat format, const Uint32 val)
+{
+    const int bytes = SDL_AUDIO_BITSIZE(format) / 8;
+    int i;
+    for (i = 0; i < bytes; i++) {
+        const int shift = SDL_AUDIO_ISBIGENDIAN(format) ? ((bytes - 1 - i) * 8) : (i * 8);
+        ptr[i] = (Uint8) (val >> shift);
+    }
+}
+
+/* The same math the scalar converters in SDL_audiotypecvt.c do. */
+static float
+reference_to_float(const Uint8 *ptr, const SDL_AudioFormat format)
+{
+    const Uint32 raw = read_raw(ptr, format);
+    switch (format & ~SDL_AUDIO_MASK_ENDIAN) {
+        case AUDIO_S8: return (((float) (Sint8) raw) * DIVBY127);
+        case AUDIO_U8: return ((((float) (Uint8) raw) * DIVBY127) - 1.0f);
+        case AUDIO_S16: return (((float) (Sint16) raw) * DIVBY32767);
+        case AUDIO_U16: return ((((float) (Uint16) raw) * DIVBY32767) - 1.0f);
+        case AUDIO_S32: return (float) (((double) (Sint32) raw) * DIVBY2147483647);
+        case AUDIO_F32: { float f; SDL_memcpy(&f, &raw, sizeof (f)); return f; }
+        default: break;
+    }
+    SDL_assert(!"unexpected format");
+    return 0.0f;
+}
+
+static void
+reference_from_float(Uint8 *ptr, const SDL_AudioFormat format, const float f)
+{
+    Uint32 raw = 0;
+    switch (format & ~SDL_AUDIO_MASK_ENDIAN) {
+        case AUDIO_S8: raw = (Uint8) (Sint8) (f * 127.0f); break;
+        case AUDIO_U8: raw = (Uint8) ((f + 1.0f) * 127.0f); break;
+        case AUDIO_S16: raw = (Uint16) (Sint16) (f * 32767.0f); break;
+        case AUDIO_U16: raw = (Uint16) ((f + 1.0f) * 32767.0f); break;
+        case AUDIO_S32: raw = (Uint32) (Sint32) (((double) f) * 2147483647.0); break;
+        case AUDIO_F32: SDL_memcpy(&raw, &f, sizeof (raw)); break;
+        default: SDL_assert(!"unexpected format"); break;
+    }
+    write_raw(ptr, format, raw);
+}
+
+static void
+fill_random(Uint8 *buf, const SDL_AudioFormat format, const int samples)
+{
+    const int size = SDL_AUDIO_BITSIZE(format) / 8;
+    int i;
+    for (i = 0; i < samples; i++) {
+        if (SDL_AUDIO_ISFLOAT(format)) {
+            const float f = random_float();
+            Uint32 raw;
+            SDL_memcpy(&raw, &f, sizeof (raw));
+            write_raw(buf + (i * size), format, raw);
+        } else {
+            write_raw(buf + (i * size), format, random_u32());
+        }
+    }
+}
+
+/* Convert (samples) from src_fmt to dst_fmt with the buffer starting (misalign)
+   bytes past a 16-byte boundary, and compare to the reference converter. */
+static int
+check_conversion(const SDL_AudioFormat src_fmt, const SDL_AudioFormat dst_fmt,
+                 const int samples, const int misalign)
+{
+    const int src_size = SDL_AUDIO_BITSIZE(src_fmt) / 8;
+    const int dst_size = SDL_AUDIO_BITSIZE(dst_fmt) / 8;
+    Uint8 *input = (Uint8 *) SDL_malloc((samples * src_size) + 1);
+    Uint8 *expected = (Uint8 *) SDL_malloc((samples * dst_size) + 1);
+    Uint8 *base = NULL;
+    SDL_AudioCVT cvt;
+    int retval = 0;
+    int i;
+
+    if (SDL_BuildAudioCVT(&cvt, src_fmt, 1, 48000, dst_fmt, 1, 48000) < 0) {
+        SDL_Log("SDL_BuildAudioCVT(%s -> %s) failed: %s", format_name(src_fmt), format_name(dst_fmt), SDL_GetError());
+        SDL_free(input);
+        SDL_free(expected);
+        return -1;
+    }
+
+    base = (Uint8 *) SDL_malloc((samples * src_size * cvt.len_mult) + 32);
+    if (!input || !expected || !base) {
+        SDL_Log("Out of memory!");
+        SDL_free(input);
+        SDL_free(expected);
+        SDL_free(base);
+        return -1;
+    }
+
+    fill_random(input, src_fmt, samples);
+    for (i = 0; i < samples; i++) {
+        if (SDL_AUDIO_ISFLOAT(src_fmt) || SDL_AUDIO_ISFLOAT(dst_fmt)) {
+            reference_from_float(expected + (i * dst_size), dst_fmt, reference_to_float(input + (i * src_size), src_fmt));
+        } else {  /* same type, just a byteswap. */
+            write_raw(expected + (i * dst_size), dst_fmt, read_raw(input + (i * src_size), src_fmt));
+        }
+    }
+
+    cvt.buf = (Uint8 *) (((((size_t) base) + 15) & ~((size_t) 15)) + misalign);
+    cvt.len = samples * src_size;
+    SDL_memcpy(cvt.buf, input, cvt.len);
+
+    if (SDL_ConvertAudio(&cvt) < 0) {
+        SDL_Log("SDL_ConvertAudio(%s -> %s) failed: %s", format_name(src_fmt), format_name(dst_fmt), SDL_GetError());
+        retval = -1;
+    } else if (cvt.len_cvt != (samples * dst_size)) {
+        SDL_Log("%s -> %s: expected %d bytes, got %d", format_name(src_fmt), format_name(dst_fmt), samples * dst_size, cvt.len_cvt);
+        retval = -1;
+    } else {
+        for (i = 0; i < samples; i++) {
+            if (SDL_memcmp(cvt.buf + (i * dst_size), expected + (i * dst_size), dst_size) != 0) {
+                SDL_Log("%s -> %s: mismatch at sample %d of %d (misalign %d): expected 0x%08X, got 0x%08X",
+                        format_name(src_fmt), format_name(dst_fmt), i, samples, misalign,
+                        (unsigned int) read_raw(expected + (i * dst_size), dst_fmt),
+                        (unsigned int) read_raw(cvt.buf + (i * dst_size), dst_fmt));
+                retval = -1;
+                break;
+            }
+        }
+    }
+
+    SDL_free(base);
+    SDL_free(input);
+    SDL_free(expected);
+    return retval;
+}
+
+static void
+benchmark_conversion(const SDL_AudioFormat src_fmt, const SDL_AudioFormat dst_fmt,
+                     const int samples, const int iterations)
+{
+    const int src_size = SDL_AUDIO_BITSIZE(src_fmt) / 8;
+    const double freq = (double) SDL_GetPerformanceFrequency();
+    Uint8 *input = (Uint8 *) SDL_malloc(samples * src_size);
+    Uint8 *base = NULL;
+    SDL_AudioCVT cvt;
+    Uint64 total = 0;
+    int i;
+
+    if (!input || (SDL_BuildAudioCVT(&cvt, src_fmt, 1, 48000, dst_fmt, 1, 48000) < 0)) {
+        SDL_free(input);
+        return;
+    }
+
+    base = (Uint8 *) SDL_malloc((samples * src_size * cvt.len_mult) + 16);
+    if (!base) {
+        SDL_free(input);
+        return;
+    }
+
+    fill_random(input, src_fmt, samples);
+    cvt.buf = (Uint8 *) ((((size_t) base) + 15) & ~((size_t) 15));
+
+    for (i = 0; i < iterations; i++) {
+        Uint64 start;
+        SDL_memcpy(cvt.buf, input, samples * src_size);
+        cvt.len = samples * src_size;
+        start = SDL_GetPerformanceCounter();
+        SDL_ConvertAudio(&cvt);
+        total += SDL_GetPerformanceCounter() - start;
+    }
+
+    SDL_Log("%-12s -> %-12s %10.1f Msamples/sec",
+            format_name(src_fmt), format_name(dst_fmt),
+            ((double) samples * iterations) / (((double) total) / freq) / 1000000.0);
+
+    SDL_free(base);
+    SDL_free(input);
+}
+
+int
+main(int argc, char **argv)
+{
+    int iterations = 200;
+    int failures = 0;
+    int i, samples, misalign;
+
+    /* Enable standard application logging */
+    SDL_LogSetPriority(SDL_LOG_CATEGORY_APPLICATION, SDL_LOG_PRIORITY_INFO);
+
+    if (argc > 1) {
+        iterations = SDL_atoi(argv[1]);
+    }
+
+    if (SDL_Init(0) < 0) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't initialize SDL: %s\n", SDL_GetError());
+        return 1;
+    }
+
+    /* The converters are chosen when the audio subsystem starts up; the
+       dummy driver is always there to get us that far. */
+    if (SDL_AudioInit("dummy") < 0) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't initialize dummy audio: %s\n", SDL_GetError());
+        SDL_Quit();
+        return 1;
+    }
+
+    SDL_Log("CPU features: SSE2=%d NEON=%d", (int) SDL_HasSSE2(), (int) SDL_HasNEON());
+
+    for (i = 0; i < SDL_arraysize(formats); i++) {
+        const SDL_AudioFormat fmt = formats[i].format;
+        const SDL_AudioFormat swapped = fmt ^ SDL_AUDIO_MASK_ENDIAN;
+        for (samples = 0; samples < 70; samples++) {
+            for (misalign = 0; misalign < 16; misalign += SDL_AUDIO_BITSIZE(fmt) / 8) {
+                if (fmt != AUDIO_F32SYS) {
+                    failures += (check_conversion(fmt, AUDIO_F32SYS, samples, misalign) < 0);
+                    failures += (check_conversion(AUDIO_F32SYS, fmt, samples, misalign) < 0);
+                }
+                if (SDL_AUDIO_BITSIZE(fmt) > 8) {
+                    failures += (check_conversion(fmt, swapped, samples, misalign) < 0);
+                }
+            }
+        }
+    }
+
+    SDL_Log("Exactness check: %s (%d failures)", failures ? "FAILED" : "passed", failures);
+
+    if (iterations > 0) {
+        for (i = 0; i < SDL_arraysize(formats); i++) {
+            const SDL_AudioFormat fmt = formats[i].format;
+            if (fmt != AUDIO_F32SYS) {
+                benchmark_conversion(fmt, AUDIO_F32SYS, 256 * 1024, iterations);
+                benchmark_conversion(AUDIO_F32SYS, fmt, 256 * 1024, iterations);
+            }
+        }
+    }
+
+    SDL_AudioQuit();
+    SDL_Quit();
+    return failures ? 1 : 0;
+}
+
+/* vi: set ts=4 sw=4 expandtab: */
@@ -494,13 +494,13 @@ int audio_printCurrentAudioDriver()
 }
 
 /* Definition of all formats, channels, and frequencies used to test audio conversions */
-const int _numAudioFormats = 18;
+const int _numAudioFormats = 20;
 SDL_AudioFormat _audioFormats[] = { AUDIO_S8, AUDIO_U8, AUDIO_S16LSB, AUDIO_S16MSB, AUDIO_S16SYS, AUDIO_S16, AUDIO_U16LSB,
                 AUDIO_U16MSB, AUDIO_U16SYS, AUDIO_U16, AUDIO_S32LSB, AUDIO_S32MSB, AUDIO_S32SYS, AUDIO_S32,
-                                AUDIO_F32LSB, AUDIO_F32MSB, AUDIO_F32SYS, AUDIO_F32 };
+                                AUDIO_F32LSB, AUDIO_F32MSB, AUDIO_F32SYS, AUDIO_F32, AUDIO_S16P, AUDIO_F32P };
 char *_audioFormatsVerbose[] = { "AUDIO_S8", "AUDIO_U8", "AUDIO_S16LSB", "AUDIO_S16MSB", "AUDIO_S16SYS", "AUDIO_S16", "AUDIO_U16LSB",
                 "AUDIO_U16MSB", "AUDIO_U16SYS", "AUDIO_U16", "AUDIO_S32LSB", "AUDIO_S32MSB", "AUDIO_S32SYS", "AUDIO_S32",
-                                "AUDIO_F32LSB", "AUDIO_F32MSB", "AUDIO_F32SYS", "AUDIO_F32" };
+                                "AUDIO_F32LSB", "AUDIO_F32MSB", "AUDIO_F32SYS", "AUDIO_F32", "AUDIO_S16P", "AUDIO_F32P" };
 const int _numAudioChannels = 4;
 Uint8 _audioChannels[] = { 1, 2, 4, 6 };
 const int _numAudioFrequencies = 4;
@@ -907,6 +907,291 @@ int audio_convertAudio()
 }
 
 
+/* Runs one conversion of len bytes from in; the result is in cvt->buf. */
+static int _convertPlanarBufferRate(SDL_AudioCVT *cvt, SDL_AudioFormat src_format, Uint8 src_channels, int src_rate,
+                                    SDL_AudioFormat dst_format, Uint8 dst_channels, int dst_rate, const void *in, int len)
+{
+  int result;
+
+  cvt->buf = NULL;
+  result = SDL_BuildAudioCVT(cvt, src_format, src_channels, src_rate, dst_format, dst_channels, dst_rate);
+  SDLTest_AssertPass("Call to SDL_BuildAudioCVT(0x%04x,%i,%i ==> 0x%04x,%i,%i)", src_format, src_channels, src_rate, dst_format, dst_channels, dst_rate);
+  SDLTest_AssertCheck(result == 0 || result == 1, "Verify result value; expected: 0 or 1, got: %i", result);
+  if (result < 0) {
+    return -1;
+  }
+  cvt->len = len;
+  cvt->buf = (Uint8 *)SDL_malloc(len * cvt->len_mult);
+  SDLTest_AssertCheck(cvt->buf != NULL, "Check data buffer to convert is not NULL");
+  if (cvt->buf == NULL) {
+    return -1;
+  }
+  SDL_memcpy(cvt->buf, in, len);
+  result = SDL_ConvertAudio(cvt);
+  SDLTest_AssertPass("Call to SDL_ConvertAudio()");
+  SDLTest_AssertCheck(result == 0, "Verify result value; expected: 0; got: %i", result);
+  return result;
+}
+
+static int _convertPlanarBuffer(SDL_AudioCVT *cvt, SDL_AudioFormat src_format, Uint8 src_channels,
+                                SDL_AudioFormat dst_format, Uint8 dst_channels, const void *in, int len)
+{
+  return _convertPlanarBufferRate(cvt, src_format, src_channels, 44100, dst_format, dst_channels, 44100, in, len);
+}
+
+/**
+ * \brief Converts to and from planar formats and checks the samples
+ *
+ * \sa https://wiki.libsdl.org/SDL_BuildAudioCVT
+ * \sa https://wiki.libsdl.org/SDL_ConvertAudio
+ */
+int audio_convertPlanarAudio()
+{
+  const int frames = 64;
+  float monoF32[64], stereoF32[128];
+  Sint16 interleavedS16[64 * 6], fourS16[64 * 4];
+  SDL_AudioCVT cvt;
+  int i, ch, mismatches;
+
+  for (i = 0; i < frames; i++) {
+    monoF32[i] = (float)(i - 32) / 32.0f;
+    stereoF32[i * 2] = monoF32[i];
+    stereoF32[i * 2 + 1] = -monoF32[i] / 2.0f;
+  }
+  for (i = 0; i < frames * 6; i++) {
+    interleavedS16[i] = (Sint16)SDLTest_RandomSint16();
+  }
+  for (i = 0; i < frames * 4; i++) {
+    fourS16[i] = (Sint16)SDLTest_RandomSint16();
+  }
+
+  /* Planar mono is the same as interleaved mono */
+  if (_convertPlanarBuffer(&cvt, AUDIO_F32P, 1, AUDIO_F32, 2, monoF32, sizeof (monoF32)) == 0) {
+    const float *out = (const float *)cvt.buf;
+    mismatches = 0;
+    for (i = 0; i < frames; i++) {
+      mismatches += (out[i * 2] != monoF32[i]) || (out[i * 2 + 1] != monoF32[i]);
+    }
+    SDLTest_AssertCheck(cvt.len_cvt == sizeof (stereoF32), "Verify mono to stereo length; expected: %i, got: %i", (int) sizeof (stereoF32), cvt.len_cvt);
+    SDLTest_AssertCheck(mismatches == 0, "Verify planar mono to stereo; mismatches: %i", mismatches);
+  }
+  SDL_free(cvt.buf);
+
+  /* The same layout on both sides only converts the samples, in place, so
+     it matches converting the same buffer as interleaved data */
+  if (_convertPlanarBuffer(&cvt, AUDIO_S16, 4, AUDIO_F32, 4, fourS16, sizeof (fourS16)) == 0) {
+    float fourF32[64 * 4];
+    SDL_memcpy(fourF32, cvt.buf, sizeof (fourF32));
+    SDL_free(cvt.buf);
+    if (_convertPlanarBuffer(&cvt, AUDIO_S16P, 4, AUDIO_F32P, 4, fourS16, sizeof (fourS16)) == 0) {
+      SDLTest_AssertCheck(cvt.len_cvt == sizeof (fourF32), "Verify planar S16 to planar float length; expected: %i, got: %i", (int) sizeof (fourF32), cvt.len_cvt);
+      SDLTest_AssertCheck(SDL_memcmp(cvt.buf, fourF32, sizeof (fourF32)) == 0, "Verify planar S16 to planar float keeps the samples in place");
+    }
+  }
+  SDL_free(cvt.buf);
+
+  /* Interleaved to planar and back again */
+  if (_convertPlanarBuffer(&cvt, AUDIO_S16, 6, AUDIO_S16P, 6, interleavedS16, sizeof (interleavedS16)) == 0) {
+    Sint16 planarS16[64 * 6];
+    const Sint16 *out = (const Sint16 *)cvt.buf;
+    mismatches = 0;
+    for (ch = 0; ch < 6; ch++) {
+      for (i = 0; i < frames; i++) {
+        mismatches += (out[ch * frames + i] != interleavedS16[i * 6 + ch]);
+      }
+    }
+    SDLTest_AssertCheck(mismatches == 0, "Verify interleaved to planar layout; mismatches: %i", mismatches);
+    SDL_memcpy(planarS16, cvt.buf, sizeof (planarS16));
+    SDL_free(cvt.buf);
+    if (_convertPlanarBuffer(&cvt, AUDIO_S16P, 6, AUDIO_S16, 6, planarS16, sizeof (planarS16)) == 0) {
+      SDLTest_AssertCheck(SDL_memcmp(cvt.buf, interleavedS16, sizeof (interleavedS16)) == 0, "Verify planar to interleaved round-trip is exact");
+    }
+  }
+  SDL_free(cvt.buf);
+
+  if (_convertPlanarBuffer(&cvt, AUDIO_F32P, 2, AUDIO_F32, 2, stereoF32, sizeof (stereoF32)) == 0) {
+    float interleavedF32[128];
+    const float *out = (const float *)cvt.buf;
+    mismatches = 0;
+    for (i = 0; i < frames; i++) {
+      mismatches += (out[i * 2] != stereoF32[i]) || (out[i * 2 + 1] != stereoF32[frames + i]);
+    }
+    SDLTest_AssertCheck(mismatches == 0, "Verify planar to interleaved layout; mismatches: %i", mismatches);
+    SDL_memcpy(interleavedF32, cvt.buf, sizeof (interleavedF32));
+    SDL_free(cvt.buf);
+    if (_convertPlanarBuffer(&cvt, AUDIO_F32, 2, AUDIO_F32P, 2, interleavedF32, sizeof (interleavedF32)) == 0) {
+      SDLTest_AssertCheck(SDL_memcmp(cvt.buf, stereoF32, sizeof (stereoF32)) == 0, "Verify interleaved to planar round-trip is exact");
+    }
+  }
+  SDL_free(cvt.buf);
+
+  return TEST_COMPLETED;
+}
+
+/**
+ * \brief Resamples up and down to and from planar formats and checks the
+ * result matches resampling the same data interleaved
+ *
+ * \sa https://wiki.libsdl.org/SDL_BuildAudioCVT
+ * \sa https://wiki.libsdl.org/SDL_ConvertAudio
+ */
+int audio_resamplePlanarAudio()
+{
+  const int rates[][2] = { { 48000, 44100 }, { 22050, 44100 } };
+  const int frames = 4800;
+  Sint16 *interleaved, *planar;
+  SDL_AudioCVT cvt;
+  int i, j, mismatches;
+
+  interleaved = (Sint16 *)SDL_malloc(frames * 2 * sizeof (Sint16));
+  planar = (Sint16 *)SDL_malloc(frames * 2 * sizeof (Sint16));
+  SDLTest_AssertCheck(interleaved != NULL && planar != NULL, "Check sample buffers are not NULL");
+  if (interleaved == NULL || planar == NULL) {
+    SDL_free(interleaved);
+    SDL_free(planar);
+    return TEST_ABORTED;
+  }
+  for (i = 0; i < frames; i++) {
+    interleaved[i * 2] = planar[i] = (Sint16)SDLTest_RandomSint16();
+    interleaved[i * 2 + 1] = planar[frames + i] = (Sint16)SDLTest_RandomSint16();
+  }
+
+  for (j = 0; j < SDL_arraysize(rates); j++) {
+    const int src_rate = rates[j][0];
+    const int dst_rate = rates[j][1];
+    float *expected;
+    int expectedlen;
+
+    if (_convertPlanarBufferRate(&cvt, AUDIO_S16, 2, src_rate, AUDIO_F32, 2, dst_rate, interleaved, frames * 2 * sizeof (Sint16)) != 0) {
+      SDL_free(cvt.buf);
+      continue;
+    }
+    expected = (float *)cvt.buf;
+    expectedlen = cvt.len_cvt;
+
+    /* Planar in, interleaved out */
+    if (_convertPlanarBufferRate(&cvt, AUDIO_S16P, 2, src_rate, AUDIO_F32, 2, dst_rate, planar, frames * 2 * sizeof (Sint16)) == 0) {
+      SDLTest_AssertCheck(cvt.len_cvt == expectedlen, "Verify planar %i to %i length; expected: %i, got: %i", src_rate, dst_rate, expectedlen, cvt.len_cvt);
+      if (cvt.len_cvt == expectedlen) {
+        SDLTest_AssertCheck(SDL_memcmp(cvt.buf, expected, expectedlen) == 0, "Verify planar %i to %i matches interleaved", src_rate, dst_rate);
+      }
+    }
+    SDL_free(cvt.buf);
+
+    /* Interleaved in, planar out */
+    if (_convertPlanarBufferRate(&cvt, AUDIO_S16, 2, src_rate, AUDIO_F32P, 2, dst_rate, interleaved, frames * 2 * sizeof (Sint16)) == 0) {
+      const float *out = (const float *)cvt.buf;
+      const int outframes = expectedlen / (2 * (int) sizeof (float));
+      SDLTest_AssertCheck(cvt.len_cvt == expectedlen, "Verify %i to planar %i length; expected: %i, got: %i", src_rate, dst_rate, expectedlen, cvt.len_cvt);
+      if (cvt.len_cvt == expectedlen) {
+        mismatches = 0;
+        for (i = 0; i < outframes; i++) {
+          mismatches += (out[i] != expected[i * 2]) || (out[outframes + i] != expected[i * 2 + 1]);
+        }
+        SDLTest_AssertCheck(mismatches == 0, "Verify %i to planar %i matches interleaved; mismatches: %i", src_rate, dst_rate, mismatches);
+      }
+    }
+    SDL_free(cvt.buf);
+    SDL_free(expected);
+  }
+
+  SDL_free(interleaved);
+  SDL_free(planar);
+  return TEST_COMPLETED;
+}
+
+/**
+ * \brief Captures into a ring buffer on the dummy driver: the ring stays
+ * within SDL_HINT_AUDIO_CAPTURE_RING_MS, counts overruns when the reader
+ * falls behind, and timestamps never go backwards.
+ *
+ * \sa https://wiki.libsdl.org/SDL_DequeueAudio
+ */
+int audio_captureRingBuffer()
+{
+  const Uint32 maxBytes = (48000 / 10) * 2;  /* 100 ms of mono S16 */
+  SDL_AudioSpec desired, obtained;
+  SDL_AudioDeviceStats stats;
+  SDL_AudioDeviceID id;
+  Uint8 buf[300];
+  Uint64 timestamp, last = 0;
+  Uint32 queued, overruns, got;
+  int result, totalDelay, backwards = 0, reads = 0;
+
+  /* Switch the running audio subsystem over to the dummy driver */
+  SDL_SetHint(SDL_HINT_AUDIO_CAPTURE_RING_MS, "100");
+  result = SDL_AudioInit("dummy");
+  SDLTest_AssertPass("Call to SDL_AudioInit('dummy')");
+  SDLTest_AssertCheck(result == 0, "Validate result value; expected: 0 got: %d", result);
+
+  SDL_zero(desired);
+  desired.freq = 48000;
+  desired.format = AUDIO_S16SYS;
+  desired.channels = 1;
+  desired.samples = 480;
+  id = SDL_OpenAudioDevice(NULL, 1, &desired, &obtained, 0);
+  SDLTest_AssertPass("Call to SDL_OpenAudioDevice(NULL, 1, ...)");
+  SDLTest_AssertCheck(id > 0, "Validate device ID; expected: >0, got: %i", id);
+  if (id == 0) {
+    SDLTest_LogError("%s", SDL_GetError());
+    SDL_QuitSubSystem(SDL_INIT_AUDIO);
+    SDL_SetHint(SDL_HINT_AUDIO_CAPTURE_RING_MS, "0");
+    _audioSetUp(NULL);
+    return TEST_ABORTED;
+  }
+
+  /* Don't read for a while, so the ring fills up and overruns */
+  SDL_PauseAudioDevice(id, 0);
+  totalDelay = 0;
+  do {
+    SDL_Delay(10);
+    totalDelay += 10;
+    SDL_GetAudioDeviceStats(id, &stats);
+  } while (stats.capture_overruns < 5 && totalDelay < 3000);
+  queued = SDL_GetQueuedAudioSize(id);
+  SDLTest_AssertCheck(queued > 0 && queued <= maxBytes, "Verify queued capture is capped at 100 ms; expected: 1..%u, got: %u", maxBytes, queued);
+  SDLTest_AssertCheck(stats.capture_overruns > 0, "Verify overruns are counted; expected: >0, got: %u", stats.capture_overruns);
+
+  overruns = stats.capture_overruns;
+  SDL_Delay(50);
+  SDL_GetAudioDeviceStats(id, &stats);
+  SDLTest_AssertCheck(stats.capture_overruns > overruns, "Verify overruns keep growing while nothing is read; expected: >%u, got: %u", overruns, stats.capture_overruns);
+
+  /* Read in pieces that don't line up with the device's blocks */
+  totalDelay = 0;
+  while (totalDelay < 300) {
+    got = SDL_DequeueAudioWithTimestamp(id, buf, sizeof (buf), &timestamp);
+    if (got > 0) {
+      reads++;
+      backwards += (timestamp < last);
+      last = timestamp;
+    } else {
+      SDL_Delay(2);
+      totalDelay += 2;
+    }
+  }
+  SDLTest_AssertCheck(reads > 0, "Verify data was dequeued; got %i reads", reads);
+  SDLTest_AssertCheck(backwards == 0, "Verify timestamps never go backwards; %i did in %i reads", backwards, reads);
+
+  /* Nothing to read gives no timestamp */
+  SDL_PauseAudioDevice(id, 1);
+  SDL_Delay(20);
+  SDL_ClearQueuedAudio(id);
+  got = SDL_DequeueAudioWithTimestamp(id, buf, sizeof (buf), &timestamp);
+  SDLTest_AssertCheck(got == 0 && timestamp == 0, "Verify empty dequeue; expected: 0 bytes at 0, got: %u at %" SDL_PRIu64, got, timestamp);
+
+  SDL_CloseAudioDevice(id);
+  SDLTest_AssertPass("Call to SDL_CloseAudioDevice()");
+  SDL_QuitSubSystem(SDL_INIT_AUDIO);
+  SDLTest_AssertPass("Call to SDL_QuitSubSystem(SDL_INIT_AUDIO)");
+  SDL_SetHint(SDL_HINT_AUDIO_CAPTURE_RING_MS, "0");
+
+  /* Restart audio again */
+  _audioSetUp(NULL);
+
+  return TEST_COMPLETED;
+}
+
 /**
  * \brief Opens, checks current connected status, and closes a device.
  *
@@ -1022,11 +1307,20 @@ static const SDLTest_TestCaseReference audioTest14 =
 static const SDLTest_TestCaseReference audioTest15 =
         { (SDLTest_TestCaseFp)audio_pauseUnpauseAudio, "audio_pauseUnpauseAudio", "Pause and Unpause audio for various audio specs while testing callback.", TEST_ENABLED };
 
+static const SDLTest_TestCaseReference audioTest16 =
+        { (SDLTest_TestCaseFp)audio_convertPlanarAudio, "audio_convertPlanarAudio", "Convert to and from planar audio and check the samples.", TEST_ENABLED };
+
+static const SDLTest_TestCaseReference audioTest17 =
+        { (SDLTest_TestCaseFp)audio_captureRingBuffer, "audio_captureRingBuffer", "Capture into a ring buffer and check its cap, overruns and timestamps.", TEST_ENABLED };
+
+static const SDLTest_TestCaseReference audioTest18 =
+        { (SDLTest_TestCaseFp)audio_resamplePlanarAudio, "audio_resamplePlanarAudio", "Resample to and from planar audio and compare with interleaved.", TEST_ENABLED };
+
 /* Sequence of Audio test cases */
 static const SDLTest_TestCaseReference *audioTests[] =  {
     &audioTest1, &audioTest2, &audioTest3, &audioTest4, &audioTest5, &audioTest6,
     &audioTest7, &audioTest8, &audioTest9, &audioTest10, &audioTest11,
-    &audioTest12, &audioTest13, &audioTest14, &audioTest15, NULL
+    &audioTest12, &audioTest13, &audioTest14, &audioTest15, &audioTest16, &audioTest17, &audioTest18, NULL
 };
 
 /* Audio test suite (global) */
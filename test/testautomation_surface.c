@@ -588,6 +588,821 @@ surface_testBlitBlendLoop(void *arg) {
 
 }
 
+/* The per-pixel alpha blend SDL's 32-bit blitters are expected to match
+   exactly (see BlitRGBtoRGBPixelAlpha() in SDL_blit_A.c) */
+static Uint32
+_blendPixelReference(Uint32 s, Uint32 d)
+{
+   Uint32 a = s >> 24;
+   Uint32 result = 0;
+   int shift;
+
+   if (a == 0) {
+      return d;
+   } else if (a == 255) {
+      return s;
+   }
+   for (shift = 0; shift < 24; shift += 8) {
+      int sc = (s >> shift) & 0xff;
+      int dc = (d >> shift) & 0xff;
+      int c = dc + (((sc - dc) * (int)a) >> 8);
+      result |= ((Uint32)c & 0xff) << shift;
+   }
+   return result | ((a + ((d >> 24) * (a ^ 0xff) >> 8)) << 24);
+}
+
+/**
+ * @brief Tests per-pixel alpha blits of ARGB8888 onto 32-bit surfaces against a reference blend, for every width, alignment and run of alpha the SIMD blitters special-case.
+ */
+int
+surface_testBlitBlendExact(void *arg)
+{
+   const Uint32 dstFormats[] = { SDL_PIXELFORMAT_ARGB8888, SDL_PIXELFORMAT_RGB888 };
+   const int w = 67, h = 9;
+   SDL_Surface *src, *dst, *ref;
+   SDL_Rect srcRect, dstRect;
+   int f, x, y, mismatches;
+
+   if (SDL_HasMMX() && !SDL_HasSSE41()) {
+      SDLTest_Log("MMX blitters round differently, skipping exactness checks");
+      return TEST_SKIPPED;
+   }
+
+   for (f = 0; f < SDL_arraysize(dstFormats); f++) {
+      src = SDL_CreateRGBSurfaceWithFormat(0, w, h, 32, SDL_PIXELFORMAT_ARGB8888);
+      dst = SDL_CreateRGBSurfaceWithFormat(0, w, h, 32, dstFormats[f]);
+      SDLTest_AssertCheck(src != NULL && dst != NULL, "Verify surfaces were created");
+      if (src == NULL || dst == NULL) {
+         return TEST_ABORTED;
+      }
+      SDL_SetSurfaceBlendMode(src, SDL_BLENDMODE_BLEND);
+
+      /* Random colors; alpha in runs of transparent, opaque and random */
+      for (y = 0; y < h; y++) {
+         Uint32 *s = (Uint32 *)((Uint8 *)src->pixels + y * src->pitch);
+         Uint32 *d = (Uint32 *)((Uint8 *)dst->pixels + y * dst->pitch);
+         for (x = 0; x < w; x++) {
+            Uint32 a;
+            switch ((x / 8 + y) % 4) {
+               case 0: a = 0; break;
+               case 1: a = 255; break;
+               case 2: a = SDLTest_RandomUint8(); break;
+               default: a = (x & 1) ? 255 : SDLTest_RandomUint8(); break;
+            }
+            s[x] = (SDLTest_RandomUint32() & 0x00ffffff) | (a << 24);
+            d[x] = SDLTest_RandomUint32();
+         }
+      }
+      ref = SDL_ConvertSurfaceFormat(dst, dstFormats[f], 0);
+      SDLTest_AssertCheck(ref != NULL, "Verify reference surface was created");
+      if (ref == NULL) {
+         return TEST_ABORTED;
+      }
+
+      /* Blit a different width and offset onto each row */
+      for (y = 0; y < h; y++) {
+         srcRect.x = y;
+         srcRect.y = y;
+         srcRect.w = w - 2 * y;
+         srcRect.h = 1;
+         dstRect.x = (y * 3) % 5;
+         dstRect.y = y;
+         SDL_BlitSurface(src, &srcRect, dst, &dstRect);
+         for (x = 0; x < srcRect.w; x++) {
+            Uint32 *s = (Uint32 *)((Uint8 *)src->pixels + y * src->pitch) + srcRect.x + x;
+            Uint32 *r = (Uint32 *)((Uint8 *)ref->pixels + y * ref->pitch) + dstRect.x + x;
+            if (dstRect.x + x < w) {
+               *r = _blendPixelReference(*s, *r);
+            }
+         }
+      }
+
+      mismatches = 0;
+      for (y = 0; y < h; y++) {
+         Uint32 *d = (Uint32 *)((Uint8 *)dst->pixels + y * dst->pitch);
+         Uint32 *r = (Uint32 *)((Uint8 *)ref->pixels + y * ref->pitch);
+         for (x = 0; x < w; x++) {
+            if (d[x] != r[x]) {
+               if (mismatches++ == 0) {
+                  SDLTest_LogError("First mismatch at %d,%d: got 0x%08x, expected 0x%08x", x, y, d[x], r[x]);
+               }
+            }
+         }
+      }
+      SDLTest_AssertCheck(mismatches == 0, "Verify blit onto %s matches the reference blend; mismatches: %d",
+                          SDL_GetPixelFormatName(dstFormats[f]), mismatches);
+
+      SDL_FreeSurface(ref);
+      SDL_FreeSurface(dst);
+      SDL_FreeSurface(src);
+   }
+
+   return TEST_COMPLETED;
+}
+
+/**
+ * @brief Tests filtered stretching: flat colors stay flat, same size is a
+ * copy, shrinking averages and enlarging interpolates.
+ *
+ * @sa http://wiki.libsdl.org/moin.cgi/SDL_SoftStretchLinear
+ */
+int
+surface_testSoftStretchLinear(void *arg)
+{
+   SDL_Surface *src, *dst;
+   SDL_Rect srcRect, dstRect;
+   Uint32 *p;
+   int x, y, ret, mismatches;
+
+   src = SDL_CreateRGBSurfaceWithFormat(0, 37, 23, 32, SDL_PIXELFORMAT_ARGB8888);
+   dst = SDL_CreateRGBSurfaceWithFormat(0, 101, 7, 16, SDL_PIXELFORMAT_RGB565);
+   SDLTest_AssertCheck(src != NULL && dst != NULL, "Verify surfaces were created");
+   if (src == NULL || dst == NULL) {
+      return TEST_ABORTED;
+   }
+
+   /* A flat color, converted to another format on the way */
+   SDL_FillRect(src, NULL, 0xff00ff00);
+   ret = SDL_SoftStretchLinear(src, NULL, dst, NULL);
+   SDLTest_AssertCheck(ret == 0, "Verify result from SDL_SoftStretchLinear, expected: 0, got: %i", ret);
+   mismatches = 0;
+   for (y = 0; y < dst->h; y++) {
+      const Uint16 *d = (const Uint16 *)((Uint8 *)dst->pixels + y * dst->pitch);
+      for (x = 0; x < dst->w; x++) {
+         mismatches += (d[x] != 0x07e0);
+      }
+   }
+   SDLTest_AssertCheck(mismatches == 0, "Verify flat color stays flat; mismatches: %d", mismatches);
+   SDL_FreeSurface(dst);
+
+   /* The same size is a plain copy */
+   dst = SDL_CreateRGBSurfaceWithFormat(0, 37, 23, 32, SDL_PIXELFORMAT_ARGB8888);
+   SDLTest_AssertCheck(dst != NULL, "Verify surface was created");
+   if (dst == NULL) {
+      SDL_FreeSurface(src);
+      return TEST_ABORTED;
+   }
+   for (y = 0; y < src->h; y++) {
+      p = (Uint32 *)((Uint8 *)src->pixels + y * src->pitch);
+      for (x = 0; x < src->w; x++) {
+         p[x] = SDLTest_RandomUint32();
+      }
+   }
+   ret = SDL_SoftStretchLinear(src, NULL, dst, NULL);
+   SDLTest_AssertCheck(ret == 0, "Verify result from SDL_SoftStretchLinear, expected: 0, got: %i", ret);
+   ret = SDL_memcmp(src->pixels, dst->pixels, src->h * src->pitch);
+   SDLTest_AssertCheck(ret == 0, "Verify same size stretch is a copy");
+   SDL_FreeSurface(dst);
+   SDL_FreeSurface(src);
+
+   /* 2x2 to 1x1 averages, 2x1 to 4x1 interpolates */
+   src = SDL_CreateRGBSurfaceWithFormat(0, 2, 2, 32, SDL_PIXELFORMAT_ARGB8888);
+   dst = SDL_CreateRGBSurfaceWithFormat(0, 4, 1, 32, SDL_PIXELFORMAT_ARGB8888);
+   if (src == NULL || dst == NULL) {
+      SDL_FreeSurface(src);
+      SDL_FreeSurface(dst);
+      return TEST_ABORTED;
+   }
+   p = (Uint32 *)src->pixels;
+   p[0] = 0x00000000;
+   p[1] = 0x04080c10;
+   p = (Uint32 *)((Uint8 *)src->pixels + src->pitch);
+   p[0] = 0x08101820;
+   p[1] = 0x0c182430;
+   dstRect.x = 0;
+   dstRect.y = 0;
+   dstRect.w = 1;
+   dstRect.h = 1;
+   ret = SDL_SoftStretchLinear(src, NULL, dst, &dstRect);
+   p = (Uint32 *)dst->pixels;
+   SDLTest_AssertCheck(ret == 0 && p[0] == 0x060c1218, "Verify shrinking averages, expected: 0x060c1218, got: 0x%08x", p[0]);
+
+   srcRect.x = 0;
+   srcRect.y = 0;
+   srcRect.w = 2;
+   srcRect.h = 1;
+   p = (Uint32 *)src->pixels;
+   p[0] = 0x00000000;
+   p[1] = 0x64646464;
+   ret = SDL_SoftStretchLinear(src, &srcRect, dst, NULL);
+   p = (Uint32 *)dst->pixels;
+   SDLTest_AssertCheck(ret == 0 && p[0] == 0x00000000 && p[1] == 0x19191919 &&
+                       p[2] == 0x4b4b4b4b && p[3] == 0x64646464,
+                       "Verify enlarging interpolates, got: 0x%08x 0x%08x 0x%08x 0x%08x",
+                       p[0], p[1], p[2], p[3]);
+
+   SDL_FreeSurface(dst);
+   SDL_FreeSurface(src);
+
+   return TEST_COMPLETED;
+}
+
+/**
+ * @brief Tests filtered RenderCopy on the software renderer into rects
+ * much bigger than the target: only the visible part is filtered, and it
+ * matches the same part of a full stretch.
+ *
+ * @sa http://wiki.libsdl.org/moin.cgi/SDL_RenderCopy
+ */
+int
+surface_testRenderCopyLinearClipped(void *arg)
+{
+   const char *hint = SDL_GetHint(SDL_HINT_RENDER_SCALE_QUALITY);
+   char *oldHint = hint ? SDL_strdup(hint) : NULL;
+   SDL_Surface *src, *target, *full;
+   SDL_Renderer *renderer;
+   SDL_Texture *texture;
+   SDL_Rect dstRect, part;
+   Uint32 *p;
+   int x, y, ret, mismatches;
+
+   src = SDL_CreateRGBSurfaceWithFormat(0, 64, 64, 32, SDL_PIXELFORMAT_ARGB8888);
+   target = SDL_CreateRGBSurfaceWithFormat(0, 640, 480, 32, SDL_PIXELFORMAT_ARGB8888);
+   full = SDL_CreateRGBSurfaceWithFormat(0, 1000, 800, 32, SDL_PIXELFORMAT_ARGB8888);
+   SDLTest_AssertCheck(src != NULL && target != NULL && full != NULL, "Verify surfaces were created");
+   if (src == NULL || target == NULL || full == NULL) {
+      SDL_FreeSurface(src);
+      SDL_FreeSurface(target);
+      SDL_FreeSurface(full);
+      SDL_free(oldHint);
+      return TEST_ABORTED;
+   }
+   for (y = 0; y < src->h; y++) {
+      p = (Uint32 *)((Uint8 *)src->pixels + y * src->pitch);
+      for (x = 0; x < src->w; x++) {
+         p[x] = SDLTest_RandomUint32() | 0xff000000;
+      }
+   }
+
+   SDL_SetHint(SDL_HINT_RENDER_SCALE_QUALITY, "linear");
+   renderer = SDL_CreateSoftwareRenderer(target);
+   SDLTest_AssertCheck(renderer != NULL, "Verify SDL_CreateSoftwareRenderer result");
+   texture = renderer ? SDL_CreateTextureFromSurface(renderer, src) : NULL;
+   SDLTest_AssertCheck(texture != NULL, "Verify SDL_CreateTextureFromSurface result");
+   if (texture == NULL) {
+      goto done;
+   }
+   SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_NONE);
+
+   /* A rect hanging off every side of the target, against a full stretch */
+   dstRect.x = -203;
+   dstRect.y = -151;
+   dstRect.w = full->w;
+   dstRect.h = full->h;
+   ret = SDL_RenderCopy(renderer, texture, NULL, &dstRect);
+   SDLTest_AssertCheck(ret == 0, "Verify result from SDL_RenderCopy, expected: 0, got: %i", ret);
+   ret = SDL_SoftStretchLinear(src, NULL, full, NULL);
+   SDLTest_AssertCheck(ret == 0, "Verify result from SDL_SoftStretchLinear, expected: 0, got: %i", ret);
+   mismatches = 0;
+   for (y = 0; y < target->h; y++) {
+      const Uint32 *t = (const Uint32 *)((Uint8 *)target->pixels + y * target->pitch);
+      const Uint32 *f = (const Uint32 *)((Uint8 *)full->pixels + (y - dstRect.y) * full->pitch);
+      for (x = 0; x < target->w; x++) {
+         mismatches += (t[x] != f[x - dstRect.x]);
+      }
+   }
+   SDLTest_AssertCheck(mismatches == 0, "Verify visible part matches the full stretch; mismatches: %d", mismatches);
+
+   /* Far too big to filter whole, and a part of it inside a clip rect */
+   dstRect.x = -20000;
+   dstRect.y = -20000;
+   dstRect.w = 40000;
+   dstRect.h = 40000;
+   ret = SDL_RenderCopy(renderer, texture, NULL, &dstRect);
+   SDLTest_AssertCheck(ret == 0, "Verify result from SDL_RenderCopy into a 40000x40000 rect, expected: 0, got: %i", ret);
+   part.x = 100;
+   part.y = 100;
+   part.w = 10;
+   part.h = 10;
+   SDL_RenderSetClipRect(renderer, &part);
+   dstRect.w = 24000;
+   dstRect.h = 24000;
+   ret = SDL_RenderCopy(renderer, texture, NULL, &dstRect);
+   SDLTest_AssertCheck(ret == 0, "Verify result from clipped SDL_RenderCopy into a 24000x24000 rect, expected: 0, got: %i", ret);
+   dstRect.x = 1000;
+   ret = SDL_RenderCopy(renderer, texture, NULL, &dstRect);
+   SDLTest_AssertCheck(ret == 0, "Verify result from SDL_RenderCopy outside the clip rect, expected: 0, got: %i", ret);
+
+done:
+   if (texture != NULL) {
+      SDL_DestroyTexture(texture);
+   }
+   if (renderer != NULL) {
+      SDL_DestroyRenderer(renderer);
+   }
+   /* SDL_SetHint() can't unset a hint, so put back the default instead */
+   SDL_SetHint(SDL_HINT_RENDER_SCALE_QUALITY, oldHint ? oldHint : "nearest");
+   SDL_free(oldHint);
+   SDL_FreeSurface(full);
+   SDL_FreeSurface(target);
+   SDL_FreeSurface(src);
+
+   return TEST_COMPLETED;
+}
+
+/**
+ * @brief Tests that SDL_FillRects() with overlapping and clipped rects
+ * fills the same pixels as filling each rect on its own.
+ *
+ * @sa http://wiki.libsdl.org/moin.cgi/SDL_FillRects
+ */
+int
+surface_testFillRects(void *arg)
+{
+   const Uint32 formats[] = { SDL_PIXELFORMAT_RGB332, SDL_PIXELFORMAT_RGB565, SDL_PIXELFORMAT_RGB24, SDL_PIXELFORMAT_ARGB8888 };
+   const int w = 301, h = 97;
+   SDL_Rect rects[16];
+   SDL_Surface *merged, *single;
+   int f, i, y, ret, mismatches;
+
+   for (f = 0; f < SDL_arraysize(formats); f++) {
+      merged = SDL_CreateRGBSurfaceWithFormat(0, w, h, 0, formats[f]);
+      single = SDL_CreateRGBSurfaceWithFormat(0, w, h, 0, formats[f]);
+      SDLTest_AssertCheck(merged != NULL && single != NULL, "Verify surfaces were created");
+      if (merged == NULL || single == NULL) {
+         return TEST_ABORTED;
+      }
+
+      for (i = 0; i < SDL_arraysize(rects); i++) {
+         rects[i].x = SDLTest_RandomIntegerInRange(-20, w);
+         rects[i].y = SDLTest_RandomIntegerInRange(-20, h);
+         rects[i].w = SDLTest_RandomIntegerInRange(0, w / 2);
+         rects[i].h = SDLTest_RandomIntegerInRange(0, h / 2);
+      }
+
+      ret = SDL_FillRects(merged, rects, SDL_arraysize(rects), 0x5a5a5a5a);
+      SDLTest_AssertCheck(ret == 0, "Verify result from SDL_FillRects, expected: 0, got: %i", ret);
+      for (i = 0; i < SDL_arraysize(rects); i++) {
+         SDL_FillRect(single, &rects[i], 0x5a5a5a5a);
+      }
+
+      mismatches = 0;
+      for (y = 0; y < h; y++) {
+         if (SDL_memcmp((Uint8 *)merged->pixels + y * merged->pitch,
+                        (Uint8 *)single->pixels + y * single->pitch,
+                        w * merged->format->BytesPerPixel) != 0) {
+            mismatches++;
+         }
+      }
+      SDLTest_AssertCheck(mismatches == 0, "Verify SDL_FillRects on %s matches SDL_FillRect; rows that differ: %d",
+                          SDL_GetPixelFormatName(formats[f]), mismatches);
+
+      SDL_FreeSurface(single);
+      SDL_FreeSurface(merged);
+   }
+
+   return TEST_COMPLETED;
+}
+
+/**
+ * @brief Tests plain copy blits at every row alignment, including one big
+ * enough to use non-temporal stores.
+ *
+ * @sa http://wiki.libsdl.org/moin.cgi/SDL_BlitSurface
+ */
+int
+surface_testBlitCopy(void *arg)
+{
+   const struct { int w, h; } sizes[] = { { 3, 5 }, { 67, 33 }, { 1031, 7 }, { 1500, 1000 } };
+   SDL_Surface *src, *dst;
+   SDL_Rect dstrect;
+   int i, x, y, ret, mismatches;
+
+   for (i = 0; i < SDL_arraysize(sizes); i++) {
+      src = SDL_CreateRGBSurfaceWithFormat(0, sizes[i].w, sizes[i].h, 0, SDL_PIXELFORMAT_RGB24);
+      dst = SDL_CreateRGBSurfaceWithFormat(0, sizes[i].w + 5, sizes[i].h, 0, SDL_PIXELFORMAT_RGB24);
+      SDLTest_AssertCheck(src != NULL && dst != NULL, "Verify surfaces were created");
+      if (src == NULL || dst == NULL) {
+         return TEST_ABORTED;
+      }
+      for (y = 0; y < src->h; y++) {
+         Uint8 *row = (Uint8 *)src->pixels + y * src->pitch;
+         for (x = 0; x < src->w * 3; x++) {
+            row[x] = (Uint8)(x * 7 + y * 13);
+         }
+      }
+
+      for (x = 0; x < 5; x++) {
+         SDL_memset(dst->pixels, 0, dst->h * dst->pitch);
+         dstrect.x = x;
+         dstrect.y = 0;
+         dstrect.w = src->w;
+         dstrect.h = src->h;
+         ret = SDL_BlitSurface(src, NULL, dst, &dstrect);
+         SDLTest_AssertCheck(ret == 0, "Verify result from SDL_BlitSurface, expected: 0, got: %i", ret);
+
+         mismatches = 0;
+         for (y = 0; y < src->h; y++) {
+            const Uint8 *row = (const Uint8 *)dst->pixels + y * dst->pitch;
+            if (SDL_memcmp(row + x * 3, (const Uint8 *)src->pixels + y * src->pitch, src->w * 3) != 0) {
+               mismatches++;
+            }
+         }
+         SDLTest_AssertCheck(mismatches == 0, "Verify %dx%d copy to x=%d; rows that differ: %d",
+                             src->w, src->h, x, mismatches);
+      }
+
+      SDL_FreeSurface(dst);
+      SDL_FreeSurface(src);
+   }
+
+   return TEST_COMPLETED;
+}
+
+/* Reads a 16, 24 or 32 bit pixel the way SDL stores it */
+static Uint32
+_readPixel(const Uint8 *p, int bpp)
+{
+   if (bpp == 4) {
+      return *(const Uint32 *)p;
+   } else if (bpp == 2) {
+      return *(const Uint16 *)p;
+   }
+#if SDL_BYTEORDER == SDL_LIL_ENDIAN
+   return p[0] | (p[1] << 8) | (p[2] << 16);
+#else
+   return (p[0] << 16) | (p[1] << 8) | p[2];
+#endif
+}
+
+/**
+ * @brief Tests SDL_ConvertPixels between the 24 and 32 bit byte-per-channel
+ * formats against converting each pixel with SDL_GetRGBA and SDL_MapRGBA.
+ *
+ * @sa http://wiki.libsdl.org/moin.cgi/SDL_ConvertPixels
+ */
+int
+surface_testConvertPixelsSwizzle(void *arg)
+{
+   const Uint32 formats[] = {
+      SDL_PIXELFORMAT_ARGB8888, SDL_PIXELFORMAT_ABGR8888, SDL_PIXELFORMAT_RGBA8888,
+      SDL_PIXELFORMAT_BGRA8888, SDL_PIXELFORMAT_RGB888, SDL_PIXELFORMAT_BGRX8888,
+      SDL_PIXELFORMAT_RGB24, SDL_PIXELFORMAT_BGR24
+   };
+   const int w = 37, h = 3;
+   Uint8 src[37 * 4 * 3], dst[37 * 4 * 3];
+   SDL_PixelFormat *srcfmt, *dstfmt;
+   int s, d, i, x, y, ret, mismatches;
+
+   for (i = 0; i < sizeof(src); i++) {
+      src[i] = (Uint8)SDLTest_RandomUint8();
+   }
+
+   for (s = 0; s < SDL_arraysize(formats); s++) {
+      for (d = 0; d < SDL_arraysize(formats); d++) {
+         const int srcbpp = SDL_BYTESPERPIXEL(formats[s]);
+         const int dstbpp = SDL_BYTESPERPIXEL(formats[d]);
+         if (s == d) {
+            continue;
+         }
+         srcfmt = SDL_AllocFormat(formats[s]);
+         dstfmt = SDL_AllocFormat(formats[d]);
+         SDLTest_AssertCheck(srcfmt != NULL && dstfmt != NULL, "Verify formats were allocated");
+         if (srcfmt == NULL || dstfmt == NULL) {
+            return TEST_ABORTED;
+         }
+
+         ret = SDL_ConvertPixels(w, h, formats[s], src, w * srcbpp, formats[d], dst, w * dstbpp);
+         SDLTest_AssertCheck(ret == 0, "Verify result from SDL_ConvertPixels, expected: 0, got: %i", ret);
+
+         mismatches = 0;
+         for (y = 0; y < h; y++) {
+            for (x = 0; x < w; x++) {
+               Uint8 r, g, b, a;
+               Uint32 expected, actual;
+               SDL_GetRGBA(_readPixel(&src[(y * w + x) * srcbpp], srcbpp), srcfmt, &r, &g, &b, &a);
+               expected = SDL_MapRGBA(dstfmt, r, g, b, a);
+               actual = _readPixel(&dst[(y * w + x) * dstbpp], dstbpp);
+               if (!dstfmt->Amask && dstbpp == 4) {
+                  /* the unused byte is zeroed */
+                  expected &= (dstfmt->Rmask | dstfmt->Gmask | dstfmt->Bmask);
+               }
+               if (actual != expected) {
+                  mismatches++;
+               }
+            }
+         }
+         SDLTest_AssertCheck(mismatches == 0, "Verify %s to %s; pixels that differ: %d",
+                             SDL_GetPixelFormatName(formats[s]), SDL_GetPixelFormatName(formats[d]), mismatches);
+
+         SDL_FreeFormat(dstfmt);
+         SDL_FreeFormat(srcfmt);
+      }
+   }
+
+   return TEST_COMPLETED;
+}
+
+/**
+ * @brief Tests colorkey blits, with and without surface alpha, against
+ * working out each destination pixel with SDL_GetRGBA and SDL_MapRGBA.
+ *
+ * @sa http://wiki.libsdl.org/moin.cgi/SDL_SetColorKey
+ */
+int
+surface_testBlitColorKey(void *arg)
+{
+   const struct {
+      Uint32 src, dst;
+      int alpha;
+   } blits[] = {
+      { SDL_PIXELFORMAT_RGB565, SDL_PIXELFORMAT_RGB565, -1 },
+      { SDL_PIXELFORMAT_ARGB1555, SDL_PIXELFORMAT_ARGB1555, -1 },
+      { SDL_PIXELFORMAT_RGB888, SDL_PIXELFORMAT_RGB888, -1 },
+      { SDL_PIXELFORMAT_ARGB8888, SDL_PIXELFORMAT_ARGB8888, -1 },
+      { SDL_PIXELFORMAT_ARGB8888, SDL_PIXELFORMAT_ABGR8888, -1 },
+      { SDL_PIXELFORMAT_RGB888, SDL_PIXELFORMAT_RGBA8888, -1 },
+      { SDL_PIXELFORMAT_RGB888, SDL_PIXELFORMAT_RGB888, 128 },
+      { SDL_PIXELFORMAT_RGB888, SDL_PIXELFORMAT_ARGB8888, 77 },
+      { SDL_PIXELFORMAT_BGR888, SDL_PIXELFORMAT_ABGR8888, 255 }
+   };
+   const int w = 37, h = 3;
+   SDL_Surface *src, *dst, *old;
+   int i, x, y, ret, mismatches;
+
+   for (i = 0; i < SDL_arraysize(blits); i++) {
+      int srcbpp, dstbpp;
+      Uint32 key, rgbmask;
+
+      src = SDL_CreateRGBSurfaceWithFormat(0, w, h, 0, blits[i].src);
+      dst = SDL_CreateRGBSurfaceWithFormat(0, w, h, 0, blits[i].dst);
+      old = SDL_CreateRGBSurfaceWithFormat(0, w, h, 0, blits[i].dst);
+      SDLTest_AssertCheck(src != NULL && dst != NULL && old != NULL, "Verify surfaces are not NULL");
+      if (src == NULL || dst == NULL || old == NULL) {
+         return TEST_ABORTED;
+      }
+      srcbpp = src->format->BytesPerPixel;
+      dstbpp = dst->format->BytesPerPixel;
+
+      /* Random pixels, with a run of keyed pixels and some scattered ones */
+      for (y = 0; y < h; y++) {
+         for (x = 0; x < src->pitch; x++) {
+            ((Uint8 *)src->pixels)[y * src->pitch + x] = (Uint8)SDLTest_RandomUint8();
+         }
+         for (x = 0; x < dst->pitch; x++) {
+            ((Uint8 *)dst->pixels)[y * dst->pitch + x] = (Uint8)SDLTest_RandomUint8();
+         }
+      }
+      key = _readPixel((const Uint8 *)src->pixels, srcbpp);
+      for (y = 0; y < h; y++) {
+         for (x = 0; x < w; x++) {
+            if ((y == 1 && x >= 4 && x < 24) || (x * 7 + y) % 5 == 0) {
+               SDL_memcpy((Uint8 *)src->pixels + y * src->pitch + x * srcbpp, src->pixels, srcbpp);
+            }
+         }
+      }
+      SDL_memcpy(old->pixels, dst->pixels, dst->pitch * h);
+
+      ret = SDL_SetColorKey(src, SDL_TRUE, key);
+      SDLTest_AssertCheck(ret == 0, "Verify result from SDL_SetColorKey, expected: 0, got: %i", ret);
+      if (blits[i].alpha < 0) {
+         ret = SDL_SetSurfaceBlendMode(src, SDL_BLENDMODE_NONE);
+      } else {
+         ret = SDL_SetSurfaceBlendMode(src, SDL_BLENDMODE_BLEND);
+         ret |= SDL_SetSurfaceAlphaMod(src, (Uint8)blits[i].alpha);
+      }
+      SDLTest_AssertCheck(ret == 0, "Verify result from setting the blend, expected: 0, got: %i", ret);
+
+      ret = SDL_BlitSurface(src, NULL, dst, NULL);
+      SDLTest_AssertCheck(ret == 0, "Verify result from SDL_BlitSurface, expected: 0, got: %i", ret);
+
+      rgbmask = ~src->format->Amask;
+      mismatches = 0;
+      for (y = 0; y < h; y++) {
+         for (x = 0; x < w; x++) {
+            const Uint32 s = _readPixel((const Uint8 *)src->pixels + y * src->pitch + x * srcbpp, srcbpp);
+            const Uint32 d = _readPixel((const Uint8 *)old->pixels + y * old->pitch + x * dstbpp, dstbpp);
+            const Uint32 actual = _readPixel((const Uint8 *)dst->pixels + y * dst->pitch + x * dstbpp, dstbpp);
+            Uint32 expected = d;
+            if ((s & rgbmask) != (key & rgbmask)) {
+               Uint8 sR, sG, sB, sA, dR, dG, dB, dA;
+               SDL_GetRGBA(s, src->format, &sR, &sG, &sB, &sA);
+               if (blits[i].alpha >= 0) {
+                  const int A = blits[i].alpha;
+                  SDL_GetRGBA(d, dst->format, &dR, &dG, &dB, &dA);
+                  sR = (Uint8)((((int)sR - dR) * A) / 255 + dR);
+                  sG = (Uint8)((((int)sG - dG) * A) / 255 + dG);
+                  sB = (Uint8)((((int)sB - dB) * A) / 255 + dB);
+                  sA = (Uint8)(A + dA - (A * dA) / 255);
+               }
+               expected = SDL_MapRGBA(dst->format, sR, sG, sB, sA);
+               if (!dst->format->Amask && dstbpp == 4) {
+                  /* the unused byte is zeroed */
+                  expected &= (dst->format->Rmask | dst->format->Gmask | dst->format->Bmask);
+               }
+            }
+            if (actual != expected) {
+               mismatches++;
+            }
+         }
+      }
+      SDLTest_AssertCheck(mismatches == 0, "Verify %s to %s with alpha %d; pixels that differ: %d",
+                          SDL_GetPixelFormatName(blits[i].src), SDL_GetPixelFormatName(blits[i].dst),
+                          blits[i].alpha, mismatches);
+
+      SDL_FreeSurface(old);
+      SDL_FreeSurface(dst);
+      SDL_FreeSurface(src);
+   }
+
+   return TEST_COMPLETED;
+}
+
+/**
+ * @brief Tests that blits from and to paletted surfaces keep up with alpha
+ * mod and palette changes, including going back to earlier settings.
+ *
+ * @sa http://wiki.libsdl.org/moin.cgi/SDL_SetSurfaceAlphaMod
+ * @sa http://wiki.libsdl.org/moin.cgi/SDL_SetPaletteColors
+ */
+int
+surface_testBlitPaletteChanges(void *arg)
+{
+   const Uint8 mods[] = { 255, 128, 255, 17, 128 };
+   const int w = 16, h = 16;
+   SDL_Surface *indexed, *rgb, *target;
+   SDL_Color colors[256];
+   int i, m, x, ret, mismatches;
+
+   indexed = SDL_CreateRGBSurfaceWithFormat(0, w, h, 8, SDL_PIXELFORMAT_INDEX8);
+   rgb = SDL_CreateRGBSurfaceWithFormat(0, w, h, 32, SDL_PIXELFORMAT_ARGB8888);
+   target = SDL_CreateRGBSurfaceWithFormat(0, w, h, 8, SDL_PIXELFORMAT_INDEX8);
+   SDLTest_AssertCheck(indexed != NULL && rgb != NULL && target != NULL, "Verify surfaces are not NULL");
+   if (indexed == NULL || rgb == NULL || target == NULL) {
+      return TEST_ABORTED;
+   }
+   for (i = 0; i < w * h; i++) {
+      ((Uint8 *)indexed->pixels)[(i / w) * indexed->pitch + (i % w)] = (Uint8)i;
+   }
+
+   /* Palette to RGB, changing the alpha mod and then the palette */
+   for (m = 0; m < 2 * SDL_arraysize(mods); m++) {
+      const int A = mods[m % SDL_arraysize(mods)];
+      if (m % SDL_arraysize(mods) == 0) {
+         for (i = 0; i < 256; i++) {
+            colors[i].r = (Uint8)SDLTest_RandomUint8();
+            colors[i].g = (Uint8)SDLTest_RandomUint8();
+            colors[i].b = (Uint8)SDLTest_RandomUint8();
+            colors[i].a = 0xFF;
+         }
+         ret = SDL_SetPaletteColors(indexed->format->palette, colors, 0, 256);
+         SDLTest_AssertCheck(ret == 0, "Verify result from SDL_SetPaletteColors, expected: 0, got: %i", ret);
+      }
+      /* Opaque blits go through the color table, the others blend */
+      ret = SDL_SetSurfaceBlendMode(indexed, (A == 255) ? SDL_BLENDMODE_NONE : SDL_BLENDMODE_BLEND);
+      ret |= SDL_SetSurfaceAlphaMod(indexed, (Uint8)A);
+      SDLTest_AssertCheck(ret == 0, "Verify result from setting the blend, expected: 0, got: %i", ret);
+      SDL_memset(rgb->pixels, 0x40, rgb->pitch * h);
+      ret = SDL_BlitSurface(indexed, NULL, rgb, NULL);
+      SDLTest_AssertCheck(ret == 0, "Verify result from SDL_BlitSurface, expected: 0, got: %i", ret);
+
+      mismatches = 0;
+      for (i = 0; i < w * h; i++) {
+         const Uint32 actual = *(const Uint32 *)((const Uint8 *)rgb->pixels + (i / w) * rgb->pitch + (i % w) * 4);
+         const Uint32 expected = SDL_MapRGBA(rgb->format,
+                                             (Uint8)((((int)colors[i].r - 0x40) * A) / 255 + 0x40),
+                                             (Uint8)((((int)colors[i].g - 0x40) * A) / 255 + 0x40),
+                                             (Uint8)((((int)colors[i].b - 0x40) * A) / 255 + 0x40),
+                                             (Uint8)(A + 0x40 - (A * 0x40) / 255));
+         if (actual != expected) {
+            mismatches++;
+         }
+      }
+      SDLTest_AssertCheck(mismatches == 0, "Verify blit with alpha mod %d; pixels that differ: %d", A, mismatches);
+   }
+
+   /* RGB and palette to palette, changing the destination palette. RGB
+      goes through a 3-3-2 palette, so the destination gets those colors,
+      shuffled differently each time. */
+   SDL_SetSurfaceBlendMode(indexed, SDL_BLENDMODE_NONE);
+   SDL_SetSurfaceAlphaMod(indexed, 255);
+   SDL_SetSurfaceBlendMode(rgb, SDL_BLENDMODE_NONE);
+   for (m = 0; m < 3; m++) {
+      Uint8 index332[256];
+      for (i = 0; i < 256; i++) {
+         const int c = (i * (m * 2 + 3) + m * 41) & 0xFF;
+         int r = c & 0xe0, g = (c << 3) & 0xe0, b = c & 0x3;
+         colors[i].r = (Uint8)(r | (r >> 3) | (r >> 6));
+         colors[i].g = (Uint8)(g | (g >> 3) | (g >> 6));
+         b |= b << 2;
+         colors[i].b = (Uint8)(b | (b << 4));
+         colors[i].a = 0xFF;
+         index332[c] = (Uint8)i;
+      }
+      ret = SDL_SetPaletteColors(target->format->palette, colors, 0, 256);
+      SDLTest_AssertCheck(ret == 0, "Verify result from SDL_SetPaletteColors, expected: 0, got: %i", ret);
+
+      ret = SDL_BlitSurface(indexed, NULL, target, NULL);
+      SDLTest_AssertCheck(ret == 0, "Verify result from SDL_BlitSurface, expected: 0, got: %i", ret);
+      mismatches = 0;
+      for (i = 0; i < w * h; i++) {
+         const SDL_Color *c = &indexed->format->palette->colors[i];
+         const Uint8 actual = ((const Uint8 *)target->pixels)[(i / w) * target->pitch + (i % w)];
+         if (actual != SDL_MapRGB(target->format, c->r, c->g, c->b)) {
+            mismatches++;
+         }
+      }
+      SDLTest_AssertCheck(mismatches == 0, "Verify palette to palette blit %d; pixels that differ: %d", m, mismatches);
+
+      ret = SDL_BlitSurface(rgb, NULL, target, NULL);
+      SDLTest_AssertCheck(ret == 0, "Verify result from SDL_BlitSurface, expected: 0, got: %i", ret);
+      mismatches = 0;
+      for (i = 0; i < w * h; i++) {
+         const Uint8 actual = ((const Uint8 *)target->pixels)[(i / w) * target->pitch + (i % w)];
+         Uint8 r, g, b;
+         SDL_GetRGB(*(const Uint32 *)((const Uint8 *)rgb->pixels + (i / w) * rgb->pitch + (i % w) * 4), rgb->format, &r, &g, &b);
+         x = (r & 0xe0) | ((g >> 3) & 0x1c) | (b >> 6);
+         if (actual != index332[x]) {
+            mismatches++;
+         }
+      }
+      SDLTest_AssertCheck(mismatches == 0, "Verify RGB to palette blit %d; pixels that differ: %d", m, mismatches);
+   }
+
+   SDL_FreeSurface(target);
+   SDL_FreeSurface(rgb);
+   SDL_FreeSurface(indexed);
+
+   return TEST_COMPLETED;
+}
+
+/**
+ * @brief Tests that big blits split over several threads match the same
+ * blits done on one thread.
+ *
+ * @sa http://wiki.libsdl.org/moin.cgi/SDL_BlitSurface
+ * @sa http://wiki.libsdl.org/moin.cgi/SDL_BlitScaled
+ */
+int
+surface_testBlitThreads(void *arg)
+{
+   const struct {
+      Uint32 dst;
+      int w, h;
+      SDL_bool scaled;
+   } blits[] = {
+      { SDL_PIXELFORMAT_ARGB8888, 1021, 773, SDL_FALSE },
+      { SDL_PIXELFORMAT_RGB565, 1021, 773, SDL_FALSE },
+      { SDL_PIXELFORMAT_ARGB8888, 1500, 1103, SDL_TRUE },
+      { SDL_PIXELFORMAT_ABGR8888, 1500, 1103, SDL_TRUE },
+      { SDL_PIXELFORMAT_RGB565, 901, 677, SDL_TRUE }
+   };
+   const char *threads[] = { "4", "7" };
+   const char *hint = SDL_GetHint(SDL_HINT_BLIT_THREADS);
+   char *oldHint = hint ? SDL_strdup(hint) : NULL;
+   SDL_Surface *src, *single, *banded;
+   int i, t, x, y, ret;
+
+   src = SDL_CreateRGBSurfaceWithFormat(0, 1021, 773, 32, SDL_PIXELFORMAT_ARGB8888);
+   SDLTest_AssertCheck(src != NULL, "Verify source surface is not NULL");
+   if (src == NULL) {
+      SDL_free(oldHint);
+      return TEST_ABORTED;
+   }
+   for (y = 0; y < src->h; y++) {
+      for (x = 0; x < src->pitch; x++) {
+         ((Uint8 *)src->pixels)[y * src->pitch + x] = (Uint8)SDLTest_RandomUint8();
+      }
+   }
+   SDL_SetSurfaceBlendMode(src, SDL_BLENDMODE_NONE);
+
+   for (i = 0; i < SDL_arraysize(blits); i++) {
+      single = SDL_CreateRGBSurfaceWithFormat(0, blits[i].w, blits[i].h, 0, blits[i].dst);
+      banded = SDL_CreateRGBSurfaceWithFormat(0, blits[i].w, blits[i].h, 0, blits[i].dst);
+      SDLTest_AssertCheck(single != NULL && banded != NULL, "Verify destination surfaces are not NULL");
+      if (single == NULL || banded == NULL) {
+         SDL_FreeSurface(single);
+         SDL_FreeSurface(banded);
+         break;
+      }
+
+      SDL_SetHint(SDL_HINT_BLIT_THREADS, "1");
+      ret = blits[i].scaled ? SDL_BlitScaled(src, NULL, single, NULL) : SDL_BlitSurface(src, NULL, single, NULL);
+      SDLTest_AssertCheck(ret == 0, "Verify result from blitting on one thread, expected: 0, got: %i", ret);
+
+      for (t = 0; t < SDL_arraysize(threads); t++) {
+         SDL_memset(banded->pixels, 0, banded->pitch * banded->h);
+         SDL_SetHint(SDL_HINT_BLIT_THREADS, threads[t]);
+         ret = blits[i].scaled ? SDL_BlitScaled(src, NULL, banded, NULL) : SDL_BlitSurface(src, NULL, banded, NULL);
+         SDLTest_AssertCheck(ret == 0, "Verify result from blitting on %s threads, expected: 0, got: %i", threads[t], ret);
+         ret = SDLTest_CompareSurfaces(banded, single, 0);
+         SDLTest_AssertCheck(ret == 0, "Verify %s %dx%d %s on %s threads matches one thread, expected: 0, got: %i",
+                             blits[i].scaled ? "scaled blit to" : "blit to",
+                             blits[i].w, blits[i].h, SDL_GetPixelFormatName(blits[i].dst), threads[t], ret);
+      }
+
+      SDL_FreeSurface(banded);
+      SDL_FreeSurface(single);
+   }
+
+   /* An empty hint gets back the default of one thread per CPU core */
+   SDL_SetHint(SDL_HINT_BLIT_THREADS, oldHint ? oldHint : "");
+   SDL_free(oldHint);
+   SDL_FreeSurface(src);
+
+   return TEST_COMPLETED;
+}
+
 /* ================= Test References ================== */
 
 /* Surface test cases */
@@ -630,11 +1445,39 @@ static const SDLTest_TestCaseReference surfaceTest11 =
 static const SDLTest_TestCaseReference surfaceTest12 =
         { (SDLTest_TestCaseFp)surface_testBlitBlendMod, "surface_testBlitBlendMod", "Tests blitting routines with mod blending mode.", TEST_ENABLED};
 
+static const SDLTest_TestCaseReference surfaceTest13 =
+        { (SDLTest_TestCaseFp)surface_testBlitBlendExact, "surface_testBlitBlendExact", "Tests per-pixel alpha blits against a reference blend.", TEST_ENABLED};
+
+static const SDLTest_TestCaseReference surfaceTest14 =
+        { (SDLTest_TestCaseFp)surface_testSoftStretchLinear, "surface_testSoftStretchLinear", "Tests filtered stretching with SDL_SoftStretchLinear.", TEST_ENABLED};
+
+static const SDLTest_TestCaseReference surfaceTest15 =
+        { (SDLTest_TestCaseFp)surface_testFillRects, "surface_testFillRects", "Tests that SDL_FillRects matches filling each rect.", TEST_ENABLED};
+
+static const SDLTest_TestCaseReference surfaceTest16 =
+        { (SDLTest_TestCaseFp)surface_testBlitCopy, "surface_testBlitCopy", "Tests copy blits at every row alignment.", TEST_ENABLED};
+
+static const SDLTest_TestCaseReference surfaceTest17 =
+        { (SDLTest_TestCaseFp)surface_testConvertPixelsSwizzle, "surface_testConvertPixelsSwizzle", "Tests SDL_ConvertPixels between 24 and 32 bit RGB formats.", TEST_ENABLED};
+
+static const SDLTest_TestCaseReference surfaceTest18 =
+        { (SDLTest_TestCaseFp)surface_testBlitColorKey, "surface_testBlitColorKey", "Tests colorkey blits with and without surface alpha.", TEST_ENABLED};
+
+static const SDLTest_TestCaseReference surfaceTest19 =
+        { (SDLTest_TestCaseFp)surface_testBlitPaletteChanges, "surface_testBlitPaletteChanges", "Tests paletted blits after alpha mod and palette changes.", TEST_ENABLED};
+
+static const SDLTest_TestCaseReference surfaceTest20 =
+        { (SDLTest_TestCaseFp)surface_testRenderCopyLinearClipped, "surface_testRenderCopyLinearClipped", "Tests filtered software RenderCopy into rects bigger than the target.", TEST_ENABLED};
+
+static const SDLTest_TestCaseReference surfaceTest21 =
+        { (SDLTest_TestCaseFp)surface_testBlitThreads, "surface_testBlitThreads", "Tests big blits on several threads against one thread.", TEST_ENABLED};
+
 /* Sequence of Surface test cases */
 static const SDLTest_TestCaseReference *surfaceTests[] =  {
     &surfaceTest1, &surfaceTest2, &surfaceTest3, &surfaceTest4, &surfaceTest5,
     &surfaceTest6, &surfaceTest7, &surfaceTest8, &surfaceTest9, &surfaceTest10,
-    &surfaceTest11, &surfaceTest12, NULL
+    &surfaceTest11, &surfaceTest12, &surfaceTest13, &surfaceTest14, &surfaceTest15, &surfaceTest16, &surfaceTest17,
+    &surfaceTest18, &surfaceTest19, &surfaceTest20, &surfaceTest21, NULL
 };
 
 /* Surface test suite (global) */
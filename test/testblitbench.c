@@ -0,0 +1,216 @@
+/*
+  Copyright (C) 1997-2017 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely.
+*/
+
+/* Program to time big software blits with 1 through N threads (see
+   SDL_HINT_BLIT_THREADS). Results go to stdout as CSV, one line per blit
+   and thread count, along with the speedup over one thread and whether
+   the result matched the single threaded blit byte for byte:
+
+     testblitbench --threads 8 --size 3840x2160 > blit.csv */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "SDL.h"
+
+static const struct
+{
+    const char *name;
+    Uint32 src_format;
+    Uint32 dst_format;
+    SDL_BlendMode blend;
+    int scale;          /* source is scale/3 of the destination size */
+} blits[] = {
+    { "copy", SDL_PIXELFORMAT_ARGB8888, SDL_PIXELFORMAT_ARGB8888, SDL_BLENDMODE_NONE, 3 },
+    { "convert", SDL_PIXELFORMAT_ARGB8888, SDL_PIXELFORMAT_RGB565, SDL_BLENDMODE_NONE, 3 },
+    { "convert24", SDL_PIXELFORMAT_RGB24, SDL_PIXELFORMAT_ABGR8888, SDL_BLENDMODE_NONE, 3 },
+    { "blend", SDL_PIXELFORMAT_ARGB8888, SDL_PIXELFORMAT_RGB888, SDL_BLENDMODE_BLEND, 3 },
+    { "stretch", SDL_PIXELFORMAT_ARGB8888, SDL_PIXELFORMAT_ARGB8888, SDL_BLENDMODE_NONE, 2 },
+    { "scaled", SDL_PIXELFORMAT_ARGB8888, SDL_PIXELFORMAT_ABGR8888, SDL_BLENDMODE_NONE, 2 },
+    { "shrink", SDL_PIXELFORMAT_ARGB8888, SDL_PIXELFORMAT_ABGR8888, SDL_BLENDMODE_NONE, 4 },
+    { "scaledblend", SDL_PIXELFORMAT_ARGB8888, SDL_PIXELFORMAT_RGB888, SDL_BLENDMODE_BLEND, 2 }
+};
+
+static int width = 1920;
+static int height = 1080;
+static Uint64 min_ticks;
+
+
+/* Fill a surface with a pattern that has every alpha value in it */
+static void
+fill_surface(SDL_Surface *surface, Uint32 seed)
+{
+    int x, y;
+
+    SDL_LockSurface(surface);
+    for (y = 0; y < surface->h; y++) {
+        Uint8 *row = (Uint8 *) surface->pixels + y * surface->pitch;
+        for (x = 0; x < surface->pitch; x++) {
+            seed = (seed * 1103515245) + 12345;
+            row[x] = (Uint8) (seed >> 16);
+        }
+    }
+    SDL_UnlockSurface(surface);
+}
+
+/* Time one blit with (threads) threads. Returns the best time in seconds. */
+static double
+bench(int b, int threads, SDL_Surface *src, SDL_Surface *dst,
+      const void *dstpixels, const void *reference, SDL_bool *identical)
+{
+    const Uint64 freq = SDL_GetPerformanceFrequency();
+    const int dstlen = dst->h * dst->pitch;
+    char value[16];
+    Uint64 total = 0;
+    Uint64 best = 0;
+    int iterations = 0;
+
+    SDL_snprintf(value, sizeof (value), "%d", threads);
+    SDL_SetHint(SDL_HINT_BLIT_THREADS, value);
+
+    *identical = SDL_TRUE;
+    while ((iterations < 3) || (total < min_ticks)) {
+        Uint64 start, ticks;
+        SDL_memcpy(dst->pixels, dstpixels, dstlen);  /* blending reads it. */
+        start = SDL_GetPerformanceCounter();
+        if (src->w == dst->w) {
+            SDL_BlitSurface(src, NULL, dst, NULL);
+        } else {
+            SDL_BlitScaled(src, NULL, dst, NULL);
+        }
+        ticks = SDL_GetPerformanceCounter() - start;
+        if ((iterations == 0) || (ticks < best)) {
+            best = ticks;
+        }
+        total += ticks;
+        iterations++;
+        if (reference && (SDL_memcmp(dst->pixels, reference, dstlen) != 0)) {
+            *identical = SDL_FALSE;
+        }
+    }
+
+    printf("%s,%d,%d,%d,%d,%d,%d,%.3f,%.3f,%.2f",
+           blits[b].name, threads, src->w, src->h, dst->w, dst->h, iterations,
+           (best * 1000000.0) / freq,
+           ((total * 1000000.0) / freq) / iterations,
+           (((double) dst->w * dst->h) / ((double) SDL_max(best, 1) / freq)) / 1000000.0);
+    return (double) SDL_max(best, 1) / freq;
+}
+
+static int
+bench_blit(int b, int maxthreads)
+{
+    const int src_w = (width * blits[b].scale) / 3;
+    const int src_h = (height * blits[b].scale) / 3;
+    SDL_Surface *src = SDL_CreateRGBSurfaceWithFormat(0, src_w, src_h, 0, blits[b].src_format);
+    SDL_Surface *dst = SDL_CreateRGBSurfaceWithFormat(0, width, height, 0, blits[b].dst_format);
+    void *dstpixels = NULL;
+    void *reference = NULL;
+    double single = 0.0;
+    int threads;
+    int mismatches = 0;
+
+    if (!src || !dst) {
+        SDL_Log("Couldn't create surfaces for %s: %s\n", blits[b].name, SDL_GetError());
+        SDL_FreeSurface(src);
+        SDL_FreeSurface(dst);
+        return 1;
+    }
+
+    fill_surface(src, 1);
+    fill_surface(dst, 2);
+    SDL_SetSurfaceBlendMode(src, blits[b].blend);
+    dstpixels = SDL_malloc(dst->h * dst->pitch);
+    reference = SDL_malloc(dst->h * dst->pitch);
+    if (!dstpixels || !reference) {
+        SDL_Log("Out of memory\n");
+        mismatches = 1;
+        goto done;
+    }
+    SDL_memcpy(dstpixels, dst->pixels, dst->h * dst->pitch);
+
+    for (threads = 1; threads <= maxthreads; threads++) {
+        SDL_bool identical;
+        const double seconds = bench(b, threads, src, dst, dstpixels,
+                                     (threads == 1) ? NULL : reference, &identical);
+        if (threads == 1) {
+            single = seconds;
+            SDL_memcpy(reference, dst->pixels, dst->h * dst->pitch);
+        } else if (!identical) {
+            mismatches++;
+        }
+        printf(",%.2f,%s\n", single / seconds, identical ? "yes" : "NO");
+    }
+
+  done:
+    SDL_free(reference);
+    SDL_free(dstpixels);
+    SDL_FreeSurface(src);
+    SDL_FreeSurface(dst);
+    return mismatches;
+}
+
+int
+main(int argc, char **argv)
+{
+    int maxthreads = 0;
+    int msec = 100;
+    int mismatches = 0;
+    int i;
+
+    /* Enable standard application logging */
+    SDL_LogSetPriority(SDL_LOG_CATEGORY_APPLICATION, SDL_LOG_PRIORITY_INFO);
+
+    for (i = 1; i < argc; i++) {
+        if ((SDL_strcmp(argv[i], "--threads") == 0) && argv[i+1]) {
+            maxthreads = SDL_atoi(argv[++i]);
+        } else if ((SDL_strcmp(argv[i], "--msec") == 0) && argv[i+1]) {
+            msec = SDL_atoi(argv[++i]);
+        } else if ((SDL_strcmp(argv[i], "--size") == 0) && argv[i+1]) {
+            if (SDL_sscanf(argv[++i], "%dx%d", &width, &height) != 2) {
+                width = height = 0;
+            }
+        } else {
+            SDL_Log("USAGE: %s [--threads N] [--msec N] [--size WxH]\n", argv[0]);
+            return 1;
+        }
+    }
+    if ((width < 3) || (height < 3) || (msec < 0)) {
+        SDL_Log("--size must be at least 3x3 and --msec can't be negative\n");
+        return 1;
+    }
+
+    if (SDL_Init(0) == -1) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "SDL_Init() failed: %s\n", SDL_GetError());
+        return 2;
+    }
+
+    if (maxthreads <= 0) {
+        maxthreads = SDL_min(SDL_GetCPUCount(), 8);
+    }
+    min_ticks = (SDL_GetPerformanceFrequency() * msec) / 1000;
+
+    printf("# cpus=%d threads=1-%d size=%dx%d\n", SDL_GetCPUCount(), maxthreads, width, height);
+    printf("blit,threads,src_w,src_h,dst_w,dst_h,iterations,best_usec,avg_usec,mpixels_per_sec,speedup,identical\n");
+
+    for (i = 0; i < SDL_arraysize(blits); i++) {
+        mismatches += bench_blit(i, maxthreads);
+    }
+
+    if (mismatches) {
+        SDL_Log("%d threaded blits didn't match the single threaded result!\n", mismatches);
+    }
+    SDL_Quit();
+    return mismatches ? 4 : 0;
+}
+
+/* vi: set ts=4 sw=4 expandtab: */
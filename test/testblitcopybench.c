@@ -0,0 +1,212 @@
+/*
+  Copyright (C) 1997-2017 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely.
+*/
+
+/* Program to time the plain copy blit (same format, no blending) for a
+   range of sizes and row alignments. Results go to stdout as CSV, with the
+   bandwidth in GB/s, so each of SDL's copy paths can be compared:
+
+     testblitcopybench --dispatch scalar > scalar.csv
+     testblitcopybench --dispatch sse > sse.csv
+     testblitcopybench --dispatch avx > avx.csv
+
+   Forcing a dispatch hides the newer CPU features from SDL (see
+   SDL_HINT_CPU_DISABLE_FEATURES), so it can't select code the CPU lacks.
+   Blits run on one thread, so the numbers are for the copy loop itself. */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "SDL.h"
+
+static const struct
+{
+    int w, h;
+} sizes[] = {
+    { 64, 64 },
+    { 320, 240 },
+    { 640, 480 },
+    { 1280, 720 },
+    { 1920, 1080 },
+    { 3840, 2160 }
+};
+
+/* Destination x offsets, in pixels, so rows start at different alignments */
+static const int offsets[] = { 0, 1, 3 };
+
+static const struct
+{
+    const char *name;
+    const char *disable;    /* SDL_HINT_CPU_DISABLE_FEATURES */
+} dispatches[] = {
+    { "auto", NULL },
+    { "scalar", "all" },
+    { "mmx", "sse,altivec,neon" },
+    { "sse", "avx,altivec,neon" },
+    { "avx", "altivec,neon" },
+    { "neon", "mmx,sse,altivec" }
+};
+
+static Uint64 min_ticks;
+
+
+/* Fill a surface with a pattern, so a bad copy shows up */
+static void
+fill_surface(SDL_Surface *surface, Uint32 seed)
+{
+    int x, y;
+
+    for (y = 0; y < surface->h; y++) {
+        Uint8 *row = (Uint8 *) surface->pixels + y * surface->pitch;
+        for (x = 0; x < surface->pitch; x++) {
+            seed = (seed * 1103515245) + 12345;
+            row[x] = (Uint8) (seed >> 16);
+        }
+    }
+}
+
+/* Time one copy. Returns 1 if the copy was wrong, 0 otherwise. */
+static int
+bench(const char *dispatch, int w, int h, int offset)
+{
+    const Uint64 freq = SDL_GetPerformanceFrequency();
+    SDL_Surface *src = SDL_CreateRGBSurfaceWithFormat(0, w, h, 0, SDL_PIXELFORMAT_ARGB8888);
+    SDL_Surface *dst = SDL_CreateRGBSurfaceWithFormat(0, w + offset, h, 0, SDL_PIXELFORMAT_ARGB8888);
+    SDL_Rect dstrect;
+    Uint64 total = 0;
+    Uint64 best = 0;
+    int iterations = 0;
+    int mismatches = 0;
+    int y;
+
+    if (!src || !dst) {
+        SDL_Log("Couldn't create %dx%d surfaces: %s\n", w, h, SDL_GetError());
+        SDL_FreeSurface(src);
+        SDL_FreeSurface(dst);
+        return 1;
+    }
+    fill_surface(src, 1);
+    fill_surface(dst, 2);
+    SDL_SetSurfaceBlendMode(src, SDL_BLENDMODE_NONE);
+
+    dstrect.x = offset;
+    dstrect.y = 0;
+    dstrect.w = w;
+    dstrect.h = h;
+    while ((iterations < 3) || (total < min_ticks)) {
+        Uint64 start, ticks;
+        SDL_Rect rect = dstrect;
+        start = SDL_GetPerformanceCounter();
+        SDL_BlitSurface(src, NULL, dst, &rect);
+        ticks = SDL_GetPerformanceCounter() - start;
+        if ((iterations == 0) || (ticks < best)) {
+            best = ticks;
+        }
+        total += ticks;
+        iterations++;
+    }
+
+    for (y = 0; y < h; y++) {
+        if (SDL_memcmp((Uint8 *) dst->pixels + y * dst->pitch + offset * 4,
+                       (Uint8 *) src->pixels + y * src->pitch, w * 4) != 0) {
+            mismatches++;
+        }
+    }
+
+    printf("%s,%d,%d,%d,%d,%.3f,%.3f,%.2f,%s\n",
+           dispatch, w, h, offset, iterations,
+           (best * 1000000.0) / freq,
+           ((total * 1000000.0) / freq) / iterations,
+           (((double) w * h * 4) / ((double) SDL_max(best, 1) / freq)) / 1000000000.0,
+           mismatches ? "NO" : "yes");
+
+    SDL_FreeSurface(src);
+    SDL_FreeSurface(dst);
+    return mismatches ? 1 : 0;
+}
+
+int
+main(int argc, char **argv)
+{
+    const char *dispatch = "auto";
+    int msec = 100;
+    int mismatches = 0;
+    int i, j;
+
+    /* Enable standard application logging */
+    SDL_LogSetPriority(SDL_LOG_CATEGORY_APPLICATION, SDL_LOG_PRIORITY_INFO);
+
+    for (i = 1; i < argc; i++) {
+        if ((SDL_strcmp(argv[i], "--dispatch") == 0) && argv[i+1]) {
+            dispatch = argv[++i];
+        } else if ((SDL_strcmp(argv[i], "--msec") == 0) && argv[i+1]) {
+            msec = SDL_atoi(argv[++i]);
+        } else {
+            SDL_Log("USAGE: %s [--dispatch auto|scalar|mmx|sse|avx|neon] [--msec N]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (msec < 0) {
+        SDL_Log("--msec can't be negative\n");
+        return 1;
+    }
+
+    for (i = 0; i < SDL_arraysize(dispatches); i++) {
+        if (SDL_strcmp(dispatch, dispatches[i].name) == 0) {
+            break;
+        }
+    }
+    if (i == SDL_arraysize(dispatches)) {
+        SDL_Log("Unknown dispatch '%s'\n", dispatch);
+        return 1;
+    }
+
+    /* This has to happen before anything asks SDL about the CPU. */
+    if (dispatches[i].disable) {
+        SDL_SetHintWithPriority(SDL_HINT_CPU_DISABLE_FEATURES, dispatches[i].disable, SDL_HINT_OVERRIDE);
+    }
+    SDL_SetHint(SDL_HINT_BLIT_THREADS, "1");
+
+    if (SDL_Init(0) == -1) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "SDL_Init() failed: %s\n", SDL_GetError());
+        return 2;
+    }
+
+    if (((SDL_strcmp(dispatch, "mmx") == 0) && !SDL_HasMMX()) ||
+        ((SDL_strcmp(dispatch, "sse") == 0) && !SDL_HasSSE()) ||
+        ((SDL_strcmp(dispatch, "avx") == 0) && !SDL_HasAVX()) ||
+        ((SDL_strcmp(dispatch, "neon") == 0) && !SDL_HasNEON())) {
+        SDL_Log("This CPU can't run the %s code paths\n", dispatch);
+        SDL_Quit();
+        return 3;
+    }
+
+    min_ticks = (SDL_GetPerformanceFrequency() * msec) / 1000;
+
+    printf("# dispatch=%s mmx=%d sse=%d avx=%d neon=%d\n",
+           dispatch, (int) SDL_HasMMX(), (int) SDL_HasSSE(),
+           (int) SDL_HasAVX(), (int) SDL_HasNEON());
+    printf("dispatch,w,h,dst_x,iterations,best_usec,avg_usec,gbytes_per_sec,identical\n");
+
+    for (i = 0; i < SDL_arraysize(sizes); i++) {
+        for (j = 0; j < SDL_arraysize(offsets); j++) {
+            mismatches += bench(dispatch, sizes[i].w, sizes[i].h, offsets[j]);
+        }
+    }
+
+    if (mismatches) {
+        SDL_Log("%d copies didn't match the source!\n", mismatches);
+    }
+    SDL_Quit();
+    return mismatches ? 4 : 0;
+}
+
+/* vi: set ts=4 sw=4 expandtab: */
@@ -0,0 +1,283 @@
+/*
+  Copyright (C) 1997-2017 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely.
+*/
+
+/* Program to time colorkeyed sprite blits: a screen's worth of round
+   sprites with keyed corners, drawn over a background each frame. Results
+   go to stdout as CSV, with a checksum of the finished frame, so each of
+   SDL's code paths can be timed and checked against the others:
+
+     testcolorkeybench --dispatch scalar > scalar.csv
+     testcolorkeybench --dispatch sse2 > sse2.csv
+     testcolorkeybench --dispatch avx2 > avx2.csv
+
+   Forcing a dispatch hides the newer CPU features from SDL (see
+   SDL_HINT_CPU_DISABLE_FEATURES), so it can't select code the CPU lacks.
+   Blits run on one thread, so the numbers are for the blit loops. */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "SDL.h"
+
+static const struct
+{
+    const char *name;
+    Uint32 src_format;
+    Uint32 dst_format;
+    int alpha;          /* surface alpha, or -1 for a plain colorkey blit */
+} scenes[] = {
+    { "565", SDL_PIXELFORMAT_RGB565, SDL_PIXELFORMAT_RGB565, -1 },
+    { "555", SDL_PIXELFORMAT_RGB555, SDL_PIXELFORMAT_RGB555, -1 },
+    { "xrgb", SDL_PIXELFORMAT_RGB888, SDL_PIXELFORMAT_RGB888, -1 },
+    { "argb", SDL_PIXELFORMAT_ARGB8888, SDL_PIXELFORMAT_ARGB8888, -1 },
+    { "swizzle", SDL_PIXELFORMAT_ARGB8888, SDL_PIXELFORMAT_ABGR8888, -1 },
+    { "alpha", SDL_PIXELFORMAT_RGB888, SDL_PIXELFORMAT_RGB888, 128 },
+    { "alphaargb", SDL_PIXELFORMAT_RGB888, SDL_PIXELFORMAT_ARGB8888, 200 }
+};
+
+static const struct
+{
+    const char *name;
+    const char *disable;    /* SDL_HINT_CPU_DISABLE_FEATURES */
+} dispatches[] = {
+    { "auto", NULL },
+    { "scalar", "all" },
+    { "sse2", "sse41,altivec,neon" },
+    { "sse41", "avx2,altivec,neon" },
+    { "avx2", "altivec,neon" },
+    { "neon", "mmx,sse,altivec" }
+};
+
+static int width = 1920;
+static int height = 1080;
+static int sprite_size = 64;
+static int sprite_count = 1000;
+static Uint64 min_ticks;
+
+
+/* A round sprite with a pattern in it; everything outside the circle is
+   the colorkey. */
+static SDL_Surface *
+create_sprite(Uint32 format, Uint32 *key)
+{
+    SDL_Surface *sprite = SDL_CreateRGBSurfaceWithFormat(0, sprite_size, sprite_size, 0, format);
+    const int r = sprite_size / 2;
+    int x, y;
+
+    if (!sprite) {
+        return NULL;
+    }
+    *key = SDL_MapRGB(sprite->format, 0xFF, 0x00, 0xFF);
+    for (y = 0; y < sprite_size; y++) {
+        for (x = 0; x < sprite_size; x++) {
+            const int dx = x - r, dy = y - r;
+            Uint32 pixel = *key;
+            if ((dx * dx) + (dy * dy) < (r * r)) {
+                pixel = SDL_MapRGBA(sprite->format, (Uint8) (x * 4), (Uint8) (y * 4),
+                                    (Uint8) ((x ^ y) * 8), (Uint8) (x + y));
+                if (pixel == *key) {
+                    pixel ^= 1;
+                }
+            }
+            SDL_memcpy((Uint8 *) sprite->pixels + y * sprite->pitch + x * sprite->format->BytesPerPixel,
+                       &pixel, sprite->format->BytesPerPixel);
+        }
+    }
+    return sprite;
+}
+
+/* Fill a surface with a pattern, so blending has something to work on */
+static void
+fill_surface(SDL_Surface *surface, Uint32 seed)
+{
+    int x, y;
+
+    for (y = 0; y < surface->h; y++) {
+        Uint8 *row = (Uint8 *) surface->pixels + y * surface->pitch;
+        for (x = 0; x < surface->pitch; x++) {
+            seed = (seed * 1103515245) + 12345;
+            row[x] = (Uint8) (seed >> 16);
+        }
+    }
+}
+
+/* Draw one frame: the background, then every sprite at the same places
+   each time, some of them partly off the screen. */
+static void
+draw_frame(SDL_Surface *screen, SDL_Surface *background, SDL_Surface *sprite)
+{
+    Uint32 seed = 1;
+    int i;
+
+    SDL_memcpy(screen->pixels, background->pixels, screen->h * screen->pitch);
+    for (i = 0; i < sprite_count; i++) {
+        SDL_Rect rect;
+        seed = (seed * 1103515245) + 12345;
+        rect.x = (int) ((seed >> 8) % (Uint32) (width + sprite_size)) - sprite_size / 2;
+        seed = (seed * 1103515245) + 12345;
+        rect.y = (int) ((seed >> 8) % (Uint32) (height + sprite_size)) - sprite_size / 2;
+        rect.w = sprite_size;
+        rect.h = sprite_size;
+        SDL_BlitSurface(sprite, NULL, screen, &rect);
+    }
+}
+
+static Uint32
+checksum(SDL_Surface *surface)
+{
+    Uint32 sum = 5381;
+    int x, y;
+
+    for (y = 0; y < surface->h; y++) {
+        const Uint8 *row = (const Uint8 *) surface->pixels + y * surface->pitch;
+        for (x = 0; x < surface->w * surface->format->BytesPerPixel; x++) {
+            sum = (sum * 33) + row[x];
+        }
+    }
+    return sum;
+}
+
+/* Time one scene. Returns 1 if the surfaces couldn't be set up. */
+static int
+bench(const char *dispatch, int s)
+{
+    const Uint64 freq = SDL_GetPerformanceFrequency();
+    SDL_Surface *screen = SDL_CreateRGBSurfaceWithFormat(0, width, height, 0, scenes[s].dst_format);
+    SDL_Surface *background = SDL_CreateRGBSurfaceWithFormat(0, width, height, 0, scenes[s].dst_format);
+    SDL_Surface *sprite;
+    Uint32 key = 0;
+    Uint64 total = 0;
+    Uint64 best = 0;
+    int iterations = 0;
+
+    sprite = create_sprite(scenes[s].src_format, &key);
+    if (!screen || !background || !sprite) {
+        SDL_Log("Couldn't create surfaces for %s: %s\n", scenes[s].name, SDL_GetError());
+        SDL_FreeSurface(screen);
+        SDL_FreeSurface(background);
+        SDL_FreeSurface(sprite);
+        return 1;
+    }
+    fill_surface(background, 2);
+    SDL_SetColorKey(sprite, SDL_TRUE, key);
+    if (scenes[s].alpha < 0) {
+        SDL_SetSurfaceBlendMode(sprite, SDL_BLENDMODE_NONE);
+    } else {
+        SDL_SetSurfaceBlendMode(sprite, SDL_BLENDMODE_BLEND);
+        SDL_SetSurfaceAlphaMod(sprite, (Uint8) scenes[s].alpha);
+    }
+
+    while ((iterations < 3) || (total < min_ticks)) {
+        Uint64 start, ticks;
+        start = SDL_GetPerformanceCounter();
+        draw_frame(screen, background, sprite);
+        ticks = SDL_GetPerformanceCounter() - start;
+        if ((iterations == 0) || (ticks < best)) {
+            best = ticks;
+        }
+        total += ticks;
+        iterations++;
+    }
+
+    printf("%s,%s,%d,%d,%d,%.3f,%.3f,%.3f,%08x\n",
+           scenes[s].name, dispatch, sprite_size, sprite_count, iterations,
+           (best * 1000.0) / freq,
+           ((total * 1000.0) / freq) / iterations,
+           ((double) sprite_count / ((double) SDL_max(best, 1) / freq)) / 1000000.0,
+           checksum(screen));
+
+    SDL_FreeSurface(screen);
+    SDL_FreeSurface(background);
+    SDL_FreeSurface(sprite);
+    return 0;
+}
+
+int
+main(int argc, char **argv)
+{
+    const char *dispatch = "auto";
+    int msec = 200;
+    int failures = 0;
+    int i;
+
+    /* Enable standard application logging */
+    SDL_LogSetPriority(SDL_LOG_CATEGORY_APPLICATION, SDL_LOG_PRIORITY_INFO);
+
+    for (i = 1; i < argc; i++) {
+        if ((SDL_strcmp(argv[i], "--dispatch") == 0) && argv[i+1]) {
+            dispatch = argv[++i];
+        } else if ((SDL_strcmp(argv[i], "--msec") == 0) && argv[i+1]) {
+            msec = SDL_atoi(argv[++i]);
+        } else if ((SDL_strcmp(argv[i], "--sprites") == 0) && argv[i+1]) {
+            sprite_count = SDL_atoi(argv[++i]);
+        } else if ((SDL_strcmp(argv[i], "--sprite-size") == 0) && argv[i+1]) {
+            sprite_size = SDL_atoi(argv[++i]);
+        } else if ((SDL_strcmp(argv[i], "--size") == 0) && argv[i+1]) {
+            if (SDL_sscanf(argv[++i], "%dx%d", &width, &height) != 2) {
+                width = height = 0;
+            }
+        } else {
+            SDL_Log("USAGE: %s [--dispatch auto|scalar|sse2|sse41|avx2|neon] [--msec N] [--sprites N] [--sprite-size N] [--size WxH]\n", argv[0]);
+            return 1;
+        }
+    }
+    if ((width < 1) || (height < 1) || (sprite_size < 2) || (sprite_count < 0) || (msec < 0)) {
+        SDL_Log("--size and --sprite-size must be positive and --sprites and --msec can't be negative\n");
+        return 1;
+    }
+
+    for (i = 0; i < SDL_arraysize(dispatches); i++) {
+        if (SDL_strcmp(dispatch, dispatches[i].name) == 0) {
+            break;
+        }
+    }
+    if (i == SDL_arraysize(dispatches)) {
+        SDL_Log("Unknown dispatch '%s'\n", dispatch);
+        return 1;
+    }
+
+    /* This has to happen before anything asks SDL about the CPU. */
+    if (dispatches[i].disable) {
+        SDL_SetHintWithPriority(SDL_HINT_CPU_DISABLE_FEATURES, dispatches[i].disable, SDL_HINT_OVERRIDE);
+    }
+    SDL_SetHint(SDL_HINT_BLIT_THREADS, "1");
+
+    if (SDL_Init(0) == -1) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "SDL_Init() failed: %s\n", SDL_GetError());
+        return 2;
+    }
+
+    if (((SDL_strcmp(dispatch, "sse2") == 0) && !SDL_HasSSE2()) ||
+        ((SDL_strcmp(dispatch, "sse41") == 0) && !SDL_HasSSE41()) ||
+        ((SDL_strcmp(dispatch, "avx2") == 0) && !SDL_HasAVX2()) ||
+        ((SDL_strcmp(dispatch, "neon") == 0) && !SDL_HasNEON())) {
+        SDL_Log("This CPU can't run the %s code paths\n", dispatch);
+        SDL_Quit();
+        return 3;
+    }
+
+    min_ticks = (SDL_GetPerformanceFrequency() * msec) / 1000;
+
+    printf("# dispatch=%s sse2=%d sse41=%d avx2=%d neon=%d size=%dx%d\n",
+           dispatch, (int) SDL_HasSSE2(), (int) SDL_HasSSE41(),
+           (int) SDL_HasAVX2(), (int) SDL_HasNEON(), width, height);
+    printf("scene,dispatch,sprite_size,sprites,iterations,best_msec,avg_msec,msprites_per_sec,checksum\n");
+
+    for (i = 0; i < SDL_arraysize(scenes); i++) {
+        failures += bench(dispatch, i);
+    }
+
+    SDL_Quit();
+    return failures ? 4 : 0;
+}
+
+/* vi: set ts=4 sw=4 expandtab: */
@@ -0,0 +1,293 @@
+/*
+  Copyright (C) 1997-2017 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely.
+*/
+
+/* Checks SDL_MixAudioFormat() against a plain C reference, bit for bit, for
+   the formats that have SIMD mixers, and then reports how fast it mixes
+   every format. */
+
+#include "SDL.h"
+
+static const struct
+{
+    SDL_AudioFormat format;
+    const char *name;
+} formats[] = {
+    { AUDIO_U8, "AUDIO_U8" },
+    { AUDIO_S8, "AUDIO_S8" },
+    { AUDIO_U16LSB, "AUDIO_U16LSB" },
+    { AUDIO_U16MSB, "AUDIO_U16MSB" },
+    { AUDIO_S16LSB, "AUDIO_S16LSB" },
+    { AUDIO_S16MSB, "AUDIO_S16MSB" },
+    { AUDIO_S32LSB, "AUDIO_S32LSB" },
+    { AUDIO_S32MSB, "AUDIO_S32MSB" },
+    { AUDIO_F32LSB, "AUDIO_F32LSB" },
+    { AUDIO_F32MSB, "AUDIO_F32MSB" }
+};
+
+static const int volumes[] = { 1, 17, 64, 100, 127, SDL_MIX_MAXVOLUME };
+
+static Uint32 seed = 0x12345678;
+
+static Uint32
+random_u32(void)
+{
+    /* xorshift32; we want the same data on every run. */
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    return seed;
+}
+
+static Sint32
+random_s32(void)
+{
+    /* Mix in full scale values, so the saturation gets exercised. */
+    switch (random_u32() % 8) {
+        case 0: return (Sint32) 0x7FFFFFFF;
+        case 1: return (Sint32) 0x80000000;
+        default: break;
+    }
+    return (Sint32) random_u32();
+}
+
+static Sint16
+random_s16(void)
+{
+    switch (random_u32() % 8) {
+        case 0: return 32767;
+        case 1: return -32768;
+        default: break;
+    }
+    return (Sint16) random_u32();
+}
+
+static float
+random_float(void)
+{
+    switch (random_u32() % 16) {
+        case 0: return -1.0f;
+        case 1: return 1.0f;
+        case 2: return 0.0f;
+        case 3: return 3.0e+38f;
+        case 4: return -3.0e+38f;
+        default: break;
+    }
+    return (((float) (random_u32() % 2000001)) / 1000000.0f) - 1.0f;
+}
+
+static void
+fill_random(Uint8 *buf, const SDL_AudioFormat format, const int samples)
+{
+    int i;
+    for (i = 0; i < samples; i++) {
+        switch (format) {
+            case AUDIO_S16SYS: ((Sint16 *) buf)[i] = random_s16(); break;
+            case AUDIO_S32SYS: ((Sint32 *) buf)[i] = random_s32(); break;
+            case AUDIO_F32SYS: ((float *) buf)[i] = random_float(); break;
+            default:
+                {
+                    const int size = SDL_AUDIO_BITSIZE(format) / 8;
+                    int j;
+                    for (j = 0; j < size; j++) {
+                        buf[(i * size) + j] = (Uint8) random_u32();
+                    }
+                }
+                break;
+        }
+    }
+}
+
+/* The same math the scalar code in SDL_mixer.c does. */
+static void
+reference_mix(Uint8 *dst, const Uint8 *src, const SDL_AudioFormat format,
+              const int samples, const int volume)
+{
+    int i;
+    switch (format) {
+        case AUDIO_S16SYS:
+            for (i = 0; i < samples; i++) {
+                const int s = (((int) ((const Sint16 *) src)[i]) * volume) / SDL_MIX_MAXVOLUME;
+                const int sum = ((Sint16 *) dst)[i] + s;
+                ((Sint16 *) dst)[i] = (Sint16) SDL_max(-32768, SDL_min(32767, sum));
+            }
+            break;
+
+        case AUDIO_S32SYS:
+            for (i = 0; i < samples; i++) {
+                const Sint64 s = (((Sint64) ((const Sint32 *) src)[i]) * volume) / SDL_MIX_MAXVOLUME;
+                const Sint64 sum = ((Sint32 *) dst)[i] + s;
+                ((Sint32 *) dst)[i] = (Sint32) SDL_max(-((Sint64) 0x80000000), SDL_min((Sint64) 0x7FFFFFFF, sum));
+            }
+            break;
+
+        case AUDIO_F32SYS:
+            for (i = 0; i < samples; i++) {
+                const float s = (((const float *) src)[i] * ((float) volume)) * (1.0f / ((float) SDL_MIX_MAXVOLUME));
+                const double sum = ((double) s) + ((double) ((float *) dst)[i]);
+                ((float *) dst)[i] = (float) SDL_max(-3.402823466e+38F, SDL_min(3.402823466e+38F, sum));
+            }
+            break;
+
+        default:
+            SDL_assert(!"unexpected format");
+            break;
+    }
+}
+
+/* Mix (samples) with both buffers starting (misalign) samples past a
+   32-byte boundary, and compare to the reference mixer. */
+static int
+check_mix(const SDL_AudioFormat format, const char *name, const int samples,
+          const int misalign, const int volume)
+{
+    const int size = SDL_AUDIO_BITSIZE(format) / 8;
+    const int len = samples * size;
+    Uint8 *srcbase = (Uint8 *) SDL_malloc(len + (misalign * size) + 32);
+    Uint8 *dstbase = (Uint8 *) SDL_malloc(len + (misalign * size) + 32);
+    Uint8 *expected = (Uint8 *) SDL_malloc(len + 1);
+    Uint8 *src, *dst;
+    int retval = 0;
+    int i;
+
+    if (!srcbase || !dstbase || !expected) {
+        SDL_Log("Out of memory!");
+        SDL_free(srcbase);
+        SDL_free(dstbase);
+        SDL_free(expected);
+        return -1;
+    }
+
+    src = (Uint8 *) (((((size_t) srcbase) + 31) & ~((size_t) 31)) + (misalign * size));
+    dst = (Uint8 *) (((((size_t) dstbase) + 31) & ~((size_t) 31)) + (misalign * size));
+    fill_random(src, format, samples);
+    fill_random(dst, format, samples);
+    SDL_memcpy(expected, dst, len);
+
+    reference_mix(expected, src, format, samples, volume);
+    SDL_MixAudioFormat(dst, src, format, (Uint32) len, volume);
+
+    for (i = 0; i < samples; i++) {
+        if (SDL_memcmp(dst + (i * size), expected + (i * size), size) != 0) {
+            Uint32 want = 0, got = 0;
+            SDL_memcpy(&want, expected + (i * size), size);
+            SDL_memcpy(&got, dst + (i * size), size);
+            SDL_Log("%s: mismatch at sample %d of %d (misalign %d, volume %d): expected 0x%08X, got 0x%08X",
+                    name, i, samples, misalign, volume, (unsigned int) want, (unsigned int) got);
+            retval = -1;
+            break;
+        }
+    }
+
+    SDL_free(srcbase);
+    SDL_free(dstbase);
+    SDL_free(expected);
+    return retval;
+}
+
+static double
+benchmark_mix(const SDL_AudioFormat format, const SDL_bool reference,
+              const int samples, const int iterations)
+{
+    const int size = SDL_AUDIO_BITSIZE(format) / 8;
+    const double freq = (double) SDL_GetPerformanceFrequency();
+    Uint8 *src = (Uint8 *) SDL_malloc(samples * size);
+    Uint8 *dst = (Uint8 *) SDL_malloc(samples * size);
+    Uint64 total = 0;
+    int i;
+
+    if (!src || !dst) {
+        SDL_free(src);
+        SDL_free(dst);
+        return 0.0;
+    }
+
+    fill_random(src, format, samples);
+    fill_random(dst, format, samples);
+
+    for (i = 0; i < iterations; i++) {
+        const Uint64 start = SDL_GetPerformanceCounter();
+        if (reference) {
+            reference_mix(dst, src, format, samples, SDL_MIX_MAXVOLUME / 2);
+        } else {
+            SDL_MixAudioFormat(dst, src, format, samples * size, SDL_MIX_MAXVOLUME / 2);
+        }
+        total += SDL_GetPerformanceCounter() - start;
+    }
+
+    SDL_free(src);
+    SDL_free(dst);
+
+    if (!total) {
+        return 0.0;
+    }
+    return ((double) samples * iterations) / (((double) total) / freq) / 1000000.0;
+}
+
+int
+main(int argc, char **argv)
+{
+    static const SDL_AudioFormat checked[] = { AUDIO_S16SYS, AUDIO_S32SYS, AUDIO_F32SYS };
+    int iterations = 200;
+    int failures = 0;
+    int i, j, samples, misalign;
+
+    /* Enable standard application logging */
+    SDL_LogSetPriority(SDL_LOG_CATEGORY_APPLICATION, SDL_LOG_PRIORITY_INFO);
+
+    if (argc > 1) {
+        iterations = SDL_atoi(argv[1]);
+    }
+
+    if (SDL_Init(0) < 0) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't initialize SDL: %s\n", SDL_GetError());
+        return 1;
+    }
+
+    SDL_Log("CPU features: SSE2=%d AVX2=%d NEON=%d", (int) SDL_HasSSE2(), (int) SDL_HasAVX2(), (int) SDL_HasNEON());
+
+    for (i = 0; i < SDL_arraysize(checked); i++) {
+        const char *name = NULL;
+        for (j = 0; j < SDL_arraysize(formats); j++) {
+            if (formats[j].format == checked[i]) {
+                name = formats[j].name;
+            }
+        }
+        for (j = 0; j < SDL_arraysize(volumes); j++) {
+            for (samples = 0; samples < 70; samples++) {
+                for (misalign = 0; misalign < 8; misalign++) {
+                    failures += (check_mix(checked[i], name, samples, misalign, volumes[j]) < 0);
+                }
+            }
+        }
+    }
+
+    SDL_Log("Exactness check: %s (%d failures)", failures ? "FAILED" : "passed", failures);
+
+    if (iterations > 0) {
+        for (i = 0; i < SDL_arraysize(formats); i++) {
+            const SDL_AudioFormat fmt = formats[i].format;
+            const double mixed = benchmark_mix(fmt, SDL_FALSE, 64 * 1024, iterations);
+            if ((fmt == AUDIO_S16SYS) || (fmt == AUDIO_S32SYS) || (fmt == AUDIO_F32SYS)) {
+                const double plain = benchmark_mix(fmt, SDL_TRUE, 64 * 1024, iterations);
+                SDL_Log("%-12s %10.1f Msamples/sec (plain C: %.1f, %.2fx)",
+                        formats[i].name, mixed, plain, (plain > 0.0) ? (mixed / plain) : 0.0);
+            } else {
+                SDL_Log("%-12s %10.1f Msamples/sec", formats[i].name, mixed);
+            }
+        }
+    }
+
+    SDL_Quit();
+    return failures ? 1 : 0;
+}
+
+/* vi: set ts=4 sw=4 expandtab: */